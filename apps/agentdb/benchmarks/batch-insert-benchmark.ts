@@ -0,0 +1,130 @@
+/**
+ * Batch Insert Benchmark - main-thread cost of batchInsertParallel
+ *
+ * Inserts the same synthetic episode rows (text, JSON metadata, a Float32
+ * embedding) with inline and with worker serialization, and reports wall
+ * time and main-thread active time from performance.eventLoopUtilization().
+ * The SQLite writes run on the main thread either way; the difference is
+ * what serialization and the hand-off back from the workers cost it.
+ *
+ * The hand-off is also measured on its own: the main-thread cost of taking
+ * a worker's serialized chunk and building bind arguments from it, for
+ * structured-cloned bind arrays versus transferred packRows() output.
+ *
+ * Usage:
+ *   tsx benchmarks/batch-insert-benchmark.ts --rows 100000 --dim 384 --runs 3
+ */
+
+import { performance } from 'perf_hooks';
+import { deserialize, serialize } from 'v8';
+import Database from 'better-sqlite3';
+import { BatchOperations } from '../src/optimizations/BatchOperations.js';
+import { packRows, readPackedRow, serializeRows } from '../src/optimizations/row-serializer.js';
+
+const COLUMNS = ['session_id', 'task', 'reward', 'metadata', 'embedding'];
+
+function parseArgs(argv: string[]): Map<string, string> {
+  const args = new Map<string, string>();
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith('--')) {
+      const [key, inline] = argv[i].slice(2).split('=', 2);
+      args.set(key, inline ?? argv[++i] ?? '');
+    }
+  }
+  return args;
+}
+
+function createRows(count: number, dimension: number): Array<Record<string, any>> {
+  return Array.from({ length: count }, (_, i) => ({
+    session_id: `session-${i % 64}`,
+    task: `summarize the deployment log for service ${i % 500} and note failures`,
+    reward: (i % 100) / 100,
+    metadata: { index: i, tags: ['deploy', `shard-${i % 8}`] },
+    embedding: Float32Array.from({ length: dimension }, (_, d) => Math.sin(i * 0.01 + d)),
+  }));
+}
+
+async function run(rows: Array<Record<string, any>>, useWorkers: boolean) {
+  const db = new Database(':memory:');
+  db.exec(`
+    CREATE TABLE episodes (
+      id INTEGER PRIMARY KEY, session_id TEXT, task TEXT, reward REAL, metadata TEXT, embedding BLOB
+    )
+  `);
+  const ops = new BatchOperations(db, {} as any);
+
+  const elu = performance.eventLoopUtilization();
+  const start = performance.now();
+  const result = await ops.batchInsertParallel('episodes', rows, COLUMNS, { chunkSize: 1000, useWorkers });
+  const wallMs = performance.now() - start;
+  const { active } = performance.eventLoopUtilization(elu);
+  db.close();
+
+  if (result.totalInserted !== rows.length) {
+    throw new Error(`Inserted ${result.totalInserted} of ${rows.length} rows`);
+  }
+  return { wallMs, mainThreadMs: active };
+}
+
+/**
+ * Main-thread ms to receive every chunk and build its bind arguments.
+ * v8.serialize() is the wire format of postMessage; transferred buffers
+ * are not part of the message, so only the rest is deserialized.
+ */
+function measureHandoff(rows: Array<Record<string, any>>, chunkSize: number) {
+  const chunks: Array<Array<Record<string, any>>> = [];
+  for (let i = 0; i < rows.length; i += chunkSize) chunks.push(rows.slice(i, i + chunkSize));
+
+  const cloned = chunks.map((chunk) => serialize(serializeRows(chunk, COLUMNS)));
+  let start = performance.now();
+  for (const message of cloned) {
+    for (const row of deserialize(message) as any[][]) {
+      row.map((value) => (value instanceof Uint8Array ? Buffer.from(value.buffer, value.byteOffset, value.byteLength) : value));
+    }
+  }
+  const clonedMs = performance.now() - start;
+
+  const packed = chunks.map((chunk) => packRows(chunk, COLUMNS));
+  const messages = packed.map(({ tags, values, ends, bytes, ...rest }) => serialize(rest));
+  start = performance.now();
+  packed.forEach((chunk, i) => {
+    deserialize(messages[i]);
+    const args = new Array(chunk.columnCount);
+    for (let r = 0; r < chunk.length; r++) readPackedRow(chunk, r, args);
+  });
+  const packedMs = performance.now() - start;
+
+  return { clonedMs, packedMs };
+}
+
+async function main(): Promise<void> {
+  const args = parseArgs(process.argv.slice(2));
+  const count = parseInt(args.get('rows') ?? '100000', 10);
+  const dimension = parseInt(args.get('dim') ?? '384', 10);
+  const runs = parseInt(args.get('runs') ?? '3', 10);
+  const rows = createRows(count, dimension);
+
+  console.log(`[BatchInsertBenchmark] rows=${count}, dim=${dimension}, runs=${runs}`);
+  for (const useWorkers of [false, true]) {
+    const samples = [];
+    for (let i = 0; i < runs; i++) samples.push(await run(rows, useWorkers));
+    const best = samples.sort((a, b) => a.mainThreadMs - b.mainThreadMs)[0];
+    console.log(
+      `[BatchInsertBenchmark] ${useWorkers ? 'workers' : 'inline '}: ` +
+        `wall ${best.wallMs.toFixed(0)}ms, main thread ${best.mainThreadMs.toFixed(0)}ms`
+    );
+  }
+
+  const handoffs = Array.from({ length: runs }, () => measureHandoff(rows, 1000));
+  const cloned = Math.min(...handoffs.map((h) => h.clonedMs));
+  const packed = Math.min(...handoffs.map((h) => h.packedMs));
+  console.log(
+    `[BatchInsertBenchmark] hand-off: cloned arrays ${cloned.toFixed(0)}ms, packed ${packed.toFixed(0)}ms ` +
+      `(${(cloned / Math.max(packed, 0.001)).toFixed(1)}x less main-thread time)`
+  );
+}
+
+main().catch((error) => {
+  console.error('[BatchInsertBenchmark] Failed:', error);
+  process.exit(1);
+});
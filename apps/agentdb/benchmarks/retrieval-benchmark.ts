@@ -0,0 +1,554 @@
+/**
+ * Retrieval Benchmark - every vector backend on one dataset, at several scales
+ *
+ * Builds HNSWLibBackend, RuVectorBackend, WASMVectorSearch (brute force) and
+ * the browser HNSWIndex over the same vectors and reports, per backend, scale
+ * and M: build time, RSS growth, and for each efSearch the QPS, p50/p99
+ * latency and recall@k against exact ground truth. Results are written as
+ * JSON so backend defaults (backends/detector.ts) can be chosen from data.
+ *
+ * Datasets: SIFT (.fvecs), GloVe (.txt) and OpenAI embedding samples
+ * (.jsonl/.json) load from --base/--query files. Without files, a seeded
+ * clustered synthetic set at the preset's dimension is generated, so runs
+ * are reproducible anywhere. Vectors are L2-normalized and searched with
+ * cosine, which ranks identically to L2 on unit vectors and keeps recall
+ * comparable across backends.
+ *
+ * Usage:
+ *   tsx benchmarks/retrieval-benchmark.ts --dataset openai --scales 1000,10000
+ *   tsx benchmarks/retrieval-benchmark.ts --dataset sift --base sift_base.fvecs --query sift_query.fvecs
+ *   tsx benchmarks/retrieval-benchmark.ts --backends hnswlib,wasm-brute --M 16 --ef 32,64 --out run.json
+ */
+
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import { LatencyHistogram } from '../src/observability/latency.js';
+import { dotBatch, l2Norm, selectTopK } from '../src/utils/vector-kernels.js';
+
+type BackendName = 'hnswlib' | 'ruvector' | 'wasm-brute' | 'browser-hnsw';
+
+const ALL_BACKENDS: BackendName[] = ['hnswlib', 'ruvector', 'wasm-brute', 'browser-hnsw'];
+
+const DATASET_DIMENSIONS: Record<string, number> = {
+  sift: 128,
+  glove: 100,
+  openai: 1536,
+};
+
+interface BenchmarkOptions {
+  dataset: string;
+  base?: string;
+  query?: string;
+  dimension: number;
+  scales: number[];
+  queries: number;
+  k: number;
+  M: number[];
+  ef: number[];
+  efConstruction: number;
+  backends: BackendName[];
+  seed: number;
+  warmup: number;
+  targetRecall: number;
+  out: string;
+}
+
+interface IndexParams {
+  dimension: number;
+  M: number;
+  efConstruction: number;
+}
+
+/**
+ * One backend behind a uniform build/search surface; search returns row indices
+ */
+interface BenchAdapter {
+  readonly tunable: boolean;
+  build(vectors: Float32Array[], params: IndexParams): Promise<void>;
+  search(query: Float32Array, k: number, ef: number): number[];
+  close(): void;
+}
+
+interface EfRun {
+  ef: number | null;
+  qps: number;
+  p50Ms: number;
+  p99Ms: number;
+  meanMs: number;
+  recall: number;
+}
+
+interface BackendResult {
+  backend: BackendName;
+  scale: number;
+  M: number | null;
+  efConstruction: number | null;
+  buildTimeMs: number;
+  rssMB: { before: number; after: number; delta: number };
+  runs: EfRun[];
+}
+
+// ============================================================================
+// Backend adapters
+// ============================================================================
+
+/**
+ * Adapters import their backend lazily so a missing native package skips
+ * that backend instead of failing the run
+ */
+const ADAPTERS: Record<BackendName, () => Promise<BenchAdapter>> = {
+  async hnswlib() {
+    const { HNSWLibBackend } = await import('../src/backends/hnswlib/HNSWLibBackend.js');
+    let backend: InstanceType<typeof HNSWLibBackend> | null = null;
+    return {
+      tunable: true,
+      async build(vectors, params) {
+        backend = new HNSWLibBackend({ ...params, metric: 'cosine', maxElements: vectors.length });
+        await backend.initialize();
+        backend.beginBulkLoad();
+        backend.insertBatch(vectors.map((embedding, i) => ({ id: String(i), embedding })));
+        await backend.endBulkLoad();
+      },
+      search(query, k, ef) {
+        return backend!.search(query, k, { efSearch: ef }).map((r) => Number(r.id));
+      },
+      close() {
+        backend?.close();
+      },
+    };
+  },
+
+  async ruvector() {
+    const { RuVectorBackend } = await import('../src/backends/ruvector/RuVectorBackend.js');
+    let backend: InstanceType<typeof RuVectorBackend> | null = null;
+    return {
+      tunable: true,
+      async build(vectors, params) {
+        backend = new RuVectorBackend({ ...params, metric: 'cosine', maxElements: vectors.length });
+        await backend.initialize();
+        backend.beginBulkLoad();
+        backend.insertBatch(vectors.map((embedding, i) => ({ id: String(i), embedding })));
+        await backend.endBulkLoad();
+      },
+      search(query, k, ef) {
+        return backend!.search(query, k, { efSearch: ef }).map((r) => Number(r.id));
+      },
+      close() {
+        backend?.close();
+      },
+    };
+  },
+
+  async 'wasm-brute'() {
+    const { WASMVectorSearch } = await import('../src/controllers/WASMVectorSearch.js');
+    let search: InstanceType<typeof WASMVectorSearch> | null = null;
+    return {
+      tunable: false,
+      async build(vectors) {
+        // The index path never touches the database
+        search = new WASMVectorSearch(null as any, { indexThreshold: 0 });
+        search.buildIndex(vectors, vectors.map((_, i) => i));
+      },
+      search(query, k) {
+        return search!.searchIndex(query, k).map((r) => r.id);
+      },
+      close() {
+        search?.clearIndex();
+      },
+    };
+  },
+
+  async 'browser-hnsw'() {
+    const { HNSWIndex } = await import('../src/browser/HNSWIndex.js');
+    let index: InstanceType<typeof HNSWIndex> | null = null;
+    return {
+      tunable: true,
+      async build(vectors, params) {
+        index = new HNSWIndex({ ...params, distanceFunction: 'cosine' });
+        vectors.forEach((vector, i) => index!.add(vector, i));
+      },
+      search(query, k, ef) {
+        return index!.search(query, k, ef).map((r) => r.id);
+      },
+      close() {
+        index?.clear();
+      },
+    };
+  },
+};
+
+// ============================================================================
+// Datasets
+// ============================================================================
+
+/**
+ * Seeded PRNG (mulberry32) so synthetic datasets are identical across runs
+ */
+function createRandom(seed: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function createGaussian(random: () => number): () => number {
+  return () => Math.sqrt(-2 * Math.log(1 - random())) * Math.cos(2 * Math.PI * random());
+}
+
+/**
+ * Gaussian clusters around random centroids; uniform noise would make every
+ * neighbor equidistant and recall meaningless
+ */
+function generateSynthetic(count: number, dimension: number, seed: number): Float32Array[] {
+  const gaussian = createGaussian(createRandom(seed));
+  const clusters = Math.max(8, Math.round(Math.sqrt(count)));
+  const centroids = Array.from({ length: clusters }, () => {
+    const c = new Float32Array(dimension);
+    for (let d = 0; d < dimension; d++) c[d] = gaussian();
+    return c;
+  });
+
+  const spread = 0.35;
+  return Array.from({ length: count }, (_, i) => {
+    const centroid = centroids[i % clusters];
+    const v = new Float32Array(dimension);
+    for (let d = 0; d < dimension; d++) v[d] = centroid[d] + spread * gaussian();
+    return v;
+  });
+}
+
+/**
+ * .fvecs: per vector, an int32 dimension followed by that many float32s
+ */
+function readFvecs(file: string, limit: number): Float32Array[] {
+  const buffer = fs.readFileSync(file);
+  const view = new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength);
+  const vectors: Float32Array[] = [];
+  let offset = 0;
+  while (offset < buffer.byteLength && vectors.length < limit) {
+    const dimension = view.getInt32(offset, true);
+    offset += 4;
+    const v = new Float32Array(dimension);
+    for (let d = 0; d < dimension; d++) v[d] = view.getFloat32(offset + d * 4, true);
+    offset += dimension * 4;
+    vectors.push(v);
+  }
+  return vectors;
+}
+
+/**
+ * GloVe text (token followed by floats), JSON lines (array or {embedding}),
+ * or a JSON array of either
+ */
+function readTextVectors(file: string, limit: number): Float32Array[] {
+  const text = fs.readFileSync(file, 'utf-8');
+  const toVector = (item: any) => Float32Array.from(Array.isArray(item) ? item : item.embedding ?? item.vector);
+
+  if (file.endsWith('.json')) {
+    return (JSON.parse(text) as any[]).slice(0, limit).map(toVector);
+  }
+
+  const vectors: Float32Array[] = [];
+  for (const line of text.split('\n')) {
+    if (vectors.length >= limit) break;
+    const trimmed = line.trim();
+    if (!trimmed) continue;
+    if (trimmed.startsWith('{') || trimmed.startsWith('[')) {
+      vectors.push(toVector(JSON.parse(trimmed)));
+    } else {
+      vectors.push(Float32Array.from(trimmed.split(/\s+/).slice(1), Number));
+    }
+  }
+  return vectors;
+}
+
+function readVectors(file: string, limit: number): Float32Array[] {
+  return file.endsWith('.fvecs') ? readFvecs(file, limit) : readTextVectors(file, limit);
+}
+
+function normalizeInPlace(vectors: Float32Array[]): void {
+  for (const v of vectors) {
+    const norm = l2Norm(v);
+    if (norm > 0) for (let d = 0; d < v.length; d++) v[d] /= norm;
+  }
+}
+
+/**
+ * Base vectors for the largest scale plus a disjoint query set
+ */
+function loadDataset(options: BenchmarkOptions): { base: Float32Array[]; queries: Float32Array[]; synthetic: boolean } {
+  const maxScale = Math.max(...options.scales);
+  let base: Float32Array[];
+  let queries: Float32Array[];
+  let synthetic = false;
+
+  if (options.base) {
+    base = readVectors(options.base, maxScale + (options.query ? 0 : options.queries));
+    queries = options.query ? readVectors(options.query, options.queries) : base.splice(base.length - options.queries);
+  } else {
+    synthetic = true;
+    const all = generateSynthetic(maxScale + options.queries, options.dimension, options.seed);
+    queries = all.splice(maxScale);
+    base = all;
+  }
+
+  if (base.length < maxScale) {
+    throw new Error(`Dataset has ${base.length} base vectors, fewer than the largest scale (${maxScale})`);
+  }
+
+  normalizeInPlace(base);
+  normalizeInPlace(queries);
+  return { base, queries, synthetic };
+}
+
+/**
+ * Exact top-k row indices for each query over the first `scale` rows
+ */
+function computeGroundTruth(base: Float32Array[], queries: Float32Array[], scale: number, k: number): number[][] {
+  const dimension = base[0].length;
+  const matrix = new Float32Array(scale * dimension);
+  for (let i = 0; i < scale; i++) matrix.set(base[i], i * dimension);
+  const scores = new Float32Array(scale);
+
+  return queries.map((query) => {
+    dotBatch(query, matrix, scale, dimension, scores);
+    return selectTopK(scores, k).map((entry) => entry.index);
+  });
+}
+
+// ============================================================================
+// Measurement
+// ============================================================================
+
+function rssMB(): number {
+  (globalThis as any).gc?.();
+  return process.memoryUsage().rss / (1024 * 1024);
+}
+
+function recallAtK(results: number[][], truth: number[][], k: number): number {
+  let hits = 0;
+  for (let q = 0; q < truth.length; q++) {
+    const expected = new Set(truth[q]);
+    for (const id of results[q].slice(0, k)) if (expected.has(id)) hits++;
+  }
+  return hits / (truth.length * k);
+}
+
+function measureRun(adapter: BenchAdapter, queries: Float32Array[], truth: number[][], options: BenchmarkOptions, ef: number): EfRun {
+  for (let i = 0; i < Math.min(options.warmup, queries.length); i++) {
+    adapter.search(queries[i], options.k, ef);
+  }
+
+  const histogram = new LatencyHistogram();
+  const results: number[][] = [];
+  for (const query of queries) {
+    const start = performance.now();
+    results.push(adapter.search(query, options.k, ef));
+    histogram.record(performance.now() - start);
+  }
+
+  return {
+    ef: adapter.tunable ? ef : null,
+    qps: histogram.sum > 0 ? (queries.length * 1000) / histogram.sum : 0,
+    p50Ms: histogram.percentile(0.5),
+    p99Ms: histogram.percentile(0.99),
+    meanMs: histogram.sum / histogram.count,
+    recall: recallAtK(results, truth, options.k),
+  };
+}
+
+async function benchmarkBackend(
+  name: BackendName,
+  base: Float32Array[],
+  queries: Float32Array[],
+  truth: number[][],
+  scale: number,
+  M: number,
+  options: BenchmarkOptions
+): Promise<BackendResult> {
+  const adapter = await ADAPTERS[name]();
+  const vectors = base.slice(0, scale);
+  const params: IndexParams = { dimension: base[0].length, M, efConstruction: options.efConstruction };
+
+  try {
+    const before = rssMB();
+    const start = performance.now();
+    await adapter.build(vectors, params);
+    const buildTimeMs = performance.now() - start;
+    const after = rssMB();
+
+    const efValues = adapter.tunable ? options.ef : [options.k];
+    const runs = efValues.map((ef) => measureRun(adapter, queries, truth, options, ef));
+
+    return {
+      backend: name,
+      scale,
+      M: adapter.tunable ? M : null,
+      efConstruction: adapter.tunable ? options.efConstruction : null,
+      buildTimeMs,
+      rssMB: { before, after, delta: after - before },
+      runs,
+    };
+  } finally {
+    adapter.close();
+  }
+}
+
+/**
+ * Fastest configuration at each scale that meets the recall target
+ */
+function summarize(results: BackendResult[], targetRecall: number) {
+  const scales = [...new Set(results.map((r) => r.scale))];
+  return scales.map((scale) => {
+    let best: { backend: BackendName; M: number | null; ef: number | null; qps: number; recall: number; p99Ms: number } | null = null;
+    for (const result of results.filter((r) => r.scale === scale)) {
+      for (const run of result.runs) {
+        if (run.recall >= targetRecall && (!best || run.qps > best.qps)) {
+          best = { backend: result.backend, M: result.M, ef: run.ef, qps: run.qps, recall: run.recall, p99Ms: run.p99Ms };
+        }
+      }
+    }
+    return { scale, targetRecall, best };
+  });
+}
+
+// ============================================================================
+// CLI
+// ============================================================================
+
+function parseList(value: string): number[] {
+  return value.split(',').map((v) => parseInt(v.trim(), 10)).filter((v) => Number.isFinite(v) && v > 0);
+}
+
+function parseArgs(argv: string[]): BenchmarkOptions {
+  const args = new Map<string, string>();
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith('--')) {
+      const [key, inline] = argv[i].slice(2).split('=', 2);
+      args.set(key, inline ?? argv[++i] ?? '');
+    }
+  }
+
+  const dataset = args.get('dataset') ?? 'openai';
+  const dimension = args.has('dim') ? parseInt(args.get('dim')!, 10) : DATASET_DIMENSIONS[dataset];
+  if (!dimension && !args.has('base')) {
+    throw new Error(`Unknown dataset "${dataset}"; use sift, glove, openai, or pass --dim/--base`);
+  }
+
+  const backends = (args.get('backends') ?? ALL_BACKENDS.join(',')).split(',').map((b) => b.trim()) as BackendName[];
+  for (const backend of backends) {
+    if (!ALL_BACKENDS.includes(backend)) {
+      throw new Error(`Unknown backend "${backend}"; expected one of ${ALL_BACKENDS.join(', ')}`);
+    }
+  }
+
+  const benchmarkDir = path.dirname(fileURLToPath(import.meta.url));
+  const stamp = new Date().toISOString().replace(/[:.]/g, '-');
+
+  return {
+    dataset,
+    base: args.get('base'),
+    query: args.get('query'),
+    dimension,
+    scales: parseList(args.get('scales') ?? '1000,10000'),
+    queries: parseInt(args.get('queries') ?? '200', 10),
+    k: parseInt(args.get('k') ?? '10', 10),
+    M: parseList(args.get('M') ?? '8,16,32'),
+    ef: parseList(args.get('ef') ?? '16,32,64,128,256'),
+    efConstruction: parseInt(args.get('ef-construction') ?? '200', 10),
+    backends,
+    seed: parseInt(args.get('seed') ?? '42', 10),
+    warmup: parseInt(args.get('warmup') ?? '20', 10),
+    targetRecall: parseFloat(args.get('target-recall') ?? '0.95'),
+    out: args.get('out') ?? path.join(benchmarkDir, 'results', `retrieval-${dataset}-${stamp}.json`),
+  };
+}
+
+async function main(): Promise<void> {
+  const options = parseArgs(process.argv.slice(2));
+  const { base, queries, synthetic } = loadDataset(options);
+  const dimension = base[0].length;
+
+  console.log(
+    `[RetrievalBenchmark] ${options.dataset}${synthetic ? ' (synthetic)' : ''}: ` +
+      `dim=${dimension}, scales=${options.scales.join('/')}, queries=${queries.length}, k=${options.k}`
+  );
+
+  const results: BackendResult[] = [];
+  const skipped: Array<{ backend: BackendName; reason: string }> = [];
+
+  for (const scale of options.scales) {
+    const truth = computeGroundTruth(base, queries, scale, options.k);
+
+    for (const backend of options.backends) {
+      if (skipped.some((s) => s.backend === backend)) continue;
+      const grid = backend === 'wasm-brute' ? [options.M[0]] : options.M;
+
+      for (const M of grid) {
+        try {
+          const result = await benchmarkBackend(backend, base, queries, truth, scale, M, options);
+          results.push(result);
+          for (const run of result.runs) {
+            console.log(
+              `[RetrievalBenchmark] ${backend} n=${scale} M=${result.M ?? '-'} ef=${run.ef ?? '-'}: ` +
+                `${run.qps.toFixed(0)} QPS, p50=${run.p50Ms.toFixed(3)}ms, p99=${run.p99Ms.toFixed(3)}ms, ` +
+                `recall@${options.k}=${run.recall.toFixed(3)}, build=${result.buildTimeMs.toFixed(0)}ms`
+            );
+          }
+        } catch (error) {
+          const reason = (error as Error).message.split('\n')[0];
+          console.warn(`[RetrievalBenchmark] Skipping ${backend}: ${reason}`);
+          skipped.push({ backend, reason });
+          break;
+        }
+      }
+    }
+  }
+
+  const report = {
+    suite: 'retrieval',
+    version: 1,
+    timestamp: new Date().toISOString(),
+    environment: {
+      node: process.version,
+      platform: process.platform,
+      arch: process.arch,
+      cpus: os.cpus().length,
+      cpuModel: os.cpus()[0]?.model ?? 'unknown',
+      totalMemoryMB: Math.round(os.totalmem() / (1024 * 1024)),
+    },
+    config: {
+      dataset: options.dataset,
+      synthetic,
+      base: options.base ?? null,
+      query: options.query ?? null,
+      dimension,
+      scales: options.scales,
+      queries: queries.length,
+      k: options.k,
+      M: options.M,
+      ef: options.ef,
+      efConstruction: options.efConstruction,
+      seed: options.seed,
+      metric: 'cosine',
+    },
+    results,
+    skipped,
+    summary: summarize(results, options.targetRecall),
+  };
+
+  fs.mkdirSync(path.dirname(options.out), { recursive: true });
+  fs.writeFileSync(options.out, JSON.stringify(report, null, 2));
+  console.log(`[RetrievalBenchmark] Results written to ${options.out}`);
+}
+
+main().catch((error) => {
+  console.error('[RetrievalBenchmark] Failed:', error);
+  process.exit(1);
+});
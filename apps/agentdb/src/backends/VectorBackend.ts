@@ -2,7 +2,7 @@
  * VectorBackend - Unified interface for vector database backends
  *
  * Provides abstraction over different vector search implementations
- * (RuVector, hnswlib-node) for AgentDB v2.
+ * (RuVector, hnswlib-node, IVF-PQ) for AgentDB v2.
  *
  * Design:
  * - String-based IDs for all operations (backends handle label mapping internally)
@@ -11,6 +11,9 @@
  * - Backend-specific optimizations hidden behind interface
  */
 
+import type { QuantizationConfig, QuantizationMode, QuantizationStats } from './quantization/QuantizedIndex.js';
+import type { HnswSearchPoolStats } from '../utils/HnswSearchPool.js';
+
 export interface VectorConfig {
   /** Vector dimension (e.g., 384, 768, 1536) */
   dimension?: number;
@@ -31,6 +34,36 @@ export interface VectorConfig {
 
   /** HNSW efSearch - search quality (default: 100) */
   efSearch?: number;
+
+  /**
+   * Quantized candidate tier (ruvector/hnswlib): 'int8' or 'binary' codes are
+   * scanned first and the top k * rerankFactor candidates re-ranked exactly
+   */
+  quantization?: QuantizationMode | QuantizationConfig;
+
+  /**
+   * Worker threads serving searchAsync() from read-only index replicas
+   * (hnswlib; default: 0 = search on the calling thread)
+   */
+  searchWorkers?: number;
+
+  /** Max delay before replicas pick up writes, in ms (default: 1000) */
+  searchRefreshMs?: number;
+
+  /**
+   * Compact in the background once tombstoned points exceed this share of
+   * the graph (hnswlib; default: 0.2, 0 disables)
+   */
+  compactionThreshold?: number;
+
+  /** Share of one core a background compaction may use (default: 0.25) */
+  compactionCpuShare?: number;
+
+  /**
+   * Bulk loads of at least this many vectors into an empty index are built
+   * in a worker thread (hnswlib; default: 50000)
+   */
+  bulkWorkerThreshold?: number;
 }
 
 export interface SearchResult {
@@ -54,8 +87,19 @@ export interface SearchOptions {
   /** Override efSearch for this query */
   efSearch?: number;
 
-  /** Metadata filters (post-filtering) */
+  /**
+   * Metadata filters (MetadataFilter syntax: plain equality or $eq, $in, $gte...).
+   * Backends that support it evaluate these during graph traversal.
+   */
   filter?: Record<string, any>;
+
+  /**
+   * Restrict results to these IDs (pre-filter), e.g. built from a SQL query over
+   * indexed columns. Backends widen the search until k allowed matches are found
+   * or the allowed set is exhausted. A set reused across queries may be
+   * resolved once, so don't mutate it between searches.
+   */
+  allowedIds?: ReadonlySet<string> | ((id: string) => boolean);
 }
 
 export interface VectorStats {
@@ -69,10 +113,16 @@ export interface VectorStats {
   metric: string;
 
   /** Backend name */
-  backend: 'ruvector' | 'hnswlib';
+  backend: 'ruvector' | 'hnswlib' | 'pq';
 
   /** Memory usage in bytes (0 if not available) */
   memoryUsage: number;
+
+  /** Quantized tier stats (scan/re-rank latency, sampled recall) when enabled */
+  quantization?: QuantizationStats;
+
+  /** Search worker replicas behind searchAsync(), when enabled */
+  searchWorkers?: HnswSearchPoolStats;
 }
 
 /**
@@ -86,7 +136,7 @@ export interface VectorStats {
  */
 export interface VectorBackend {
   /** Backend name for detection and logging */
-  readonly name: 'ruvector' | 'hnswlib';
+  readonly name: 'ruvector' | 'hnswlib' | 'pq';
 
   /**
    * Insert a single vector with optional metadata
@@ -106,6 +156,17 @@ export interface VectorBackend {
     metadata?: Record<string, any>;
   }>): void;
 
+  /**
+   * Start a bulk load (optional): subsequent inserts are buffered and indexed
+   * together by endBulkLoad(). Buffered vectors are not searchable until then.
+   */
+  beginBulkLoad?(): void;
+
+  /**
+   * Finish a bulk load, building the index for all buffered vectors
+   */
+  endBulkLoad?(): Promise<void>;
+
   /**
    * Search for k-nearest neighbors
    * @param query - Query vector
@@ -115,6 +176,14 @@ export interface VectorBackend {
    */
   search(query: Float32Array, k: number, options?: SearchOptions): SearchResult[];
 
+  /**
+   * Search without blocking the event loop
+   *
+   * Backends with a search worker pool run the query on a worker; otherwise
+   * this resolves to search(). Results are identical to search().
+   */
+  searchAsync(query: Float32Array, k: number, options?: SearchOptions): Promise<SearchResult[]>;
+
   /**
    * Remove a vector by ID
    * @param id - Vector ID to remove
@@ -15,8 +15,10 @@
 import type { VectorBackend, VectorConfig } from './VectorBackend.js';
 import { RuVectorBackend } from './ruvector/RuVectorBackend.js';
 import { HNSWLibBackend } from './hnswlib/HNSWLibBackend.js';
+import { PQBackend, type PQBackendConfig } from './pq/PQBackend.js';
+import { resolveQuantization } from './quantization/QuantizedIndex.js';
 
-export type BackendType = 'auto' | 'ruvector' | 'hnswlib';
+export type BackendType = 'auto' | 'ruvector' | 'hnswlib' | 'pq';
 
 export interface BackendDetection {
   available: 'ruvector' | 'hnswlib' | 'none';
@@ -98,14 +100,34 @@ export async function detectBackends(): Promise<BackendDetection> {
 /**
  * Create vector backend with automatic detection
  *
- * @param type - Backend type: 'auto', 'ruvector', or 'hnswlib'
- * @param config - Vector configuration
+ * @param type - Backend type: 'auto', 'ruvector', 'hnswlib', or 'pq'
+ *   ('pq' is pure JS and never auto-selected; pass `pq` options in config)
+ * @param config - Vector configuration. `quantization: 'int8' | 'binary'` (or
+ *   `{ mode, rerankFactor, recallSampleRate }`) enables the quantized candidate
+ *   tier on ruvector/hnswlib; stats are reported under getStats().quantization
  * @returns Initialized VectorBackend instance
  */
 export async function createBackend(
   type: BackendType,
-  config: VectorConfig
+  config: VectorConfig | PQBackendConfig
 ): Promise<VectorBackend> {
+  const quantization = resolveQuantization(config.quantization);
+  if (!['none', 'int8', 'binary'].includes(quantization.mode)) {
+    throw new Error(
+      `Unknown quantization mode '${quantization.mode}' (expected 'none', 'int8' or 'binary')`
+    );
+  }
+
+  // Compressed IVF-PQ backend has no native dependencies to detect
+  if (type === 'pq') {
+    if (quantization.mode !== 'none') {
+      throw new Error("The 'pq' backend is already compressed; quantization applies to ruvector/hnswlib");
+    }
+    const backend = new PQBackend(config);
+    await backend.initialize();
+    return backend;
+  }
+
   const detection = await detectBackends();
 
   let backend: VectorBackend;
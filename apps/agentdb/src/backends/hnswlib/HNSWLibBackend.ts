@@ -7,11 +7,19 @@
  * Features:
  * - String ID support (maps to hnswlib numeric labels)
  * - Metadata storage alongside vectors
- * - Persistent save/load with mappings
+ * - Single-file persistence (graph, id map, metadata; checksummed) with
+ *   append-only deltas between compactions; legacy .mappings.json still loads
  * - Backward compatible with existing HNSWIndex usage
+ * - Optional int8/binary candidate tier with exact re-rank (config.quantization)
+ * - Bulk-load mode: buffered inserts built into the graph in one pass, in a
+ *   worker thread for large loads into an empty index
+ * - Optional search workers: searchAsync() runs on read-only replicas
+ *   (config.searchWorkers)
  *
- * Note: hnswlib-node doesn't support true deletion - removed IDs are
- * tracked but vectors remain until rebuild.
+ * Deletion: removed points are tombstoned in the graph (markDelete) and their
+ * labels reused by later inserts, which updates the slot in place and repairs
+ * its neighbor lists. When tombstones pile up, a background compaction copies
+ * the live points into a fresh graph under a CPU budget.
  */
 
 import type {
@@ -22,12 +30,64 @@ import type {
   VectorStats,
 } from '../VectorBackend.js';
 import hnswlibNode from 'hnswlib-node';
+import { MetadataFilter } from '../../controllers/MetadataFilter.js';
+import { LabelBitset } from '../../utils/LabelBitset.js';
+import { searchKnnFiltered } from '../../utils/filtered-search.js';
+import {
+  QuantizedIndex,
+  exactDistance,
+  resolveQuantization,
+} from '../quantization/QuantizedIndex.js';
+import { WorkerPool } from '../../utils/WorkerPool.js';
+import { HnswSearchPool } from '../../utils/HnswSearchPool.js';
+import {
+  compactHnswIndex,
+  replayCompactionLog,
+  type CompactionLogEntry,
+} from '../../utils/hnsw-compaction.js';
+import {
+  isIndexFile,
+  readIndexFile,
+  writeIndexFile,
+  appendIndexDelta,
+  type IndexDelta,
+} from '../../utils/IndexFile.js';
 import * as fs from 'fs/promises';
 import * as fsSync from 'fs';
+import * as os from 'os';
 import * as path from 'path';
+import { createRequire } from 'module';
 
 const { HierarchicalNSW } = hnswlibNode as any;
 
+/** Default bulkWorkerThreshold: buffered vectors built off the main thread (empty index only) */
+const WORKER_BUILD_THRESHOLD = 50000;
+
+/** save() rewrites the base once appended changes exceed this share of it */
+const DELTA_COMPACT_RATIO = 0.25;
+
+/**
+ * Worker source: build a fresh HNSW index from packed vectors and write it to disk
+ */
+const BUILD_WORKER_SOURCE = `
+function handle(p) {
+  const { HierarchicalNSW } = require(p.modulePath);
+  const index = new HierarchicalNSW(p.metric, p.dimension);
+  index.initIndex(p.maxElements, p.M, p.efConstruction);
+  for (let i = 0; i < p.labels.length; i++) {
+    index.addPoint(p.vectors.subarray(i * p.dimension, (i + 1) * p.dimension), p.labels[i]);
+  }
+  index.writeIndexSync(p.path);
+  return { count: p.labels.length };
+}
+`;
+
+interface BulkEntry {
+  id: string;
+  label: number;
+  embedding: Float32Array;
+}
+
 interface SavedMappings {
   idToLabel: Record<string, number>;
   labelToId: Record<string, string>;
@@ -48,8 +108,35 @@ export class HNSWLibBackend implements VectorBackend {
   private metadata: Map<string, Record<string, any>> = new Map();
   private nextLabel: number = 0;
 
-  // Tracking for deletions (hnswlib doesn't support true deletion)
-  private deletedIds: Set<string> = new Set();
+  // Labels free for reuse; the tombstoned ones are still marked deleted in the graph
+  private freeLabels: Set<number> = new Set();
+  private tombstoned: Set<number> = new Set();
+
+  // Writes made while a background compaction copies the graph
+  private compactionLog: CompactionLogEntry[] | null = null;
+  private compactionTimer: ReturnType<typeof setTimeout> | null = null;
+
+  // Compact codes scanned before exact re-rank (null when quantization is off)
+  private quantized: QuantizedIndex | null = null;
+
+  // Inserts buffered between beginBulkLoad() and endBulkLoad()
+  private bulkBuffer: BulkEntry[] | null = null;
+
+  // Labels a worker is building into a new graph; removes of these are
+  // tombstoned on that graph once it replaces the current one
+  private workerBuild: Set<number> | null = null;
+
+  // Bumped on every index/mapping change; search replicas are used only when current
+  private generation = 0;
+  private searchPool: HnswSearchPool | null = null;
+
+  // allowedIds sets reused across queries, resolved once per generation
+  private allowedBitsets = new WeakMap<ReadonlySet<string>, { generation: number; size: number; bitset: LabelBitset }>();
+
+  // File written by the last save()/load() and changes made since, which the
+  // next save() to the same path appends instead of rewriting the base
+  private persisted: { path: string; length: number; baseCount: number; deltaOps: number } | null = null;
+  private journal: IndexDelta[] = [];
 
   constructor(config: VectorConfig) {
     // Handle both dimension and dimensions for backward compatibility
@@ -62,6 +149,8 @@ export class HNSWLibBackend implements VectorBackend {
       M: 16,
       efConstruction: 200,
       efSearch: 100,
+      compactionThreshold: 0.2,
+      compactionCpuShare: 0.25,
       ...config,
       dimension,  // Ensure dimension (singular) is always set
     };
@@ -89,6 +178,21 @@ export class HNSWLibBackend implements VectorBackend {
       this.config.efConstruction!
     );
     this.index.setEf(this.config.efSearch!);
+    this.quantized = this.createQuantizedIndex();
+    this.generation++;
+
+    if (this.config.searchWorkers && this.config.searchWorkers > 0 && !this.searchPool) {
+      try {
+        this.searchPool = new HnswSearchPool({
+          metric,
+          dimension: this.config.dimension!,
+          size: this.config.searchWorkers,
+          refreshDelayMs: this.config.searchRefreshMs,
+        });
+      } catch (error) {
+        console.warn('[HNSWLibBackend] Search workers unavailable, searching inline:', error);
+      }
+    }
 
     console.log(
       `[HNSWLibBackend] Initialized with dimension=${this.config.dimension}, ` +
@@ -109,11 +213,16 @@ export class HNSWLibBackend implements VectorBackend {
       throw new Error(`Vector with ID '${id}' already exists`);
     }
 
-    // Allocate numeric label
-    const label = this.nextLabel++;
+    // Allocate numeric label, reusing a freed one when available
+    const label = this.allocateLabel();
 
-    // Add to index (hnswlib requires number[] not Float32Array)
-    this.index.addPoint(Array.from(embedding), label);
+    if (this.bulkBuffer) {
+      // Graph insertion (and quantized codes) deferred to endBulkLoad()
+      this.bulkBuffer.push({ id, label, embedding });
+    } else {
+      this.addToGraph(label, embedding);
+      this.quantized?.add(id, embedding);
+    }
 
     // Store mappings
     this.idToLabel.set(id, label);
@@ -124,8 +233,8 @@ export class HNSWLibBackend implements VectorBackend {
       this.metadata.set(id, metadata);
     }
 
-    // Remove from deleted set if re-inserting
-    this.deletedIds.delete(id);
+    this.generation++;
+    this.recordChange({ op: 'add', id, label, vector: embedding, metadata });
   }
 
   /**
@@ -143,6 +252,91 @@ export class HNSWLibBackend implements VectorBackend {
     }
   }
 
+  /**
+   * Start buffering inserts; the graph is built once in endBulkLoad()
+   *
+   * Vectors inserted while bulk loading are not searchable until then.
+   */
+  beginBulkLoad(): void {
+    if (!this.index) {
+      throw new Error('Backend not initialized. Call initialize() first.');
+    }
+    this.bulkBuffer ??= [];
+  }
+
+  /**
+   * Insert buffered vectors with a single capacity resize. Large loads into an
+   * empty index are built in a worker thread so the event loop stays free;
+   * inserts keep buffering until the built graph is swapped in, and removes
+   * of vectors the worker already has are applied to it afterwards.
+   */
+  async endBulkLoad(): Promise<void> {
+    let buffer = this.bulkBuffer;
+    if (!buffer || buffer.length === 0 || !this.index) {
+      this.bulkBuffer = null;
+      return;
+    }
+
+    const existing = this.index.getCurrentCount();
+    const threshold = this.config.bulkWorkerThreshold ?? WORKER_BUILD_THRESHOLD;
+    let built = false;
+    if (existing === 0 && buffer.length >= threshold) {
+      this.bulkBuffer = [];
+      this.workerBuild = new Set(buffer.map((entry) => entry.label));
+      try {
+        await this.buildInWorker(buffer);
+        built = true;
+      } catch (error) {
+        console.warn('[HNSWLibBackend] Worker build failed, inserting on main thread:', error);
+      } finally {
+        this.workerBuild = null;
+      }
+      if (!this.index) return; // closed meanwhile
+
+      // Entries removed during the build (their label may already be reused
+      // by a later insert) are tombstoned in the new graph, then inserts
+      // buffered meanwhile are added to it
+      const isLive = (entry: BulkEntry) => this.labelToId.get(entry.label) === entry.id;
+      const late = this.bulkBuffer!;
+      if (built) {
+        for (const entry of buffer) {
+          if (isLive(entry)) continue;
+          this.index.markDelete(entry.label);
+          this.tombstoned.add(entry.label);
+        }
+        this.ensureCapacity(this.index.getCurrentCount() + late.length);
+        for (const { label, embedding } of late) {
+          this.addToGraph(label, embedding);
+        }
+      }
+      buffer = [...buffer.filter(isLive), ...late];
+    }
+    this.bulkBuffer = null;
+
+    if (!built) {
+      this.ensureCapacity(existing + buffer.length);
+      for (const { label, embedding } of buffer) {
+        this.addToGraph(label, embedding);
+      }
+    }
+
+    if (this.quantized) {
+      for (const { id, embedding } of buffer) {
+        this.quantized.add(id, embedding);
+      }
+    }
+
+    this.generation++;
+    console.log(`[HNSWLibBackend] Bulk loaded ${buffer.length} vectors${built ? ' (worker build)' : ''}`);
+  }
+
+  /**
+   * Whether inserts are currently buffered
+   */
+  isBulkLoading(): boolean {
+    return this.bulkBuffer !== null;
+  }
+
   /**
    * Search for k-nearest neighbors
    */
@@ -151,14 +345,99 @@ export class HNSWLibBackend implements VectorBackend {
       throw new Error('Backend not initialized. Call initialize() first.');
     }
 
+    if (this.index.getCurrentCount() === 0) {
+      return [];
+    }
+
+    return this.quantized
+      ? this.searchQuantized(query, k, options)
+      : this.searchGraph(query, k, options);
+  }
+
+  /**
+   * Full-precision HNSW graph search
+   */
+  private searchGraph(query: Float32Array, k: number, options?: SearchOptions): SearchResult[] {
     // Update efSearch if specified
     if (options?.efSearch) {
       this.index.setEf(options.efSearch);
     }
 
-    // Perform HNSW search
-    const result = this.index.searchKnn(Array.from(query), k);
+    // Perform HNSW search; filters and deletions are checked during traversal
+    const filter = this.buildLabelFilter(options);
+    const result = filter
+      ? searchKnnFiltered(this.index, query, k, filter.predicate, {
+          baseEf: options?.efSearch ?? this.config.efSearch!,
+          maxMatches: filter.maxMatches,
+        })
+      : this.index.searchKnn(query, Math.min(k, this.index.getCurrentCount()));
+
+    return this.toResults(result, options);
+  }
 
+  /**
+   * Search on a worker replica when one is loaded; otherwise inline
+   *
+   * Metadata filters, predicate allowedIds and the quantized tier need
+   * main-thread state and always run inline. A stale replica still answers
+   * (vectors inserted since its snapshot are missing until the refresh it
+   * triggers lands), but if any returned label was removed or reused since,
+   * the query is re-run inline.
+   */
+  async searchAsync(query: Float32Array, k: number, options?: SearchOptions): Promise<SearchResult[]> {
+    const pool = this.searchPool;
+    const hasMetadataFilter = !!options?.filter && Object.keys(options.filter).length > 0;
+    if (
+      !pool ||
+      !this.index ||
+      this.quantized ||
+      this.bulkBuffer ||
+      hasMetadataFilter ||
+      typeof options?.allowedIds === 'function'
+    ) {
+      return this.search(query, k, options);
+    }
+
+    if (!pool.isFresh(this.generation)) {
+      pool.scheduleRefresh(() => this.snapshotForPool());
+      if (!pool.canServe()) return this.search(query, k, options);
+    }
+
+    if (this.index.getCurrentCount() === 0) {
+      return [];
+    }
+
+    // Explicit id sets travel to the worker as a label bitset
+    let allowed: LabelBitset | undefined;
+    if (options?.allowedIds) {
+      allowed = this.resolveAllowedIds(options.allowedIds as ReadonlySet<string>);
+      if (allowed.count === 0) return [];
+    }
+
+    const result = await pool.search(query, k, {
+      ef: options?.efSearch ?? this.config.efSearch,
+      allowed: allowed?.toWords(),
+      maxMatches: allowed?.count,
+    });
+    const current = result?.ids.every((id, i) => id !== undefined && this.labelToId.get(result.neighbors[i]) === id);
+    return current ? this.toResults(result!, options) : this.search(query, k, options);
+  }
+
+  /**
+   * Resolves once a scheduled search replica refresh has been published
+   */
+  whenSearchReplicasRefreshed(): Promise<void> {
+    return this.searchPool?.whenRefreshed() ?? Promise.resolve();
+  }
+
+  /**
+   * Map hnswlib labels/distances to results, dropping deleted ids and
+   * applying the similarity threshold
+   */
+  private toResults(
+    result: { neighbors: number[]; distances: number[] },
+    options?: SearchOptions
+  ): SearchResult[] {
     const results: SearchResult[] = [];
 
     for (let i = 0; i < result.neighbors.length; i++) {
@@ -172,11 +451,6 @@ export class HNSWLibBackend implements VectorBackend {
         continue;
       }
 
-      // Skip deleted IDs
-      if (this.deletedIds.has(id)) {
-        continue;
-      }
-
       // Convert distance to similarity
       const similarity = this.distanceToSimilarity(distance);
 
@@ -193,31 +467,159 @@ export class HNSWLibBackend implements VectorBackend {
       });
     }
 
-    // Apply metadata filters if specified (post-filtering)
-    if (options?.filter) {
-      return this.applyFilters(results, options.filter);
+    return results;
+  }
+
+  /**
+   * Scan quantized codes for k * rerankFactor candidates, then re-rank them
+   * with exact distances against the stored float vectors
+   */
+  private searchQuantized(query: Float32Array, k: number, options?: SearchOptions): SearchResult[] {
+    const quantized = this.quantized!;
+    const filter = this.buildLabelFilter(options);
+    const allow = filter
+      ? (id: string) => {
+          const label = this.idToLabel.get(id);
+          return label !== undefined && filter.predicate(label);
+        }
+      : undefined;
+
+    const candidates = quantized.candidates(query, k * quantized.rerankFactor, allow);
+
+    const start = performance.now();
+    const scored = candidates
+      .map((id) => ({
+        id,
+        distance: exactDistance(
+          this.config.metric,
+          query,
+          this.index.getPoint(this.idToLabel.get(id)!)
+        ),
+      }))
+      .sort((a, b) => a.distance - b.distance);
+
+    const results: SearchResult[] = [];
+    for (const { id, distance } of scored) {
+      if (results.length >= k) break;
+      const similarity = this.distanceToSimilarity(distance);
+      if (options?.threshold !== undefined && similarity < options.threshold) {
+        continue;
+      }
+      results.push({ id, distance, similarity, metadata: this.metadata.get(id) });
+    }
+    quantized.recordRerank(performance.now() - start);
+
+    if (quantized.shouldSampleRecall()) {
+      const exact = this.searchGraph(query, k, options);
+      quantized.recordRecall(results.map((r) => r.id), exact.map((r) => r.id));
     }
 
     return results;
   }
 
+  /**
+   * Label bitset for an allowedIds set
+   *
+   * Callers issuing many queries with one set (e.g. clustering a candidate
+   * window) pay the id lookups once per index generation instead of per query.
+   */
+  private resolveAllowedIds(ids: ReadonlySet<string>): LabelBitset {
+    const cached = this.allowedBitsets.get(ids);
+    if (cached && cached.generation === this.generation && cached.size === ids.size) {
+      return cached.bitset;
+    }
+
+    const bitset = new LabelBitset(this.nextLabel);
+    for (const id of ids) {
+      const label = this.idToLabel.get(id);
+      if (label !== undefined) {
+        bitset.add(label);
+      }
+    }
+    this.allowedBitsets.set(ids, { generation: this.generation, size: ids.size, bitset });
+    return bitset;
+  }
+
+  /**
+   * Build a label predicate for in-traversal filtering
+   *
+   * Combines deletions, allowedIds and metadata filters. Returns null when
+   * nothing needs filtering so the unfiltered fast path is used.
+   */
+  private buildLabelFilter(
+    options?: SearchOptions
+  ): { predicate: (label: number) => boolean; maxMatches?: number } | null {
+    const hasMetadataFilter = !!options?.filter && Object.keys(options.filter).length > 0;
+    const allowed = options?.allowedIds;
+
+    if (!hasMetadataFilter && !allowed) {
+      return null;
+    }
+
+    const matchesMetadata = hasMetadataFilter ? MetadataFilter.compile(options!.filter!) : null;
+
+    // Explicit id sets are resolved to a label bitset
+    let bitset: LabelBitset | null = null;
+    let allowFn: ((id: string) => boolean) | null = null;
+    if (typeof allowed === 'function') {
+      allowFn = allowed;
+    } else if (allowed) {
+      bitset = this.resolveAllowedIds(allowed);
+    }
+
+    const predicate = (label: number): boolean => {
+      if (bitset && !bitset.has(label)) return false;
+      const id = this.labelToId.get(label);
+      if (id === undefined) return false;
+      if (allowFn && !allowFn(id)) return false;
+      if (matchesMetadata) {
+        const metadata = this.metadata.get(id);
+        if (!metadata || !matchesMetadata(metadata)) return false;
+      }
+      return true;
+    };
+
+    return { predicate, maxMatches: bitset ? bitset.count : undefined };
+  }
+
   /**
    * Remove a vector by ID
-   * Note: hnswlib doesn't support true deletion - we mark as deleted
+   *
+   * The point is tombstoned (hnswlib keeps it for routing but never returns
+   * it) and its label goes back to the free list for the next insert.
    */
   remove(id: string): boolean {
-    const label = this.idToLabel.get(id);
-    if (label === undefined) {
+    if (!this.removeInternal(id)) {
       return false; // Not found
     }
+    this.generation++;
+    this.recordChange({ op: 'remove', id });
+    this.maybeScheduleCompaction();
+    return true;
+  }
 
-    // Mark as deleted (can't actually remove from hnswlib)
-    this.deletedIds.add(id);
-    this.metadata.delete(id);
-
-    // Note: We keep idToLabel/labelToId mappings for consistency
-    // A full rebuild would be needed to reclaim space
+  private removeInternal(id: string): boolean {
+    const label = this.idToLabel.get(id);
+    if (label === undefined) return false;
+
+    const buffered = this.bulkBuffer ? this.bulkBuffer.findIndex((e) => e.label === label) : -1;
+    if (buffered >= 0) {
+      // Not in the graph yet
+      this.bulkBuffer!.splice(buffered, 1);
+    } else if (this.workerBuild?.has(label)) {
+      // Only in the graph being built; endBulkLoad() tombstones it there
+      this.workerBuild.delete(label);
+    } else {
+      this.index.markDelete(label);
+      this.tombstoned.add(label);
+      this.compactionLog?.push({ op: 'remove', label });
+    }
 
+    this.idToLabel.delete(id);
+    this.labelToId.delete(label);
+    this.metadata.delete(id);
+    this.quantized?.remove(id);
+    this.freeLabels.add(label);
     return true;
   }
 
@@ -225,7 +627,7 @@ export class HNSWLibBackend implements VectorBackend {
    * Get backend statistics
    */
   getStats(): VectorStats {
-    const activeCount = this.idToLabel.size - this.deletedIds.size;
+    const activeCount = this.idToLabel.size;
 
     return {
       count: activeCount,
@@ -233,43 +635,61 @@ export class HNSWLibBackend implements VectorBackend {
       metric: this.config.metric,
       backend: 'hnswlib',
       memoryUsage: 0, // hnswlib doesn't expose memory usage
+      quantization: this.quantized?.getStats(),
+      searchWorkers: this.searchPool?.getStats(),
     };
   }
 
   /**
-   * Save index to disk with mappings
+   * Save index, id map and metadata to a single file
+   *
+   * Saving again to the same path appends the changes since the last save;
+   * the base is rewritten once appended changes exceed DELTA_COMPACT_RATIO.
    */
   async save(savePath: string): Promise<void> {
     if (!this.index) {
       throw new Error('No index to save');
     }
+    if (this.bulkBuffer) {
+      throw new Error('Cannot save during a bulk load. Call endBulkLoad() first.');
+    }
 
     try {
-      // Create directory if needed
-      const indexDir = path.dirname(savePath);
-      if (!fsSync.existsSync(indexDir)) {
-        await fs.mkdir(indexDir, { recursive: true });
+      const filePath = path.resolve(savePath);
+      const persisted = this.persisted;
+
+      if (
+        persisted &&
+        persisted.path === filePath &&
+        persisted.deltaOps + this.journal.length <= persisted.baseCount * DELTA_COMPACT_RATIO
+      ) {
+        const length = appendIndexDelta(filePath, this.journal, persisted.length);
+        if (length !== null) {
+          persisted.deltaOps += this.journal.length;
+          persisted.length = length;
+          console.log(`[HNSWLibBackend] Appended ${this.journal.length} changes to ${filePath}`);
+          this.journal = [];
+          return;
+        }
       }
 
-      // Save HNSW index
-      this.index.writeIndex(savePath);
-
-      // Save mappings and metadata
-      const mappingsPath = savePath + '.mappings.json';
-      const mappings: SavedMappings = {
-        idToLabel: Object.fromEntries(this.idToLabel.entries()),
-        labelToId: Object.fromEntries(
-          Array.from(this.labelToId.entries()).map(([k, v]) => [k.toString(), v])
-        ),
-        metadata: Object.fromEntries(this.metadata.entries()),
-        nextLabel: this.nextLabel,
-        config: this.config,
-      };
-
-      await fs.writeFile(mappingsPath, JSON.stringify(mappings, null, 2));
+      const length = writeIndexFile(
+        filePath,
+        (graphPath) => this.index.writeIndexSync(graphPath),
+        this.idToLabel.entries(),
+        {
+          config: this.config,
+          nextLabel: this.nextLabel,
+          metadata: Object.fromEntries(this.metadata.entries()),
+          freeLabels: Array.from(this.freeLabels),
+          tombstoned: Array.from(this.tombstoned),
+          quantized: this.quantized?.toJSON(),
+        }
+      );
+      this.persisted = { path: filePath, length, baseCount: this.idToLabel.size, deltaOps: 0 };
+      this.journal = [];
 
-      console.log(`[HNSWLibBackend] Index saved to ${savePath}`);
-      console.log(`[HNSWLibBackend] Mappings saved to ${mappingsPath}`);
+      console.log(`[HNSWLibBackend] Index saved to ${filePath} (${this.idToLabel.size} vectors)`);
     } catch (error) {
       console.error('[HNSWLibBackend] Failed to save index:', error);
       throw error;
@@ -284,8 +704,17 @@ export class HNSWLibBackend implements VectorBackend {
       throw new Error(`Index file not found: ${loadPath}`);
     }
 
+    if (isIndexFile(loadPath)) {
+      this.loadIndexFile(loadPath);
+      return;
+    }
+
     try {
       console.log(`[HNSWLibBackend] Loading index from ${loadPath}...`);
+      this.persisted = null;
+      this.journal = [];
+      this.freeLabels = new Set();
+      this.tombstoned = new Set();
 
       // Initialize index first
       const metricMap: Record<string, string> = {
@@ -299,6 +728,7 @@ export class HNSWLibBackend implements VectorBackend {
 
       // Load HNSW index
       this.index.readIndex(loadPath);
+      this.generation++;
       this.index.setEf(this.config.efSearch!);
 
       // Load mappings and metadata
@@ -321,6 +751,8 @@ export class HNSWLibBackend implements VectorBackend {
           this.config = { ...this.config, ...mappingsData.config };
         }
 
+        await this.loadQuantized(loadPath);
+
         console.log(
           `[HNSWLibBackend] ✅ Index loaded successfully (${this.idToLabel.size} vectors)`
         );
@@ -336,16 +768,289 @@ export class HNSWLibBackend implements VectorBackend {
     }
   }
 
+  /**
+   * Load the single-file format: base sections, then replay appended deltas
+   */
+  private loadIndexFile(loadPath: string): void {
+    const filePath = path.resolve(loadPath);
+    console.log(`[HNSWLibBackend] Loading index from ${filePath}...`);
+
+    const metric = this.config.metric || 'cosine';
+    const index = new HierarchicalNSW(metric, this.config.dimension);
+    const contents = readIndexFile(filePath, (graphPath) => index.readIndexSync(graphPath));
+    const { meta } = contents;
+
+    if (meta.config) {
+      this.config = { ...this.config, ...meta.config };
+    }
+    index.setEf(this.config.efSearch!);
+
+    this.index = index;
+    this.idToLabel = new Map(contents.ids);
+    this.labelToId = new Map(contents.ids.map(([id, label]) => [label, id]));
+    this.metadata = new Map(Object.entries(meta.metadata || {}));
+    this.freeLabels = new Set(meta.freeLabels || []);
+    this.tombstoned = new Set(meta.tombstoned || []);
+    this.nextLabel = meta.nextLabel ?? contents.ids.length;
+
+    this.quantized = this.createQuantizedIndex();
+    const quantRestored = !!this.quantized && !!meta.quantized && this.quantized.restore(meta.quantized);
+
+    for (const delta of contents.deltas) {
+      if (delta.op === 'add') {
+        if (this.idToLabel.has(delta.id)) continue;
+        this.freeLabels.delete(delta.label);
+        this.addToGraph(delta.label, delta.vector);
+        this.idToLabel.set(delta.id, delta.label);
+        this.labelToId.set(delta.label, delta.id);
+        if (delta.metadata) this.metadata.set(delta.id, delta.metadata);
+        this.nextLabel = Math.max(this.nextLabel, delta.label + 1);
+        if (quantRestored) this.quantized!.add(delta.id, delta.vector);
+      } else {
+        this.removeInternal(delta.id);
+      }
+    }
+
+    if (this.quantized && !quantRestored) {
+      for (const [id, label] of this.idToLabel) {
+        this.quantized.add(id, new Float32Array(index.getPoint(label)));
+      }
+    }
+
+    this.persisted = {
+      path: filePath,
+      length: contents.length,
+      baseCount: contents.ids.length,
+      deltaOps: contents.deltas.length,
+    };
+    this.journal = [];
+    this.generation++;
+
+    console.log(
+      `[HNSWLibBackend] ✅ Index loaded successfully (${this.idToLabel.size} vectors, ` +
+        `${contents.deltas.length} deltas replayed)`
+    );
+  }
+
   /**
    * Close and cleanup resources
    */
   close(): void {
+    this.searchPool?.close().catch(() => {});
+    this.searchPool = null;
     this.index = null;
     this.idToLabel.clear();
     this.labelToId.clear();
     this.metadata.clear();
-    this.deletedIds.clear();
+    this.freeLabels.clear();
+    this.tombstoned.clear();
+    this.compactionLog = null;
+    if (this.compactionTimer) clearTimeout(this.compactionTimer);
+    this.compactionTimer = null;
+    this.quantized?.clear();
     this.nextLabel = 0;
+    this.persisted = null;
+    this.journal = [];
+  }
+
+  /**
+   * Current index for the search pool (null while bulk loading); tombstones
+   * are part of the serialized graph
+   */
+  private snapshotForPool(): { index: any; generation: number; ef: number; labels: ReadonlyMap<number, string> } | null {
+    if (!this.index || this.bulkBuffer) return null;
+    return {
+      index: this.index,
+      generation: this.generation,
+      ef: this.config.efSearch!,
+      labels: new Map(this.labelToId),
+    };
+  }
+
+  /**
+   * Next label: a freed one first, so tombstoned slots are refilled
+   */
+  private allocateLabel(): number {
+    const free = this.freeLabels.values().next();
+    if (!free.done) {
+      this.freeLabels.delete(free.value);
+      return free.value;
+    }
+    return this.nextLabel++;
+  }
+
+  /**
+   * Add a point under `label`; on a tombstoned label hnswlib un-deletes the
+   * slot, overwrites its vector and repairs its neighbor lists in place
+   */
+  private addToGraph(label: number, embedding: Float32Array): void {
+    if (!this.tombstoned.delete(label)) {
+      this.ensureCapacity(this.index.getCurrentCount() + 1);
+    }
+    this.index.addPoint(embedding, label);
+    this.compactionLog?.push({ op: 'add', label, vector: embedding });
+  }
+
+  /**
+   * Start a background compaction once tombstones exceed compactionThreshold
+   * of the graph (0 disables)
+   */
+  private maybeScheduleCompaction(): void {
+    const threshold = this.config.compactionThreshold ?? 0.2;
+    if (threshold <= 0 || this.compactionLog || this.compactionTimer || !this.index) return;
+
+    const graphCount = this.index.getCurrentCount();
+    if (this.tombstoned.size < Math.max(64, graphCount * threshold)) return;
+
+    this.compactionTimer = setTimeout(() => {
+      this.compactionTimer = null;
+      this.compact().catch((error) => {
+        console.warn('[HNSWLibBackend] Background compaction failed:', error);
+      });
+    }, 0);
+    this.compactionTimer.unref?.();
+  }
+
+  /**
+   * Rebuild the graph without tombstones while search and writes continue
+   *
+   * Live points are copied in time slices using at most compactionCpuShare of
+   * a core; writes during the copy are logged and replayed before the swap.
+   *
+   * @returns false if skipped (already running, bulk loading, nothing to drop)
+   */
+  async compact(): Promise<boolean> {
+    if (!this.index || this.compactionLog || this.bulkBuffer || this.tombstoned.size === 0) {
+      return false;
+    }
+
+    const source = this.index;
+    const dropped = this.tombstoned.size;
+    const start = Date.now();
+    this.compactionLog = [];
+
+    try {
+      const target = await compactHnswIndex(source, Array.from(this.labelToId.keys()), {
+        createIndex: (capacity) => {
+          const index = new HierarchicalNSW(this.config.metric, this.config.dimension);
+          index.initIndex(
+            Math.max(capacity, this.config.maxElements!),
+            this.config.M!,
+            this.config.efConstruction!
+          );
+          index.setEf(this.config.efSearch!);
+          return index;
+        },
+        cpuShare: this.config.compactionCpuShare,
+        shouldAbort: () => this.index !== source || this.bulkBuffer !== null,
+      });
+      if (!target || this.index !== source || this.bulkBuffer) return false;
+
+      this.tombstoned = replayCompactionLog(target, this.compactionLog);
+      this.index = target;
+      this.generation++;
+      console.log(
+        `[HNSWLibBackend] Compacted ${dropped} tombstones in ${Date.now() - start}ms ` +
+          `(${this.idToLabel.size} live vectors)`
+      );
+      return true;
+    } finally {
+      this.compactionLog = null;
+    }
+  }
+
+  /**
+   * Journal a change for the next appending save(); once the journal is past
+   * the compaction point it is dropped and the next save() writes a new base
+   */
+  private recordChange(delta: IndexDelta): void {
+    const persisted = this.persisted;
+    if (!persisted) return;
+    if (persisted.deltaOps + this.journal.length >= persisted.baseCount * DELTA_COMPACT_RATIO) {
+      this.persisted = null;
+      this.journal = [];
+      return;
+    }
+    this.journal.push(delta);
+  }
+
+  /**
+   * Grow the index once to fit `required` points
+   */
+  private ensureCapacity(required: number): void {
+    const max = this.index.getMaxElements();
+    if (required > max) {
+      this.index.resizeIndex(Math.max(required, max * 2));
+      this.config.maxElements = this.index.getMaxElements();
+    }
+  }
+
+  /**
+   * Build a fresh index from buffered vectors in a worker, then load it here
+   */
+  private async buildInWorker(buffer: BulkEntry[]): Promise<void> {
+    const dimension = this.config.dimension!;
+    const vectors = new Float32Array(buffer.length * dimension);
+    const labels = new Float64Array(buffer.length);
+    buffer.forEach(({ label, embedding }, i) => {
+      vectors.set(embedding, i * dimension);
+      labels[i] = label;
+    });
+
+    const indexPath = path.join(os.tmpdir(), `agentdb-bulk-${process.pid}-${Date.now()}.hnsw`);
+    const pool = new WorkerPool(BUILD_WORKER_SOURCE, { size: 1 });
+    try {
+      await pool.run(
+        {
+          modulePath: createRequire(import.meta.url).resolve('hnswlib-node'),
+          metric: this.config.metric,
+          dimension,
+          maxElements: Math.max(this.config.maxElements!, buffer.length),
+          M: this.config.M,
+          efConstruction: this.config.efConstruction,
+          vectors,
+          labels,
+          path: indexPath,
+        },
+        [vectors.buffer, labels.buffer]
+      );
+
+      const index = new HierarchicalNSW(this.config.metric, dimension);
+      index.readIndexSync(indexPath);
+      index.setEf(this.config.efSearch!);
+      this.index = index;
+      this.generation++;
+      this.config.maxElements = index.getMaxElements();
+    } finally {
+      await pool.close();
+      await fs.rm(indexPath, { force: true });
+    }
+  }
+
+  private createQuantizedIndex(): QuantizedIndex | null {
+    const quantization = resolveQuantization(this.config.quantization);
+    return quantization.mode === 'none'
+      ? null
+      : new QuantizedIndex(this.config.dimension!, this.config.metric, quantization);
+  }
+
+  /**
+   * Restore quantized codes from the sidecar file, re-encoding from the
+   * graph's stored vectors if it is missing or was written with other settings
+   */
+  private async loadQuantized(loadPath: string): Promise<void> {
+    this.quantized = this.createQuantizedIndex();
+    if (!this.quantized) return;
+
+    const quantPath = loadPath + '.quant.json';
+    if (fsSync.existsSync(quantPath)) {
+      const saved = JSON.parse(await fs.readFile(quantPath, 'utf-8'));
+      if (this.quantized.restore(saved)) return;
+    }
+
+    for (const [id, label] of this.idToLabel) {
+      this.quantized.add(id, new Float32Array(this.index.getPoint(label)));
+    }
   }
 
   /**
@@ -371,32 +1076,19 @@ export class HNSWLibBackend implements VectorBackend {
     }
   }
 
-  /**
-   * Apply metadata filters (post-filtering)
-   */
-  private applyFilters(
-    results: SearchResult[],
-    filters: Record<string, any>
-  ): SearchResult[] {
-    return results.filter((result) => {
-      if (!result.metadata) return false;
-
-      // Check if all filter conditions match
-      return Object.entries(filters).every(([key, value]) => {
-        return result.metadata![key] === value;
-      });
-    });
-  }
-
   /**
    * Check if needs rebuilding (for backward compat with HNSWIndex)
-   * @param updateThreshold - Percentage of deletes to trigger rebuild (default: 0.1)
+   *
+   * Tombstones are reused and compacted in the background, so this is only
+   * true when compaction is disabled (compactionThreshold: 0) and tombstones
+   * exceed `updateThreshold` of the graph.
+   * @param updateThreshold - Share of tombstoned points (default: 0.1)
    */
   needsRebuild(updateThreshold: number = 0.1): boolean {
-    if (this.idToLabel.size === 0) return false;
+    if (!this.index || (this.config.compactionThreshold ?? 0.2) > 0) return false;
 
-    const deletePercentage = this.deletedIds.size / this.idToLabel.size;
-    return deletePercentage > updateThreshold;
+    const graphCount = this.index.getCurrentCount();
+    return graphCount > 0 && this.tombstoned.size / graphCount > updateThreshold;
   }
 
   /**
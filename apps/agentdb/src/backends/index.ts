@@ -18,6 +18,8 @@ export type {
 export { RuVectorBackend } from './ruvector/RuVectorBackend.js';
 export { RuVectorLearning } from './ruvector/RuVectorLearning.js';
 export { HNSWLibBackend } from './hnswlib/HNSWLibBackend.js';
+export { PQBackend, sqliteVectorFetcher } from './pq/PQBackend.js';
+export { QuantizedIndex } from './quantization/QuantizedIndex.js';
 
 // Factory and detection
 export {
@@ -30,3 +32,9 @@ export {
 
 export type { BackendType, BackendDetection } from './factory.js';
 export type { LearningConfig, EnhancementOptions } from './ruvector/RuVectorLearning.js';
+export type { PQBackendConfig, PQOptions } from './pq/PQBackend.js';
+export type {
+  QuantizationMode,
+  QuantizationConfig,
+  QuantizationStats
+} from './quantization/QuantizedIndex.js';
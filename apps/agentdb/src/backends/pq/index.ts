@@ -0,0 +1,8 @@
+/**
+ * PQ Backend Exports
+ *
+ * Export PQBackend (IVF-PQ compressed index) and SQLite re-rank helper
+ */
+
+export { PQBackend, sqliteVectorFetcher } from './PQBackend.js';
+export type { PQBackendConfig, PQOptions } from './PQBackend.js';
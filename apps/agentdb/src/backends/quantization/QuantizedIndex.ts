@@ -0,0 +1,403 @@
+/**
+ * QuantizedIndex - Scalar int8 / 1-bit binary codes for fast candidate scans
+ *
+ * Keeps a compact copy of every vector next to a backend's full-precision
+ * index. Queries scan the codes (int8 dot products or popcount Hamming
+ * distance), and the top candidates are re-ranked by the backend with exact
+ * float distances. Memory touched per query drops ~4x for int8 and ~32x for
+ * binary compared with scanning Float32 vectors.
+ *
+ * Codes are stored in contiguous slabs indexed by slot; removed slots are
+ * recycled on the next insert.
+ */
+
+import { l2Norm, selectTopK } from '../../utils/vector-kernels.js';
+
+export type QuantizationMode = 'none' | 'int8' | 'binary';
+
+export interface QuantizationConfig {
+  /** Quantization tier (default: 'none') */
+  mode: QuantizationMode;
+
+  /** Candidates re-ranked exactly = k * rerankFactor (default: 4 for int8, 10 for binary) */
+  rerankFactor?: number;
+
+  /** Fraction of queries also run at full precision to estimate recall (default: 0.01) */
+  recallSampleRate?: number;
+}
+
+export interface QuantizationStats {
+  mode: QuantizationMode;
+  /** Code bytes per vector (excluding slot bookkeeping) */
+  bytesPerVector: number;
+  /** Total bytes held in code slabs */
+  codeBytes: number;
+  rerankFactor: number;
+  queries: number;
+  avgScanMs: number;
+  avgRerankMs: number;
+  /** Mean recall@k of quantized search vs full precision over sampled queries */
+  recallEstimate: number | null;
+  recallSamples: number;
+}
+
+interface SavedQuantizedIndex {
+  mode: QuantizationMode;
+  dimension: number;
+  metric: string;
+  ids: Array<string | null>;
+  codes: string;
+  scales: string;
+}
+
+/**
+ * Normalize a quantization option passed as a mode string or config object
+ */
+export function resolveQuantization(
+  option: QuantizationMode | QuantizationConfig | undefined
+): QuantizationConfig {
+  if (!option) return { mode: 'none' };
+  return typeof option === 'string' ? { mode: option } : option;
+}
+
+/**
+ * Popcount of a 32-bit word
+ */
+function popcount32(x: number): number {
+  x = x - ((x >>> 1) & 0x55555555);
+  x = (x & 0x33333333) + ((x >>> 2) & 0x33333333);
+  x = (x + (x >>> 4)) & 0x0f0f0f0f;
+  return Math.imul(x, 0x01010101) >>> 24;
+}
+
+export class QuantizedIndex {
+  readonly mode: Exclude<QuantizationMode, 'none'>;
+  readonly dimension: number;
+  readonly rerankFactor: number;
+
+  private metric: 'cosine' | 'l2' | 'ip';
+  private recallSampleRate: number;
+
+  // Per-slot code storage
+  private stride: number;
+  private int8Codes: Int8Array = new Int8Array(0);
+  private binaryCodes: Uint32Array = new Uint32Array(0);
+  private scales: Float32Array = new Float32Array(0); // int8: scale, binary: unused
+  private norms2: Float32Array = new Float32Array(0); // squared norm (l2 scoring)
+  private capacity = 0;
+
+  private slotIds: Array<string | null> = [];
+  private idToSlot: Map<string, number> = new Map();
+  private freeSlots: number[] = [];
+
+  // Stats
+  private queries = 0;
+  private scanTime = 0;
+  private rerankTime = 0;
+  private recallSum = 0;
+  private recallSamples = 0;
+
+  constructor(dimension: number, metric: 'cosine' | 'l2' | 'ip', config: QuantizationConfig) {
+    if (config.mode === 'none') {
+      throw new Error("QuantizedIndex requires mode 'int8' or 'binary'");
+    }
+    this.mode = config.mode;
+    this.dimension = dimension;
+    this.metric = metric;
+    this.rerankFactor = config.rerankFactor ?? (config.mode === 'binary' ? 10 : 4);
+    this.recallSampleRate = config.recallSampleRate ?? 0.01;
+    this.stride = config.mode === 'binary' ? Math.ceil(dimension / 32) : dimension;
+    this.grow(1024);
+  }
+
+  get size(): number {
+    return this.idToSlot.size;
+  }
+
+  /**
+   * Quantize and store a vector (overwrites an existing id)
+   */
+  add(id: string, vector: Float32Array): void {
+    let slot = this.idToSlot.get(id);
+    if (slot === undefined) {
+      slot = this.freeSlots.pop() ?? this.slotIds.length;
+      if (slot >= this.capacity) {
+        this.grow(this.capacity * 2);
+      }
+      this.slotIds[slot] = id;
+      this.idToSlot.set(id, slot);
+    }
+    this.encode(slot, vector);
+  }
+
+  remove(id: string): boolean {
+    const slot = this.idToSlot.get(id);
+    if (slot === undefined) return false;
+    this.idToSlot.delete(id);
+    this.slotIds[slot] = null;
+    this.freeSlots.push(slot);
+    return true;
+  }
+
+  clear(): void {
+    this.slotIds = [];
+    this.idToSlot.clear();
+    this.freeSlots = [];
+  }
+
+  /**
+   * Approximate top-n ids by scanning codes (higher score is closer)
+   */
+  candidates(query: Float32Array, n: number, allow?: (id: string) => boolean): string[] {
+    const start = performance.now();
+    const slots = this.slotIds.length;
+    const scores = new Float32Array(slots);
+
+    if (this.mode === 'binary') {
+      const qbits = new Uint32Array(this.stride);
+      this.packBits(this.metric === 'cosine' ? this.normalized(query) : query, qbits, 0);
+      const bits = this.binaryCodes;
+      const stride = this.stride;
+
+      for (let s = 0; s < slots; s++) {
+        const id = this.slotIds[s];
+        if (id === null || (allow && !allow(id))) {
+          scores[s] = -Infinity;
+          continue;
+        }
+        let hamming = 0;
+        const offset = s * stride;
+        for (let w = 0; w < stride; w++) {
+          hamming += popcount32(qbits[w] ^ bits[offset + w]);
+        }
+        scores[s] = -hamming;
+      }
+    } else {
+      const q = this.metric === 'cosine' ? this.normalized(query) : query;
+      const codes = this.int8Codes;
+      const dim = this.dimension;
+
+      for (let s = 0; s < slots; s++) {
+        const id = this.slotIds[s];
+        if (id === null || (allow && !allow(id))) {
+          scores[s] = -Infinity;
+          continue;
+        }
+        // Asymmetric: float query against int8 codes, one scale per vector
+        let dot = 0;
+        const offset = s * dim;
+        for (let d = 0; d < dim; d++) {
+          dot += q[d] * codes[offset + d];
+        }
+        dot *= this.scales[s];
+        scores[s] = this.metric === 'l2' ? 2 * dot - this.norms2[s] : dot;
+      }
+    }
+
+    const top = selectTopK(scores, n)
+      .filter(({ score }) => score !== -Infinity)
+      .map(({ index }) => this.slotIds[index] as string);
+
+    this.queries++;
+    this.scanTime += performance.now() - start;
+    return top;
+  }
+
+  /**
+   * Record time spent re-ranking candidates for the last query
+   */
+  recordRerank(ms: number): void {
+    this.rerankTime += ms;
+  }
+
+  /**
+   * Whether this query should also run at full precision for recall tracking
+   */
+  shouldSampleRecall(): boolean {
+    return this.recallSampleRate > 0 && Math.random() < this.recallSampleRate;
+  }
+
+  /**
+   * Record recall@k for a sampled query
+   */
+  recordRecall(quantizedIds: string[], exactIds: string[]): void {
+    if (exactIds.length === 0) return;
+    const exact = new Set(exactIds);
+    let hits = 0;
+    for (const id of quantizedIds) {
+      if (exact.has(id)) hits++;
+    }
+    this.recallSum += hits / exactIds.length;
+    this.recallSamples++;
+  }
+
+  getStats(): QuantizationStats {
+    const bytesPerVector = this.mode === 'binary' ? this.stride * 4 : this.dimension + 8;
+    return {
+      mode: this.mode,
+      bytesPerVector,
+      codeBytes: bytesPerVector * this.size,
+      rerankFactor: this.rerankFactor,
+      queries: this.queries,
+      avgScanMs: this.queries > 0 ? this.scanTime / this.queries : 0,
+      avgRerankMs: this.queries > 0 ? this.rerankTime / this.queries : 0,
+      recallEstimate: this.recallSamples > 0 ? this.recallSum / this.recallSamples : null,
+      recallSamples: this.recallSamples,
+    };
+  }
+
+  /**
+   * Serialize codes for a sidecar file
+   */
+  toJSON(): SavedQuantizedIndex {
+    const slots = this.slotIds.length;
+    const codes = this.mode === 'binary'
+      ? this.binaryCodes.subarray(0, slots * this.stride)
+      : this.int8Codes.subarray(0, slots * this.stride);
+    return {
+      mode: this.mode,
+      dimension: this.dimension,
+      metric: this.metric,
+      ids: this.slotIds,
+      codes: Buffer.from(codes.buffer, codes.byteOffset, codes.byteLength).toString('base64'),
+      scales: Buffer.from(
+        this.scales.buffer,
+        this.scales.byteOffset,
+        slots * 4
+      ).toString('base64'),
+    };
+  }
+
+  /**
+   * Restore codes saved by toJSON(); returns false if the layout does not match
+   */
+  restore(saved: SavedQuantizedIndex): boolean {
+    if (saved.mode !== this.mode || saved.dimension !== this.dimension || saved.metric !== this.metric) {
+      return false;
+    }
+
+    const slots = saved.ids.length;
+    this.clear();
+    this.grow(Math.max(1024, slots));
+
+    const codes = Buffer.from(saved.codes, 'base64');
+    const scales = Buffer.from(saved.scales, 'base64');
+    new Uint8Array(this.mode === 'binary' ? this.binaryCodes.buffer : this.int8Codes.buffer).set(codes);
+    new Uint8Array(this.scales.buffer).set(scales);
+
+    this.slotIds = saved.ids;
+    saved.ids.forEach((id, slot) => {
+      if (id === null) {
+        this.freeSlots.push(slot);
+      } else {
+        this.idToSlot.set(id, slot);
+      }
+    });
+    if (this.mode === 'int8') {
+      this.recomputeNorms(slots);
+    }
+    return true;
+  }
+
+  private encode(slot: number, vector: Float32Array): void {
+    const v = this.metric === 'cosine' ? this.normalized(vector) : vector;
+
+    if (this.mode === 'binary') {
+      this.packBits(v, this.binaryCodes, slot * this.stride);
+      return;
+    }
+
+    let maxAbs = 0;
+    for (let d = 0; d < this.dimension; d++) {
+      const a = Math.abs(v[d]);
+      if (a > maxAbs) maxAbs = a;
+    }
+    const scale = maxAbs === 0 ? 0 : maxAbs / 127;
+    const inv = scale === 0 ? 0 : 1 / scale;
+    const offset = slot * this.dimension;
+    for (let d = 0; d < this.dimension; d++) {
+      this.int8Codes[offset + d] = Math.round(v[d] * inv);
+    }
+    this.scales[slot] = scale;
+    this.recomputeNorms(slot + 1, slot);
+  }
+
+  private recomputeNorms(end: number, start = 0): void {
+    for (let s = start; s < end; s++) {
+      let sum = 0;
+      const offset = s * this.dimension;
+      for (let d = 0; d < this.dimension; d++) {
+        const x = this.int8Codes[offset + d];
+        sum += x * x;
+      }
+      this.norms2[s] = sum * this.scales[s] * this.scales[s];
+    }
+  }
+
+  private packBits(v: Float32Array, out: Uint32Array, offset: number): void {
+    out.fill(0, offset, offset + this.stride);
+    for (let d = 0; d < this.dimension; d++) {
+      if (v[d] > 0) {
+        out[offset + (d >>> 5)] |= 1 << (d & 31);
+      }
+    }
+  }
+
+  private normalized(v: Float32Array): Float32Array {
+    const norm = l2Norm(v);
+    if (norm === 0) return v;
+    const out = new Float32Array(v.length);
+    for (let i = 0; i < v.length; i++) out[i] = v[i] / norm;
+    return out;
+  }
+
+  private grow(capacity: number): void {
+    if (this.mode === 'binary') {
+      const codes = new Uint32Array(capacity * this.stride);
+      codes.set(this.binaryCodes);
+      this.binaryCodes = codes;
+    } else {
+      const codes = new Int8Array(capacity * this.stride);
+      codes.set(this.int8Codes);
+      this.int8Codes = codes;
+      const norms2 = new Float32Array(capacity);
+      norms2.set(this.norms2);
+      this.norms2 = norms2;
+    }
+    const scales = new Float32Array(capacity);
+    scales.set(this.scales);
+    this.scales = scales;
+    this.capacity = capacity;
+  }
+}
+
+/**
+ * Exact distance between a query and a stored vector, matching hnswlib's
+ * conventions: cosine = 1 - cos, l2 = squared Euclidean, ip = 1 - dot
+ */
+export function exactDistance(
+  metric: 'cosine' | 'l2' | 'ip',
+  query: Float32Array,
+  vector: ArrayLike<number>
+): number {
+  let dot = 0;
+  let qq = 0;
+  let vv = 0;
+  for (let i = 0; i < query.length; i++) {
+    const q = query[i];
+    const v = vector[i];
+    dot += q * v;
+    qq += q * q;
+    vv += v * v;
+  }
+  switch (metric) {
+    case 'l2':
+      return qq + vv - 2 * dot;
+    case 'ip':
+      return 1 - dot;
+    default: {
+      const denom = Math.sqrt(qq) * Math.sqrt(vv);
+      return denom === 0 ? 1 : 1 - dot / denom;
+    }
+  }
+}
@@ -0,0 +1,8 @@
+/**
+ * Quantization Exports
+ *
+ * Export QuantizedIndex (int8/binary candidate tier) and helpers
+ */
+
+export { QuantizedIndex, exactDistance, resolveQuantization } from './QuantizedIndex.js';
+export type { QuantizationMode, QuantizationConfig, QuantizationStats } from './QuantizedIndex.js';
@@ -10,9 +10,16 @@
  * - Distance-to-similarity conversion for all metrics
  * - Batch operations for optimal throughput
  * - Persistent storage with separate metadata files
+ * - Optional int8/binary candidate tier with exact re-rank (config.quantization)
  */
 
 import type { VectorBackend, VectorConfig, SearchResult, SearchOptions, VectorStats } from '../VectorBackend.js';
+import { MetadataFilter } from '../../controllers/MetadataFilter.js';
+import {
+  QuantizedIndex,
+  exactDistance,
+  resolveQuantization,
+} from '../quantization/QuantizedIndex.js';
 
 export class RuVectorBackend implements VectorBackend {
   readonly name = 'ruvector' as const;
@@ -20,6 +27,10 @@ export class RuVectorBackend implements VectorBackend {
   private config: VectorConfig;
   private metadata: Map<string, Record<string, any>> = new Map();
   private initialized = false;
+  private quantized: QuantizedIndex | null = null;
+  // Entries buffered between beginBulkLoad() and endBulkLoad(), by id so
+  // removes and re-inserts replace the pending entry
+  private bulkBuffer: Map<string, { id: string; vector: Float32Array; metadata?: Record<string, any> }> | null = null;
 
   constructor(config: VectorConfig) {
     // Handle both dimension and dimensions for backward compatibility
@@ -69,6 +80,11 @@ export class RuVectorBackend implements VectorBackend {
         m: this.config.M || 16  // Note: lowercase 'm'
       });
 
+      const quantization = resolveQuantization(this.config.quantization);
+      if (quantization.mode !== 'none') {
+        this.quantized = new QuantizedIndex(dimensions, this.config.metric, quantization);
+      }
+
       this.initialized = true;
     } catch (error) {
       const errorMessage = (error as Error).message;
@@ -100,15 +116,23 @@ export class RuVectorBackend implements VectorBackend {
 
     // RuVector v0.1.30+ uses object API with 'vector' field
     // Native VectorDB requires Float32Array, not regular array
-    this.db.insert({
+    const entry = {
       id: id,
       vector: embedding instanceof Float32Array ? embedding : new Float32Array(embedding),
       metadata: metadata
-    });
+    };
+    if (this.bulkBuffer) {
+      // Re-insert keeps only the latest vector, in insertion order
+      this.bulkBuffer.delete(id);
+      this.bulkBuffer.set(id, entry);
+    } else {
+      this.db.insert(entry);
+    }
 
     if (metadata) {
       this.metadata.set(id, metadata);
     }
+    this.quantized?.add(id, embedding);
   }
 
   /**
@@ -117,8 +141,49 @@ export class RuVectorBackend implements VectorBackend {
   insertBatch(items: Array<{ id: string; embedding: Float32Array; metadata?: Record<string, any> }>): void {
     this.ensureInitialized();
 
+    if (this.bulkBuffer || typeof this.db.insertBatch !== 'function') {
+      for (const item of items) {
+        this.insert(item.id, item.embedding, item.metadata);
+      }
+      return;
+    }
+
+    this.db.insertBatch(items.map(item => ({
+      id: item.id,
+      vector: item.embedding instanceof Float32Array ? item.embedding : new Float32Array(item.embedding),
+      metadata: item.metadata
+    })));
     for (const item of items) {
-      this.insert(item.id, item.embedding, item.metadata);
+      if (item.metadata) {
+        this.metadata.set(item.id, item.metadata);
+      }
+      this.quantized?.add(item.id, item.embedding);
+    }
+  }
+
+  /**
+   * Start buffering inserts for one native insertBatch() in endBulkLoad()
+   */
+  beginBulkLoad(): void {
+    this.ensureInitialized();
+    this.bulkBuffer ??= new Map();
+  }
+
+  /**
+   * Hand all buffered entries to the native batch insert
+   */
+  async endBulkLoad(): Promise<void> {
+    const buffer = this.bulkBuffer;
+    this.bulkBuffer = null;
+    if (!buffer || buffer.size === 0) return;
+
+    const entries = [...buffer.values()];
+    if (typeof this.db.insertBatch === 'function') {
+      this.db.insertBatch(entries);
+    } else {
+      for (const entry of entries) {
+        this.db.insert(entry);
+      }
     }
   }
 
@@ -128,44 +193,144 @@ export class RuVectorBackend implements VectorBackend {
   search(query: Float32Array, k: number, options?: SearchOptions): SearchResult[] {
     this.ensureInitialized();
 
-    // Apply efSearch parameter if provided
-    if (options?.efSearch) {
+    // efSearch goes with each native query (searchNative); bindings that
+    // only take it as a setting get it here too
+    if (options?.efSearch && typeof this.db.setEfSearch === 'function') {
       this.db.setEfSearch(options.efSearch);
     }
 
     // RuVector v0.1.30+ supports both object API and legacy positional args
     // Use object API for consistency with insert
     // Native VectorDB requires Float32Array, not regular array
-    const results = this.db.search({
-      vector: query instanceof Float32Array ? query : new Float32Array(query),
-      k: k,
-      threshold: options?.threshold,
-      filter: options?.filter
-    });
-
-    // Convert results and apply filtering
-    return results
-      .map((r: { id: string; distance: number }) => ({
-        id: r.id,
-        distance: r.distance,
-        similarity: this.distanceToSimilarity(r.distance),
-        metadata: this.metadata.get(r.id)
-      }))
-      .filter((r: SearchResult) => {
-        // Apply similarity threshold
-        if (options?.threshold && r.similarity < options.threshold) {
-          return false;
-        }
-
-        // Apply metadata filters
-        if (options?.filter && r.metadata) {
-          return Object.entries(options.filter).every(
-            ([key, value]) => r.metadata![key] === value
-          );
-        }
-
-        return true;
+    const vector = query instanceof Float32Array ? query : new Float32Array(query);
+    const matches = this.buildMatcher(options);
+
+    if (this.quantized) {
+      return this.searchQuantized(vector, k, options, matches);
+    }
+    return this.searchNative(vector, k, options, matches);
+  }
+
+  /**
+   * Async search; native VectorDB handles are not shareable across threads, so this runs inline
+   */
+  async searchAsync(query: Float32Array, k: number, options?: SearchOptions): Promise<SearchResult[]> {
+    return this.search(query, k, options);
+  }
+
+  /**
+   * Full-precision search on the native index
+   */
+  private searchNative(
+    vector: Float32Array,
+    k: number,
+    options: SearchOptions | undefined,
+    matches: ((r: SearchResult) => boolean) | null
+  ): SearchResult[] {
+    const total = this.db.count();
+
+    // The native index has no id/metadata pre-filter, so widen the candidate
+    // window until k results pass (or the index is exhausted) instead of a
+    // fixed over-fetch multiplier
+    let fetchK = Math.min(k, total);
+    let results: SearchResult[] = [];
+
+    while (fetchK > 0) {
+      const raw = this.db.search({
+        vector,
+        k: fetchK,
+        efSearch: options?.efSearch ? Math.max(options.efSearch, fetchK) : undefined,
+        threshold: options?.threshold,
+        filter: options?.filter
       });
+
+      results = raw
+        .map((r: { id: string; distance: number }) => ({
+          id: r.id,
+          distance: r.distance,
+          similarity: this.distanceToSimilarity(r.distance),
+          metadata: this.metadata.get(r.id)
+        }))
+        .filter((r: SearchResult) => {
+          // Apply similarity threshold
+          if (options?.threshold && r.similarity < options.threshold) {
+            return false;
+          }
+          return matches ? matches(r) : true;
+        });
+
+      if (!matches || results.length >= k || raw.length < fetchK || fetchK >= total) {
+        break;
+      }
+      fetchK = Math.min(fetchK * 2, total);
+    }
+
+    return results.slice(0, k);
+  }
+
+  /**
+   * Scan quantized codes for k * rerankFactor candidates, then re-rank them
+   * with exact distances against vectors fetched from the native index
+   */
+  private searchQuantized(
+    vector: Float32Array,
+    k: number,
+    options: SearchOptions | undefined,
+    matches: ((r: SearchResult) => boolean) | null
+  ): SearchResult[] {
+    const quantized = this.quantized!;
+    const allow = matches
+      ? (id: string) => matches({ id, distance: 0, similarity: 0, metadata: this.metadata.get(id) })
+      : undefined;
+
+    const candidates = quantized.candidates(vector, k * quantized.rerankFactor, allow);
+
+    const start = performance.now();
+    const scored: Array<{ id: string; distance: number }> = [];
+    for (const id of candidates) {
+      const entry = this.db.get(id);
+      if (!entry) continue;
+      scored.push({ id, distance: exactDistance(this.config.metric, vector, entry.vector) });
+    }
+    scored.sort((a, b) => a.distance - b.distance);
+
+    const results: SearchResult[] = [];
+    for (const { id, distance } of scored) {
+      if (results.length >= k) break;
+      const similarity = this.distanceToSimilarity(distance);
+      if (options?.threshold && similarity < options.threshold) continue;
+      results.push({ id, distance, similarity, metadata: this.metadata.get(id) });
+    }
+    quantized.recordRerank(performance.now() - start);
+
+    if (quantized.shouldSampleRecall()) {
+      const exact = this.searchNative(vector, k, options, matches);
+      quantized.recordRecall(results.map((r) => r.id), exact.map((r) => r.id));
+    }
+
+    return results;
+  }
+
+  /**
+   * Combine allowedIds and metadata filters into one result predicate
+   */
+  private buildMatcher(options?: SearchOptions): ((r: SearchResult) => boolean) | null {
+    const allowed = options?.allowedIds;
+    const hasFilter = !!options?.filter && Object.keys(options.filter).length > 0;
+    if (!allowed && !hasFilter) return null;
+
+    const allowFn = typeof allowed === 'function'
+      ? allowed
+      : allowed
+        ? (id: string) => allowed.has(id)
+        : null;
+    const matchesMetadata = hasFilter ? MetadataFilter.compile(options!.filter!) : null;
+
+    return (r: SearchResult) => {
+      if (allowFn && !allowFn(r.id)) return false;
+      if (matchesMetadata && (!r.metadata || !matchesMetadata(r.metadata))) return false;
+      return true;
+    };
   }
 
   /**
@@ -175,11 +340,15 @@ export class RuVectorBackend implements VectorBackend {
     this.ensureInitialized();
 
     this.metadata.delete(id);
+    this.quantized?.remove(id);
+
+    // Drop any pending bulk entry; an older copy may still be in the native index
+    const buffered = this.bulkBuffer?.delete(id) ?? false;
 
     try {
-      return this.db.remove(id);
+      return this.db.remove(id) || buffered;
     } catch {
-      return false;
+      return buffered;
     }
   }
 
@@ -194,7 +363,8 @@ export class RuVectorBackend implements VectorBackend {
       dimension: this.config.dimension || 384,
       metric: this.config.metric,
       backend: 'ruvector',
-      memoryUsage: this.db.memoryUsage?.() || 0
+      memoryUsage: this.db.memoryUsage?.() || 0,
+      quantization: this.quantized?.getStats()
     };
   }
 
@@ -214,6 +384,10 @@ export class RuVectorBackend implements VectorBackend {
       metadataPath,
       JSON.stringify(Object.fromEntries(this.metadata), null, 2)
     );
+
+    if (this.quantized) {
+      await fs.writeFile(path + '.quant.json', JSON.stringify(this.quantized.toJSON()));
+    }
   }
 
   /**
@@ -235,6 +409,34 @@ export class RuVectorBackend implements VectorBackend {
       // No metadata file - this is okay for backward compatibility
       console.debug(`[RuVectorBackend] No metadata file found at ${metadataPath}`);
     }
+
+    if (this.quantized) {
+      await this.loadQuantized(path);
+    }
+  }
+
+  /**
+   * Restore quantized codes from the sidecar file. Without one, codes are
+   * re-encoded for ids known from metadata; other ids are re-added on insert.
+   */
+  private async loadQuantized(path: string): Promise<void> {
+    const quantized = this.quantized!;
+    const fs = await import('fs/promises');
+    try {
+      const saved = JSON.parse(await fs.readFile(path + '.quant.json', 'utf-8'));
+      if (quantized.restore(saved)) return;
+    } catch {
+      // Missing or unreadable sidecar - fall through to re-encoding
+    }
+
+    quantized.clear();
+    for (const id of this.metadata.keys()) {
+      const entry = this.db.get(id);
+      if (entry) quantized.add(id, new Float32Array(entry.vector));
+    }
+    console.warn(
+      `[RuVectorBackend] No quantized codes at ${path}.quant.json; re-encoded ${quantized.size} vectors`
+    );
   }
 
   /**
@@ -243,6 +445,7 @@ export class RuVectorBackend implements VectorBackend {
   close(): void {
     // RuVector cleanup if needed
     this.metadata.clear();
+    this.quantized?.clear();
   }
 
   /**
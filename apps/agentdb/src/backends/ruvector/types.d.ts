@@ -11,6 +11,8 @@ declare module '@ruvector/core' {
   export interface SearchQuery {
     vector: Float32Array | number[];
     k?: number;
+    /** Candidate list size for this query (HNSW ef) */
+    efSearch?: number;
     filter?: Record<string, any>;
     threshold?: number;
   }
@@ -48,7 +50,7 @@ declare module '@ruvector/core' {
     delete(id: string): boolean;
     remove(id: string): boolean;
     count(): number;
-    setEfSearch(ef: number): void;
+    setEfSearch?(ef: number): void;
     save(path?: string): void;
     load(path: string): void;
     clear(): void;
@@ -64,6 +64,10 @@ class MinHeap<T> {
     return this.items[0]?.item;
   }
 
+  peekPriority(): number | undefined {
+    return this.items[0]?.priority;
+  }
+
   size(): number {
     return this.items.length;
   }
@@ -144,6 +148,9 @@ export class HNSWIndex {
       return nodeId;
     }
 
+    // Register before wiring so connect() can reach the new node
+    this.nodes.set(nodeId, node);
+
     // Find nearest neighbors at each layer
     const ep = this.entryPoint;
     let nearest = ep;
@@ -187,7 +194,6 @@ export class HNSWIndex {
       this.entryPoint = nodeId;
     }
 
-    this.nodes.set(nodeId, node);
     return nodeId;
   }
 
@@ -235,7 +241,7 @@ export class HNSWIndex {
 
     while (candidates.size() > 0) {
       const c = candidates.pop()!;
-      const fDist = -w.peek()!; // Furthest point distance
+      const fDist = -w.peekPriority()!; // Furthest point distance
 
       const cDist = this.distance(query, this.nodes.get(c)!.vector);
       if (cDist > fDist) break;
@@ -246,7 +252,7 @@ export class HNSWIndex {
         visited.add(e);
 
         const eDist = this.distance(query, this.nodes.get(e)!.vector);
-        const fDist = -w.peek()!;
+        const fDist = -w.peekPriority()!;
 
         if (eDist < fDist || w.size() < ef) {
           candidates.push(e, eDist);
@@ -299,11 +305,9 @@ export class HNSWIndex {
    * Random level assignment
    */
   private randomLevel(): number {
-    let level = 0;
-    while (Math.random() < this.ml && level < this.config.maxLayers - 1) {
-      level++;
-    }
-    return level;
+    // Exponentially decaying layer distribution: floor(-ln(U) * mL)
+    const level = Math.floor(-Math.log(1 - Math.random()) * this.ml);
+    return Math.min(level, this.config.maxLayers - 1);
   }
 
   /**
@@ -22,6 +22,7 @@ export interface PQConfig {
   numCentroids: number;        // Usually 256 (uint8)
   maxIterations?: number;      // K-means iterations
   convergenceThreshold?: number;
+  initialization?: 'kmeans++' | 'random';  // Centroid seeding (random is O(k) vs O(n·k²))
 }
 
 export interface PQCodebook {
@@ -47,7 +48,8 @@ export class ProductQuantization {
       numSubvectors: config.numSubvectors,
       numCentroids: config.numCentroids,
       maxIterations: config.maxIterations || 50,
-      convergenceThreshold: config.convergenceThreshold || 1e-4
+      convergenceThreshold: config.convergenceThreshold || 1e-4,
+      initialization: config.initialization || 'kmeans++'
     };
 
     // Validate config
@@ -69,8 +71,10 @@ export class ProductQuantization {
 
     console.log(`[PQ] Training ${this.config.numSubvectors} subvectors with ${this.config.numCentroids} centroids each...`);
 
-    // Train each subvector independently
+    // Train each subvector independently, yielding between them so long
+    // trainings don't block the event loop
     for (let s = 0; s < this.config.numSubvectors; s++) {
+      await new Promise(resolve => setTimeout(resolve, 0));
       const startDim = s * subvectorDim;
       const endDim = startDim + subvectorDim;
 
@@ -78,7 +82,7 @@ export class ProductQuantization {
       const subvectors = vectors.map(v => v.slice(startDim, endDim));
 
       // Run k-means
-      const subCentroids = await this.kMeans(subvectors, this.config.numCentroids);
+      const subCentroids = this.kMeans(subvectors, this.config.numCentroids);
       centroids.push(...subCentroids);
 
       if ((s + 1) % 4 === 0 || s === this.config.numSubvectors - 1) {
@@ -100,12 +104,14 @@ export class ProductQuantization {
   /**
    * K-means clustering for centroids
    */
-  private async kMeans(vectors: Float32Array[], k: number): Promise<Float32Array[]> {
+  private kMeans(vectors: Float32Array[], k: number): Float32Array[] {
     const dim = vectors[0].length;
     const n = vectors.length;
 
-    // Initialize centroids with k-means++
-    const centroids = this.kMeansPlusPlus(vectors, k);
+    // Initialize centroids with k-means++ (or random sampling)
+    const centroids = this.config.initialization === 'random'
+      ? this.randomInit(vectors, k)
+      : this.kMeansPlusPlus(vectors, k);
     const assignments = new Uint32Array(n);
     let prevInertia = Infinity;
 
@@ -158,6 +164,19 @@ export class ProductQuantization {
     return centroids;
   }
 
+  /**
+   * Random initialization: k distinct training vectors (repeats if n < k)
+   */
+  private randomInit(vectors: Float32Array[], k: number): Float32Array[] {
+    const n = vectors.length;
+    const order = Array.from({ length: n }, (_, i) => i);
+    for (let i = n - 1; i > 0; i--) {
+      const j = Math.floor(Math.random() * (i + 1));
+      [order[i], order[j]] = [order[j], order[i]];
+    }
+    return Array.from({ length: k }, (_, i) => new Float32Array(vectors[order[i % n]]));
+  }
+
   /**
    * K-means++ initialization for better centroid selection
    */
@@ -294,6 +313,84 @@ export class ProductQuantization {
     return Math.sqrt(distance);
   }
 
+  /**
+   * Encode a vector straight into a code buffer (no intermediate allocations)
+   *
+   * @param out - Destination, receives numSubvectors bytes at `offset`
+   */
+  encodeInto(vector: Float32Array, out: Uint8Array, offset: number = 0): void {
+    if (!this.trained || !this.codebook) {
+      throw new Error('Codebook must be trained before compression');
+    }
+
+    const { subvectorDim, numSubvectors, numCentroids, centroids } = this.codebook;
+
+    for (let s = 0; s < numSubvectors; s++) {
+      const start = s * subvectorDim;
+      let minDist = Infinity;
+      let minIdx = 0;
+
+      for (let c = 0; c < numCentroids; c++) {
+        const centroid = centroids[s * numCentroids + c];
+        let dist = 0;
+        for (let d = 0; d < subvectorDim; d++) {
+          const diff = vector[start + d] - centroid[d];
+          dist += diff * diff;
+        }
+        if (dist < minDist) {
+          minDist = dist;
+          minIdx = c;
+        }
+      }
+
+      out[offset + s] = minIdx;
+    }
+  }
+
+  /**
+   * Build the ADC lookup table for a query
+   *
+   * table[s * numCentroids + c] is the squared distance between the query's
+   * s-th subvector and centroid c. Computed once per query, after which the
+   * distance to any code is numSubvectors table lookups (see adcDistance).
+   */
+  computeDistanceTable(query: Float32Array, out?: Float32Array): Float32Array {
+    if (!this.codebook) {
+      throw new Error('Codebook not available');
+    }
+
+    const { subvectorDim, numSubvectors, numCentroids, centroids } = this.codebook;
+    const table = out ?? new Float32Array(numSubvectors * numCentroids);
+
+    for (let s = 0; s < numSubvectors; s++) {
+      const start = s * subvectorDim;
+      for (let c = 0; c < numCentroids; c++) {
+        const centroid = centroids[s * numCentroids + c];
+        let dist = 0;
+        for (let d = 0; d < subvectorDim; d++) {
+          const diff = query[start + d] - centroid[d];
+          dist += diff * diff;
+        }
+        table[s * numCentroids + c] = dist;
+      }
+    }
+
+    return table;
+  }
+
+  /**
+   * Squared ADC distance for codes at `offset`, using a precomputed table
+   */
+  adcDistance(table: Float32Array, codes: Uint8Array, offset: number = 0): number {
+    const m = this.config.numSubvectors;
+    const k = this.config.numCentroids;
+    let distance = 0;
+    for (let s = 0; s < m; s++) {
+      distance += table[s * k + codes[offset + s]];
+    }
+    return distance;
+  }
+
   /**
    * Batch compression for multiple vectors
    */
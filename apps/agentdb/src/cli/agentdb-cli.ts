@@ -142,6 +142,7 @@ class AgentDBCLI {
       undefined   // graphBackend - requires @ruvector/graph-node
     );
     this.skills = new SkillLibrary(this.db, this.embedder);
+    this.skills.setEpisodeBackend(this.reflexion.getEpisodeBackend());
   }
 
   // ============================================================================
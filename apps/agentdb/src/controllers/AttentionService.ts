@@ -11,6 +11,7 @@
  * Features:
  * - Automatic runtime detection (Node.js NAPI vs Browser WASM)
  * - Zero-copy Float32Array processing
+ * - Batched execution over contiguous [B, L, D] buffers (attentionBatch)
  * - Graceful fallbacks for unsupported environments
  * - Performance monitoring hooks
  * - Type-safe interfaces
@@ -65,6 +66,42 @@ export interface AttentionResult {
   runtime: 'napi' | 'wasm' | 'fallback';
 }
 
+/**
+ * Input for a batched attention call: B independent samples in contiguous
+ * row-major buffers
+ */
+export interface AttentionBatchInput {
+  /** Query vectors [batchSize * queryLen * embedDim] */
+  query: Float32Array;
+  /** Key vectors [batchSize * keyLen * embedDim] */
+  key: Float32Array;
+  /** Value vectors [batchSize * keyLen * embedDim] */
+  value: Float32Array;
+  batchSize: number;
+  queryLen: number;
+  /** Keys per sample (default: queryLen) */
+  keyLen?: number;
+  /** Optional attention mask [batchSize * queryLen * keyLen]; 0 masks a key out */
+  mask?: Float32Array;
+  /** Destination [batchSize * queryLen * embedDim]; may be `query` itself. Allocated if omitted */
+  output?: Float32Array;
+  /** Hyperbolic space curvature (hyperbolic only, default: -1.0) */
+  curvature?: number;
+}
+
+/**
+ * Result from a batched attention call
+ */
+export interface AttentionBatchResult {
+  /** The destination buffer, filled for every sample */
+  output: Float32Array;
+  batchSize: number;
+  /** Execution time in milliseconds for the whole batch */
+  executionTimeMs: number;
+  mechanism: AttentionResult['mechanism'];
+  runtime: AttentionResult['runtime'];
+}
+
 /**
  * Statistics about attention operations
  */
@@ -111,6 +148,23 @@ function detectRuntime(): RuntimeEnvironment {
   return 'unknown';
 }
 
+/**
+ * Native function names per mechanism; batch variants add a `Batch` suffix
+ */
+const NATIVE_ENTRY_POINTS: Record<AttentionResult['mechanism'], string> = {
+  'multi-head': 'multiHeadAttention',
+  flash: 'flashAttention',
+  linear: 'linearAttention',
+  hyperbolic: 'hyperbolicAttention',
+  moe: 'moeAttention',
+};
+
+function sharesMemory(a: Float32Array, b: Float32Array): boolean {
+  return a.buffer === b.buffer
+    && a.byteOffset < b.byteOffset + b.byteLength
+    && b.byteOffset < a.byteOffset + a.byteLength;
+}
+
 /**
  * AttentionService - Main controller for attention mechanisms
  */
@@ -121,6 +175,9 @@ export class AttentionService {
   private wasmModule: any = null;
   private initialized: boolean = false;
 
+  // Reused by the JS kernels so repeated calls don't allocate per query row
+  private scratch = new Float64Array(0);
+
   // Performance tracking
   private stats: AttentionStats = {
     totalOps: 0,
@@ -613,6 +670,96 @@ export class AttentionService {
     }
   }
 
+  /**
+   * Run one attention mechanism over a batch of samples in a single call
+   *
+   * Uses the native module's batch entry point when it has one (one boundary
+   * crossing for the whole batch), otherwise per-sample native calls on
+   * subarray views, otherwise the JS kernels with reused scratch buffers.
+   * Results are written into `input.output` (or a buffer allocated once per
+   * call), sample b at offset b * queryLen * embedDim.
+   */
+  async attentionBatch(
+    mechanism: AttentionResult['mechanism'],
+    input: AttentionBatchInput
+  ): Promise<AttentionBatchResult> {
+    if (!this.initialized) {
+      await this.initialize();
+    }
+
+    const { embedDim, numHeads, headDim } = this.config;
+    const { query, key, value, mask, batchSize, queryLen } = input;
+    const keyLen = input.keyLen ?? queryLen;
+    const queryStride = queryLen * embedDim;
+    const keyStride = keyLen * embedDim;
+    const maskStride = queryLen * keyLen;
+
+    if (query.length !== batchSize * queryStride) {
+      throw new Error(`Batched ${mechanism} attention: query has ${query.length} values, expected ${batchSize} x ${queryLen} x ${embedDim}`);
+    }
+    if (key.length !== batchSize * keyStride || value.length !== batchSize * keyStride) {
+      throw new Error(`Batched ${mechanism} attention: key/value must be ${batchSize} x ${keyLen} x ${embedDim}`);
+    }
+    if (mask && mask.length !== batchSize * maskStride) {
+      throw new Error(`Batched ${mechanism} attention: mask must be ${batchSize} x ${queryLen} x ${keyLen}`);
+    }
+    const output = input.output ?? new Float32Array(query.length);
+    if (output.length !== query.length) {
+      throw new Error(`Batched ${mechanism} attention: output must hold ${query.length} values`);
+    }
+    if (sharesMemory(output, key) || sharesMemory(output, value)) {
+      throw new Error(`Batched ${mechanism} attention: output may alias query but not key or value`);
+    }
+
+    const start = performance.now();
+    const native = this.napiModule ?? this.wasmModule;
+    const nativeRuntime: 'napi' | 'wasm' = this.napiModule ? 'napi' : 'wasm';
+    const entry = NATIVE_ENTRY_POINTS[mechanism];
+    const extra = this.nativeExtraArgs(mechanism, input.curvature);
+    let runtime: AttentionResult['runtime'] = 'fallback';
+
+    try {
+      if (native && typeof native[`${entry}Batch`] === 'function') {
+        // Batch entry point: writes into output
+        native[`${entry}Batch`](query, key, value, batchSize, queryLen, keyLen, numHeads, headDim, output, ...extra, mask);
+        runtime = nativeRuntime;
+      } else if (native && typeof native[entry] === 'function') {
+        for (let b = 0; b < batchSize; b++) {
+          const q = query.subarray(b * queryStride, (b + 1) * queryStride);
+          const k = key.subarray(b * keyStride, (b + 1) * keyStride);
+          const v = value.subarray(b * keyStride, (b + 1) * keyStride);
+          const m = mask?.subarray(b * maskStride, (b + 1) * maskStride);
+          const result = native[entry](q, k, v, numHeads, headDim, ...extra, ...(mechanism === 'linear' || mechanism === 'hyperbolic' ? [] : [m]));
+          output.set(result instanceof Float32Array ? result : result.output, b * queryStride);
+        }
+        runtime = nativeRuntime;
+      } else if (mechanism === 'linear') {
+        this.linearAttentionKernel(query, key, value, batchSize, queryLen, keyLen, output);
+      } else {
+        // Hyperbolic falls back to unmasked attention, as in the single-call path
+        const kernelMask = mechanism === 'hyperbolic' ? undefined : mask;
+        this.dotProductAttentionKernel(query, key, value, kernelMask, batchSize, queryLen, keyLen, output);
+      }
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new Error(`Batched ${mechanism} attention failed: ${errorMessage}`);
+    }
+
+    const executionTimeMs = performance.now() - start;
+    this.updateStats(mechanism, runtime, executionTimeMs, output.length * 4);
+
+    return { output, batchSize, executionTimeMs, mechanism, runtime };
+  }
+
+  /**
+   * Mechanism-specific native arguments that follow headDim
+   */
+  private nativeExtraArgs(mechanism: AttentionResult['mechanism'], curvature: number = -1.0): number[] {
+    if (mechanism === 'hyperbolic') return [curvature];
+    if (mechanism === 'moe') return [this.config.numExperts || 8, this.config.topK || 2];
+    return [];
+  }
+
   /**
    * Fallback JavaScript implementation of multi-head attention
    * Used when native modules are not available
@@ -623,83 +770,134 @@ export class AttentionService {
     value: Float32Array,
     mask?: Float32Array
   ): { output: Float32Array; weights?: Float32Array } {
-    const { numHeads, headDim, embedDim } = this.config;
-    const seqLen = Math.floor(query.length / embedDim);
-    const batchSize = 1; // Simplified for fallback
+    const seqLen = Math.floor(query.length / this.config.embedDim);
+    const output = new Float32Array(query.length);
+    this.dotProductAttentionKernel(query, key, value, mask, 1, seqLen, seqLen, output);
+    return { output };
+  }
 
-    // Simple scaled dot-product attention
-    const scale = 1.0 / Math.sqrt(headDim);
+  /**
+   * Fallback JavaScript implementation of linear attention
+   */
+  private linearAttentionFallback(
+    query: Float32Array,
+    key: Float32Array,
+    value: Float32Array
+  ): Float32Array {
+    const seqLen = Math.floor(query.length / this.config.embedDim);
     const output = new Float32Array(query.length);
+    this.linearAttentionKernel(query, key, value, 1, seqLen, seqLen, output);
+    return output;
+  }
+
+  /**
+   * Scaled dot-product attention over a batch (scores from the first head's
+   * dimensions, as in the single-call fallback). Scores are computed once per
+   * query/key pair into scratch, and each output row is written only after
+   * its query row has been read, so output may alias query.
+   */
+  private dotProductAttentionKernel(
+    query: Float32Array,
+    key: Float32Array,
+    value: Float32Array,
+    mask: Float32Array | undefined,
+    batchSize: number,
+    queryLen: number,
+    keyLen: number,
+    output: Float32Array
+  ): void {
+    const { headDim, embedDim } = this.config;
+    const scale = 1.0 / Math.sqrt(headDim);
+    const scoreDim = Math.min(headDim, embedDim);
+    const scratch = this.scratchFor(keyLen + embedDim);
+    const accum = embedDim; // scratch[keyLen...] holds the output row sums
+
+    for (let b = 0; b < batchSize; b++) {
+      const qBase = b * queryLen * embedDim;
+      const kBase = b * keyLen * embedDim;
+      const mBase = b * queryLen * keyLen;
 
-    for (let i = 0; i < seqLen; i++) {
-      for (let d = 0; d < embedDim; d++) {
-        let sum = 0;
+      for (let i = 0; i < queryLen; i++) {
+        const qRow = qBase + i * embedDim;
         let weightSum = 0;
 
-        for (let j = 0; j < seqLen; j++) {
-          // Compute attention score
+        for (let j = 0; j < keyLen; j++) {
           let score = 0;
-          for (let k = 0; k < headDim; k++) {
-            const qIdx = i * embedDim + k;
-            const kIdx = j * embedDim + k;
-            score += query[qIdx] * key[kIdx];
+          const kRow = kBase + j * embedDim;
+          for (let d = 0; d < scoreDim; d++) {
+            score += query[qRow + d] * key[kRow + d];
           }
-          score *= scale;
+          const weight = mask && mask[mBase + i * keyLen + j] === 0 ? 0 : Math.exp(score * scale);
+          scratch[j] = weight;
+          weightSum += weight;
+        }
 
-          // Apply mask if provided
-          if (mask && mask[i * seqLen + j] === 0) {
-            score = -Infinity;
+        scratch.fill(0, keyLen, keyLen + accum);
+        for (let j = 0; j < keyLen; j++) {
+          const weight = scratch[j];
+          if (weight === 0) continue;
+          const vRow = kBase + j * embedDim;
+          for (let d = 0; d < embedDim; d++) {
+            scratch[keyLen + d] += weight * value[vRow + d];
           }
-
-          // Softmax (simplified)
-          const weight = Math.exp(score);
-          const vIdx = j * embedDim + d;
-          sum += weight * value[vIdx];
-          weightSum += weight;
         }
 
-        output[i * embedDim + d] = weightSum > 0 ? sum / weightSum : 0;
+        for (let d = 0; d < embedDim; d++) {
+          output[qRow + d] = weightSum > 0 ? scratch[keyLen + d] / weightSum : 0;
+        }
       }
     }
-
-    return { output };
   }
 
   /**
-   * Fallback JavaScript implementation of linear attention
+   * Linear attention with the elu + 1 feature map. The key/value sums don't
+   * depend on the query row, so they are computed once per sample: O(L * D)
+   * instead of O(L^2 * D).
    */
-  private linearAttentionFallback(
+  private linearAttentionKernel(
     query: Float32Array,
     key: Float32Array,
-    value: Float32Array
-  ): Float32Array {
-    // Simplified linear attention using feature maps
+    value: Float32Array,
+    batchSize: number,
+    queryLen: number,
+    keyLen: number,
+    output: Float32Array
+  ): void {
     const { embedDim } = this.config;
-    const seqLen = Math.floor(query.length / embedDim);
-    const output = new Float32Array(query.length);
-
-    // Apply feature map (elu + 1)
+    const scratch = this.scratchFor(2 * embedDim);
     const featureMap = (x: number) => x > 0 ? x + 1 : Math.exp(x);
 
-    for (let i = 0; i < seqLen; i++) {
-      for (let d = 0; d < embedDim; d++) {
-        let numerator = 0;
-        let denominator = 0;
-
-        for (let j = 0; j < seqLen; j++) {
-          const qVal = featureMap(query[i * embedDim + d]);
-          const kVal = featureMap(key[j * embedDim + d]);
-          const vVal = value[j * embedDim + d];
-
-          numerator += qVal * kVal * vVal;
-          denominator += qVal * kVal;
+    for (let b = 0; b < batchSize; b++) {
+      const qBase = b * queryLen * embedDim;
+      const kBase = b * keyLen * embedDim;
+
+      // scratch[0..D) = sum_j phi(k) * v, scratch[D..2D) = sum_j phi(k)
+      scratch.fill(0, 0, 2 * embedDim);
+      for (let j = 0; j < keyLen; j++) {
+        const row = kBase + j * embedDim;
+        for (let d = 0; d < embedDim; d++) {
+          const kVal = featureMap(key[row + d]);
+          scratch[d] += kVal * value[row + d];
+          scratch[embedDim + d] += kVal;
         }
+      }
 
-        output[i * embedDim + d] = denominator > 0 ? numerator / denominator : 0;
+      for (let i = 0; i < queryLen; i++) {
+        const row = qBase + i * embedDim;
+        for (let d = 0; d < embedDim; d++) {
+          const qVal = featureMap(query[row + d]);
+          const denominator = qVal * scratch[embedDim + d];
+          output[row + d] = denominator > 0 ? (qVal * scratch[d]) / denominator : 0;
+        }
       }
     }
+  }
 
-    return output;
+  private scratchFor(size: number): Float64Array {
+    if (this.scratch.length < size) {
+      this.scratch = new Float64Array(Math.max(size, this.scratch.length * 2));
+    }
+    return this.scratch;
   }
 
   /**
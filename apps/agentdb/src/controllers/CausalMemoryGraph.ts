@@ -14,6 +14,11 @@
  * - Poincaré embeddings for hierarchical relationships
  * - Feature flag: ENABLE_HYPERBOLIC_ATTENTION (default: false)
  * - 100% backward compatible with fallback to standard retrieval
+ *
+ * Multi-hop chains are searched on an in-memory CSR copy of causal_edges
+ * (see CausalCsrGraph), shared by all instances on one connection. It is
+ * loaded on first use, extended by addCausalEdge(), caught up on rows other
+ * code appends, and reloaded after writes from another connection.
  */
 
 import type { IDatabaseConnection, DatabaseRows } from '../types/database.types.js';
@@ -22,6 +27,19 @@ import type { GraphDatabaseAdapter, CausalEdge as GraphCausalEdge } from '../bac
 import { NodeIdMapper } from '../utils/NodeIdMapper.js';
 import { AttentionService, type HyperbolicAttentionConfig } from '../services/AttentionService.js';
 import { EmbeddingService } from './EmbeddingService.js';
+import { CausalCsrGraph } from '../utils/CausalCsrGraph.js';
+
+/** Rows fetched per page when loading causal_edges into the chain graph */
+const CHAIN_GRAPH_PAGE_SIZE = 50000;
+
+interface ChainGraphState {
+  graph: CausalCsrGraph;
+  maxEdgeId: number;
+  dataVersion: number | null;
+}
+
+// One chain graph per database connection
+const chainGraphs = new WeakMap<object, ChainGraphState>();
 
 /**
  * Configuration for CausalMemoryGraph
@@ -204,8 +222,16 @@ export class CausalMemoryGraph {
       edge.mechanism || null,
       edge.metadata ? JSON.stringify(edge.metadata) : null
     );
+    const edgeId = normalizeRowId(result.lastInsertRowid);
 
-    return normalizeRowId(result.lastInsertRowid);
+    // Extend a loaded chain graph in place; gaps are left to the catch-up scan
+    const state = chainGraphs.get(this.db);
+    if (state && edgeId === state.maxEdgeId + 1) {
+      state.graph.addEdge(edge.fromMemoryId, edge.toMemoryId, edge.uplift ?? null, edge.confidence);
+      state.maxEdgeId = edgeId;
+    }
+
+    return edgeId;
   }
 
   /**
@@ -383,7 +409,7 @@ export class CausalMemoryGraph {
    * Get causal chain (multi-hop reasoning)
    *
    * v2: Uses HyperbolicAttention if enabled for tree-structured retrieval
-   * v1: Falls back to recursive CTE with standard scoring
+   * v1: Best-first search over the in-memory edge graph, ranked by total uplift
    *
    * @param fromMemoryId - Starting memory node
    * @param toMemoryId - Target memory node
@@ -404,52 +430,88 @@ export class CausalMemoryGraph {
       return this.getCausalChainWithAttention(fromMemoryId, toMemoryId, maxDepth);
     }
 
-    interface ChainRow {
-      path: string;
-      total_uplift: number;
-      min_confidence: number;
+    // v1: Best-first search over the in-memory edge graph
+    return this.getChainGraph().findChains(fromMemoryId, toMemoryId, { maxDepth, limit: 10 });
+  }
+
+  /**
+   * Drop the shared chain graph so the next chain query reloads it
+   *
+   * Call after deleting or updating causal_edges rows on this connection
+   * outside this class; appended rows are picked up automatically.
+   */
+  invalidateChainGraph(): void {
+    chainGraphs.delete(this.db);
+  }
+
+  /**
+   * Chain graph for this connection, loaded or caught up as needed
+   */
+  private getChainGraph(): CausalCsrGraph {
+    const dataVersion = this.readDataVersion();
+    let state = chainGraphs.get(this.db);
+    if (state && state.dataVersion !== dataVersion) {
+      state = undefined; // Another connection wrote to the database
+    }
+
+    const maxRow = this.db.prepare('SELECT MAX(id) AS max_id FROM causal_edges').get() as any;
+    const maxEdgeId = maxRow?.max_id ?? 0;
+    if (state && state.maxEdgeId === maxEdgeId) {
+      return state.graph;
     }
 
-    // v1: Legacy recursive CTE
-    const chains = this.db.prepare<ChainRow>(`
-      WITH RECURSIVE chain(from_id, to_id, depth, path, total_uplift, min_confidence) AS (
-        SELECT
-          from_memory_id,
-          to_memory_id,
-          1,
-          from_memory_id || '->' || to_memory_id,
-          uplift,
-          confidence
-        FROM causal_edges
-        WHERE from_memory_id = ? AND confidence >= 0.5
-
-        UNION ALL
-
-        SELECT
-          chain.from_id,
-          ce.to_memory_id,
-          chain.depth + 1,
-          chain.path || '->' || ce.to_memory_id,
-          chain.total_uplift + ce.uplift,
-          MIN(chain.min_confidence, ce.confidence)
-        FROM chain
-        JOIN causal_edges ce ON chain.to_id = ce.from_memory_id
-        WHERE chain.depth < ?
-          AND ce.confidence >= 0.5
-          AND chain.path NOT LIKE '%' || ce.to_memory_id || '%'
-      )
-      SELECT path, total_uplift, min_confidence
-      FROM chain
-      WHERE to_id = ?
-      ORDER BY total_uplift DESC
-      LIMIT 10
-    `).all(fromMemoryId, maxDepth, toMemoryId);
-
-    return chains.map(row => ({
-      path: row.path.split('->').map(Number),
-      totalUplift: row.total_uplift,
-      confidence: row.min_confidence
-    }));
+    const start = Date.now();
+    const graph = state?.graph ?? new CausalCsrGraph();
+    const fromId = state?.maxEdgeId ?? 0;
+    const before = graph.edges;
+
+    const stmt = this.db.prepare(`
+      SELECT id, from_memory_id, to_memory_id, uplift, confidence
+      FROM causal_edges
+      WHERE id > ?
+      ORDER BY id
+      LIMIT ?
+    `) as any;
+
+    let lastId = fromId;
+    while (true) {
+      let pageRows = 0;
+      const rows = typeof stmt.iterate === 'function'
+        ? stmt.iterate(lastId, CHAIN_GRAPH_PAGE_SIZE)
+        : stmt.all(lastId, CHAIN_GRAPH_PAGE_SIZE);
+
+      for (const row of rows as Iterable<any>) {
+        // A fresh load builds the CSR once at the end; a catch-up folds in as usual
+        graph.addEdge(row.from_memory_id, row.to_memory_id, row.uplift, row.confidence, !!state);
+        lastId = row.id;
+        pageRows++;
+      }
+      if (pageRows < CHAIN_GRAPH_PAGE_SIZE) break;
+    }
+    if (!state) graph.build();
+
+    chainGraphs.set(this.db, { graph, maxEdgeId: Math.max(lastId, maxEdgeId), dataVersion });
+    if (!state) {
+      console.log(
+        `[CausalMemoryGraph] Loaded chain graph: ${graph.edges} edges, ${graph.nodes} nodes ` +
+          `in ${Date.now() - start}ms`
+      );
+    } else if (graph.edges - before > 1000) {
+      console.log(`[CausalMemoryGraph] Chain graph caught up ${graph.edges - before} edges`);
+    }
+    return graph;
+  }
+
+  /**
+   * SQLite data_version: changes when another connection commits (null if unsupported)
+   */
+  private readDataVersion(): number | null {
+    try {
+      const row = this.db.prepare('PRAGMA data_version').get() as any;
+      return row?.data_version ?? null;
+    } catch {
+      return null;
+    }
   }
 
   /**
@@ -487,39 +549,8 @@ export class CausalMemoryGraph {
       computeTimeMs: number;
     };
   }[]> {
-    // Get all candidate chains using CTE
-    const candidateChains = this.db.prepare(`
-      WITH RECURSIVE chain(from_id, to_id, depth, path, total_uplift, min_confidence) AS (
-        SELECT
-          from_memory_id,
-          to_memory_id,
-          1,
-          from_memory_id || '->' || to_memory_id,
-          uplift,
-          confidence
-        FROM causal_edges
-        WHERE from_memory_id = ? AND confidence >= 0.5
-
-        UNION ALL
-
-        SELECT
-          chain.from_id,
-          ce.to_memory_id,
-          chain.depth + 1,
-          chain.path || '->' || ce.to_memory_id,
-          chain.total_uplift + ce.uplift,
-          MIN(chain.min_confidence, ce.confidence)
-        FROM chain
-        JOIN causal_edges ce ON chain.to_id = ce.from_memory_id
-        WHERE chain.depth < ?
-          AND ce.confidence >= 0.5
-          AND chain.path NOT LIKE '%' || ce.to_memory_id || '%'
-      )
-      SELECT path, total_uplift, min_confidence
-      FROM chain
-      WHERE to_id = ?
-      LIMIT 50
-    `).all(fromMemoryId, maxDepth, toMemoryId) as any[];
+    // Candidate chains from the edge graph, re-ranked by attention below
+    const candidateChains = this.getChainGraph().findChains(fromMemoryId, toMemoryId, { maxDepth, limit: 50 });
 
     if (candidateChains.length === 0) {
       return [];
@@ -532,9 +563,8 @@ export class CausalMemoryGraph {
 
     // Get embeddings and hierarchy levels for all chain nodes
     const allNodeIds = new Set<number>();
-    candidateChains.forEach((chain: any) => {
-      const path = chain.path.split('->').map(Number);
-      path.forEach(id => allNodeIds.add(id));
+    candidateChains.forEach((chain) => {
+      chain.path.forEach(id => allNodeIds.add(id));
     });
 
     const nodeEmbeddings = new Map<number, Float32Array>();
@@ -549,12 +579,8 @@ export class CausalMemoryGraph {
 
         // Calculate hierarchy level (depth from root)
         const level = candidateChains
-          .filter((chain: any) => chain.path.includes(String(nodeId)))
-          .reduce((minDepth: number, chain: any) => {
-            const path = chain.path.split('->').map(Number);
-            const idx = path.indexOf(nodeId);
-            return Math.min(minDepth, idx);
-          }, maxDepth);
+          .filter((chain) => chain.path.includes(nodeId))
+          .reduce((minDepth: number, chain) => Math.min(minDepth, chain.path.indexOf(nodeId)), maxDepth);
 
         hierarchyLevels.set(nodeId, level);
       }
@@ -586,8 +612,8 @@ export class CausalMemoryGraph {
 
     // Re-rank chains by attention weights
     const rankedChains = candidateChains
-      .map((chain: any) => {
-        const path = chain.path.split('->').map(Number);
+      .map((chain) => {
+        const path = chain.path;
 
         // Calculate average attention weight for nodes in path
         const avgWeight = path.reduce((sum: number, nodeId: number) => {
@@ -597,8 +623,8 @@ export class CausalMemoryGraph {
 
         return {
           path,
-          totalUplift: chain.total_uplift,
-          confidence: chain.min_confidence * avgWeight, // Boost confidence by attention
+          totalUplift: chain.totalUplift,
+          confidence: chain.confidence * avgWeight, // Boost confidence by attention
           attentionMetrics: {
             hyperbolicDistance: attentionResult.distances,
             computeTimeMs: attentionResult.metrics.computeTimeMs,
@@ -3,23 +3,83 @@
  *
  * Handles text-to-vector embedding generation using various models.
  * Supports both local (transformers.js) and remote (OpenAI, etc.) embeddings.
+ *
+ * Concurrent embed() calls are coalesced within a short window into one model
+ * forward pass or one OpenAI request, identical in-flight texts share a single
+ * pending result, and the number of concurrent batches is bounded.
+ * Results are kept in an O(1) LRU bounded by entry count and bytes, keyed by
+ * sha256(text). An optional PersistentEmbeddingCache adds a second tier keyed
+ * by (model, sha256(text)) that survives restarts.
  */
 
+import { LRUCache, hashKey, type LRUCacheStats } from '../utils/LRUCache.js';
+import type { PersistentEmbeddingCache } from './PersistentEmbeddingCache.js';
+
 export interface EmbeddingConfig {
   model: string;
   dimension: number;
   provider: 'transformers' | 'openai' | 'local';
   apiKey?: string;
+
+  /** Coalescing window for concurrent embed() calls in ms (default: 5) */
+  batchWindowMs?: number;
+
+  /** Max texts per model batch / API request (default: 32 transformers, 2048 OpenAI) */
+  maxBatchSize?: number;
+
+  /** Max batches in flight at once (default: 2) */
+  maxConcurrency?: number;
+
+  /** Max cached embeddings (default: 10000) */
+  cacheMaxEntries?: number;
+
+  /** Byte budget for cached embeddings (default: 64MB) */
+  cacheMaxBytes?: number;
+
+  /** Second-tier cache read before calling the model and written back asynchronously */
+  persistentCache?: PersistentEmbeddingCache;
 }
 
+interface PendingEmbedding {
+  text: string;
+  key: string;
+  resolve: (embedding: Float32Array) => void;
+  reject: (error: unknown) => void;
+}
+
+/** OpenAI accepts at most 2048 inputs per embeddings request */
+const OPENAI_MAX_INPUTS = 2048;
+
+/** Approximate per-entry overhead: base64 sha256 key plus map/object slots */
+const CACHE_ENTRY_OVERHEAD = 160;
+
 export class EmbeddingService {
   private config: EmbeddingConfig;
   private pipeline: any; // transformers.js pipeline
-  private cache: Map<string, Float32Array>;
+  private cache: LRUCache<Float32Array>;
+  private persistentCache: PersistentEmbeddingCache | null;
+
+  // Batching state
+  private inflight: Map<string, Promise<Float32Array>> = new Map();
+  private queue: PendingEmbedding[] = [];
+  private flushTimer: ReturnType<typeof setTimeout> | null = null;
+  private activeBatches = 0;
 
   constructor(config: EmbeddingConfig) {
     this.config = config;
-    this.cache = new Map();
+    this.cache = new LRUCache<Float32Array>({
+      maxEntries: config.cacheMaxEntries ?? 10000,
+      maxBytes: config.cacheMaxBytes ?? 64 * 1024 * 1024,
+      sizeOf: embedding => embedding.byteLength + CACHE_ENTRY_OVERHEAD,
+    });
+    this.persistentCache = config.persistentCache ?? null;
+  }
+
+  /**
+   * Attach (or detach with null) the persistent second-tier cache
+   */
+  setPersistentCache(cache: PersistentEmbeddingCache | null): void {
+    this.persistentCache = cache;
   }
 
   /**
@@ -63,42 +123,63 @@ export class EmbeddingService {
    * Generate embedding for text
    */
   async embed(text: string): Promise<Float32Array> {
-    // Check cache
-    const cacheKey = `${this.config.model}:${text}`;
-    if (this.cache.has(cacheKey)) {
-      return this.cache.get(cacheKey)!;
+    // Check cache (one model per service, so the text digest is the key)
+    const cacheKey = hashKey(text ?? '');
+    const cached = this.cache.get(cacheKey);
+    if (cached) {
+      return cached;
     }
 
-    let embedding: Float32Array;
+    if (!this.isBatchedProvider()) {
+      // Mock embedding for testing - cheap enough to compute inline, never persisted
+      const embedding = this.mockEmbedding(text);
+      this.cache.set(cacheKey, embedding);
+      return embedding;
+    }
 
-    if (this.config.provider === 'transformers' && this.pipeline) {
-      // Use transformers.js
-      const output = await this.pipeline(text, { pooling: 'mean', normalize: true });
-      embedding = new Float32Array(output.data);
-    } else if (this.config.provider === 'openai' && this.config.apiKey) {
-      // Use OpenAI API
-      embedding = await this.embedOpenAI(text);
-    } else {
-      // Mock embedding for testing
-      embedding = this.mockEmbedding(text);
+    // Read through the persistent tier before calling the model
+    const stored = this.persistentCache?.get(this.config.model, cacheKey);
+    if (stored) {
+      this.cache.set(cacheKey, stored);
+      return stored;
     }
 
-    // Cache result
-    if (this.cache.size > 10000) {
-      // Simple LRU: clear half the cache
-      const keysToDelete = Array.from(this.cache.keys()).slice(0, 5000);
-      keysToDelete.forEach(k => this.cache.delete(k));
+    // Share the pending result for identical in-flight texts
+    const pending = this.inflight.get(cacheKey);
+    if (pending) {
+      return pending;
     }
-    this.cache.set(cacheKey, embedding);
 
-    return embedding;
+    const promise = new Promise<Float32Array>((resolve, reject) => {
+      this.queue.push({ text, key: cacheKey, resolve, reject });
+    });
+    this.inflight.set(cacheKey, promise);
+
+    if (this.queue.length >= this.maxBatchSize()) {
+      this.drainQueue();
+    } else if (!this.flushTimer) {
+      this.flushTimer = setTimeout(() => this.drainQueue(), this.config.batchWindowMs ?? 5);
+    }
+
+    return promise;
   }
 
   /**
    * Batch embed multiple texts
+   *
+   * Texts are queued together and flushed immediately, so they are sent as
+   * full model batches instead of waiting for the coalescing window.
    */
   async embedBatch(texts: string[]): Promise<Float32Array[]> {
-    return Promise.all(texts.map(text => this.embed(text)));
+    if (this.persistentCache && this.isBatchedProvider()) {
+      this.prefetchPersistent(texts.map(text => hashKey(text ?? '')));
+    }
+
+    const results = texts.map(text => this.embed(text));
+    if (this.queue.length > 0) {
+      this.drainQueue();
+    }
+    return Promise.all(results);
   }
 
   /**
@@ -108,11 +189,117 @@ export class EmbeddingService {
     this.cache.clear();
   }
 
+  /**
+   * Bulk-load the persistent tier into memory
+   *
+   * @param texts - Load these texts' embeddings; otherwise the most recent
+   *   entries for this model, up to the in-memory entry limit
+   * @returns Number of embeddings loaded
+   */
+  async warmCache(texts?: string[]): Promise<number> {
+    if (!this.persistentCache) return 0;
+
+    if (texts) {
+      return this.prefetchPersistent(texts.map(text => hashKey(text ?? '')));
+    }
+
+    const limit = Math.min(this.config.cacheMaxEntries ?? 10000, 10000);
+    const rows = this.persistentCache.loadRecent(this.config.model, limit);
+    // Insert oldest first so the newest end up most recently used
+    for (let i = rows.length - 1; i >= 0; i--) {
+      this.cache.set(rows[i][0], rows[i][1]);
+    }
+    return rows.length;
+  }
+
+  /**
+   * Embedding cache hit/miss/eviction metrics
+   */
+  getCacheStats(): LRUCacheStats {
+    return this.cache.getStats();
+  }
+
   // ========================================================================
   // Private Methods
   // ========================================================================
 
-  private async embedOpenAI(text: string): Promise<Float32Array> {
+  private isBatchedProvider(): boolean {
+    return (
+      (this.config.provider === 'transformers' && !!this.pipeline) ||
+      (this.config.provider === 'openai' && !!this.config.apiKey)
+    );
+  }
+
+  private prefetchPersistent(keys: string[]): number {
+    const missing = keys.filter(key => !this.cache.has(key));
+    if (missing.length === 0) return 0;
+
+    const found = this.persistentCache!.getMany(this.config.model, missing);
+    for (const [key, embedding] of found) {
+      this.cache.set(key, embedding);
+    }
+    return found.size;
+  }
+
+  private maxBatchSize(): number {
+    const limit = this.config.provider === 'openai' ? OPENAI_MAX_INPUTS : 32;
+    return Math.min(this.config.maxBatchSize ?? limit, limit);
+  }
+
+  /**
+   * Start queued batches up to the concurrency limit
+   */
+  private drainQueue(): void {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+
+    const maxConcurrency = Math.max(1, this.config.maxConcurrency ?? 2);
+    while (this.queue.length > 0 && this.activeBatches < maxConcurrency) {
+      const batch = this.queue.splice(0, this.maxBatchSize());
+      this.activeBatches++;
+      this.runBatch(batch).finally(() => {
+        this.activeBatches--;
+        this.drainQueue();
+      });
+    }
+  }
+
+  private async runBatch(batch: PendingEmbedding[]): Promise<void> {
+    try {
+      const texts = batch.map(item => item.text);
+      const embeddings = this.config.provider === 'openai'
+        ? await this.embedOpenAI(texts)
+        : await this.embedTransformers(texts);
+
+      batch.forEach((item, i) => {
+        this.cache.set(item.key, embeddings[i]);
+        this.persistentCache?.put(this.config.model, item.key, embeddings[i]);
+        item.resolve(embeddings[i]);
+      });
+    } catch (error) {
+      batch.forEach(item => item.reject(error));
+    } finally {
+      batch.forEach(item => this.inflight.delete(item.key));
+    }
+  }
+
+  /**
+   * One transformers.js forward pass over the whole batch
+   */
+  private async embedTransformers(texts: string[]): Promise<Float32Array[]> {
+    const output = await this.pipeline(texts, { pooling: 'mean', normalize: true });
+    const data: Float32Array = output.data;
+    const dim = output.dims?.[output.dims.length - 1] ?? data.length / texts.length;
+
+    return texts.map((_, i) => new Float32Array(data.subarray(i * dim, (i + 1) * dim)));
+  }
+
+  /**
+   * One OpenAI embeddings request for the whole batch
+   */
+  private async embedOpenAI(texts: string[]): Promise<Float32Array[]> {
     const response = await fetch('https://api.openai.com/v1/embeddings', {
       method: 'POST',
       headers: {
@@ -121,12 +308,20 @@ export class EmbeddingService {
       },
       body: JSON.stringify({
         model: this.config.model,
-        input: text
+        input: texts
       })
     });
 
+    if (!response.ok) {
+      throw new Error(`OpenAI API error: ${response.status} ${response.statusText}`);
+    }
+
     const data: any = await response.json();
-    return new Float32Array(data.data[0].embedding);
+    const embeddings: Float32Array[] = new Array(texts.length);
+    for (const item of data.data) {
+      embeddings[item.index] = new Float32Array(item.embedding);
+    }
+    return embeddings;
   }
 
   private mockEmbedding(text: string): Float32Array {
@@ -16,13 +16,19 @@
  * - Rotary positional encoding based on graph structure
  * - Feature flag: ENABLE_GRAPH_ROPE (default: false)
  * - 100% backward compatible with fallback to standard retrieval
+ *
+ * Certificates can be issued from a background queue (deferCertificates),
+ * so the request path only computes the hitting set. Source hashes are
+ * resolved and hashed per batch, and Merkle trees over identical or
+ * extended source sets come from a prefix-aware cache.
  */
 
 // Database type from db-fallback
 type Database = any;
-import * as crypto from 'crypto';
 import { AttentionService, type GraphRoPEConfig } from '../services/AttentionService.js';
 import { EmbeddingService } from './EmbeddingService.js';
+import { MerkleTreeCache, sha256Batch, sha256Hex, type MerkleTree } from '../utils/MerkleTree.js';
+import { StatementCache } from '../utils/StatementCache.js';
 
 /**
  * Configuration for ExplainableRecall
@@ -32,6 +38,30 @@ export interface ExplainableRecallConfig {
   ENABLE_GRAPH_ROPE?: boolean;
   /** GraphRoPE configuration */
   graphRoPEConfig?: Partial<GraphRoPEConfig>;
+  /**
+   * Issue certificates from a background queue; createCertificate returns a
+   * pending certificate with its final id (default: false)
+   */
+  deferCertificates?: boolean;
+  /** Certificates issued per background batch (default: 64) */
+  certificateBatchSize?: number;
+  /** Merkle trees kept for re-verification and extension (default: 256) */
+  merkleCacheSize?: number;
+}
+
+export interface CertificateRequest {
+  queryId: string;
+  queryText: string;
+  chunks: Array<{ id: string; type: string; content: string; relevance: number }>;
+  requirements: string[]; // Query requirements
+  accessLevel?: string;
+  hopDistances?: number[][]; // Optional hop distances for GraphRoPE
+}
+
+interface CertificateJob {
+  request: CertificateRequest;
+  certificate: RecallCertificate;
+  startTime: number;
 }
 
 export interface RecallCertificate {
@@ -60,6 +90,9 @@ export interface RecallCertificate {
 
   latencyMs?: number;
   metadata?: Record<string, any>;
+
+  /** Queued for issuance; Merkle fields are empty until flushed */
+  pending?: boolean;
 }
 
 export interface MerkleProof {
@@ -91,6 +124,13 @@ export class ExplainableRecall {
   private attentionService?: AttentionService;
   private embedder?: EmbeddingService;
   private config: ExplainableRecallConfig;
+  private merkleCache: MerkleTreeCache;
+  private statements: StatementCache;
+
+  // Deferred issuance queue, in arrival order
+  private queue: CertificateJob[] = [];
+  private queuedIds = new Set<string>();
+  private drainScheduled = false;
 
   /**
    * Constructor supports both v1 (legacy) and v2 (with GraphRoPE) modes
@@ -107,8 +147,13 @@ export class ExplainableRecall {
     this.embedder = embedder;
     this.config = {
       ENABLE_GRAPH_ROPE: false,
+      deferCertificates: false,
+      certificateBatchSize: 64,
+      merkleCacheSize: 256,
       ...config,
     };
+    this.merkleCache = new MerkleTreeCache(this.config.merkleCacheSize);
+    this.statements = StatementCache.for(db);
 
     // Initialize AttentionService if GraphRoPE enabled
     if (embedder && this.config.ENABLE_GRAPH_ROPE) {
@@ -126,90 +171,51 @@ export class ExplainableRecall {
    *
    * v2: Uses GraphRoPE if enabled for hop-distance-aware justification scoring
    * v1: Falls back to standard relevance-based justification
+   *
+   * With `defer` (or config.deferCertificates) the certificate is queued and
+   * returned as pending; provenance, Merkle proofs and storage happen in a
+   * background batch. Reads of a queued certificate issue it first.
    */
-  async createCertificate(params: {
-    queryId: string;
-    queryText: string;
-    chunks: Array<{ id: string; type: string; content: string; relevance: number }>;
-    requirements: string[]; // Query requirements
-    accessLevel?: string;
-    hopDistances?: number[][]; // Optional hop distances for GraphRoPE
-  }): Promise<RecallCertificate> {
-    const { queryId, queryText, chunks, requirements, accessLevel = 'internal' } = params;
-
+  async createCertificate(
+    params: CertificateRequest,
+    options: { defer?: boolean } = {}
+  ): Promise<RecallCertificate> {
     const startTime = Date.now();
+    const certificate = this.draftCertificate(params);
+    const job: CertificateJob = { request: params, certificate, startTime };
+
+    if (options.defer ?? this.config.deferCertificates) {
+      this.queue.push(job);
+      this.queuedIds.add(certificate.id);
+      this.scheduleDrain();
+      return { ...certificate, pending: true };
+    }
 
-    // 1. Compute minimal hitting set
-    const minimalWhy = this.computeMinimalHittingSet(chunks, requirements);
-
-    // 2. Calculate metrics
-    const redundancyRatio = chunks.length / minimalWhy.length;
-    const completenessScore = this.calculateCompleteness(minimalWhy, requirements);
-
-    // 3. Build provenance chain
-    const sourceHashes = chunks.map(chunk =>
-      this.getOrCreateProvenance(chunk.type, parseInt(chunk.id))
-    );
-
-    const merkleTree = this.buildMerkleTree(sourceHashes);
-    const merkleRoot = merkleTree.root;
-
-    // 4. Generate chunk metadata first (needed for certificate ID)
-    const chunkIds = chunks.map(c => c.id);
-    const chunkTypes = chunks.map(c => c.type);
-
-    // 5. Create certificate ID
-    const certificateId = this.generateCertificateId(queryId, chunkIds);
-
-    // 6. Generate proof chain for each chunk
-    const proofChain = chunks.map((chunk, idx) =>
-      this.getMerkleProof(merkleTree, idx)
-    ).flat();
-
-    // 7. Store certificate
-    this.db.prepare(`
-      INSERT INTO recall_certificates (
-        id, query_id, query_text, chunk_ids, chunk_types,
-        minimal_why, redundancy_ratio, completeness_score,
-        merkle_root, source_hashes, proof_chain,
-        access_level, latency_ms
-      ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    `).run(
-      certificateId,
-      queryId,
-      queryText,
-      JSON.stringify(chunkIds),
-      JSON.stringify(chunkTypes),
-      JSON.stringify(minimalWhy),
-      redundancyRatio,
-      completenessScore,
-      merkleRoot,
-      JSON.stringify(sourceHashes),
-      JSON.stringify(proofChain),
-      accessLevel,
-      Date.now() - startTime
-    );
+    this.issueBatch([job]);
+    return certificate;
+  }
 
-    // 7. Store justification paths
-    this.storeJustificationPaths(certificateId, chunks, minimalWhy, requirements);
+  /**
+   * Issue every queued certificate now
+   *
+   * @returns Number of certificates issued
+   */
+  async flushCertificates(): Promise<number> {
+    return this.drainCertificates();
+  }
 
-    const certificate: RecallCertificate = {
-      id: certificateId,
-      queryId,
-      queryText,
-      chunkIds,
-      chunkTypes,
-      minimalWhy,
-      redundancyRatio,
-      completenessScore,
-      merkleRoot,
-      sourceHashes,
-      proofChain,
-      accessLevel: accessLevel as any,
-      latencyMs: Date.now() - startTime
-    };
+  /**
+   * Number of certificates waiting in the background queue
+   */
+  get pendingCertificates(): number {
+    return this.queue.length;
+  }
 
-    return certificate;
+  /**
+   * Merkle tree cache hits, prefix extensions and full builds
+   */
+  getMerkleCacheStats() {
+    return this.merkleCache.getStats();
   }
 
   /**
@@ -219,9 +225,11 @@ export class ExplainableRecall {
     valid: boolean;
     issues: string[];
   } {
-    const cert = this.db.prepare(
-      'SELECT * FROM recall_certificates WHERE id = ?'
-    ).get(certificateId) as any;
+    this.ensureIssued(certificateId);
+    const cert = this.statements.get(
+      'SELECT * FROM recall_certificates WHERE id = ?',
+      [certificateId]
+    ) as any;
 
     if (!cert) {
       return { valid: false, issues: ['Certificate not found'] };
@@ -231,7 +239,7 @@ export class ExplainableRecall {
 
     // 1. Verify Merkle root
     const sourceHashes = JSON.parse(cert.source_hashes);
-    const merkleTree = this.buildMerkleTree(sourceHashes);
+    const merkleTree = this.merkleCache.get(sourceHashes);
 
     if (merkleTree.root !== cert.merkle_root) {
       issues.push('Merkle root mismatch');
@@ -240,10 +248,12 @@ export class ExplainableRecall {
     // 2. Verify chunk hashes still match
     const chunkIds = JSON.parse(cert.chunk_ids);
     const chunkTypes = JSON.parse(cert.chunk_types);
+    const currentHashes = sha256Batch(
+      chunkIds.map((id: string, i: number) => this.getContent(chunkTypes[i], parseInt(id)))
+    );
 
     for (let i = 0; i < chunkIds.length; i++) {
-      const currentHash = this.getContentHash(chunkTypes[i], parseInt(chunkIds[i]));
-      if (currentHash !== sourceHashes[i]) {
+      if (currentHashes[i] !== sourceHashes[i]) {
         issues.push(`Chunk ${chunkIds[i]} hash changed`);
       }
     }
@@ -269,6 +279,7 @@ export class ExplainableRecall {
    * Get justification for why a chunk was included
    */
   getJustification(certificateId: string, chunkId: string): JustificationPath | null {
+    this.ensureIssued(certificateId);
     const row = this.db.prepare(`
       SELECT * FROM justification_paths
       WHERE certificate_id = ? AND chunk_id = ?
@@ -328,9 +339,11 @@ export class ExplainableRecall {
       edges: Array<{ from: string; to: string; type: string }>;
     };
   } {
-    const certRow = this.db.prepare(
-      'SELECT * FROM recall_certificates WHERE id = ?'
-    ).get(certificateId) as any;
+    this.ensureIssued(certificateId);
+    const certRow = this.statements.get(
+      'SELECT * FROM recall_certificates WHERE id = ?',
+      [certificateId]
+    ) as any;
 
     if (!certRow) {
       throw new Error(`Certificate ${certificateId} not found`);
@@ -427,9 +440,11 @@ export class ExplainableRecall {
       avgNecessity: number;
     };
   } {
-    const certRow = this.db.prepare(
-      'SELECT * FROM recall_certificates WHERE id = ?'
-    ).get(certificateId) as any;
+    this.ensureIssued(certificateId);
+    const certRow = this.statements.get(
+      'SELECT * FROM recall_certificates WHERE id = ?',
+      [certificateId]
+    ) as any;
 
     if (!certRow) {
       throw new Error(`Certificate ${certificateId} not found`);
@@ -562,109 +577,225 @@ export class ExplainableRecall {
   }
 
   /**
-   * Get or create provenance record
+   * Minimal hitting set, metrics and id: the part of a certificate that
+   * needs no hashing of sources
    */
-  private getOrCreateProvenance(sourceType: string, sourceId: number): string {
-    // Check if provenance exists
-    const existing = this.db.prepare(`
-      SELECT content_hash FROM provenance_sources
-      WHERE source_type = ? AND source_id = ?
-    `).get(sourceType, sourceId) as any;
-
-    if (existing) {
-      return existing.content_hash;
-    }
+  private draftCertificate(params: CertificateRequest): RecallCertificate {
+    const { queryId, queryText, chunks, requirements, accessLevel = 'internal' } = params;
 
-    // Create new provenance
-    const contentHash = this.getContentHash(sourceType, sourceId);
+    // 1. Compute minimal hitting set
+    const minimalWhy = this.computeMinimalHittingSet(chunks, requirements);
 
-    this.db.prepare(`
-      INSERT OR IGNORE INTO provenance_sources (source_type, source_id, content_hash, creator)
-      VALUES (?, ?, ?, ?)
-    `).run(sourceType, sourceId, contentHash, 'system');
+    // 2. Calculate metrics
+    const redundancyRatio = chunks.length / minimalWhy.length;
+    const completenessScore = this.calculateCompleteness(minimalWhy, requirements);
 
-    return contentHash;
-  }
+    // 3. Chunk metadata and certificate ID
+    const chunkIds = chunks.map(c => c.id);
+    const chunkTypes = chunks.map(c => c.type);
+    const certificateId = this.generateCertificateId(queryId, chunkIds);
 
-  // Prepare statement ONCE outside loop (better-sqlite3 best practice)
-  private _episodeStmt?: any;
-  private _skillStmt?: any;
-  private _noteStmt?: any;
-  private _factStmt?: any;
+    return {
+      id: certificateId,
+      queryId,
+      queryText,
+      chunkIds,
+      chunkTypes,
+      minimalWhy,
+      redundancyRatio,
+      completenessScore,
+      merkleRoot: '',
+      sourceHashes: [],
+      proofChain: [],
+      accessLevel: accessLevel as any,
+    };
+  }
 
   /**
-   * Get content hash for a memory
+   * Resolve provenance and Merkle proofs for a batch of drafted certificates
+   * and store them, in one transaction. Fills in each job's certificate.
    */
-  private getContentHash(sourceType: string, sourceId: number): string {
-    let content = '';
+  private issueBatch(jobs: CertificateJob[]): void {
+    const run = () => {
+      // 4. Build provenance chain (one lookup per distinct source)
+      const sources = jobs.flatMap(job =>
+        job.request.chunks.map(chunk => ({ type: chunk.type, id: parseInt(chunk.id) }))
+      );
+      const hashes = this.resolveSourceHashes(sources);
+
+      let offset = 0;
+      for (const job of jobs) {
+        const { certificate, request, startTime } = job;
+        const sourceHashes = hashes.slice(offset, offset + request.chunks.length);
+        offset += request.chunks.length;
+
+        // 5. Merkle root and proof chain for each chunk
+        const merkleTree = this.merkleCache.get(sourceHashes);
+        certificate.merkleRoot = merkleTree.root;
+        certificate.sourceHashes = sourceHashes;
+        certificate.proofChain = request.chunks.map((_, idx) =>
+          this.getMerkleProof(merkleTree, idx)
+        ).flat();
+        certificate.latencyMs = Date.now() - startTime;
+
+        // 6. Store certificate
+        this.statements.run(`
+          INSERT INTO recall_certificates (
+            id, query_id, query_text, chunk_ids, chunk_types,
+            minimal_why, redundancy_ratio, completeness_score,
+            merkle_root, source_hashes, proof_chain,
+            access_level, latency_ms
+          ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+        `, [
+          certificate.id,
+          certificate.queryId,
+          certificate.queryText,
+          JSON.stringify(certificate.chunkIds),
+          JSON.stringify(certificate.chunkTypes),
+          JSON.stringify(certificate.minimalWhy),
+          certificate.redundancyRatio,
+          certificate.completenessScore,
+          certificate.merkleRoot,
+          JSON.stringify(sourceHashes),
+          JSON.stringify(certificate.proofChain),
+          certificate.accessLevel,
+          certificate.latencyMs
+        ]);
+
+        // 7. Store justification paths
+        this.storeJustificationPaths(certificate.id, request.chunks, certificate.minimalWhy, request.requirements);
+      }
+    };
 
-    switch (sourceType) {
-      case 'episode':
-        if (!this._episodeStmt) {
-          this._episodeStmt = this.db.prepare('SELECT task, output FROM episodes WHERE id = ?');
-        }
-        const episode = this._episodeStmt.get(sourceId) as any;
-        content = episode ? `${episode.task}:${episode.output}` : '';
-        break;
-      case 'skill':
-        if (!this._skillStmt) {
-          this._skillStmt = this.db.prepare('SELECT name, code FROM skills WHERE id = ?');
-        }
-        const skill = this._skillStmt.get(sourceId) as any;
-        content = skill ? `${skill.name}:${skill.code}` : '';
-        break;
-      case 'note':
-        if (!this._noteStmt) {
-          this._noteStmt = this.db.prepare('SELECT text FROM notes WHERE id = ?');
-        }
-        const note = this._noteStmt.get(sourceId) as any;
-        content = note ? note.text : '';
-        break;
-      case 'fact':
-        if (!this._factStmt) {
-          this._factStmt = this.db.prepare('SELECT subject, predicate, object FROM facts WHERE id = ?');
+    if (typeof this.db.transaction === 'function') {
+      this.db.transaction(run)();
+    } else {
+      run();
+    }
+  }
+
+  /**
+   * Issue queued certificates in batches, at most `maxBatches` of them; a
+   * failing batch is retried one certificate at a time so one bad request
+   * does not drop the others
+   */
+  private drainCertificates(maxBatches: number = Infinity): number {
+    let issued = 0;
+    const batchSize = Math.max(1, this.config.certificateBatchSize ?? 64);
+
+    for (let batches = 0; batches < maxBatches && this.queue.length > 0; batches++) {
+      const batch = this.queue.splice(0, batchSize);
+      try {
+        this.issueBatch(batch);
+        issued += batch.length;
+      } catch {
+        for (const job of batch) {
+          try {
+            this.issueBatch([job]);
+            issued++;
+          } catch (error) {
+            console.error(`[ExplainableRecall] Failed to issue certificate ${job.certificate.id}:`, error);
+          }
         }
-        const fact = this._factStmt.get(sourceId) as any;
-        content = fact ? `${fact.subject}:${fact.predicate}:${fact.object}` : '';
-        break;
+      } finally {
+        batch.forEach(job => this.queuedIds.delete(job.certificate.id));
+      }
     }
 
-    return crypto.createHash('sha256').update(content).digest('hex');
+    return issued;
   }
 
   /**
-   * Build Merkle tree from hashes
+   * Background drain: one batch per tick, rescheduled while work remains,
+   * so a long queue does not block the event loop
    */
-  private buildMerkleTree(hashes: string[]): { root: string; tree: string[][] } {
-    if (hashes.length === 0) {
-      return { root: '', tree: [[]] };
+  private scheduleDrain(): void {
+    if (this.drainScheduled) return;
+    this.drainScheduled = true;
+    setImmediate(() => {
+      this.drainScheduled = false;
+      this.drainCertificates(1);
+      if (this.queue.length > 0) this.scheduleDrain();
+    });
+  }
+
+  /**
+   * Reads of a still-queued certificate issue the queue first
+   */
+  private ensureIssued(certificateId: string): void {
+    if (this.queuedIds.has(certificateId)) {
+      this.drainCertificates();
     }
+  }
 
-    const tree: string[][] = [hashes];
+  /**
+   * Content hash for each source, from provenance records where they exist;
+   * new sources are hashed in one batch and recorded
+   */
+  private resolveSourceHashes(sources: Array<{ type: string; id: number }>): string[] {
+    const known = new Map<string, string>();
+    const missing = new Map<string, { type: string; id: number }>();
+
+    for (const { type, id } of sources) {
+      const key = `${type}:${id}`;
+      if (known.has(key) || missing.has(key)) continue;
+
+      const existing = this.statements.get(`
+        SELECT content_hash FROM provenance_sources
+        WHERE source_type = ? AND source_id = ?
+      `, [type, id]) as any;
+
+      if (existing) {
+        known.set(key, existing.content_hash);
+      } else {
+        missing.set(key, { type, id });
+      }
+    }
 
-    while (tree[tree.length - 1].length > 1) {
-      const level = tree[tree.length - 1];
-      const nextLevel: string[] = [];
+    // Create new provenance
+    const entries = [...missing];
+    const contentHashes = sha256Batch(entries.map(([, m]) => this.getContent(m.type, m.id)));
+    entries.forEach(([key, m], i) => {
+      this.statements.run(`
+        INSERT OR IGNORE INTO provenance_sources (source_type, source_id, content_hash, creator)
+        VALUES (?, ?, ?, ?)
+      `, [m.type, m.id, contentHashes[i], 'system']);
+      known.set(key, contentHashes[i]);
+    });
 
-      for (let i = 0; i < level.length; i += 2) {
-        if (i + 1 < level.length) {
-          const combined = level[i] + level[i + 1];
-          nextLevel.push(crypto.createHash('sha256').update(combined).digest('hex'));
-        } else {
-          nextLevel.push(level[i]);
-        }
-      }
+    return sources.map(({ type, id }) => known.get(`${type}:${id}`)!);
+  }
 
-      tree.push(nextLevel);
+  /**
+   * Get content of a memory, as hashed for provenance
+   */
+  private getContent(sourceType: string, sourceId: number): string {
+    switch (sourceType) {
+      case 'episode': {
+        const episode = this.statements.get('SELECT task, output FROM episodes WHERE id = ?', [sourceId]) as any;
+        return episode ? `${episode.task}:${episode.output}` : '';
+      }
+      case 'skill': {
+        const skill = this.statements.get('SELECT name, code FROM skills WHERE id = ?', [sourceId]) as any;
+        return skill ? `${skill.name}:${skill.code}` : '';
+      }
+      case 'note': {
+        const note = this.statements.get('SELECT text FROM notes WHERE id = ?', [sourceId]) as any;
+        return note ? note.text : '';
+      }
+      case 'fact': {
+        const fact = this.statements.get('SELECT subject, predicate, object FROM facts WHERE id = ?', [sourceId]) as any;
+        return fact ? `${fact.subject}:${fact.predicate}:${fact.object}` : '';
+      }
+      default:
+        return '';
     }
-
-    return { root: tree[tree.length - 1][0], tree };
   }
 
   /**
    * Get Merkle proof for a leaf
    */
-  private getMerkleProof(merkleTree: { tree: string[][] }, leafIndex: number): MerkleProof[] {
+  private getMerkleProof(merkleTree: MerkleTree, leafIndex: number): MerkleProof[] {
     const proof: MerkleProof[] = [];
     let index = leafIndex;
 
@@ -691,7 +822,7 @@ export class ExplainableRecall {
    */
   private generateCertificateId(queryId: string, chunkIds: string[]): string {
     const data = `${queryId}:${chunkIds.join(',')}:${Date.now()}`;
-    return crypto.createHash('sha256').update(data).digest('hex');
+    return sha256Hex(data);
   }
 
   /**
@@ -703,7 +834,7 @@ export class ExplainableRecall {
     minimalWhy: string[],
     requirements: string[]
   ): void {
-    const stmt = this.db.prepare(`
+    const stmt = this.statements.prepare(`
       INSERT INTO justification_paths (
         certificate_id, chunk_id, chunk_type, reason, necessity_score, path_elements
       ) VALUES (?, ?, ?, ?, ?, ?)
@@ -8,17 +8,41 @@
  * - HNSW indexing for sub-millisecond search
  * - Automatic index building and management
  * - Configurable M and efConstruction parameters
- * - Persistent index storage
+ * - Persistent index storage (single checksummed file, appended deltas)
  * - Graceful fallback to brute-force
  * - Multi-distance metric support (cosine, euclidean, ip)
+ * - Optional search workers serving queries from read-only replicas
+ * - Deletes tombstone points in place; labels are reused and dead points are
+ *   compacted away in the background instead of rebuilding from the table
  */
 
 import hnswlibNode from 'hnswlib-node';
 import * as fs from 'fs';
 import * as path from 'path';
+import { blobToFloat32 } from '../utils/vector-kernels.js';
+import { LabelBitset } from '../utils/LabelBitset.js';
+import { searchKnnFiltered } from '../utils/filtered-search.js';
+import { HnswSearchPool } from '../utils/HnswSearchPool.js';
+import { recordLatency } from '../observability/latency.js';
+import {
+  isIndexFile,
+  readIndexFile,
+  writeIndexFile,
+  appendIndexDelta,
+  type IndexDelta,
+} from '../utils/IndexFile.js';
+import {
+  compactHnswIndex,
+  replayCompactionLog,
+  type CompactionLogEntry,
+} from '../utils/hnsw-compaction.js';
+import { MetadataFilter, type MetadataFilters } from './MetadataFilter.js';
 
 const { HierarchicalNSW } = hnswlibNode as any;
 
+/** saveIndex() rewrites the base once appended changes exceed this share of it */
+const DELTA_COMPACT_RATIO = 0.25;
+
 // Database type from db-fallback
 type Database = any;
 
@@ -49,6 +73,32 @@ export interface HNSWConfig {
 
   /** Rebuild index threshold (rebuild when updates exceed this percentage) */
   rebuildThreshold: number;
+
+  /** Rows fetched per page during a streaming rebuild (default: 1000) */
+  rebuildBatchSize: number;
+
+  /** Worker threads serving search() from index replicas (default: 0 = inline) */
+  searchWorkers: number;
+
+  /** Max delay before replicas pick up writes, in ms (default: 1000) */
+  searchRefreshMs: number;
+
+  /** Compact once tombstones exceed this share of the graph (default: 0.2, 0 disables) */
+  compactionThreshold: number;
+
+  /** Share of one core a background compaction may use (default: 0.25) */
+  compactionCpuShare: number;
+}
+
+export interface HNSWBuildOptions {
+  /**
+   * Page through the table and build into a shadow index while the current
+   * index keeps serving search(). The live index is swapped in at the end.
+   */
+  streaming?: boolean;
+
+  /** Rows per page for streaming builds (defaults to config.rebuildBatchSize) */
+  batchSize?: number;
 }
 
 export interface HNSWSearchResult {
@@ -73,6 +123,8 @@ export interface HNSWStats {
   avgSearchTimeMs: number;
 }
 
+export { blobToFloat32 };
+
 export class HNSWIndex {
   private db: Database;
   private config: HNSWConfig;
@@ -88,6 +140,26 @@ export class HNSWIndex {
   private lastBuildTime: number | null = null;
   private lastSearchTime: number | null = null;
 
+  // Streaming rebuild state: the latest write per id (null = removed) that
+  // landed while a shadow build is running
+  private rebuilding: boolean = false;
+  private pendingWrites: Map<number, Float32Array | null> = new Map();
+
+  // Bumped on every index change; search replicas are used only when current
+  private generation: number = 0;
+  private searchPool: HnswSearchPool<number> | null = null;
+
+  // Last persisted file and changes since, appended by the next saveIndex()
+  private persisted: { length: number; baseCount: number; deltaOps: number } | null = null;
+  private journal: IndexDelta[] = [];
+
+  // Removed points stay in the graph as tombstones until compaction; their
+  // labels are handed out again by the next inserts
+  private freeLabels: Set<number> = new Set();
+  private tombstoned: Set<number> = new Set();
+  private compactionLog: CompactionLogEntry[] | null = null;
+  private compactionTimer: ReturnType<typeof setTimeout> | null = null;
+
   constructor(db: Database, config?: Partial<HNSWConfig>) {
     this.db = db;
     this.config = {
@@ -99,6 +171,11 @@ export class HNSWIndex {
       maxElements: 100000,
       persistIndex: true,
       rebuildThreshold: 0.1, // Rebuild after 10% updates
+      rebuildBatchSize: 1000,
+      searchWorkers: 0,
+      searchRefreshMs: 1000,
+      compactionThreshold: 0.2,
+      compactionCpuShare: 0.25,
       ...config,
     };
 
@@ -111,7 +188,14 @@ export class HNSWIndex {
   /**
    * Build HNSW index from database vectors
    */
-  async buildIndex(tableName: string = 'pattern_embeddings'): Promise<void> {
+  async buildIndex(
+    tableName: string = 'pattern_embeddings',
+    options?: HNSWBuildOptions
+  ): Promise<void> {
+    if (options?.streaming) {
+      return this.buildIndexStreaming(tableName, options.batchSize ?? this.config.rebuildBatchSize);
+    }
+
     const start = Date.now();
     console.log(`[HNSWIndex] Building HNSW index from ${tableName}...`);
 
@@ -143,21 +227,19 @@ export class HNSWIndex {
       this.idToLabel.clear();
       this.labelToId.clear();
       this.nextLabel = 0;
+      this.freeLabels.clear();
+      this.tombstoned.clear();
 
       // Add vectors to index
       console.log(`[HNSWIndex] Adding ${rows.length} vectors to index...`);
 
       for (const row of rows) {
         const id = row.id;
-        const embedding = new Float32Array(
-          (row.embedding as Buffer).buffer,
-          (row.embedding as Buffer).byteOffset,
-          (row.embedding as Buffer).byteLength / 4
-        );
+        const embedding = blobToFloat32(row.embedding as Buffer);
 
-        // Add to index with label (convert Float32Array to number[])
+        // Add to index with label (hnswlib-node accepts Float32Array directly)
         const label = this.nextLabel++;
-        this.index.addPoint(Array.from(embedding), label);
+        this.index.addPoint(embedding, label);
 
         // Store mappings
         this.idToLabel.set(id, label);
@@ -166,6 +248,8 @@ export class HNSWIndex {
       }
 
       this.indexBuilt = true;
+      this.generation++;
+      this.persisted = null; // New graph: next save writes a fresh base
       this.updatesSinceLastBuild = 0;
       this.lastBuildTime = Date.now();
 
@@ -187,6 +271,137 @@ export class HNSWIndex {
     }
   }
 
+  /**
+   * Rebuild the index by paging through the table in fixed-size batches
+   *
+   * Rows are read with keyset pagination on pattern_id, so at most one page of
+   * BLOBs is resident at a time and no vector copies are kept in vectorCache
+   * (hnswlib owns its own copy). Each page is fully consumed before yielding to
+   * the event loop, which keeps the connection free for concurrent queries
+   * while the current index continues to serve search(). Adds and removals
+   * arriving mid-build are journaled and replayed onto the shadow index before
+   * it is swapped in.
+   */
+  private async buildIndexStreaming(tableName: string, batchSize: number): Promise<void> {
+    if (this.rebuilding) {
+      throw new Error('Index rebuild already in progress');
+    }
+
+    const start = Date.now();
+    console.log(`[HNSWIndex] Streaming rebuild from ${tableName} (batch size ${batchSize})...`);
+
+    this.rebuilding = true;
+    this.pendingWrites.clear();
+
+    try {
+      const countRow = this.db.prepare(`SELECT COUNT(*) as count FROM ${tableName}`).get() as any;
+      const total = Number(countRow?.count ?? 0);
+
+      if (total === 0) {
+        console.warn('[HNSWIndex] No vectors found in database');
+        return;
+      }
+
+      const shadow = new HierarchicalNSW(this.config.metric, this.config.dimension);
+      shadow.initIndex(
+        Math.max(total, this.config.maxElements),
+        this.config.M,
+        this.config.efConstruction
+      );
+      shadow.setEf(this.config.efSearch);
+
+      const shadowIdToLabel = new Map<number, number>();
+      const shadowLabelToId = new Map<number, number>();
+      let shadowNextLabel = 0;
+
+      const addToShadow = (id: number, embedding: Float32Array) => {
+        if (shadowNextLabel >= shadow.getMaxElements()) {
+          shadow.resizeIndex(shadow.getMaxElements() * 2);
+        }
+        const label = shadowNextLabel++;
+        shadow.addPoint(embedding, label);
+        shadowIdToLabel.set(id, label);
+        shadowLabelToId.set(label, id);
+      };
+
+      const stmt = this.db.prepare(`
+        SELECT pattern_id as id, embedding
+        FROM ${tableName}
+        WHERE pattern_id > ?
+        ORDER BY pattern_id
+        LIMIT ?
+      `);
+
+      let lastId = Number.MIN_SAFE_INTEGER;
+      let added = 0;
+
+      while (true) {
+        let pageRows = 0;
+        const rows = typeof stmt.iterate === 'function'
+          ? stmt.iterate(lastId, batchSize)
+          : stmt.all(lastId, batchSize);
+
+        for (const row of rows as Iterable<any>) {
+          addToShadow(row.id, blobToFloat32(row.embedding as Buffer));
+          lastId = row.id;
+          pageRows++;
+        }
+
+        added += pageRows;
+        if (pageRows < batchSize) break;
+
+        // Yield so search() and other SQL can run between pages
+        await new Promise<void>((resolve) => setImmediate(resolve));
+      }
+
+      // Replay writes that arrived while the shadow index was being built.
+      // Each is an upsert or a removal: the streamed copy of an id may predate
+      // its latest embedding, so it is always replaced.
+      const shadowTombstoned = new Set<number>();
+      for (const [id, embedding] of this.pendingWrites) {
+        const label = shadowIdToLabel.get(id);
+        if (label !== undefined) {
+          shadow.markDelete(label);
+          shadowIdToLabel.delete(id);
+          shadowLabelToId.delete(label);
+          shadowTombstoned.add(label);
+        }
+        if (embedding) {
+          addToShadow(id, embedding);
+        }
+      }
+
+      // Atomic swap: search() sees either the old or the new index, never a mix
+      this.index = shadow;
+      this.idToLabel = shadowIdToLabel;
+      this.labelToId = shadowLabelToId;
+      this.nextLabel = shadowNextLabel;
+      this.freeLabels = new Set(shadowTombstoned);
+      this.tombstoned = shadowTombstoned;
+      this.vectorCache.clear();
+      this.indexBuilt = true;
+      this.generation++;
+      this.persisted = null; // New graph: next save writes a fresh base
+      this.updatesSinceLastBuild = 0;
+      this.lastBuildTime = Date.now();
+
+      const duration = (Date.now() - start) / 1000;
+      console.log(`[HNSWIndex] ✅ Streaming rebuild finished in ${duration.toFixed(2)}s`);
+      console.log(`[HNSWIndex] - Elements: ${shadowLabelToId.size} (${added} streamed)`);
+
+      if (this.config.persistIndex && this.config.indexPath) {
+        await this.saveIndex();
+      }
+    } catch (error) {
+      // The previous index (if any) is left in place and keeps serving
+      console.error('[HNSWIndex] Streaming rebuild failed:', error);
+      throw error;
+    } finally {
+      this.rebuilding = false;
+      this.pendingWrites.clear();
+    }
+  }
+
   /**
    * Search HNSW index for k-nearest neighbors
    */
@@ -195,20 +410,66 @@ export class HNSWIndex {
     k: number,
     options?: {
       threshold?: number;
-      filters?: Record<string, any>;
+      /** MetadataFilter over pattern_embeddings columns, resolved to a pre-filter */
+      filters?: MetadataFilters;
+      /** Restrict results to these pattern ids */
+      allowedIds?: ReadonlySet<number>;
     }
   ): Promise<HNSWSearchResult[]> {
     if (!this.index || !this.indexBuilt) {
       throw new Error('Index not built. Call buildIndex() first.');
     }
 
-    const searchStart = Date.now();
+    const searchStart = performance.now();
 
     try {
-      // Perform HNSW search (convert Float32Array to number[])
-      const result = this.index.searchKnn(Array.from(query), k);
+      // Pre-filter: resolve allowed labels before traversal so selective
+      // filters still return k results instead of post-filtering them away
+      const allowed = this.buildAllowedLabels(options);
+      const count = this.index.getCurrentCount();
+      const pool = this.getSearchPool();
+
+      // Perform HNSW search (Float32Array is passed through without boxing);
+      // a worker replica takes the query off the main thread. A stale one
+      // still answers and triggers a refresh; if a label it returned was
+      // removed or reused since its snapshot, the query is re-run inline.
+      let result;
+      if (pool && count > 0 && !pool.isFresh(this.generation)) {
+        pool.scheduleRefresh(() =>
+          this.index && this.indexBuilt
+            ? {
+                index: this.index,
+                generation: this.generation,
+                ef: this.config.efSearch,
+                labels: new Map(this.labelToId),
+              }
+            : null
+        );
+      }
+      if (pool && count > 0 && pool.canServe()) {
+        const replica = await pool.search(query, k, {
+          ef: this.config.efSearch,
+          allowed: allowed?.toWords(),
+          maxMatches: allowed?.count,
+        });
+        const current = replica?.ids.every(
+          (id, i) => id !== undefined && this.labelToId.get(replica.neighbors[i]) === id
+        );
+        if (current && this.index) result = replica!;
+      }
+      if (!result) {
+        result = allowed
+          ? searchKnnFiltered(this.index, query, k, allowed.toPredicate(), {
+              baseEf: this.config.efSearch,
+              maxMatches: allowed.count,
+            })
+          : count === 0
+            ? { neighbors: [], distances: [] }
+            : this.index.searchKnn(query, Math.min(k, count));
+      }
 
-      const searchTime = Date.now() - searchStart;
+      const searchTime = performance.now() - searchStart;
+      recordLatency('hnsw.search', allowed ? 'filtered' : 'search', searchTime);
       this.lastSearchTime = searchTime;
       this.totalSearches++;
       this.totalSearchTime += searchTime;
@@ -241,11 +502,6 @@ export class HNSWIndex {
         });
       }
 
-      // Apply filters if specified (post-filtering)
-      if (options?.filters) {
-        return this.applyFilters(results, options.filters);
-      }
-
       return results;
     } catch (error) {
       console.error('[HNSWIndex] Search failed:', error);
@@ -261,19 +517,113 @@ export class HNSWIndex {
       throw new Error('Index not built. Call buildIndex() first.');
     }
 
-    const label = this.nextLabel++;
-    this.index.addPoint(Array.from(embedding), label);
+    const label = this.allocateLabel();
+    this.addToGraph(label, embedding);
 
     this.idToLabel.set(id, label);
     this.labelToId.set(label, id);
     this.vectorCache.set(id, embedding);
+    this.journalAdd(id, embedding);
+    this.recordChange({ op: 'add', id: String(id), label, vector: embedding });
 
+    this.generation++;
     this.updatesSinceLastBuild++;
+    this.checkRebuildThreshold();
+  }
+
+  /**
+   * Add many vectors from one contiguous row-major buffer
+   *
+   * `vectors` holds `ids.length * dimension` floats. Each row is handed to
+   * hnswlib as a subarray view, so no per-vector copy or number[] boxing
+   * happens. The buffer must stay unmodified while the rows are cached.
+   */
+  addPoints(ids: ArrayLike<number>, vectors: Float32Array): void {
+    if (!this.index || !this.indexBuilt) {
+      throw new Error('Index not built. Call buildIndex() first.');
+    }
+
+    const dim = this.config.dimension;
+    if (vectors.length !== ids.length * dim) {
+      throw new Error(
+        `Buffer length ${vectors.length} does not match ${ids.length} vectors of dimension ${dim}`
+      );
+    }
+
+    this.ensureCapacity(this.index.getCurrentCount() + Math.max(0, ids.length - this.freeLabels.size));
+
+    for (let i = 0; i < ids.length; i++) {
+      const id = ids[i];
+      const row = vectors.subarray(i * dim, (i + 1) * dim);
+      const label = this.allocateLabel();
+      this.addToGraph(label, row);
+
+      this.idToLabel.set(id, label);
+      this.labelToId.set(label, id);
+      this.vectorCache.set(id, row);
+      this.journalAdd(id, row);
+      this.recordChange({ op: 'add', id: String(id), label, vector: row });
+    }
+
+    this.generation++;
+    this.updatesSinceLastBuild += ids.length;
+    this.checkRebuildThreshold();
+  }
+
+  /**
+   * Record an insert so an in-flight streaming rebuild can replay it
+   */
+  private journalAdd(id: number, embedding: Float32Array): void {
+    if (this.rebuilding) {
+      this.pendingWrites.set(id, embedding);
+    }
+  }
+
+  /**
+   * Next label for an insert, preferring one freed by a remove
+   */
+  private allocateLabel(): number {
+    const free = this.freeLabels.values().next();
+    if (!free.done) {
+      this.freeLabels.delete(free.value);
+      return free.value;
+    }
+    return this.nextLabel++;
+  }
+
+  /**
+   * Add a point under `label`. Re-adding a tombstoned label un-deletes it and
+   * updates it in place (hnswlib repairs its neighbour lists), so the slot is
+   * reused without growing the graph.
+   */
+  private addToGraph(label: number, embedding: Float32Array): void {
+    if (!this.tombstoned.delete(label)) {
+      this.ensureCapacity(this.index.getCurrentCount() + 1);
+    }
+    this.index.addPoint(embedding, label);
+    this.compactionLog?.push({ op: 'add', label, vector: embedding });
+  }
+
+  /**
+   * Grow the underlying hnswlib index if it cannot hold `required` points
+   */
+  private ensureCapacity(required: number): void {
+    const max = this.index.getMaxElements();
+    if (required > max) {
+      this.index.resizeIndex(Math.max(required, max * 2));
+    }
+  }
+
+  /**
+   * Log when incremental updates cross the rebuild threshold
+   */
+  private checkRebuildThreshold(): void {
+    if (this.config.compactionThreshold > 0) return; // Tombstones are compacted instead
 
-    // Check if rebuild is needed
     const totalElements = this.labelToId.size;
-    const updatePercentage = this.updatesSinceLastBuild / totalElements;
+    if (totalElements === 0) return;
 
+    const updatePercentage = this.updatesSinceLastBuild / totalElements;
     if (updatePercentage > this.config.rebuildThreshold) {
       console.log(`[HNSWIndex] Rebuild threshold reached (${(updatePercentage * 100).toFixed(1)}%)`);
     }
@@ -293,52 +643,154 @@ export class HNSWIndex {
       return;
     }
 
-    // Note: hnswlib doesn't support deletion, so we mark for rebuild
+    this.markRemoved(id, label);
+
+    if (this.rebuilding) {
+      this.pendingWrites.set(id, null);
+    }
+
+    this.recordChange({ op: 'remove', id: String(id) });
+    this.generation++;
+    this.updatesSinceLastBuild++;
+    this.maybeScheduleCompaction();
+  }
+
+  /**
+   * Tombstone `label` in the graph and free it for reuse
+   */
+  private markRemoved(id: number, label: number): void {
+    this.index.markDelete(label);
+    this.tombstoned.add(label);
+    this.freeLabels.add(label);
+    this.compactionLog?.push({ op: 'remove', label });
+
     this.idToLabel.delete(id);
     this.labelToId.delete(label);
     this.vectorCache.delete(id);
+  }
 
-    this.updatesSinceLastBuild++;
+  /**
+   * Start a background compaction once tombstones pass compactionThreshold
+   */
+  private maybeScheduleCompaction(): void {
+    const threshold = this.config.compactionThreshold;
+    if (threshold <= 0 || this.compactionLog || this.compactionTimer || this.rebuilding) return;
+
+    const graphCount = this.index.getCurrentCount();
+    if (this.tombstoned.size < Math.max(64, graphCount * threshold)) return;
+
+    this.compactionTimer = setTimeout(() => {
+      this.compactionTimer = null;
+      this.compact().catch((error) => {
+        console.warn('[HNSWIndex] Background compaction failed:', error);
+      });
+    }, 0);
+    this.compactionTimer.unref?.();
+  }
+
+  /**
+   * Copy live points into a fresh graph, dropping tombstones
+   *
+   * Runs in time slices limited to compactionCpuShare of one core while the
+   * current graph keeps serving searches and writes; writes made meanwhile
+   * are replayed before the swap. Labels are preserved, so the id maps and
+   * the persisted journal stay valid.
+   *
+   * @returns false if there was nothing to compact or the index changed underneath
+   */
+  async compact(): Promise<boolean> {
+    if (!this.index || !this.indexBuilt || this.compactionLog || this.rebuilding || this.tombstoned.size === 0) {
+      return false;
+    }
+
+    const source = this.index;
+    const dropped = this.tombstoned.size;
+    const start = Date.now();
+    this.compactionLog = [];
+
+    try {
+      const target = await compactHnswIndex(source, Array.from(this.labelToId.keys()), {
+        createIndex: (capacity) => {
+          const index = new HierarchicalNSW(this.config.metric, this.config.dimension);
+          index.initIndex(Math.max(capacity, this.config.maxElements), this.config.M, this.config.efConstruction);
+          index.setEf(this.config.efSearch);
+          return index;
+        },
+        cpuShare: this.config.compactionCpuShare,
+        shouldAbort: () => this.index !== source || this.rebuilding,
+      });
+      if (!target || this.index !== source || this.rebuilding) return false;
+
+      this.tombstoned = replayCompactionLog(target, this.compactionLog);
+      this.index = target;
+      this.generation++;
+      console.log(
+        `[HNSWIndex] Compacted ${dropped} tombstones in ${Date.now() - start}ms ` +
+          `(${this.labelToId.size} elements)`
+      );
+      return true;
+    } finally {
+      this.compactionLog = null;
+    }
   }
 
   /**
    * Check if index needs rebuilding
+   *
+   * Removes are handled by tombstones and compaction, so this is only true
+   * before the first build, or when compaction is disabled and tombstones exceed
+   * rebuildThreshold.
    */
   needsRebuild(): boolean {
     if (!this.indexBuilt) return true;
+    if (this.config.compactionThreshold > 0) return false;
 
-    const totalElements = this.labelToId.size;
-    if (totalElements === 0) return false;
+    const graphCount = this.index.getCurrentCount();
+    return graphCount > 0 && this.tombstoned.size / graphCount > this.config.rebuildThreshold;
+  }
 
-    const updatePercentage = this.updatesSinceLastBuild / totalElements;
-    return updatePercentage > this.config.rebuildThreshold;
+  /**
+   * Persist pending changes (appended when possible; see saveIndex)
+   */
+  async persist(): Promise<void> {
+    await this.saveIndex();
   }
 
   /**
    * Save index to disk
+   *
+   * Writes graph, id map and config to one file. After a base exists, changes
+   * since the last save are appended; a rebuild or enough appended changes
+   * (DELTA_COMPACT_RATIO) writes a fresh base.
    */
   private async saveIndex(): Promise<void> {
     if (!this.index || !this.config.indexPath) return;
 
     try {
-      const indexDir = path.dirname(this.config.indexPath);
-      if (!fs.existsSync(indexDir)) {
-        fs.mkdirSync(indexDir, { recursive: true });
+      const persisted = this.persisted;
+      if (persisted && persisted.deltaOps + this.journal.length <= persisted.baseCount * DELTA_COMPACT_RATIO) {
+        const length = appendIndexDelta(this.config.indexPath, this.journal, persisted.length);
+        if (length !== null) {
+          persisted.deltaOps += this.journal.length;
+          persisted.length = length;
+          this.journal = [];
+          return;
+        }
       }
 
-      // Save HNSW index
-      this.index.writeIndex(this.config.indexPath);
-
-      // Save mappings
-      const mappingsPath = this.config.indexPath + '.mappings.json';
-      const mappings = {
-        idToLabel: Array.from(this.idToLabel.entries()),
-        labelToId: Array.from(this.labelToId.entries()),
-        nextLabel: this.nextLabel,
-        config: this.config,
-      };
-
-      fs.writeFileSync(mappingsPath, JSON.stringify(mappings, null, 2));
+      const length = writeIndexFile(
+        this.config.indexPath,
+        (graphPath) => this.index.writeIndexSync(graphPath),
+        Array.from(this.idToLabel, ([id, label]): [string, number] => [String(id), label]),
+        {
+          config: this.config,
+          nextLabel: this.nextLabel,
+          freeLabels: Array.from(this.freeLabels),
+          tombstoned: Array.from(this.tombstoned),
+        }
+      );
+      this.persisted = { length, baseCount: this.idToLabel.size, deltaOps: 0 };
+      this.journal = [];
 
       console.log(`[HNSWIndex] Index saved to ${this.config.indexPath}`);
     } catch (error) {
@@ -346,6 +798,7 @@ export class HNSWIndex {
     }
   }
 
+
   /**
    * Load index from disk
    */
@@ -354,6 +807,11 @@ export class HNSWIndex {
       return;
     }
 
+    if (isIndexFile(this.config.indexPath)) {
+      this.loadIndexFile(this.config.indexPath);
+      return;
+    }
+
     try {
       console.log(`[HNSWIndex] Loading index from ${this.config.indexPath}...`);
 
@@ -371,8 +829,12 @@ export class HNSWIndex {
         this.labelToId = new Map(mappingsData.labelToId);
         this.nextLabel = mappingsData.nextLabel;
       }
+      this.freeLabels.clear();
+      this.tombstoned.clear();
 
       this.indexBuilt = true;
+      this.generation++;
+      this.persisted = null; // New graph: next save writes a fresh base
       console.log(`[HNSWIndex] ✅ Index loaded successfully (${this.labelToId.size} elements)`);
     } catch (error) {
       console.warn('[HNSWIndex] Failed to load index:', error);
@@ -406,39 +868,49 @@ export class HNSWIndex {
   }
 
   /**
-   * Apply post-filtering to search results
+   * Resolve filters and allowed ids into a label bitset
+   *
+   * Filters are evaluated in SQLite against pattern_embeddings, where
+   * createFilterIndex() secondary indexes can serve them, fetching ids only.
    */
-  private applyFilters(
-    results: HNSWSearchResult[],
-    filters: Record<string, any>
-  ): HNSWSearchResult[] {
-    // Build WHERE clause for filters
-    const conditions: string[] = [];
-    const params: any[] = [];
-
-    Object.entries(filters).forEach(([key, value]) => {
-      conditions.push(`${key} = ?`);
-      params.push(value);
-    });
-
-    const whereClause = conditions.join(' AND ');
+  private buildAllowedLabels(options?: {
+    filters?: MetadataFilters;
+    allowedIds?: ReadonlySet<number>;
+  }): LabelBitset | null {
+    const hasFilters = !!options?.filters && Object.keys(options.filters).length > 0;
+    if (!hasFilters && !options?.allowedIds) {
+      return null;
+    }
 
-    // Filter results by querying database
-    const filtered: HNSWSearchResult[] = [];
+    let ids: Iterable<number> = options?.allowedIds ?? [];
+    if (hasFilters) {
+      const { where, params } = MetadataFilter.toSQL(options!.filters!);
+      const rows = this.db.prepare(`
+        SELECT pattern_id as id FROM pattern_embeddings
+        WHERE ${where}
+      `).all(...params) as any[];
 
-    for (const result of results) {
-      const stmt = this.db.prepare(`
-        SELECT 1 FROM pattern_embeddings
-        WHERE pattern_id = ? AND ${whereClause}
-      `);
+      const allowedIds = options?.allowedIds;
+      ids = rows.map((row) => row.id).filter((id) => !allowedIds || allowedIds.has(id));
+    }
 
-      const matches = stmt.get(result.id, ...params);
-      if (matches) {
-        filtered.push(result);
+    const bitset = new LabelBitset(this.nextLabel);
+    for (const id of ids) {
+      const label = this.idToLabel.get(id);
+      if (label !== undefined) {
+        bitset.add(label);
       }
     }
+    return bitset;
+  }
 
-    return filtered;
+  /**
+   * Create a secondary index serving filters on `field`
+   *
+   * Accepts plain columns or `metadata.<path>` (expression index on json_extract).
+   */
+  createFilterIndex(field: string, tableName: string = 'pattern_embeddings'): void {
+    this.db.exec(MetadataFilter.indexSQL(tableName, field));
   }
 
   /**
@@ -476,20 +948,125 @@ export class HNSWIndex {
    * Clear index and free memory
    */
   clear(): void {
+    this.searchPool?.close().catch(() => {});
+    this.searchPool = null;
+    this.generation++;
     this.index = null;
     this.vectorCache.clear();
     this.idToLabel.clear();
     this.labelToId.clear();
     this.nextLabel = 0;
+    this.freeLabels.clear();
+    this.tombstoned.clear();
+    if (this.compactionTimer) clearTimeout(this.compactionTimer);
+    this.compactionTimer = null;
+    this.persisted = null;
+    this.journal = [];
     this.indexBuilt = false;
     this.updatesSinceLastBuild = 0;
     console.log('[HNSWIndex] Index cleared');
   }
 
+  /**
+   * Load the single-file format and replay appended deltas
+   */
+  private loadIndexFile(indexPath: string): void {
+    try {
+      console.log(`[HNSWIndex] Loading index from ${indexPath}...`);
+
+      const index = new HierarchicalNSW(this.config.metric, this.config.dimension);
+      const contents = readIndexFile(indexPath, (graphPath) => index.readIndexSync(graphPath));
+      index.setEf(this.config.efSearch);
+
+      this.idToLabel = new Map(contents.ids.map(([id, label]) => [Number(id), label]));
+      this.labelToId = new Map(contents.ids.map(([id, label]) => [label, Number(id)]));
+      this.nextLabel = contents.meta.nextLabel ?? contents.ids.length;
+      this.freeLabels = new Set(contents.meta.freeLabels ?? []);
+      this.tombstoned = new Set(contents.meta.tombstoned ?? []);
+      this.index = index;
+
+      for (const delta of contents.deltas) {
+        const id = Number(delta.id);
+        if (delta.op === 'add') {
+          this.freeLabels.delete(delta.label);
+          this.addToGraph(delta.label, delta.vector);
+          this.idToLabel.set(id, delta.label);
+          this.labelToId.set(delta.label, id);
+          this.nextLabel = Math.max(this.nextLabel, delta.label + 1);
+        } else {
+          const label = this.idToLabel.get(id);
+          if (label !== undefined) {
+            this.markRemoved(id, label);
+          }
+        }
+      }
+
+      this.persisted = {
+        length: contents.length,
+        baseCount: contents.ids.length,
+        deltaOps: contents.deltas.length,
+      };
+      this.journal = [];
+      this.indexBuilt = true;
+      this.generation++;
+      console.log(
+        `[HNSWIndex] ✅ Index loaded successfully (${this.labelToId.size} elements, ` +
+          `${contents.deltas.length} deltas replayed)`
+      );
+    } catch (error) {
+      console.warn('[HNSWIndex] Failed to load index:', error);
+      this.index = null;
+      this.indexBuilt = false;
+    }
+  }
+
+  /**
+   * Journal a change for the next appending saveIndex(); past the compaction
+   * point the journal is dropped and the next save writes a new base
+   */
+  private recordChange(delta: IndexDelta): void {
+    const persisted = this.persisted;
+    if (!persisted) return;
+    if (persisted.deltaOps + this.journal.length >= persisted.baseCount * DELTA_COMPACT_RATIO) {
+      this.persisted = null;
+      this.journal = [];
+      return;
+    }
+    this.journal.push(delta);
+  }
+
+  /**
+   * Lazily start the search worker pool (null when searchWorkers is 0)
+   */
+  private getSearchPool(): HnswSearchPool<number> | null {
+    if (this.searchPool || this.config.searchWorkers <= 0) {
+      return this.searchPool;
+    }
+    try {
+      this.searchPool = new HnswSearchPool<number>({
+        metric: this.config.metric,
+        dimension: this.config.dimension,
+        size: this.config.searchWorkers,
+        refreshDelayMs: this.config.searchRefreshMs,
+      });
+    } catch (error) {
+      console.warn('[HNSWIndex] Search workers unavailable, searching inline:', error);
+      this.config.searchWorkers = 0;
+    }
+    return this.searchPool;
+  }
+
   /**
    * Check if index is built and ready
    */
   isReady(): boolean {
     return this.indexBuilt && this.index !== null;
   }
+
+  /**
+   * Check if a streaming rebuild is currently running
+   */
+  isRebuilding(): boolean {
+    return this.rebuilding;
+  }
 }
@@ -17,11 +17,30 @@
  * - Decision Transformer
  * - Monte Carlo Tree Search (MCTS)
  * - Model-Based RL
+ *
+ * Policies are held per session as dense Float32 tables (PolicyTable) and
+ * saved as versions; training streams experiences into columnar buffers and
+ * runs vectorized mini-batches, on a worker thread for large sessions.
  */
 
 // Database type from db-fallback
 type Database = any;
 import { EmbeddingService } from './EmbeddingService.js';
+import {
+  PolicyTable,
+  trainPolicyEpochs,
+  createPolicyTrainingPool,
+  trainingTransferList,
+  type ExperienceBuffer,
+  type PolicyJSON,
+  type PolicyTrainingJob,
+  type PolicyTrainingResult,
+} from '../utils/policy-training.js';
+
+/** Sessions with at least this many experiences train on a worker thread */
+const TRAIN_WORKER_MIN_EXPERIENCES = 50_000;
+/** Rows read per query when loading experiences */
+const EXPERIENCE_PAGE_SIZE = 10_000;
 
 export interface LearningSession {
   id: string;
@@ -67,10 +86,18 @@ export interface TrainingResult {
   trainingTimeMs: number;
 }
 
+export interface TrainOptions {
+  /** Train on a worker thread (default: when >= 50k experiences) */
+  useWorker?: boolean;
+  /** Shuffle seed, for reproducible runs */
+  seed?: number;
+}
+
 export class LearningSystem {
   private db: Database;
   private embedder: EmbeddingService;
   private activeSessions: Map<string, LearningSession> = new Map();
+  private policies: Map<string, PolicyTable> = new Map();
 
   constructor(db: Database, embedder: EmbeddingService) {
     this.db = db;
@@ -210,6 +237,7 @@ export class LearningSystem {
 
     // Remove from active sessions
     this.activeSessions.delete(sessionId);
+    this.policies.delete(sessionId);
 
     console.log(`✅ Learning session ended: ${sessionId} (duration: ${endTime - session.startTime}ms)`);
   }
@@ -232,7 +260,7 @@ export class LearningSystem {
     const stateEmbedding = await this.getStateEmbedding(sessionId, state);
 
     // Get policy for this session
-    const policy = this.getLatestPolicy(sessionId);
+    const policy = this.getPolicyTable(sessionId);
 
     // Calculate Q-values for all actions
     const actionScores = await this.calculateActionScores(
@@ -304,12 +332,16 @@ export class LearningSystem {
 
   /**
    * Train policy with batch learning
+   *
+   * Predictions keep using the current policy while a worker trains; the
+   * trained values replace it when the run completes.
    */
   async train(
     sessionId: string,
     epochs: number,
     batchSize: number,
-    learningRate: number
+    learningRate: number,
+    options: TrainOptions = {}
   ): Promise<TrainingResult> {
     const session = this.activeSessions.get(sessionId) || this.getSession(sessionId);
 
@@ -320,47 +352,42 @@ export class LearningSystem {
     const startTime = Date.now();
 
     // Get all experiences for this session
-    const experiences = this.db.prepare(`
-      SELECT * FROM learning_experiences
-      WHERE session_id = ?
-      ORDER BY timestamp ASC
-    `).all(sessionId) as any[];
+    const policy = this.getPolicyTable(sessionId);
+    const experiences = this.loadExperienceBuffer(sessionId, policy);
 
-    if (experiences.length === 0) {
+    if (experiences.size === 0) {
       throw new Error(`No training data available for session: ${sessionId}`);
     }
 
-    let totalLoss = 0;
-    let totalReward = 0;
-    let batchCount = 0;
-
-    // Training loop
-    for (let epoch = 0; epoch < epochs; epoch++) {
-      // Shuffle experiences
-      const shuffled = this.shuffleArray([...experiences]);
-
-      // Process in batches
-      for (let i = 0; i < shuffled.length; i += batchSize) {
-        const batch = shuffled.slice(i, i + batchSize);
-
-        // Calculate loss and update policy
-        const batchLoss = await this.trainBatch(session, batch, learningRate);
-        totalLoss += batchLoss;
-        batchCount++;
-
-        // Accumulate rewards
-        totalReward += batch.reduce((sum, exp) => sum + exp.reward, 0);
-      }
+    // The job arrays are transferred to the worker; keep a copy to merge
+    // the trained deltas with feedback that arrives meanwhile
+    const base = policy.trainingArrays();
+    const stride = policy.stride;
+    const size = experiences.size;
+    const job: PolicyTrainingJob = {
+      q: base.q.slice(),
+      visits: base.visits.slice(),
+      stride,
+      actionCount: policy.actions.length,
+      stateIdx: experiences.stateIdx.subarray(0, size),
+      actionIdx: experiences.actionIdx.subarray(0, size),
+      nextStateIdx: experiences.nextStateIdx.subarray(0, size),
+      reward: experiences.reward.subarray(0, size),
+      epochs,
+      batchSize,
+      learningRate,
+      gamma: session.config.discountFactor,
+      bootstrap: session.sessionType !== 'policy-gradient',
+      seed: options.seed ?? (Math.random() * 2 ** 32) >>> 0,
+    };
 
-      // Log progress
-      if ((epoch + 1) % 10 === 0) {
-        console.log(`  Epoch ${epoch + 1}/${epochs} - Loss: ${(totalLoss / batchCount).toFixed(4)}`);
-      }
-    }
+    const useWorker = options.useWorker ?? experiences.size >= TRAIN_WORKER_MIN_EXPERIENCES;
+    const result = useWorker ? await this.trainOnWorker(job) : trainPolicyEpochs(job);
+    policy.applyTraining(result, base, stride);
 
     const trainingTimeMs = Date.now() - startTime;
-    const avgReward = totalReward / (experiences.length * epochs);
-    const finalLoss = totalLoss / batchCount;
+    const avgReward = result.rewardSum / (experiences.size * epochs);
+    const finalLoss = result.lossSum / result.batches;
 
     // Save trained policy
     await this.savePolicy(sessionId);
@@ -368,7 +395,7 @@ export class LearningSystem {
     // Calculate convergence rate
     const convergenceRate = this.calculateConvergenceRate(sessionId);
 
-    console.log(`✅ Training completed: ${epochs} epochs, ${trainingTimeMs}ms`);
+    console.log(`✅ Training completed: ${epochs} epochs, ${result.batches} batches, ${trainingTimeMs}ms`);
 
     return {
       epochsCompleted: epochs,
@@ -432,9 +459,12 @@ export class LearningSystem {
   }
 
   /**
-   * Get latest policy for session
+   * Policy for a session, loaded from its latest version on first use
    */
-  private getLatestPolicy(sessionId: string): any {
+  private getPolicyTable(sessionId: string): PolicyTable {
+    let table = this.policies.get(sessionId);
+    if (table) return table;
+
     const policy = this.db.prepare(`
       SELECT * FROM learning_policies
       WHERE session_id = ?
@@ -442,22 +472,84 @@ export class LearningSystem {
       LIMIT 1
     `).get(sessionId) as any;
 
-    if (!policy) {
-      // Return empty policy
-      return {
-        stateActionPairs: {},
-        qValues: {},
-        visitCounts: {},
-        avgRewards: {},
-      };
-    }
+    table = policy
+      ? PolicyTable.fromJSON({
+          stateActionPairs: JSON.parse(policy.state_action_pairs),
+          qValues: JSON.parse(policy.q_values),
+          visitCounts: JSON.parse(policy.visit_counts),
+          avgRewards: JSON.parse(policy.avg_rewards),
+        })
+      : new PolicyTable();
+    this.policies.set(sessionId, table);
+    return table;
+  }
 
-    return {
-      stateActionPairs: JSON.parse(policy.state_action_pairs),
-      qValues: JSON.parse(policy.q_values),
-      visitCounts: JSON.parse(policy.visit_counts),
-      avgRewards: JSON.parse(policy.avg_rewards),
+  /**
+   * Get latest policy for session
+   */
+  private getLatestPolicy(sessionId: string): PolicyJSON {
+    return this.getPolicyTable(sessionId).toJSON();
+  }
+
+  /**
+   * Read a session's experiences into columnar buffers, a page at a time,
+   * interning states and actions into the policy
+   */
+  private loadExperienceBuffer(sessionId: string, policy: PolicyTable): ExperienceBuffer {
+    const { count } = this.db.prepare(
+      'SELECT COUNT(*) as count FROM learning_experiences WHERE session_id = ?'
+    ).get(sessionId) as any;
+    const size = Number(count);
+    const buffer: ExperienceBuffer = {
+      size: 0,
+      stateIdx: new Int32Array(size),
+      actionIdx: new Int32Array(size),
+      nextStateIdx: new Int32Array(size),
+      reward: new Float32Array(size),
     };
+
+    const page = this.db.prepare(`
+      SELECT id, state, action, reward, next_state FROM learning_experiences
+      WHERE session_id = ? AND id > ?
+      ORDER BY id ASC
+      LIMIT ?
+    `);
+
+    let cursor = 0;
+    let n = 0;
+    while (n < size) {
+      const rows = page.all(sessionId, cursor, EXPERIENCE_PAGE_SIZE) as any[];
+      if (rows.length === 0) break;
+      for (const row of rows) {
+        if (n === size) break;
+        policy.cell(row.state, row.action);
+        buffer.stateIdx[n] = policy.stateIndex(row.state);
+        buffer.actionIdx[n] = policy.actionIndex(row.action);
+        buffer.nextStateIdx[n] = row.next_state ? policy.stateIndex(row.next_state, true) : -1;
+        buffer.reward[n] = row.reward;
+        n++;
+      }
+      cursor = rows[rows.length - 1].id;
+    }
+
+    buffer.size = n;
+    return buffer;
+  }
+
+  private async trainOnWorker(job: PolicyTrainingJob): Promise<PolicyTrainingResult> {
+    let pool;
+    try {
+      pool = createPolicyTrainingPool();
+    } catch (error) {
+      console.warn('[LearningSystem] Training worker unavailable, training on main thread:', error);
+      return trainPolicyEpochs(job);
+    }
+
+    try {
+      return await pool.run(job, trainingTransferList(job));
+    } finally {
+      await pool.close();
+    }
   }
 
   /**
@@ -467,7 +559,7 @@ export class LearningSystem {
     session: LearningSession,
     state: string,
     stateEmbedding: Float32Array,
-    policy: any
+    policy: PolicyTable
   ): Promise<Array<{ action: string; score: number }>> {
     // Get possible actions from past experiences
     const actions = this.db.prepare(`
@@ -488,7 +580,6 @@ export class LearningSystem {
     const scores: Array<{ action: string; score: number }> = [];
 
     for (const action of actions) {
-      const key = `${state}|${action}`;
       let score = 0;
 
       switch (session.sessionType) {
@@ -496,14 +587,14 @@ export class LearningSystem {
         case 'sarsa':
         case 'dqn':
           // Use Q-value from policy
-          score = policy.qValues[key] || 0;
+          score = policy.qValue(state, action);
           break;
 
         case 'policy-gradient':
         case 'actor-critic':
         case 'ppo':
           // Use average reward
-          score = policy.avgRewards[key] || 0;
+          score = policy.avgReward(state, action);
           break;
 
         case 'decision-transformer':
@@ -535,15 +626,8 @@ export class LearningSystem {
    * Update policy incrementally after feedback
    */
   private async updatePolicyIncremental(session: LearningSession, feedback: ActionFeedback): Promise<void> {
-    const policy = this.getLatestPolicy(feedback.sessionId);
-    const key = `${feedback.state}|${feedback.action}`;
-
-    // Initialize if not exists
-    if (!policy.qValues[key]) {
-      policy.qValues[key] = 0;
-      policy.visitCounts[key] = 0;
-      policy.avgRewards[key] = 0;
-    }
+    const policy = this.getPolicyTable(feedback.sessionId);
+    const cell = policy.cell(feedback.state, feedback.action);
 
     const alpha = session.config.learningRate;
     const gamma = session.config.discountFactor;
@@ -551,83 +635,26 @@ export class LearningSystem {
     switch (session.sessionType) {
       case 'q-learning': {
         // Q(s,a) ← Q(s,a) + α[r + γ max Q(s',a') - Q(s,a)]
-        let maxNextQ = 0;
-        if (feedback.nextState) {
-          const nextActions = Object.keys(policy.qValues).filter(k => k.startsWith(feedback.nextState + '|'));
-          maxNextQ = Math.max(...nextActions.map(k => policy.qValues[k]), 0);
-        }
+        const maxNextQ = feedback.nextState ? policy.maxQ(feedback.nextState) : 0;
         const target = feedback.reward + gamma * maxNextQ;
-        policy.qValues[key] += alpha * (target - policy.qValues[key]);
+        policy.q[cell] += alpha * (target - policy.q[cell]);
         break;
       }
 
       case 'sarsa': {
         // SARSA: Q(s,a) ← Q(s,a) + α[r + γ Q(s',a') - Q(s,a)]
         // For incremental update, we approximate with current Q-value
-        const target = feedback.reward + gamma * (policy.qValues[key] || 0);
-        policy.qValues[key] += alpha * (target - policy.qValues[key]);
+        const target = feedback.reward + gamma * policy.q[cell];
+        policy.q[cell] += alpha * (target - policy.q[cell]);
         break;
       }
 
-      case 'policy-gradient':
-      case 'actor-critic':
-      case 'ppo': {
-        // Update average reward
-        policy.visitCounts[key]++;
-        const n = policy.visitCounts[key];
-        policy.avgRewards[key] += (feedback.reward - policy.avgRewards[key]) / n;
-        break;
-      }
-
-      default:
-        // Default: simple average
-        policy.visitCounts[key]++;
-        const n = policy.visitCounts[key];
-        policy.avgRewards[key] += (feedback.reward - policy.avgRewards[key]) / n;
-    }
-  }
-
-  /**
-   * Train batch of experiences
-   */
-  private async trainBatch(
-    session: LearningSession,
-    batch: any[],
-    learningRate: number
-  ): Promise<number> {
-    let totalLoss = 0;
-    const policy = this.getLatestPolicy(session.id);
-
-    for (const exp of batch) {
-      const key = `${exp.state}|${exp.action}`;
-
-      // Initialize if needed
-      if (!policy.qValues[key]) {
-        policy.qValues[key] = 0;
-      }
-
-      // Calculate target based on algorithm
-      let target = exp.reward;
-
-      if (exp.next_state && session.sessionType !== 'policy-gradient') {
-        const nextActions = Object.keys(policy.qValues).filter(k => k.startsWith(exp.next_state + '|'));
-        const maxNextQ = Math.max(...nextActions.map(k => policy.qValues[k]), 0);
-        target += session.config.discountFactor * maxNextQ;
+      default: {
+        // policy-gradient, actor-critic, ppo and others: running average reward
+        const n = policy.recordVisit(cell);
+        policy.avgRewards[cell] += (feedback.reward - policy.avgRewards[cell]) / n;
       }
-
-      // Calculate loss (TD error)
-      const prediction = policy.qValues[key];
-      const loss = Math.pow(target - prediction, 2);
-      totalLoss += loss;
-
-      // Update Q-value
-      policy.qValues[key] += learningRate * (target - prediction);
-
-      // Update counts
-      policy.visitCounts[key] = (policy.visitCounts[key] || 0) + 1;
     }
-
-    return totalLoss / batch.length;
   }
 
   /**
@@ -692,32 +719,20 @@ export class LearningSystem {
   }
 
   // Algorithm-specific scoring methods
-  private calculateTransformerScore(state: string, action: string, policy: any): number {
-    const key = `${state}|${action}`;
-    return policy.avgRewards[key] || 0;
+  private calculateTransformerScore(state: string, action: string, policy: PolicyTable): number {
+    return policy.avgReward(state, action);
   }
 
-  private calculateUCB1(state: string, action: string, policy: any): number {
-    const key = `${state}|${action}`;
-    const q = policy.avgRewards[key] || 0;
-    const n = policy.visitCounts[key] || 1;
-    const N = Object.values(policy.visitCounts).reduce((sum: number, val: any) => sum + val, 0) || 1;
+  private calculateUCB1(state: string, action: string, policy: PolicyTable): number {
+    const q = policy.avgReward(state, action);
+    const n = policy.visitCount(state, action) || 1;
+    const N = policy.totalVisits || 1;
     const exploration = Math.sqrt(2 * Math.log(N) / n);
     return q + exploration;
   }
 
-  private calculateModelScore(state: string, action: string, policy: any): number {
-    const key = `${state}|${action}`;
-    return policy.avgRewards[key] || 0;
-  }
-
-  private shuffleArray<T>(array: T[]): T[] {
-    const result = [...array];
-    for (let i = result.length - 1; i > 0; i--) {
-      const j = Math.floor(Math.random() * (i + 1));
-      [result[i], result[j]] = [result[j], result[i]];
-    }
-    return result;
+  private calculateModelScore(state: string, action: string, policy: PolicyTable): number {
+    return policy.avgReward(state, action);
   }
 
   // ============================================================================
@@ -988,6 +1003,7 @@ export class LearningSystem {
           JSON.stringify(targetPolicy.avgRewards || {}),
           version + 1
         );
+        this.policies.delete(targetSession);
 
         transferred.skills = transferredQValues;
       }
@@ -12,8 +12,17 @@
  * - Q = query
  * - S = already selected documents
  * - λ = balance parameter (0 = max diversity, 1 = max relevance)
+ *
+ * Embeddings are packed into one row-major Float32Array (rows pre-normalized
+ * for cosine) and each candidate keeps a running max similarity to the
+ * selected set. Every round only scores the newly selected row against all
+ * candidates, using the SIMD dot kernel when available, so selection costs
+ * O(k·n·d) instead of O(k²·n·d).
  */
 
+import { SimdDotKernel, dotBatch, l2Norm } from '../utils/vector-kernels.js';
+import { recordLatency } from '../observability/latency.js';
+
 export interface MMROptions {
   lambda?: number;  // Balance between relevance and diversity (default: 0.5)
   k?: number;       // Number of results to return (default: 10)
@@ -22,12 +31,15 @@ export interface MMROptions {
 
 export interface MMRCandidate {
   id: number;
-  embedding: number[];
+  embedding: number[] | Float32Array;
   similarity: number;  // Similarity to query
   [key: string]: any;  // Additional data
 }
 
 export class MMRDiversityRanker {
+  // Shared WASM kernel (null when SIMD is unavailable); created on first use
+  private static kernel: SimdDotKernel | null | undefined;
+
   /**
    * Select diverse results using MMR algorithm
    *
@@ -36,11 +48,11 @@ export class MMRDiversityRanker {
    * @param options - MMR configuration
    * @returns Diverse subset of candidates
    */
-  static selectDiverse(
-    candidates: MMRCandidate[],
-    queryEmbedding: number[],
+  static selectDiverse<T extends MMRCandidate>(
+    candidates: T[],
+    queryEmbedding: ArrayLike<number>,
     options: MMROptions = {}
-  ): MMRCandidate[] {
+  ): T[] {
     const lambda = options.lambda ?? 0.5;
     const k = options.k ?? 10;
     const metric = options.metric ?? 'cosine';
@@ -53,64 +65,119 @@ export class MMRDiversityRanker {
       return candidates;
     }
 
-    // Calculate initial similarities to query
-    const candidatesWithSim = candidates.map(c => ({
-      ...c,
-      similarity: c.similarity ?? this.calculateSimilarity(
+    const start = performance.now();
+    const n = candidates.length;
+    const dim = candidates[0].embedding.length;
+    const { matrix, sqNorms } = this.packEmbeddings(candidates, dim, metric);
+
+    // Relevance to query (computed only where the caller did not supply it)
+    const relevance = new Float64Array(n);
+    for (let i = 0; i < n; i++) {
+      relevance[i] = candidates[i].similarity ?? this.calculateSimilarity(
         queryEmbedding,
-        c.embedding,
+        candidates[i].embedding,
         metric
-      ),
-    }));
+      );
+    }
+
+    // Scan in relevance order so ties resolve to the more relevant candidate
+    const order = Array.from({ length: n }, (_, i) => i).sort((a, b) => relevance[b] - relevance[a]);
 
-    const selected: MMRCandidate[] = [];
-    const remaining = [...candidatesWithSim];
+    const maxSimToSelected = new Float64Array(n).fill(-Infinity);
+    const taken = new Uint8Array(n);
+    const selected: T[] = [];
+
+    const kernel = this.getKernel();
+    kernel?.loadMatrix(matrix, n, dim);
+    const scratch = kernel ? null : new Float32Array(n);
 
     // Select first item (highest relevance)
-    remaining.sort((a, b) => b.similarity - a.similarity);
-    selected.push(remaining.shift()!);
+    let pick = order[0];
+
+    while (true) {
+      taken[pick] = 1;
+      selected.push(candidates[pick]);
+      if (selected.length >= k) break;
+
+      // Fold the new item into each candidate's max similarity to the selected set
+      const row = matrix.subarray(pick * dim, (pick + 1) * dim);
+      const dots = kernel ? kernel.dots(row) : dotBatch(row, matrix, n, dim, scratch!);
+      for (let i = 0; i < n; i++) {
+        if (taken[i]) continue;
+        let sim = dots[i];
+        if (metric === 'euclidean') {
+          sim = 1 / (1 + Math.sqrt(Math.max(0, sqNorms![i] + sqNorms![pick] - 2 * sim)));
+        }
+        if (sim > maxSimToSelected[i]) maxSimToSelected[i] = sim;
+      }
 
-    // Iteratively select items with highest MMR score
-    while (selected.length < k && remaining.length > 0) {
+      // Item with highest MMR score
       let maxMMR = -Infinity;
-      let maxIdx = 0;
-
-      for (let i = 0; i < remaining.length; i++) {
-        const candidate = remaining[i];
-
-        // Calculate max similarity to already-selected items
-        let maxSimToSelected = -Infinity;
-        for (const selectedItem of selected) {
-          const sim = this.calculateSimilarity(
-            candidate.embedding,
-            selectedItem.embedding,
-            metric
-          );
-          maxSimToSelected = Math.max(maxSimToSelected, sim);
+      pick = -1;
+      for (const i of order) {
+        if (taken[i]) continue;
+        const mmrScore = lambda * relevance[i] - (1 - lambda) * maxSimToSelected[i];
+        if (pick < 0 || mmrScore > maxMMR) {
+          maxMMR = mmrScore;
+          pick = i;
         }
+      }
+      if (pick < 0) break;
+    }
+
+    recordLatency('mmr.select', 'rank', performance.now() - start);
+    return selected;
+  }
 
-        // Calculate MMR score
-        const mmrScore = lambda * candidate.similarity - (1 - lambda) * maxSimToSelected;
+  /**
+   * Copy embeddings into one row-major matrix
+   *
+   * Cosine rows are normalized so a dot product is the similarity; euclidean
+   * keeps squared norms to expand |a - b|² from the same dot products.
+   */
+  private static packEmbeddings(
+    candidates: MMRCandidate[],
+    dim: number,
+    metric: 'cosine' | 'euclidean' | 'dot'
+  ): { matrix: Float32Array; sqNorms: Float64Array | null } {
+    const n = candidates.length;
+    const matrix = new Float32Array(n * dim);
+    const sqNorms = metric === 'euclidean' ? new Float64Array(n) : null;
+
+    for (let i = 0; i < n; i++) {
+      const embedding = candidates[i].embedding;
+      if (embedding.length !== dim) {
+        throw new Error(`Vector dimension mismatch: ${embedding.length} vs ${dim}`);
+      }
+      matrix.set(embedding, i * dim);
 
-        if (mmrScore > maxMMR) {
-          maxMMR = mmrScore;
-          maxIdx = i;
+      if (metric === 'cosine') {
+        const norm = l2Norm(matrix, i * dim, dim);
+        if (norm > 0) {
+          for (let j = i * dim; j < (i + 1) * dim; j++) matrix[j] /= norm;
         }
+      } else if (sqNorms) {
+        const norm = l2Norm(matrix, i * dim, dim);
+        sqNorms[i] = norm * norm;
       }
-
-      // Add item with highest MMR score
-      selected.push(remaining.splice(maxIdx, 1)[0]);
     }
 
-    return selected;
+    return { matrix, sqNorms };
+  }
+
+  private static getKernel(): SimdDotKernel | null {
+    if (this.kernel === undefined) {
+      this.kernel = SimdDotKernel.create();
+    }
+    return this.kernel;
   }
 
   /**
    * Calculate similarity between two vectors
    */
   private static calculateSimilarity(
-    vec1: number[],
-    vec2: number[],
+    vec1: ArrayLike<number>,
+    vec2: ArrayLike<number>,
     metric: 'cosine' | 'euclidean' | 'dot'
   ): number {
     if (vec1.length !== vec2.length) {
@@ -46,6 +46,27 @@ export class MetadataFilter {
     return items.filter(item => this.matchesFilters(item, filters));
   }
 
+  /**
+   * Compile filters into a reusable predicate
+   *
+   * Used for pre-filtering during ANN traversal, where the same filter is
+   * evaluated against many candidates.
+   */
+  static compile<T extends FilterableItem>(filters: MetadataFilters): (item: T) => boolean {
+    if (!filters || Object.keys(filters).length === 0) {
+      return () => true;
+    }
+    const entries = Object.entries(filters);
+    return (item: T) => {
+      for (const [field, filter] of entries) {
+        if (!this.matchesFilter(item, field, filter)) {
+          return false;
+        }
+      }
+      return true;
+    };
+  }
+
   /**
    * Check if an item matches all filters
    */
@@ -168,14 +189,9 @@ export class MetadataFilter {
   static toSQL(filters: MetadataFilters, tableName: string = ''): { where: string; params: any[] } {
     const conditions: string[] = [];
     const params: any[] = [];
-    const prefix = tableName ? `${tableName}.` : '';
 
     for (const [field, filter] of Object.entries(filters)) {
-      // For metadata fields, use JSON extraction
-      const isMetadata = field.startsWith('metadata.');
-      const columnRef = isMetadata
-        ? `json_extract(${prefix}metadata, '$.${field.slice(9)}')`
-        : `${prefix}${field}`;
+      const columnRef = this.columnRef(field, tableName);
 
       if (typeof filter !== 'object' || Array.isArray(filter)) {
         // Simple equality
@@ -254,6 +270,30 @@ export class MetadataFilter {
     return { where, params };
   }
 
+  /**
+   * SQL expression for a filter field
+   *
+   * Plain fields map to columns; `metadata.x` maps to json_extract over the
+   * metadata column.
+   */
+  static columnRef(field: string, tableName: string = ''): string {
+    const prefix = tableName ? `${tableName}.` : '';
+    return field.startsWith('metadata.')
+      ? `json_extract(${prefix}metadata, '$.${field.slice(9)}')`
+      : `${prefix}${field}`;
+  }
+
+  /**
+   * DDL for a secondary index that serves filters on `field`
+   *
+   * Metadata paths become expression indexes on json_extract, so the same
+   * expression emitted by toSQL() can use them.
+   */
+  static indexSQL(tableName: string, field: string): string {
+    const safeName = `${tableName}_${field}`.replace(/[^A-Za-z0-9_]/g, '_');
+    return `CREATE INDEX IF NOT EXISTS idx_filter_${safeName} ON ${tableName}(${this.columnRef(field)})`;
+  }
+
   /**
    * Validate filter object
    */
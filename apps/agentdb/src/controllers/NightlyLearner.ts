@@ -16,6 +16,12 @@
  * - Block-wise computation for large episode buffers
  * - Feature flag: ENABLE_FLASH_CONSOLIDATION (default: false)
  * - 100% backward compatible with fallback to standard consolidation
+ *
+ * Runs are incremental: discovery and consolidation keep a per-job
+ * watermark (last processed episode id) in learner_watermarks and only look
+ * at episodes added since. Work is committed in checkpoints of
+ * `checkpointEpisodes` episodes, so an interrupted run resumes where it
+ * stopped instead of starting over.
  */
 
 // Database type from db-fallback
@@ -25,6 +31,10 @@ import { ReflexionMemory } from './ReflexionMemory.js';
 import { SkillLibrary } from './SkillLibrary.js';
 import { EmbeddingService } from './EmbeddingService.js';
 import { AttentionService, type FlashAttentionConfig } from '../services/AttentionService.js';
+import { SimdDotKernel, dotBatch, l2Norm, selectTopK, blobToFloat32 } from '../utils/vector-kernels.js';
+
+/** Episodes before the new ones that consolidation compares them against */
+const CONSOLIDATION_CONTEXT = 1000;
 
 export interface LearnerConfig {
   minSimilarity: number; // Min similarity to consider for causal edge (default: 0.7)
@@ -41,6 +51,11 @@ export interface LearnerConfig {
   ENABLE_FLASH_CONSOLIDATION?: boolean;
   /** FlashAttention configuration */
   flashConfig?: Partial<FlashAttentionConfig>;
+
+  /** Only process episodes added since the last run (default: true) */
+  incremental?: boolean;
+  /** Episodes per checkpoint; the watermark advances after each (default: 500) */
+  checkpointEpisodes?: number;
 }
 
 export interface LearnerReport {
@@ -50,6 +65,8 @@ export interface LearnerReport {
   edgesPruned: number;
   experimentsCompleted: number;
   experimentsCreated: number;
+  /** New episodes scanned for causal edges this run */
+  episodesProcessed?: number;
   avgUplift: number;
   avgConfidence: number;
   recommendations: string[];
@@ -62,6 +79,8 @@ export class NightlyLearner {
   private skillLibrary: SkillLibrary;
   private embedder: EmbeddingService;
   private attentionService?: AttentionService;
+  private episodesProcessed = 0;
+  private static dotKernel: SimdDotKernel | null | undefined;
 
   constructor(
     db: Database,
@@ -83,6 +102,15 @@ export class NightlyLearner {
     this.causalGraph = new CausalMemoryGraph(db);
     this.reflexion = new ReflexionMemory(db, embedder);
     this.skillLibrary = new SkillLibrary(db, embedder);
+    this.skillLibrary.setEpisodeBackend(this.reflexion.getEpisodeBackend());
+
+    this.db.exec(`
+      CREATE TABLE IF NOT EXISTS learner_watermarks (
+        job TEXT PRIMARY KEY,
+        last_episode_id INTEGER NOT NULL,
+        updated_at INTEGER NOT NULL
+      )
+    `);
 
     // Initialize AttentionService if FlashAttention enabled
     if (this.config.ENABLE_FLASH_CONSOLIDATION) {
@@ -118,7 +146,8 @@ export class NightlyLearner {
       // Step 1: Discover new causal edges
       console.log('📊 Discovering causal edges from episode patterns...');
       report.edgesDiscovered = await this.discoverCausalEdges();
-      console.log(`   ✓ Discovered ${report.edgesDiscovered} new edges\n`);
+      report.episodesProcessed = this.episodesProcessed;
+      console.log(`   ✓ Discovered ${report.edgesDiscovered} new edges from ${this.episodesProcessed} new episodes\n`);
 
       // Step 2: Complete running experiments
       console.log('🧪 Completing A/B experiments...');
@@ -219,96 +248,140 @@ export class NightlyLearner {
       };
     }
 
-    // Get episodes to consolidate
-    const episodes = sessionId
-      ? this.db.prepare(`
-          SELECT id, task, output, reward FROM episodes
-          WHERE session_id = ?
-          ORDER BY ts ASC
-        `).all(sessionId) as any[]
-      : this.db.prepare(`
-          SELECT id, task, output, reward FROM episodes
-          ORDER BY ts ASC
-          LIMIT 1000
-        `).all() as any[];
+    // A given session is consolidated in full; otherwise only new episodes
+    if (sessionId) {
+      const episodes = this.db.prepare(`
+        SELECT id, task, output, reward FROM episodes
+        WHERE session_id = ?
+        ORDER BY ts ASC
+      `).all(sessionId) as any[];
+      return this.consolidateBlock(episodes, 0);
+    }
+
+    const incremental = this.config.incremental ?? true;
+    const batchSize = this.config.checkpointEpisodes ?? 500;
+    let lastId = incremental ? this.getWatermark('consolidate') : 0;
+
+    const newStmt = this.db.prepare(`
+      SELECT id, task, output, reward, ts FROM episodes
+      WHERE id > ?
+      ORDER BY id
+      LIMIT ?
+    `);
+    const contextStmt = this.db.prepare(`
+      SELECT id, task, output, reward, ts FROM episodes
+      WHERE id <= ?
+      ORDER BY id DESC
+      LIMIT ?
+    `);
+
+    const total = { edgesDiscovered: 0, episodesProcessed: 0, metrics: undefined as any };
+    while (true) {
+      const fresh = newStmt.all(lastId, batchSize) as any[];
+      if (fresh.length === 0) break;
+
+      // Recent history gives the new episodes something to link to
+      const context = contextStmt.all(lastId, Math.max(0, CONSOLIDATION_CONTEXT - fresh.length)) as any[];
+      const block = [...context, ...fresh].sort((a, b) => a.ts - b.ts || a.id - b.id);
+
+      const result = await this.consolidateBlock(block, lastId);
+      total.edgesDiscovered += result.edgesDiscovered;
+      total.episodesProcessed += fresh.length;
+      total.metrics = result.metrics;
+
+      lastId = fresh[fresh.length - 1].id;
+      if (incremental) this.setWatermark('consolidate', lastId);
+      if (fresh.length < batchSize) break;
+    }
+
+    return total;
+  }
 
+  /**
+   * FlashAttention over one block of episodes (ordered by time), linking each
+   * to its most similar later episodes. Only pairs touching an episode with
+   * id > `newAfterId` are considered, so overlapping blocks add no duplicates.
+   */
+  private async consolidateBlock(episodes: any[], newAfterId: number): Promise<{
+    edgesDiscovered: number;
+    episodesProcessed: number;
+    metrics?: {
+      computeTimeMs: number;
+      peakMemoryMB: number;
+      blocksProcessed: number;
+    };
+  }> {
     if (episodes.length === 0) {
       return { edgesDiscovered: 0, episodesProcessed: 0 };
     }
 
-    // Generate embeddings for all episodes
-    const episodeEmbeddings: Float32Array[] = [];
-    for (const episode of episodes) {
-      const text = `${episode.task}: ${episode.output}`;
-      const embedding = await this.embedder.embed(text);
-      episodeEmbeddings.push(embedding);
-    }
+    const episodeEmbeddings = await this.loadEpisodeEmbeddings(episodes);
 
     // Prepare queries (each episode is a query)
-    const dim = 384;
+    const dim = episodeEmbeddings[0].length;
     const queries = new Float32Array(episodes.length * dim);
-    const keys = new Float32Array(episodes.length * dim);
-    const values = new Float32Array(episodes.length * dim);
 
     episodeEmbeddings.forEach((embedding, idx) => {
       queries.set(embedding, idx * dim);
-      keys.set(embedding, idx * dim);
-      values.set(embedding, idx * dim);
     });
 
     // Apply FlashAttention for memory-efficient consolidation
-    const attentionResult = await this.attentionService.flashAttention(queries, keys, values);
-
-    // Analyze attention output to discover causal relationships
-    let edgesDiscovered = 0;
-    const consolidatedEmbeddings = attentionResult.output;
+    const attentionResult = await this.attentionService!.flashAttention(queries, queries, queries);
 
-    // For each episode, find similar episodes in consolidated space
+    // Normalize consolidated rows so dot products are cosine similarities
+    const consolidated = Float32Array.from(attentionResult.output);
     for (let i = 0; i < episodes.length; i++) {
-      const queryEmb = consolidatedEmbeddings.slice(i * dim, (i + 1) * dim);
-
-      // Find top-k similar episodes
-      const similarities: Array<{ idx: number; score: number }> = [];
-      for (let j = 0; j < episodes.length; j++) {
-        if (i === j) continue;
+      const norm = l2Norm(consolidated, i * dim, dim);
+      if (norm > 0) {
+        for (let j = i * dim; j < (i + 1) * dim; j++) consolidated[j] /= norm;
+      }
+    }
 
-        const keyEmb = consolidatedEmbeddings.slice(j * dim, (j + 1) * dim);
-        const score = this.cosineSimilarity(queryEmb, keyEmb);
+    const kernel = this.getDotKernel();
+    kernel?.loadMatrix(consolidated, episodes.length, dim);
+    const scratch = kernel ? null : new Float32Array(episodes.length);
+    const existingStmt = this.db.prepare(`
+      SELECT 1 FROM causal_edges
+      WHERE from_memory_id = ? AND to_memory_id = ?
+    `);
 
-        if (score >= this.config.minSimilarity) {
-          similarities.push({ idx: j, score });
-        }
-      }
+    let edgesDiscovered = 0;
 
-      // Sort by similarity
-      similarities.sort((a, b) => b.score - a.score);
+    // For each episode, take its nearest neighbours in consolidated space
+    for (let i = 0; i < episodes.length; i++) {
+      const query = consolidated.subarray(i * dim, (i + 1) * dim);
+      const scores = kernel ? kernel.dots(query) : dotBatch(query, consolidated, episodes.length, dim, scratch!);
+      const neighbours = selectTopK(scores, 6, this.config.minSimilarity)
+        .filter((entry) => entry.index !== i)
+        .slice(0, 5);
 
       // Create causal edges for top matches
-      for (const { idx, score } of similarities.slice(0, 5)) {
+      for (const { index: idx, score } of neighbours) {
         // Only create edge if temporal sequence is correct
-        if (idx > i) {
-          const uplift = episodes[idx].reward - episodes[i].reward;
-
-          if (Math.abs(uplift) >= this.config.upliftThreshold) {
-            await this.causalGraph.addCausalEdge({
-              fromMemoryId: episodes[i].id,
-              fromMemoryType: 'episode',
-              toMemoryId: episodes[idx].id,
-              toMemoryType: 'episode',
-              similarity: score,
-              uplift,
-              confidence: score,
-              sampleSize: 1,
-              mechanism: 'flash_attention_consolidation',
-              metadata: {
-                consolidationMethod: 'flash_attention',
-                blockSize: this.config.flashConfig?.blockSize || 256,
-              },
-            });
-
-            edgesDiscovered++;
-          }
-        }
+        if (idx <= i) continue;
+        if (episodes[i].id <= newAfterId && episodes[idx].id <= newAfterId) continue;
+
+        const uplift = episodes[idx].reward - episodes[i].reward;
+        if (Math.abs(uplift) < this.config.upliftThreshold) continue;
+        if (existingStmt.get(episodes[i].id, episodes[idx].id)) continue;
+
+        await this.causalGraph.addCausalEdge({
+          fromMemoryId: episodes[i].id,
+          fromMemoryType: 'episode',
+          toMemoryId: episodes[idx].id,
+          toMemoryType: 'episode',
+          similarity: score,
+          uplift,
+          confidence: score,
+          sampleSize: 1,
+          mechanism: 'flash_attention_consolidation',
+          metadata: {
+            consolidationMethod: 'flash_attention',
+            blockSize: this.config.flashConfig?.blockSize || 256,
+          },
+        });
+
+        edgesDiscovered++;
       }
     }
 
@@ -320,97 +393,180 @@ export class NightlyLearner {
   }
 
   /**
-   * Helper: Cosine similarity between two vectors
+   * Stored episode embeddings, embedding only the episodes that lack one
    */
-  private cosineSimilarity(a: Float32Array, b: Float32Array): number {
-    let dotProduct = 0;
-    let normA = 0;
-    let normB = 0;
-
-    for (let i = 0; i < a.length; i++) {
-      dotProduct += a[i] * b[i];
-      normA += a[i] * a[i];
-      normB += b[i] * b[i];
+  private async loadEpisodeEmbeddings(episodes: any[]): Promise<Float32Array[]> {
+    const stored = new Map<number, Float32Array>();
+    try {
+      const stmt = this.db.prepare('SELECT embedding FROM episode_embeddings WHERE episode_id = ?');
+      for (const episode of episodes) {
+        const row = stmt.get(episode.id) as any;
+        if (row?.embedding) stored.set(episode.id, blobToFloat32(row.embedding));
+      }
+    } catch {
+      // No episode_embeddings table: embed everything
+    }
+
+    const missing = episodes.filter((episode) => !stored.has(episode.id));
+    if (missing.length > 0) {
+      const embeddings = await this.embedder.embedBatch(missing.map((e) => `${e.task}: ${e.output}`));
+      missing.forEach((episode, i) => stored.set(episode.id, embeddings[i]));
+    }
+
+    return episodes.map((episode) => stored.get(episode.id)!);
+  }
+
+  private getDotKernel(): SimdDotKernel | null {
+    if (NightlyLearner.dotKernel === undefined) {
+      NightlyLearner.dotKernel = SimdDotKernel.create();
     }
+    return NightlyLearner.dotKernel;
+  }
 
-    const denom = Math.sqrt(normA) * Math.sqrt(normB);
-    return denom === 0 ? 0 : dotProduct / denom;
+  /**
+   * Last episode id a job has fully processed (0 if it never ran)
+   */
+  private getWatermark(job: string): number {
+    const row = this.db.prepare('SELECT last_episode_id FROM learner_watermarks WHERE job = ?').get(job) as any;
+    return row?.last_episode_id ?? 0;
   }
 
+  private setWatermark(job: string, lastEpisodeId: number): void {
+    this.db.prepare(`
+      INSERT INTO learner_watermarks (job, last_episode_id, updated_at)
+      VALUES (?, ?, ?)
+      ON CONFLICT(job) DO UPDATE SET last_episode_id = excluded.last_episode_id, updated_at = excluded.updated_at
+    `).run(job, lastEpisodeId, Date.now());
+  }
+
+  /**
+   * Forget all watermarks so the next run reprocesses the full history
+   */
+  resetWatermarks(): void {
+    this.db.prepare('DELETE FROM learner_watermarks').run();
+  }
+
+  /**
+   * Pair each new episode with same-session episodes within an hour of it
+   * and keep the pairs whose doubly robust uplift clears the thresholds
+   *
+   * A pair is considered once, when the later-inserted of its two episodes
+   * is new. The watermark advances after every checkpoint; re-running a
+   * checkpoint is harmless since existing edges are skipped.
+   */
   private async discoverCausalEdges(): Promise<number> {
+    const incremental = this.config.incremental ?? true;
+    const batchSize = this.config.checkpointEpisodes ?? 500;
+    let lastId = incremental ? this.getWatermark('discover') : 0;
     let discovered = 0;
+    this.episodesProcessed = 0;
 
-    // Find episode pairs with high similarity and temporal sequence
-    const candidatePairs = this.db.prepare(`
+    // Better-sqlite3 best practice: Prepare statements OUTSIDE loops for better performance
+    const chunkStmt = this.db.prepare(`
+      SELECT MAX(id) as last_id, COUNT(*) as count FROM (
+        SELECT id FROM episodes WHERE id > ? ORDER BY id LIMIT ?
+      )
+    `);
+    const pairsStmt = this.db.prepare(`
       SELECT
         e1.id as from_id,
         e1.task as from_task,
+        e1.session_id as session_id,
         e1.reward as from_reward,
         e2.id as to_id,
         e2.task as to_task,
         e2.reward as to_reward,
         e2.ts - e1.ts as time_diff
-      FROM episodes e1
-      JOIN episodes e2 ON e1.session_id = e2.session_id
-      WHERE e1.id != e2.id
-        AND e2.ts > e1.ts
-        AND e2.ts - e1.ts < 3600 -- Within 1 hour
+      FROM episodes n
+      JOIN episodes p ON p.session_id = n.session_id
+        AND p.id < n.id
+        AND p.ts != n.ts
+        AND ABS(n.ts - p.ts) < 3600 -- Within 1 hour
+      JOIN episodes e1 ON e1.id = CASE WHEN p.ts < n.ts THEN p.id ELSE n.id END
+      JOIN episodes e2 ON e2.id = CASE WHEN p.ts < n.ts THEN n.id ELSE p.id END
+      WHERE n.id > ? AND n.id <= ?
       ORDER BY e1.id, e2.ts
-      LIMIT 1000
-    `).all() as any[];
-
-    // Better-sqlite3 best practice: Prepare statements OUTSIDE loops for better performance
+    `);
     const checkExistingStmt = this.db.prepare(`
       SELECT id FROM causal_edges
       WHERE from_memory_id = ? AND to_memory_id = ?
     `);
 
-    for (const pair of candidatePairs) {
-      // Check if edge already exists
-      const existing = checkExistingStmt.get(pair.from_id, pair.to_id);
+    // Per-run memo: these models only depend on task (and session)
+    const propensities = new Map<string, number>();
+    const outcomeModels = new Map<string, { mu1: number; mu0: number; sampleSize: number }>();
 
-      if (existing) continue;
+    while (true) {
+      const chunk = chunkStmt.get(lastId, batchSize) as any;
+      if (!chunk?.count) break;
 
-      // Calculate propensity score e(x) - probability of treatment
-      // Simplified: use frequency of from_task in session
-      const propensity = this.calculatePropensity(pair.from_id);
+      const candidatePairs = pairsStmt.all(lastId, chunk.last_id) as any[];
 
-      // Calculate outcome models μ1(x) and μ0(x)
-      const mu1 = this.calculateOutcomeModel(pair.from_task, true);  // With treatment
-      const mu0 = this.calculateOutcomeModel(pair.from_task, false); // Without treatment
+      for (const pair of candidatePairs) {
+        // Check if edge already exists
+        const existing = checkExistingStmt.get(pair.from_id, pair.to_id);
 
-      // Calculate doubly robust estimator
-      const a = 1; // This is a treated observation
-      const y = pair.to_reward;
-      const doublyRobustEstimate = (mu1 - mu0) + (a * (y - mu1) / propensity);
+        if (existing) continue;
 
-      // Calculate confidence based on sample size and variance
-      const sampleSize = this.getSampleSize(pair.from_task);
-      const confidence = this.calculateConfidence(sampleSize, doublyRobustEstimate);
+        // Calculate propensity score e(x) - probability of treatment
+        // Simplified: use frequency of from_task in session
+        const propensityKey = `${pair.session_id}\u0000${pair.from_task}`;
+        let propensity = propensities.get(propensityKey);
+        if (propensity === undefined) {
+          propensity = this.calculatePropensity(pair.from_id);
+          propensities.set(propensityKey, propensity);
+        }
 
-      // Only add if meets thresholds
-      if (Math.abs(doublyRobustEstimate) >= this.config.upliftThreshold && confidence >= this.config.confidenceThreshold) {
-        const edge: CausalEdge = {
-          fromMemoryId: pair.from_id,
-          fromMemoryType: 'episode',
-          toMemoryId: pair.to_id,
-          toMemoryType: 'episode',
-          similarity: 0.8, // Simplified - would use embedding similarity in production
-          uplift: doublyRobustEstimate,
-          confidence,
-          sampleSize,
-          mechanism: `${pair.from_task} → ${pair.to_task} (doubly robust)`,
-          metadata: {
-            propensity,
-            mu1,
-            mu0,
-            discoveredAt: Date.now()
-          }
-        };
-
-        this.causalGraph.addCausalEdge(edge);
-        discovered++;
+        // Calculate outcome models μ1(x) and μ0(x)
+        let model = outcomeModels.get(pair.from_task);
+        if (!model) {
+          model = {
+            mu1: this.calculateOutcomeModel(pair.from_task, true),  // With treatment
+            mu0: this.calculateOutcomeModel(pair.from_task, false), // Without treatment
+            sampleSize: this.getSampleSize(pair.from_task),
+          };
+          outcomeModels.set(pair.from_task, model);
+        }
+        const { mu1, mu0, sampleSize } = model;
+
+        // Calculate doubly robust estimator
+        const a = 1; // This is a treated observation
+        const y = pair.to_reward;
+        const doublyRobustEstimate = (mu1 - mu0) + (a * (y - mu1) / propensity);
+
+        // Calculate confidence based on sample size and variance
+        const confidence = this.calculateConfidence(sampleSize, doublyRobustEstimate);
+
+        // Only add if meets thresholds
+        if (Math.abs(doublyRobustEstimate) >= this.config.upliftThreshold && confidence >= this.config.confidenceThreshold) {
+          const edge: CausalEdge = {
+            fromMemoryId: pair.from_id,
+            fromMemoryType: 'episode',
+            toMemoryId: pair.to_id,
+            toMemoryType: 'episode',
+            similarity: 0.8, // Simplified - would use embedding similarity in production
+            uplift: doublyRobustEstimate,
+            confidence,
+            sampleSize,
+            mechanism: `${pair.from_task} → ${pair.to_task} (doubly robust)`,
+            metadata: {
+              propensity,
+              mu1,
+              mu0,
+              discoveredAt: Date.now()
+            }
+          };
+
+          await this.causalGraph.addCausalEdge(edge);
+          discovered++;
+        }
       }
+
+      // Checkpoint: everything up to this episode is done
+      lastId = chunk.last_id;
+      this.episodesProcessed += chunk.count;
+      if (incremental) this.setWatermark('discover', lastId);
+      if (chunk.count < batchSize) break;
     }
 
     return discovered;
@@ -578,6 +734,10 @@ export class NightlyLearner {
         OR created_at < ?
     `).run(this.config.confidenceThreshold, cutoffTime);
 
+    if (result.changes > 0) {
+      this.causalGraph.invalidateChainGraph();
+    }
+
     return result.changes;
   }
 
@@ -641,7 +801,8 @@ export class NightlyLearner {
     console.log(`    • Edges Discovered: ${report.edgesDiscovered}`);
     console.log(`    • Edges Pruned: ${report.edgesPruned}`);
     console.log(`    • Experiments Completed: ${report.experimentsCompleted}`);
-    console.log(`    • Experiments Created: ${report.experimentsCreated}\n`);
+    console.log(`    • Experiments Created: ${report.experimentsCreated}`);
+    console.log(`    • Episodes Processed: ${report.episodesProcessed ?? 0}\n`);
     console.log('  Statistics:');
     console.log(`    • Avg Uplift: ${report.avgUplift.toFixed(3)}`);
     console.log(`    • Avg Confidence: ${report.avgConfidence.toFixed(3)}\n`);
@@ -0,0 +1,196 @@
+/**
+ * PersistentEmbeddingCache - SQLite second-tier cache for EmbeddingService
+ *
+ * Stores embeddings keyed by (model, sha256(text)) in the AgentDB database so
+ * restarts do not re-embed the same episode and skill texts. Reads are
+ * synchronous point lookups on the primary key; writes are buffered and
+ * flushed in one transaction off the request path.
+ */
+
+import type { IDatabaseConnection } from '../types/database.types.js';
+import { blobToFloat32 } from '../utils/vector-kernels.js';
+
+export interface PersistentEmbeddingCacheOptions {
+  /** Delay before buffered writes are flushed in ms (default: 100) */
+  flushIntervalMs?: number;
+  /** Flush immediately once this many writes are buffered (default: 256) */
+  maxPendingWrites?: number;
+}
+
+interface PendingWrite {
+  model: string;
+  textHash: string;
+  embedding: Float32Array;
+}
+
+/** SQLite's default SQLITE_MAX_VARIABLE_NUMBER is 999 */
+const MAX_IN_PARAMS = 500;
+
+export class PersistentEmbeddingCache {
+  private db: IDatabaseConnection;
+  private flushIntervalMs: number;
+  private maxPendingWrites: number;
+  private pending: Map<string, PendingWrite> = new Map();
+  private flushTimer: ReturnType<typeof setTimeout> | null = null;
+
+  constructor(db: IDatabaseConnection, options: PersistentEmbeddingCacheOptions = {}) {
+    this.db = db;
+    this.flushIntervalMs = options.flushIntervalMs ?? 100;
+    this.maxPendingWrites = options.maxPendingWrites ?? 256;
+    this.initializeSchema();
+  }
+
+  private initializeSchema(): void {
+    this.db.exec(`
+      CREATE TABLE IF NOT EXISTS embedding_cache (
+        model TEXT NOT NULL,
+        text_hash TEXT NOT NULL,
+        dimension INTEGER NOT NULL,
+        embedding BLOB NOT NULL,
+        created_at INTEGER DEFAULT (strftime('%s', 'now')),
+        PRIMARY KEY (model, text_hash)
+      );
+
+      CREATE INDEX IF NOT EXISTS idx_embedding_cache_created
+        ON embedding_cache(model, created_at DESC);
+    `);
+  }
+
+  /**
+   * Look up one embedding (buffered writes are visible immediately)
+   */
+  get(model: string, textHash: string): Float32Array | null {
+    const pending = this.pending.get(`${model}:${textHash}`);
+    if (pending) return pending.embedding;
+
+    const row = this.db
+      .prepare('SELECT embedding FROM embedding_cache WHERE model = ? AND text_hash = ?')
+      .get(model, textHash);
+    return row ? blobToFloat32(row.embedding) : null;
+  }
+
+  /**
+   * Look up many embeddings with chunked IN queries
+   */
+  getMany(model: string, textHashes: string[]): Map<string, Float32Array> {
+    const found = new Map<string, Float32Array>();
+    const missing: string[] = [];
+
+    for (const textHash of textHashes) {
+      const pending = this.pending.get(`${model}:${textHash}`);
+      if (pending) {
+        found.set(textHash, pending.embedding);
+      } else {
+        missing.push(textHash);
+      }
+    }
+
+    for (let i = 0; i < missing.length; i += MAX_IN_PARAMS) {
+      const chunk = missing.slice(i, i + MAX_IN_PARAMS);
+      const placeholders = chunk.map(() => '?').join(',');
+      const rows = this.db
+        .prepare(
+          `SELECT text_hash, embedding FROM embedding_cache
+           WHERE model = ? AND text_hash IN (${placeholders})`
+        )
+        .all(model, ...chunk);
+      for (const row of rows) {
+        found.set(row.text_hash, blobToFloat32(row.embedding));
+      }
+    }
+
+    return found;
+  }
+
+  /**
+   * Most recently written embeddings for a model, newest first
+   */
+  loadRecent(model: string, limit: number): Array<[string, Float32Array]> {
+    const rows = this.db
+      .prepare(
+        `SELECT text_hash, embedding FROM embedding_cache
+         WHERE model = ? ORDER BY created_at DESC LIMIT ?`
+      )
+      .all(model, limit);
+    return rows.map((row: any) => [row.text_hash, blobToFloat32(row.embedding)]);
+  }
+
+  /**
+   * Buffer a write; flushed after flushIntervalMs or at maxPendingWrites
+   */
+  put(model: string, textHash: string, embedding: Float32Array): void {
+    this.pending.set(`${model}:${textHash}`, { model, textHash, embedding });
+
+    if (this.pending.size >= this.maxPendingWrites) {
+      this.flush();
+    } else if (!this.flushTimer) {
+      this.flushTimer = setTimeout(() => this.flush(), this.flushIntervalMs);
+      // Don't keep the process alive just to flush the cache
+      (this.flushTimer as any).unref?.();
+    }
+  }
+
+  /**
+   * Write all buffered embeddings in one transaction
+   */
+  flush(): number {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    if (this.pending.size === 0) return 0;
+
+    const writes = Array.from(this.pending.values());
+    this.pending.clear();
+
+    const stmt = this.db.prepare(
+      `INSERT OR REPLACE INTO embedding_cache (model, text_hash, dimension, embedding)
+       VALUES (?, ?, ?, ?)`
+    );
+
+    try {
+      this.db.exec('BEGIN');
+      for (const { model, textHash, embedding } of writes) {
+        stmt.run(
+          model,
+          textHash,
+          embedding.length,
+          Buffer.from(embedding.buffer, embedding.byteOffset, embedding.byteLength)
+        );
+      }
+      this.db.exec('COMMIT');
+    } catch (error) {
+      try {
+        this.db.exec('ROLLBACK');
+      } catch {
+        // Transaction was not started
+      }
+      console.warn('[PersistentEmbeddingCache] Failed to flush embeddings:', error);
+      return 0;
+    }
+
+    return writes.length;
+  }
+
+  /**
+   * Number of stored embeddings (optionally for one model)
+   */
+  count(model?: string): number {
+    const row = model
+      ? this.db.prepare('SELECT COUNT(*) as count FROM embedding_cache WHERE model = ?').get(model)
+      : this.db.prepare('SELECT COUNT(*) as count FROM embedding_cache').get();
+    return row?.count ?? 0;
+  }
+
+  /**
+   * Delete stored embeddings (optionally for one model)
+   */
+  clear(model?: string): void {
+    this.pending.clear();
+    if (model) {
+      this.db.prepare('DELETE FROM embedding_cache WHERE model = ?').run(model);
+    } else {
+      this.db.exec('DELETE FROM embedding_cache');
+    }
+  }
+}
@@ -7,6 +7,7 @@
  * Features:
  * - Connect to remote QUIC servers
  * - Send sync requests (episodes, skills, edges)
+ * - Binary sync streams (syncStream)
  * - Handle responses and errors
  * - Automatic retry with exponential backoff
  * - Connection pooling for efficiency
@@ -14,6 +15,7 @@
  */
 
 import chalk from 'chalk';
+import type { StreamSyncRequest } from './QUICServer.js';
 
 export interface QUICClientConfig {
   serverHost: string;
@@ -29,6 +31,11 @@ export interface QUICClientConfig {
     ca?: string;
     rejectUnauthorized?: boolean;
   };
+  /**
+   * Opens a sync stream and returns the server's frames (e.g. bound to
+   * QUICServer.streamSync in-process); default: the reference transport
+   */
+  streamTransport?: (request: StreamSyncRequest, authToken: string) => AsyncIterable<Uint8Array>;
 }
 
 export interface SyncOptions {
@@ -65,7 +72,8 @@ interface Connection {
 }
 
 export class QUICClient {
-  private config: Required<QUICClientConfig>;
+  private config: Required<Omit<QUICClientConfig, 'streamTransport'>>;
+  private streamTransport?: QUICClientConfig['streamTransport'];
   private connectionPool: Map<string, Connection> = new Map();
   private isConnected: boolean = false;
   private retryCount: number = 0;
@@ -81,6 +89,7 @@ export class QUICClient {
       poolSize: config.poolSize || 5,
       tlsConfig: config.tlsConfig || { rejectUnauthorized: true },
     };
+    this.streamTransport = config.streamTransport;
   }
 
   /**
@@ -252,6 +261,73 @@ export class QUICClient {
     }
   }
 
+  /**
+   * Open a binary sync stream (see QUICServer.streamSync)
+   *
+   * Yields the server's bytes as they arrive; decode with SyncCodec's
+   * readFrames()/decodeFrame(). Opening the stream is retried like sync();
+   * a stream that fails midway is not, since frames were already consumed.
+   */
+  async *syncStream(request: StreamSyncRequest): AsyncGenerator<Uint8Array> {
+    if (!this.isConnected) {
+      await this.connect();
+    }
+
+    const connection = await this.acquireConnection();
+    try {
+      const stream = await this.openStreamWithRetry(connection, request);
+      for await (const chunk of stream) {
+        yield chunk;
+      }
+    } finally {
+      this.releaseConnection(connection);
+    }
+  }
+
+  private async openStreamWithRetry(
+    connection: Connection,
+    request: StreamSyncRequest,
+    attempt: number = 0
+  ): Promise<AsyncIterator<Uint8Array> & AsyncIterable<Uint8Array>> {
+    try {
+      connection.requestCount++;
+      connection.lastUsedAt = Date.now();
+
+      const source = this.streamTransport
+        ? this.streamTransport(request, this.config.authToken)
+        : this.referenceStream();
+      const iterator = source[Symbol.asyncIterator]();
+
+      // Pull the first chunk so auth and request errors surface here
+      const first = await iterator.next();
+      return (async function* () {
+        if (first.done) return;
+        yield first.value;
+        for (let next = await iterator.next(); !next.done; next = await iterator.next()) {
+          yield next.value;
+        }
+      })();
+    } catch (error) {
+      const err = error as Error;
+
+      if (attempt < this.config.maxRetries) {
+        const delay = this.config.retryDelayMs * Math.pow(2, attempt);
+        console.log(chalk.yellow(`⚠️  Stream open failed, retrying in ${delay}ms (attempt ${attempt + 1}/${this.config.maxRetries})`));
+        await this.sleep(delay);
+        return this.openStreamWithRetry(connection, request, attempt + 1);
+      }
+
+      throw new Error(`Sync stream failed after ${this.config.maxRetries} retries: ${err.message}`);
+    }
+  }
+
+  /**
+   * Reference transport: an empty stream, like sendRequest()'s mock response
+   */
+  private async *referenceStream(): AsyncGenerator<Uint8Array> {
+    await this.sleep(100);
+  }
+
   /**
    * Send request with automatic retry
    */
@@ -22,6 +22,16 @@ import type { IDatabaseConnection, DatabaseRows } from '../types/database.types.
 import { normalizeRowId } from '../types/database.types.js';
 import { EmbeddingService } from './EmbeddingService.js';
 import type { VectorBackend, SearchResult } from '../backends/VectorBackend.js';
+import { StatementCache } from '../utils/StatementCache.js';
+import { blobToFloat32 } from '../utils/vector-kernels.js';
+import {
+  LexicalIndex,
+  fuseRankings,
+  isExactTokenQuery,
+  type FusionOptions,
+  type RankedHit,
+  type RetrievalMode,
+} from '../utils/LexicalIndex.js';
 
 export interface ReasoningPattern {
   id?: number;
@@ -35,6 +45,7 @@ export interface ReasoningPattern {
   metadata?: Record<string, any>;
   createdAt?: number;
   similarity?: number; // Cosine similarity score (for search results)
+  score?: number; // Fused or BM25 score (lexical/hybrid search results)
 }
 
 export interface PatternSearchQuery {
@@ -46,6 +57,12 @@ export interface PatternSearchQuery {
   threshold?: number;
   /** Enable GNN-based query enhancement (requires LearningBackend) */
   useGNN?: boolean;
+  /**
+   * 'vector' (default), 'lexical' (BM25 over task type, approach and tags,
+   * no embedding) or 'hybrid' (both, fused). Lexical modes need `task`.
+   */
+  retrieval?: RetrievalMode;
+  fusion?: FusionOptions;
   filters?: {
     taskType?: string;
     minSuccessRate?: number;
@@ -89,6 +106,7 @@ export class ReasoningBank {
   private db: IDatabaseConnection;
   private embedder: EmbeddingService;
   private cache: Map<string, any>;
+  private lexical: LexicalIndex;
 
   // v2: Optional vector backend (uses legacy if not provided)
   private vectorBackend?: VectorBackend;
@@ -96,6 +114,7 @@ export class ReasoningBank {
 
   // Maps pattern ID (number) to vector backend ID (string) for hybrid mode
   private idMapping: Map<number, string> = new Map();
+  private vectorToPattern: Map<string, number> = new Map();
   private nextVectorId = 0;
 
   /**
@@ -119,6 +138,12 @@ export class ReasoningBank {
     this.learningBackend = learningBackend;
     this.cache = new Map();
     this.initializeSchema();
+    this.lexical = LexicalIndex.open(this.db, {
+      table: 'reasoning_patterns',
+      key: 'id',
+      columns: ['task_type', 'approach', 'tags'],
+      weights: [2, 1, 1],
+    });
   }
 
   /**
@@ -190,6 +215,7 @@ export class ReasoningBank {
       // v2: Use VectorBackend for high-performance search
       const vectorId = `pattern_${this.nextVectorId++}`;
       this.idMapping.set(patternId, vectorId);
+      this.vectorToPattern.set(vectorId, patternId);
 
       this.vectorBackend.insert(vectorId, embedding, {
         patternId,
@@ -227,11 +253,18 @@ export class ReasoningBank {
    * v1 (legacy): Uses SQLite with cosine similarity computation
    * v2 (VectorBackend): Uses high-performance vector search (8x faster)
    * v2 + GNN: Optionally enhances query with learned patterns
+   * retrieval 'lexical' / 'hybrid': BM25 inverted index, alone or fused with ANN
    */
   async searchPatterns(query: PatternSearchQuery): Promise<ReasoningPattern[]> {
     const k = query.k || 10;
     const threshold = query.threshold || 0.0;
 
+    if (query.task && query.retrieval && query.retrieval !== 'vector') {
+      if (this.lexical.available) {
+        return this.searchPatternsHybrid({ ...query, task: query.task, k }, this.lexical);
+      }
+    }
+
     // Generate embedding if task string provided (v1 API compatibility)
     let queryEmbedding: Float32Array;
     if (query.task && !query.taskEmbedding) {
@@ -268,14 +301,14 @@ export class ReasoningBank {
     // Optional: Apply GNN enhancement
     if (query.useGNN && this.learningBackend) {
       // Get initial candidates for GNN context
-      const candidates = this.vectorBackend!.search(queryEmbedding, k * 3, { threshold: 0.0 });
+      const candidates = await this.vectorBackend!.searchAsync(queryEmbedding, k * 3, { threshold: 0.0 });
 
       if (candidates.length > 0) {
-        // Retrieve neighbor embeddings for GNN
-        const neighborEmbeddings = await this.getEmbeddingsForVectorIds(
-          candidates.map(c => c.id)
-        );
-        const weights = candidates.map(c => c.similarity);
+        // Retrieve neighbor embeddings for GNN (weights stay aligned with them)
+        const embeddingsById = await this.getEmbeddingsForVectorIds(candidates.map(c => c.id));
+        const neighbors = candidates.filter(c => embeddingsById.has(c.id));
+        const neighborEmbeddings = neighbors.map(c => embeddingsById.get(c.id)!);
+        const weights = neighbors.map(c => c.similarity);
 
         // Enhance query using GNN
         queryEmbedding = this.learningBackend.enhance(queryEmbedding, neighborEmbeddings, weights);
@@ -283,12 +316,97 @@ export class ReasoningBank {
     }
 
     // Perform vector search
-    const results = this.vectorBackend!.search(queryEmbedding, k, { threshold });
+    const results = await this.vectorBackend!.searchAsync(queryEmbedding, k, { threshold });
 
     // Hydrate with metadata from SQLite
     return this.hydratePatterns(results);
   }
 
+  /**
+   * Lexical or hybrid search. Exact-token queries (tool names, error codes)
+   * that hit the inverted index return without embedding the query; otherwise
+   * BM25 and ANN rankings are fused.
+   */
+  private async searchPatternsHybrid(
+    query: PatternSearchQuery & { task: string; k: number },
+    lexical: LexicalIndex
+  ): Promise<ReasoningPattern[]> {
+    const { task, k } = query;
+    const filter = this.lexicalFilter(query.filters);
+    const exact = isExactTokenQuery(task);
+
+    if (query.retrieval === 'lexical' || exact) {
+      const hits = lexical.search(task, k, { match: exact ? 'all' : 'any', ...filter });
+      if (query.retrieval === 'lexical' || hits.length > 0) {
+        return this.hydrateRanked(hits, new Map());
+      }
+    }
+
+    // Deeper candidate lists on both sides so fusion can reorder them
+    const depth = k * 3;
+    const lexicalHits = lexical.search(task, depth, { match: 'any', ...filter });
+    const vectorResults = await this.searchPatterns({ ...query, retrieval: 'vector', k: depth });
+
+    const similarities = new Map<number, number>();
+    const vectorHits: RankedHit[] = vectorResults.map((pattern) => {
+      similarities.set(pattern.id!, pattern.similarity ?? 0);
+      return { id: pattern.id!, score: pattern.similarity ?? 0 };
+    });
+
+    return this.hydrateRanked(fuseRankings(lexicalHits, vectorHits, query.fusion).slice(0, k), similarities);
+  }
+
+  /**
+   * Pattern filters as a condition on reasoning_patterns (aliased `t`)
+   */
+  private lexicalFilter(filters: PatternSearchQuery['filters']): { where?: string; params: any[] } {
+    const conditions: string[] = [];
+    const params: any[] = [];
+
+    if (filters?.taskType) {
+      conditions.push('t.task_type = ?');
+      params.push(filters.taskType);
+    }
+    if (filters?.minSuccessRate !== undefined) {
+      conditions.push('t.success_rate >= ?');
+      params.push(filters.minSuccessRate);
+    }
+    if (filters?.tags && filters.tags.length > 0) {
+      conditions.push(`(${filters.tags.map(() => 't.tags LIKE ?').join(' OR ')})`);
+      filters.tags.forEach((tag) => params.push(`%"${tag}"%`));
+    }
+
+    return { where: conditions.length > 0 ? conditions.join(' AND ') : undefined, params };
+  }
+
+  /**
+   * Load ranked pattern ids in rank order
+   */
+  private hydrateRanked(hits: RankedHit[], similarities: Map<number, number>): ReasoningPattern[] {
+    if (hits.length === 0) return [];
+
+    const rows = StatementCache.for(this.db).fetchByIds('reasoning_patterns', hits.map((hit) => hit.id));
+    const byId = new Map(rows.map((row) => [row.id, row]));
+
+    return hits.flatMap((hit) => {
+      const row = byId.get(hit.id);
+      if (!row) return [];
+      return [{
+        id: row.id,
+        taskType: row.task_type,
+        approach: row.approach,
+        successRate: row.success_rate,
+        uses: row.uses,
+        avgReward: row.avg_reward,
+        tags: row.tags ? JSON.parse(row.tags) : [],
+        metadata: row.metadata ? JSON.parse(row.metadata) : {},
+        createdAt: row.ts,
+        similarity: similarities.get(hit.id),
+        score: hit.score,
+      }];
+    });
+  }
+
   /**
    * v1: Legacy search using SQLite (backward compatible)
    */
@@ -381,21 +499,23 @@ export class ReasoningBank {
    * Hydrate search results with metadata from SQLite
    */
   private hydratePatterns(results: SearchResult[]): ReasoningPattern[] {
-    // Prepare statement OUTSIDE loop for better-sqlite3 best practice
-    const stmt = this.db.prepare(`
-      SELECT * FROM reasoning_patterns WHERE id = ?
-    `);
-
-    return results.map(result => {
+    const patternIds = results.map(result => {
       const patternId = result.metadata?.patternId;
       if (!patternId) {
         throw new Error(`VectorBackend result missing patternId: ${result.id}`);
       }
+      return patternId as number;
+    });
 
-      const row = stmt.get(patternId) as any;
+    // One bucketed IN query instead of a lookup per result
+    const rows = StatementCache.for(this.db).fetchByIds('reasoning_patterns', patternIds);
+    const byId = new Map(rows.map((row: any) => [row.id, row]));
+
+    return results.map((result, i) => {
+      const row = byId.get(patternIds[i]);
 
       if (!row) {
-        throw new Error(`Pattern ${patternId} not found in database`);
+        throw new Error(`Pattern ${patternIds[i]} not found in database`);
       }
 
       return {
@@ -414,34 +534,47 @@ export class ReasoningBank {
   }
 
   /**
-   * Get embeddings for vector IDs (for GNN)
+   * Embeddings for VectorBackend ids, keyed by vector id
+   *
+   * Patterns are fetched in one bucketed, projected query; embeddings stored
+   * in pattern_embeddings are reused and only the rest are re-embedded, in
+   * one batch.
    */
-  private async getEmbeddingsForVectorIds(vectorIds: string[]): Promise<Float32Array[]> {
-    // In a full implementation, this would retrieve embeddings from VectorBackend
-    // For now, we regenerate them from the database
-    const embeddings: Float32Array[] = [];
-
-    for (const vectorId of vectorIds) {
-      // Find pattern ID from mapping
-      let patternId: number | undefined;
-      for (const [pid, vid] of this.idMapping.entries()) {
-        if (vid === vectorId) {
-          patternId = pid;
-          break;
-        }
-      }
+  private async getEmbeddingsForVectorIds(vectorIds: string[]): Promise<Map<string, Float32Array>> {
+    const embeddings = new Map<string, Float32Array>();
+    const patternIds = vectorIds
+      .map((vectorId) => this.vectorToPattern.get(vectorId))
+      .filter((id): id is number => id !== undefined);
+    if (patternIds.length === 0) return embeddings;
+
+    const statements = StatementCache.for(this.db);
+    const rows = statements.fetchByIds<{ id: number; task_type: string; approach: string }>(
+      'reasoning_patterns',
+      patternIds,
+      { columns: ['task_type', 'approach'] }
+    );
+    const stored = new Map(
+      statements
+        .fetchByIds<{ pattern_id: number; embedding: Buffer }>('pattern_embeddings', patternIds, {
+          key: 'pattern_id',
+          columns: ['embedding'],
+        })
+        .map((row) => [row.pattern_id, row.embedding])
+    );
 
-      if (patternId) {
-        const pattern = this.getPattern(patternId);
-        if (pattern?.approach) {
-          const embedding = await this.embedder.embed(
-            `${pattern.taskType}: ${pattern.approach}`
-          );
-          embeddings.push(embedding);
-        }
-      }
+    const missing = rows.filter((row) => !stored.has(row.id) && row.approach);
+    const generated = missing.length > 0
+      ? await this.embedder.embedBatch(missing.map((row) => `${row.task_type}: ${row.approach}`))
+      : [];
+    const byPattern = new Map<number, Float32Array>(missing.map((row, i) => [row.id, generated[i]]));
+    for (const [patternId, blob] of stored) {
+      byPattern.set(patternId, blobToFloat32(blob));
     }
 
+    for (const vectorId of vectorIds) {
+      const embedding = byPattern.get(this.vectorToPattern.get(vectorId) ?? -1);
+      if (embedding) embeddings.set(vectorId, embedding);
+    }
     return embeddings;
   }
 
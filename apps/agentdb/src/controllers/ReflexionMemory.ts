@@ -17,6 +17,8 @@ import type { GraphBackend, GraphNode } from '../backends/GraphBackend.js';
 import type { GraphDatabaseAdapter } from '../backends/graph/GraphDatabaseAdapter.js';
 import { NodeIdMapper } from '../utils/NodeIdMapper.js';
 import { QueryCache, type QueryCacheConfig } from '../core/QueryCache.js';
+import { startTrace, type StageTrace } from '../observability/latency.js';
+import { StatementCache } from '../utils/StatementCache.js';
 
 export interface Episode {
   id?: number;
@@ -47,8 +49,45 @@ export interface ReflexionQuery {
   onlyFailures?: boolean;
   onlySuccesses?: boolean;
   timeWindowDays?: number;
+  /**
+   * Episode fields to hydrate (default: all). Skipping large text fields
+   * (input, output, critique, metadata) avoids reading them from disk.
+   */
+  fields?: Array<keyof Episode>;
+  /**
+   * Abort retrieval (e.g. a cancelled MCP request); checked between stages
+   * and between pages of the SQL fallback scan
+   */
+  signal?: AbortSignal;
 }
 
+// Rows per page in the SQL fallback scan; only the running top-k is kept
+const SQL_FALLBACK_PAGE_SIZE = 2000;
+
+// Matching episodes above which filters are applied after an over-fetched
+// ANN search instead of as an allowed-id pre-filter
+const PREFILTER_MAX_IDS = 10000;
+
+// Episode field -> episodes column, for projected hydration
+const EPISODE_COLUMNS: Record<keyof Episode, string> = {
+  id: 'id',
+  ts: 'ts',
+  sessionId: 'session_id',
+  task: 'task',
+  input: 'input',
+  output: 'output',
+  critique: 'critique',
+  reward: 'reward',
+  success: 'success',
+  latencyMs: 'latency_ms',
+  tokensUsed: 'tokens_used',
+  tags: 'tags',
+  metadata: 'metadata',
+};
+
+// Read for filtering regardless of the requested fields
+const FILTER_COLUMNS = ['id', 'ts', 'reward', 'success'];
+
 export class ReflexionMemory {
   private db: IDatabaseConnection;
   private embedder: EmbeddingService;
@@ -73,6 +112,14 @@ export class ReflexionMemory {
     this.queryCache = new QueryCache(cacheConfig);
   }
 
+  /**
+   * Vector backend holding this store's episode embeddings keyed by episode
+   * id, or undefined when there is none (graph backends key episodes by node)
+   */
+  getEpisodeBackend(): VectorBackend | undefined {
+    return this.graphBackend ? undefined : this.vectorBackend;
+  }
+
   /**
    * Store a new episode with its critique and outcome
    * Invalidates relevant cache entries
@@ -229,12 +276,15 @@ export class ReflexionMemory {
       onlyFailures = false,
       onlySuccesses = false,
       timeWindowDays,
+      fields,
+      signal,
     } = query;
+    signal?.throwIfAborted();
 
     // Check cache first
     const cacheKey = this.queryCache.generateKey(
       'retrieveRelevant',
-      [task, currentState, k, minReward, onlyFailures, onlySuccesses, timeWindowDays],
+      [task, currentState, k, minReward, onlyFailures, onlySuccesses, timeWindowDays, fields],
       'episodes'
     );
 
@@ -243,25 +293,42 @@ export class ReflexionMemory {
       return cached;
     }
 
-    // Generate and enhance query embedding
-    const queryEmbedding = await this.prepareQueryEmbedding(task, currentState, k);
+    // Per-stage latency: embed, then the chosen strategy's stages
+    const trace = startTrace('reflexion.retrieve');
+    let failure: unknown;
 
-    // Try different retrieval strategies in order of preference
-    let episodes: EpisodeWithEmbedding[] = [];
+    try {
+      // Generate and enhance query embedding
+      const queryEmbedding = await this.prepareQueryEmbedding(task, currentState, k);
+      trace.stage('embed');
+      signal?.throwIfAborted();
+
+      // Try different retrieval strategies in order of preference
+      let episodes: EpisodeWithEmbedding[] = [];
+
+      if (this.graphBackend && 'searchSimilarEpisodes' in this.graphBackend) {
+        episodes = await this.retrieveFromGraphAdapter(queryEmbedding, query);
+        trace.stage('graph');
+      } else if (this.graphBackend && 'execute' in this.graphBackend) {
+        episodes = await this.retrieveFromGenericGraph(query);
+        trace.stage('graph');
+      } else if (this.vectorBackend) {
+        episodes = await this.retrieveFromVectorBackend(queryEmbedding, query, trace);
+      } else {
+        episodes = await this.retrieveFromSQLFallback(queryEmbedding, query);
+        trace.stage('sql');
+      }
 
-    if (this.graphBackend && 'searchSimilarEpisodes' in this.graphBackend) {
-      episodes = await this.retrieveFromGraphAdapter(queryEmbedding, query);
-    } else if (this.graphBackend && 'execute' in this.graphBackend) {
-      episodes = await this.retrieveFromGenericGraph(query);
-    } else if (this.vectorBackend) {
-      episodes = await this.retrieveFromVectorBackend(queryEmbedding, query);
-    } else {
-      episodes = await this.retrieveFromSQLFallback(queryEmbedding, query);
+      // Cache and return results
+      signal?.throwIfAborted();
+      this.queryCache.set(cacheKey, episodes);
+      return episodes;
+    } catch (error) {
+      failure = error;
+      throw error;
+    } finally {
+      trace.end(failure);
     }
-
-    // Cache and return results
-    this.queryCache.set(cacheKey, episodes);
-    return episodes;
   }
 
   /**
@@ -329,76 +396,127 @@ export class ReflexionMemory {
    */
   private async retrieveFromVectorBackend(
     queryEmbedding: Float32Array,
-    query: ReflexionQuery
+    query: ReflexionQuery,
+    trace?: StageTrace
   ): Promise<EpisodeWithEmbedding[]> {
     const { k = 5, minReward, onlyFailures, onlySuccesses, timeWindowDays } = query;
 
-    // Get candidates from vector backend
-    const searchResults = this.vectorBackend!.search(queryEmbedding, k * 3, {
-      threshold: 0.0,
-    });
-
-    // Fetch full episode data from DB
-    const episodeIds = searchResults.map((r) => parseInt(r.id));
-    if (episodeIds.length === 0) {
+    // Selective filters become an allowed-id pre-filter so the backend
+    // returns k matching neighbors; broad ones over-fetch and post-filter
+    const prefilter = this.resolveEpisodePrefilter(query);
+    trace?.stage('prefilter');
+    if (prefilter.allowedIds?.size === 0) {
       return [];
     }
+    query.signal?.throwIfAborted();
 
-    const rows = this.fetchEpisodesByIds(episodeIds);
-    const episodeMap = new Map(rows.map((r) => [r.id.toString(), r]));
-
-    // Map results with similarity scores and apply filters
+    const total = this.vectorBackend!.getStats().count;
+    let fetchK = Math.min(Math.max(k, Math.ceil(k * prefilter.overfetch)), Math.max(total, k));
     const episodes: EpisodeWithEmbedding[] = [];
 
-    for (const result of searchResults) {
-      const row = episodeMap.get(result.id);
-      if (!row) continue;
+    while (true) {
+      // Get candidates from vector backend
+      const searchResults = await this.vectorBackend!.searchAsync(queryEmbedding, fetchK, {
+        threshold: 0.0,
+        allowedIds: prefilter.allowedIds,
+      });
+      trace?.stage('ann');
+      query.signal?.throwIfAborted();
 
-      // Apply filters
-      if (
-        !this.passesEpisodeFilters(row, { minReward, onlyFailures, onlySuccesses, timeWindowDays })
-      ) {
-        continue;
+      // Fetch full episode data from DB
+      const episodeIds = searchResults.map((r) => parseInt(r.id));
+      if (episodeIds.length === 0) {
+        return [];
       }
 
-      episodes.push(this.convertDatabaseEpisode(row, result.similarity));
+      const rows = this.fetchEpisodesByIds(episodeIds, query.fields);
+      const episodeMap = new Map(rows.map((r) => [r.id.toString(), r]));
+      trace?.stage('fetch');
+
+      // Map results with similarity scores and apply filters
+      episodes.length = 0;
+      for (const result of searchResults) {
+        const row = episodeMap.get(result.id);
+        if (!row) continue;
+
+        // Apply filters
+        if (
+          !this.passesEpisodeFilters(row, { minReward, onlyFailures, onlySuccesses, timeWindowDays })
+        ) {
+          continue;
+        }
 
-      if (episodes.length >= k) break;
+        episodes.push(this.convertDatabaseEpisode(row, result.similarity));
+
+        if (episodes.length >= k) break;
+      }
+
+      // Widen the over-fetch until k pass or the index is exhausted
+      if (episodes.length >= k || searchResults.length < fetchK || fetchK >= total) break;
+      fetchK = Math.min(fetchK * 2, total);
     }
+    trace?.stage('filter');
 
     return episodes;
   }
 
   /**
    * Retrieve episodes using SQL-based similarity search (fallback)
+   *
+   * Scans in id-ordered pages keeping only the best candidates, so memory
+   * stays bounded by k and the page size rather than the table. Yields to the
+   * event loop between pages so query.signal can abort a long scan.
    */
   private async retrieveFromSQLFallback(
     queryEmbedding: Float32Array,
     query: ReflexionQuery
   ): Promise<EpisodeWithEmbedding[]> {
-    const { k = 5 } = query;
+    const { k = 5, signal } = query;
     const { whereClause, params } = this.buildSQLFilters(query);
+    const cursorClause = whereClause ? `${whereClause} AND e.id > ?` : 'WHERE e.id > ?';
 
     const stmt = this.db.prepare<DatabaseRows.Episode & { embedding: Buffer }>(`
       SELECT e.*, ee.embedding
       FROM episodes e
       JOIN episode_embeddings ee ON e.id = ee.episode_id
-      ${whereClause}
-      ORDER BY e.reward DESC
+      ${cursorClause}
+      ORDER BY e.id ASC
+      LIMIT ${SQL_FALLBACK_PAGE_SIZE}
     `);
 
-    const rows = stmt.all(...params);
+    type Candidate = { row: DatabaseRows.Episode; embedding: Float32Array; similarity: number };
+    // Similarity first, then higher reward
+    const byRank = (a: Candidate, b: Candidate) =>
+      b.similarity - a.similarity || b.row.reward - a.row.reward;
 
-    // Calculate similarities and convert
-    const episodes: EpisodeWithEmbedding[] = rows.map((row) => {
-      const embedding = this.deserializeEmbedding(row.embedding);
-      const similarity = this.cosineSimilarity(queryEmbedding, embedding);
-      return this.convertDatabaseEpisode(row, similarity, embedding);
-    });
+    let candidates: Candidate[] = [];
+    let cursor = 0;
+
+    for (;;) {
+      signal?.throwIfAborted();
+      const rows = stmt.all(...params, cursor);
+      if (rows.length === 0) break;
+
+      for (const row of rows) {
+        const embedding = this.deserializeEmbedding(row.embedding);
+        const similarity = this.cosineSimilarity(queryEmbedding, embedding);
+        candidates.push({ row, embedding, similarity });
+      }
+      if (candidates.length > 2 * k) {
+        candidates = candidates.sort(byRank).slice(0, k);
+      }
+
+      cursor = rows[rows.length - 1].id;
+      if (rows.length < SQL_FALLBACK_PAGE_SIZE) break;
+      // Let a cancellation (and other requests) run before the next page
+      await new Promise<void>((resolve) => setImmediate(resolve));
+    }
 
     // Sort by similarity and return top-k
-    episodes.sort((a, b) => (b.similarity || 0) - (a.similarity || 0));
-    return episodes.slice(0, k);
+    return candidates
+      .sort(byRank)
+      .slice(0, k)
+      .map(({ row, embedding, similarity }) => this.convertDatabaseEpisode(row, similarity, embedding));
   }
 
   /**
@@ -498,16 +616,51 @@ export class ReflexionMemory {
     return { whereClause, params };
   }
 
+  /**
+   * Pre-filter for the ANN search: the ids passing the query filters when
+   * few enough match, otherwise an over-fetch factor from the estimated
+   * selectivity (1 and no ids when unfiltered)
+   */
+  private resolveEpisodePrefilter(query: ReflexionQuery): { allowedIds?: Set<string>; overfetch: number } {
+    const { whereClause, params } = this.buildSQLFilters(query);
+    if (!whereClause) {
+      return { overfetch: 1 };
+    }
+
+    // Capped count, so broad filters never materialise their ids
+    const { matches } = this.db
+      .prepare<{ matches: number }>(
+        `SELECT COUNT(*) AS matches FROM (SELECT 1 FROM episodes e ${whereClause} LIMIT ${PREFILTER_MAX_IDS + 1})`
+      )
+      .get(...params)!;
+
+    if (matches <= PREFILTER_MAX_IDS) {
+      const rows = this.db
+        .prepare<{ id: number }>(`SELECT e.id FROM episodes e ${whereClause}`)
+        .all(...params);
+      return { allowedIds: new Set(rows.map((row) => row.id.toString())), overfetch: 1 };
+    }
+
+    // Estimate selectivity from the most recent episodes, floored at the
+    // PREFILTER_MAX_IDS known matches
+    const { hits } = this.db
+      .prepare<{ hits: number }>(
+        `SELECT COUNT(*) AS hits FROM (SELECT * FROM episodes ORDER BY id DESC LIMIT ${PREFILTER_MAX_IDS}) e ${whereClause}`
+      )
+      .get(...params)!;
+    const total = Math.max(this.vectorBackend!.getStats().count, matches);
+    const selectivity = Math.max(hits / PREFILTER_MAX_IDS, matches / total);
+    return { overfetch: 1 / selectivity };
+  }
+
   /**
    * Fetch episodes by IDs from database
    */
-  private fetchEpisodesByIds(episodeIds: number[]): DatabaseRows.Episode[] {
-    const placeholders = episodeIds.map(() => '?').join(',');
-    const stmt = this.db.prepare<DatabaseRows.Episode>(`
-      SELECT * FROM episodes
-      WHERE id IN (${placeholders})
-    `);
-    return stmt.all(...episodeIds);
+  private fetchEpisodesByIds(episodeIds: number[], fields?: Array<keyof Episode>): DatabaseRows.Episode[] {
+    const columns = fields?.length
+      ? [...new Set([...FILTER_COLUMNS, ...fields.map((field) => EPISODE_COLUMNS[field]).filter(Boolean)])]
+      : undefined;
+    return StatementCache.for(this.db).fetchByIds<DatabaseRows.Episode>('episodes', episodeIds, { columns });
   }
 
   /**
@@ -788,31 +941,36 @@ export class ReflexionMemory {
     const { minReward = 0.3, maxAgeDays = 30, keepMinPerTask = 5 } = config;
 
     // Keep high-reward episodes and minimum per task
-    const stmt = this.db.prepare(`
-      DELETE FROM episodes
-      WHERE id IN (
-        SELECT id FROM (
-          SELECT
-            id,
-            reward,
-            ts,
-            ROW_NUMBER() OVER (PARTITION BY task ORDER BY reward DESC) as rank
-          FROM episodes
-          WHERE reward < ?
-            AND ts < strftime('%s', 'now') - ?
-        ) WHERE rank > ?
-      )
-    `);
-
-    const result = stmt.run(minReward, maxAgeDays * 86400, keepMinPerTask);
+    const ids: number[] = this.db.prepare(`
+      SELECT id FROM (
+        SELECT
+          id,
+          reward,
+          ts,
+          ROW_NUMBER() OVER (PARTITION BY task ORDER BY reward DESC) as rank
+        FROM episodes
+        WHERE reward < ?
+          AND ts < strftime('%s', 'now') - ?
+      ) WHERE rank > ?
+    `).all(minReward, maxAgeDays * 86400, keepMinPerTask).map((row: any) => row.id as number);
+
+    if (ids.length === 0) return 0;
+
+    const remove = this.db.prepare('DELETE FROM episodes WHERE id = ?');
+    this.db.transaction(() => {
+      for (const id of ids) remove.run(id);
+    })();
+
+    // Tombstone the vectors in place rather than rebuilding the index
+    for (const id of ids) {
+      this.vectorBackend?.remove(String(id));
+    }
 
     // Invalidate caches after pruning
-    if (result.changes > 0) {
-      this.queryCache.invalidateCategory('episodes');
-      this.queryCache.invalidateCategory('task-stats');
-    }
+    this.queryCache.invalidateCategory('episodes');
+    this.queryCache.invalidateCategory('task-stats');
 
-    return result.changes;
+    return ids.length;
   }
 
   // ========================================================================
@@ -957,7 +1115,7 @@ export class ReflexionMemory {
 
     try {
       // Get initial neighbors
-      const initialResults = this.vectorBackend.search(queryEmbedding, k * 2, {
+      const initialResults = await this.vectorBackend.searchAsync(queryEmbedding, k * 2, {
         threshold: 0.0,
       });
 
@@ -1101,8 +1259,13 @@ export class ReflexionMemory {
 
   /**
    * Warm cache with common queries
+   *
+   * Also bulk-loads the most recent stored embeddings from the embedder's
+   * persistent cache.
    */
   async warmCache(sessionId?: string): Promise<void> {
+    await this.embedder.warmCache();
+
     await this.queryCache.warm(async (cache) => {
       // Warm cache with recent sessions if sessionId provided
       if (sessionId) {
@@ -15,6 +15,24 @@ import { VectorBackend } from '../backends/VectorBackend.js';
 import type { GraphDatabaseAdapter } from '../backends/graph/GraphDatabaseAdapter.js';
 import { NodeIdMapper } from '../utils/NodeIdMapper.js';
 import { QueryCache, type QueryCacheConfig } from '../core/QueryCache.js';
+import { DisjointSet } from '../utils/DisjointSet.js';
+import { WorkerPool, defaultPoolSize } from '../utils/WorkerPool.js';
+import { SimdDotKernel, blobToFloat32, dotBatch, l2Norm, selectTopK } from '../utils/vector-kernels.js';
+import {
+  LexicalIndex,
+  fuseRankings,
+  isExactTokenQuery,
+  type FusionOptions,
+  type RankedHit,
+  type RetrievalMode,
+} from '../utils/LexicalIndex.js';
+import {
+  analyzeEpisodePatterns,
+  createSkillPatternPool,
+  type EpisodePatterns,
+  type PatternEpisode,
+} from '../utils/skill-patterns.js';
+import { createNeighborScanPool, type NeighborScanJob, type NeighborScanResult } from '../utils/neighbor-scan.js';
 
 export interface Skill {
   id?: number;
@@ -50,14 +68,66 @@ export interface SkillQuery {
   k?: number;
   minSuccessRate?: number;
   preferRecent?: boolean;
+  /**
+   * 'vector' (default), 'lexical' (BM25 over name, description and code, no
+   * embedding) or 'hybrid' (both, fused). SQLite-backed skills only.
+   */
+  retrieval?: RetrievalMode;
+  fusion?: FusionOptions;
+}
+
+export interface ConsolidatedPattern {
+  task: string;
+  commonPatterns: string[];
+  successIndicators: string[];
+  avgReward: number;
+}
+
+export interface ConsolidationProgress {
+  phase: 'neighbors' | 'skills';
+  /** Episodes linked (neighbors) or clusters consolidated (skills) so far */
+  done: number;
+  total: number;
+}
+
+interface ConsolidationRow {
+  id: number;
+  task: string;
+  reward: number;
+  success: number;
+  latency_ms: number | null;
+}
+
+/** Resumable consolidation state, checkpointed in skill_consolidation_runs */
+interface ConsolidationRun {
+  phase: 'neighbors' | 'skills';
+  cursor: number;
+  episodeIds: Float64Array;
+  clusters: DisjointSet;
+  created: number;
+  updated: number;
+  patterns: ConsolidatedPattern[];
 }
 
+// Checkpoints older than this are discarded instead of resumed
+const CONSOLIDATION_RUN_TTL_SECONDS = 86400;
+// Below this many clusters, worker startup costs more than it saves
+const PARALLEL_PATTERN_MIN_CLUSTERS = 64;
+// Below this many episodes, the brute-force neighbor scan stays on the main thread
+const PARALLEL_NEIGHBOR_MIN_EPISODES = 2000;
+const NEIGHBOR_SEARCH_CONCURRENCY = 64;
+const SQL_IN_CHUNK = 500;
+
 export class SkillLibrary {
   private db: IDatabaseConnection;
   private embedder: EmbeddingService;
   private vectorBackend: VectorBackend | null;
+  // Episode vectors keyed by episode id, for consolidation neighbor lookups
+  private episodeBackend: VectorBackend | null = null;
   private graphBackend?: any; // GraphBackend or GraphDatabaseAdapter
   private queryCache: QueryCache;
+  // BM25 index over skills, opened with the controller so reads run no DDL
+  private lexical: LexicalIndex;
 
   constructor(
     db: IDatabaseConnection,
@@ -71,6 +141,20 @@ export class SkillLibrary {
     this.vectorBackend = vectorBackend || null;
     this.graphBackend = graphBackend;
     this.queryCache = new QueryCache(cacheConfig);
+    this.lexical = LexicalIndex.open(this.db, {
+      table: 'skills',
+      key: 'id',
+      columns: ['name', 'description', 'code'],
+      weights: [3, 1, 1],
+    });
+  }
+
+  /**
+   * Vector index over episodes keyed by episode id (see
+   * ReflexionMemory.getEpisodeBackend()), used to link consolidation neighbors
+   */
+  setEpisodeBackend(backend?: VectorBackend | null): void {
+    this.episodeBackend = backend ?? null;
   }
 
   /**
@@ -189,12 +273,12 @@ export class SkillLibrary {
       throw new Error('SkillQuery must provide either task (v2) or query (v1)');
     }
 
-    const { k = 5, minSuccessRate = 0.5, preferRecent = true } = query;
+    const { k = 5, minSuccessRate = 0.5, preferRecent = true, retrieval = 'vector' } = query;
 
     // Check cache first
     const cacheKey = this.queryCache.generateKey(
       'retrieveSkills',
-      [task, k, minSuccessRate, preferRecent],
+      [task, k, minSuccessRate, preferRecent, retrieval, query.fusion],
       'skills'
     );
 
@@ -203,6 +287,15 @@ export class SkillLibrary {
       return cached;
     }
 
+    const graphBacked = this.graphBackend && 'searchSkills' in this.graphBackend;
+    if (retrieval !== 'vector' && !graphBacked) {
+      if (this.lexical.available) {
+        const results = await this.retrieveSkillsHybrid(task, query, k, minSuccessRate, this.lexical);
+        this.queryCache.set(cacheKey, results);
+        return results;
+      }
+    }
+
     // Generate query embedding
     const queryEmbedding = await this.embedder.embed(task);
 
@@ -253,7 +346,7 @@ export class SkillLibrary {
 
     // Use VectorBackend for semantic search (if available)
     if (this.vectorBackend) {
-      const searchResults = this.vectorBackend.search(queryEmbedding, k * 3);
+      const searchResults = await this.vectorBackend.searchAsync(queryEmbedding, k * 3);
 
       // Map results back to skill IDs and fetch full skill data
       const skillsWithSimilarity: (Skill & { similarity: number })[] = [];
@@ -307,6 +400,73 @@ export class SkillLibrary {
     }
   }
 
+  /**
+   * Lexical or hybrid retrieval. Exact-token queries that hit the inverted
+   * index skip the embedding; otherwise BM25 and ANN rankings are fused and
+   * the fused score takes the similarity slot of the composite skill score.
+   */
+  private async retrieveSkillsHybrid(
+    task: string,
+    query: SkillQuery,
+    k: number,
+    minSuccessRate: number,
+    lexical: LexicalIndex
+  ): Promise<Skill[]> {
+    const filter = { where: 't.success_rate >= ?', params: [minSuccessRate] };
+    const exact = isExactTokenQuery(task);
+
+    let ranked: RankedHit[] | null = null;
+    if (query.retrieval === 'lexical' || exact) {
+      const hits = lexical.search(task, k * 3, { match: exact ? 'all' : 'any', ...filter });
+      if (query.retrieval === 'lexical' || hits.length > 0) ranked = hits;
+    }
+
+    if (!ranked) {
+      const depth = k * 3;
+      const lexicalHits = lexical.search(task, depth, { match: 'any', ...filter });
+      let vectorHits: RankedHit[];
+
+      if (this.vectorBackend) {
+        const results = await this.vectorBackend.searchAsync(await this.embedder.embed(task), depth);
+        vectorHits = results.map((result) => ({ id: parseInt(result.id.replace('skill:', '')), score: result.similarity }));
+      } else {
+        const skills = await this.retrieveSkillsLegacy({ task, k: depth, minSuccessRate });
+        vectorHits = skills
+          .map((skill) => ({ id: skill.id!, score: (skill as Skill & { similarity: number }).similarity }))
+          .sort((a, b) => b.score - a.score);
+      }
+
+      ranked = fuseRankings(lexicalHits, vectorHits, query.fusion);
+    }
+
+    if (ranked.length === 0) return [];
+    const top = ranked[0].score;
+    const relevance = new Map(ranked.map((hit) => [hit.id, top > 0 ? hit.score / top : 0]));
+
+    const ids = ranked.map((hit) => hit.id);
+    const rows = this.db
+      .prepare<DatabaseRows.Skill>(`SELECT * FROM skills WHERE id IN (${ids.map(() => '?').join(', ')}) AND success_rate >= ?`)
+      .all(...ids, minSuccessRate);
+
+    const skills = rows.map((row) => ({
+      id: row.id,
+      name: row.name,
+      description: row.description ?? undefined,
+      signature: JSON.parse(row.signature),
+      code: row.code ?? undefined,
+      successRate: row.success_rate,
+      uses: row.uses,
+      avgReward: row.avg_reward,
+      avgLatencyMs: row.avg_latency_ms,
+      createdFromEpisode: row.created_from_episode ?? undefined,
+      metadata: row.metadata ? JSON.parse(row.metadata) : undefined,
+      similarity: relevance.get(row.id) ?? 0,
+    }));
+
+    skills.sort((a, b) => this.computeSkillScore(b) - this.computeSkillScore(a));
+    return skills.slice(0, k);
+  }
+
   /**
    * Legacy SQL-based skill retrieval (fallback when VectorBackend not available)
    */
@@ -458,348 +618,545 @@ export class SkillLibrary {
   /**
    * Consolidate high-reward episodes into skills with ML pattern extraction
    * This is the core learning mechanism enhanced with pattern analysis
+   *
+   * Candidate episodes are clustered as connected components: episodes with
+   * the same task always share a cluster, and with clusterBy 'embedding' each
+   * episode is also linked to its ANN neighbors (vector backend searchAsync,
+   * which runs on the backend's search workers when configured; without an
+   * episode index, a brute-force scan on worker threads). Pattern extraction
+   * for large runs is spread over worker threads too. Progress is
+   * checkpointed in skill_consolidation_runs, so an interrupted run with the
+   * same settings resumes where it stopped.
    */
   async consolidateEpisodesIntoSkills(config: {
     minAttempts?: number;
     minReward?: number;
     timeWindowDays?: number;
     extractPatterns?: boolean;
+    /** Cluster by exact task only, or also by embedding neighbors (default) */
+    clusterBy?: 'task' | 'embedding';
+    /** Minimum cosine similarity for linking two episodes (default: 0.85) */
+    similarityThreshold?: number;
+    /** Neighbors looked up per episode (default: 10) */
+    neighbors?: number;
+    /** Neighbor scan and pattern extraction workers (default: auto, 0 = main thread) */
+    workers?: number;
+    /** Episodes processed between checkpoints (default: 2000) */
+    checkpointInterval?: number;
+    /** Episode vector index (default: the one from setEpisodeBackend()) */
+    episodeBackend?: VectorBackend;
+    onProgress?: (progress: ConsolidationProgress) => void;
   }): Promise<{
     created: number;
     updated: number;
-    patterns: Array<{
-      task: string;
-      commonPatterns: string[];
-      successIndicators: string[];
-      avgReward: number;
-    }>;
+    patterns: ConsolidatedPattern[];
   }> {
-    const { minAttempts = 3, minReward = 0.7, timeWindowDays = 7, extractPatterns = true } = config;
-
-    interface ConsolidationCandidate {
-      task: string;
-      attempt_count: number;
-      avg_reward: number;
-      success_rate: number;
-      avg_latency: number | null;
-      latest_episode_id: number;
-      episode_ids: string;
-    }
+    const {
+      minAttempts = 3,
+      minReward = 0.7,
+      timeWindowDays = 7,
+      extractPatterns = true,
+      clusterBy = 'embedding',
+      similarityThreshold = 0.85,
+      neighbors = 10,
+      checkpointInterval = 2000,
+      onProgress,
+    } = config;
+    const interval = Math.max(1, checkpointInterval);
+
+    this.ensureConsolidationRunsTable();
+    const runKey = [minAttempts, minReward, timeWindowDays, extractPatterns ? 1 : 0, clusterBy, similarityThreshold, neighbors].join(':');
+    let run = this.loadConsolidationRun(runKey);
+    let rows: Array<ConsolidationRow | undefined>;
+
+    if (run) {
+      rows = this.loadConsolidationRows(run.episodeIds, minReward);
+    } else {
+      const candidates = this.db
+        .prepare<ConsolidationRow>(
+          `
+        SELECT id, task, reward, success, latency_ms
+        FROM episodes
+        WHERE ts > strftime('%s', 'now') - ?
+          AND reward >= ?
+        ORDER BY id
+      `
+        )
+        .all(timeWindowDays * 86400, minReward);
+      if (candidates.length === 0) {
+        return { created: 0, updated: 0, patterns: [] };
+      }
 
-    const stmt = this.db.prepare<ConsolidationCandidate>(`
-      SELECT
-        task,
-        COUNT(*) as attempt_count,
-        AVG(reward) as avg_reward,
-        AVG(success) as success_rate,
-        AVG(latency_ms) as avg_latency,
-        MAX(id) as latest_episode_id,
-        GROUP_CONCAT(id) as episode_ids
-      FROM episodes
-      WHERE ts > strftime('%s', 'now') - ?
-        AND reward >= ?
-      GROUP BY task
-      HAVING attempt_count >= ?
-    `);
+      rows = candidates;
+      run = {
+        phase: 'neighbors',
+        cursor: 0,
+        episodeIds: Float64Array.from(candidates, (row) => row.id),
+        clusters: new DisjointSet(candidates.length),
+        created: 0,
+        updated: 0,
+        patterns: [],
+      };
+
+      // Same task -> same cluster (the v1 GROUP BY task grouping)
+      const firstByTask = new Map<string, number>();
+      candidates.forEach((row, i) => {
+        const first = firstByTask.get(row.task);
+        if (first === undefined) firstByTask.set(row.task, i);
+        else run!.clusters.union(first, i);
+      });
+      this.createConsolidationRun(runKey, run);
+    }
 
-    const candidates = stmt.all(timeWindowDays * 86400, minReward, minAttempts);
-    let created = 0;
-    let updated = 0;
-    const patterns: Array<{
-      task: string;
-      commonPatterns: string[];
-      successIndicators: string[];
-      avgReward: number;
-    }> = [];
-
-    for (const candidate of candidates) {
-      const episodeIds = candidate.episode_ids.split(',').map(Number);
-
-      // Extract patterns from successful episodes if requested
-      let extractedPatterns: string[] = [];
-      let successIndicators: string[] = [];
-      let enhancedDescription = `Auto-generated skill from successful episodes`;
-
-      if (extractPatterns) {
-        const patternData = await this.extractPatternsFromEpisodes(episodeIds);
-        extractedPatterns = patternData.commonPatterns;
-        successIndicators = patternData.successIndicators;
-
-        if (extractedPatterns.length > 0) {
-          enhancedDescription = `Skill learned from ${episodeIds.length} successful episodes. Common patterns: ${extractedPatterns.slice(0, 3).join(', ')}`;
+    // Phase 1: link ANN neighbors
+    if (run.phase === 'neighbors') {
+      const total = run.episodeIds.length;
+      const backend = config.episodeBackend ?? this.episodeBackend;
+      const scanWorkers = config.workers ?? (total - run.cursor >= PARALLEL_NEIGHBOR_MIN_EPISODES ? defaultPoolSize() : 0);
+      const scanPool = clusterBy === 'embedding' && !backend && scanWorkers > 0
+        ? this.createNeighborScanPool(scanWorkers)
+        : null;
+      const search = clusterBy === 'embedding'
+        ? this.createNeighborSearch(run.episodeIds, rows, neighbors, similarityThreshold, backend, scanPool)
+        : null;
+
+      try {
+        for (let start = run.cursor; start < total; start += interval) {
+          const end = Math.min(total, start + interval);
+          if (search) {
+            const linked = await search(start, end);
+            for (let i = start; i < end; i++) {
+              for (const j of linked[i - start]) run.clusters.union(i, j);
+            }
+          }
+          run.cursor = end;
+          this.saveConsolidationRun(runKey, run);
+          onProgress?.({ phase: 'neighbors', done: end, total });
         }
-
-        patterns.push({
-          task: candidate.task,
-          commonPatterns: extractedPatterns,
-          successIndicators: successIndicators,
-          avgReward: candidate.avg_reward,
-        });
+      } finally {
+        await scanPool?.close();
       }
 
-      // Check if skill already exists
-      const existing = this.db.prepare('SELECT id FROM skills WHERE name = ?').get(candidate.task);
-
-      if (!existing) {
-        // Create new skill with extracted patterns
-        const skill: Skill = {
-          name: candidate.task,
-          description: enhancedDescription,
-          signature: {
-            inputs: { task: 'string' },
-            outputs: { result: 'any' },
-          },
-          successRate: candidate.success_rate,
-          uses: candidate.attempt_count,
-          avgReward: candidate.avg_reward,
-          avgLatencyMs: candidate.avg_latency ?? 0,
-          createdFromEpisode: candidate.latest_episode_id,
-          metadata: {
-            sourceEpisodes: episodeIds,
-            autoGenerated: true,
-            consolidatedAt: Date.now(),
-            extractedPatterns: extractedPatterns,
-            successIndicators: successIndicators,
-            patternConfidence: this.calculatePatternConfidence(
-              episodeIds.length,
-              candidate.success_rate
-            ),
-          },
-        };
-
-        await this.createSkill(skill);
-        created++;
-      } else {
-        // Update existing skill stats
-        this.updateSkillStats(
-          (existing as any).id,
-          candidate.success_rate > 0.5,
-          candidate.avg_reward,
-          candidate.avg_latency ?? 0
-        );
-        updated++;
-      }
+      run.phase = 'skills';
+      run.cursor = 0;
+      this.saveConsolidationRun(runKey, run);
     }
 
-    return { created, updated, patterns };
-  }
+    // Phase 2: one skill per cluster with enough attempts
+    const clusters = run.clusters
+      .components()
+      .map((members) => members.filter((i) => rows[i] !== undefined))
+      .filter((members) => members.length >= minAttempts);
+
+    const workers = config.workers ?? (clusters.length - run.cursor >= PARALLEL_PATTERN_MIN_CLUSTERS ? defaultPoolSize() : 0);
+    const pool = extractPatterns && workers > 0 ? this.createPatternPool(workers) : null;
+    const existingStmt = this.db.prepare('SELECT id FROM skills WHERE name = ?');
+
+    try {
+      while (run.cursor < clusters.length) {
+        // Batch whole clusters up to roughly one checkpoint interval of episodes
+        const batch: number[][] = [];
+        let batchEpisodes = 0;
+        while (run.cursor + batch.length < clusters.length && (batch.length === 0 || batchEpisodes < interval)) {
+          const members = clusters[run.cursor + batch.length];
+          batch.push(members);
+          batchEpisodes += members.length;
+        }
 
-  /**
-   * Extract common patterns from successful episodes using ML-inspired analysis
-   */
-  private async extractPatternsFromEpisodes(episodeIds: number[]): Promise<{
-    commonPatterns: string[];
-    successIndicators: string[];
-  }> {
-    // Retrieve episodes with their outputs and critiques
-    const episodes = this.db
-      .prepare(
-        `
-      SELECT id, task, input, output, critique, reward, success, metadata
-      FROM episodes
-      WHERE id IN (${episodeIds.map(() => '?').join(',')})
-      AND success = 1
-    `
-      )
-      .all(...episodeIds) as any[];
+        const batchPatterns = extractPatterns
+          ? await this.extractClusterPatterns(batch.map((members) => members.map((i) => rows[i]!.id)), pool)
+          : null;
 
-    if (episodes.length === 0) {
-      return { commonPatterns: [], successIndicators: [] };
-    }
+        for (let b = 0; b < batch.length; b++) {
+          const members = batch[b].map((i) => rows[i]!);
+          const summary = summarizeCluster(members);
+          const name = summary.task;
+          const episodeIds = members.map((row) => row.id);
 
-    const commonPatterns: string[] = [];
-    const successIndicators: string[] = [];
+          // Extract patterns from successful episodes if requested
+          let extractedPatterns: string[] = [];
+          let successIndicators: string[] = [];
+          let enhancedDescription = `Auto-generated skill from successful episodes`;
 
-    // Pattern 1: Analyze output text for common keywords and phrases
-    const outputTexts = episodes.map((ep) => ep.output).filter(Boolean);
+          if (batchPatterns) {
+            extractedPatterns = batchPatterns[b].commonPatterns;
+            successIndicators = batchPatterns[b].successIndicators;
 
-    if (outputTexts.length > 0) {
-      const keywordFrequency = this.extractKeywordFrequency(outputTexts);
-      const topKeywords = this.getTopKeywords(keywordFrequency, 5);
+            if (extractedPatterns.length > 0) {
+              enhancedDescription = `Skill learned from ${episodeIds.length} successful episodes. Common patterns: ${extractedPatterns.slice(0, 3).join(', ')}`;
+            }
+
+            run.patterns.push({
+              task: name,
+              commonPatterns: extractedPatterns,
+              successIndicators: successIndicators,
+              avgReward: summary.avgReward,
+            });
+          }
 
-      if (topKeywords.length > 0) {
-        commonPatterns.push(`Common techniques: ${topKeywords.join(', ')}`);
+          // Check if skill already exists
+          const existing = existingStmt.get(name);
+
+          if (!existing) {
+            // Create new skill with extracted patterns
+            const skill: Skill = {
+              name,
+              description: enhancedDescription,
+              signature: {
+                inputs: { task: 'string' },
+                outputs: { result: 'any' },
+              },
+              successRate: summary.successRate,
+              uses: episodeIds.length,
+              avgReward: summary.avgReward,
+              avgLatencyMs: summary.avgLatency ?? 0,
+              createdFromEpisode: summary.latestEpisodeId,
+              metadata: {
+                sourceEpisodes: episodeIds,
+                autoGenerated: true,
+                consolidatedAt: Date.now(),
+                extractedPatterns: extractedPatterns,
+                successIndicators: successIndicators,
+                patternConfidence: this.calculatePatternConfidence(episodeIds.length, summary.successRate),
+                ...(summary.tasks.length > 1 ? { clusterTasks: summary.tasks.slice(0, 10) } : {}),
+              },
+            };
+
+            await this.createSkill(skill);
+            run.created++;
+          } else {
+            // Update existing skill stats
+            this.updateSkillStats(
+              (existing as any).id,
+              summary.successRate > 0.5,
+              summary.avgReward,
+              summary.avgLatency ?? 0
+            );
+            run.updated++;
+          }
+        }
+
+        // A run killed before this point replays the batch; existing names
+        // are updated rather than created twice
+        run.cursor += batch.length;
+        this.saveConsolidationRun(runKey, run);
+        onProgress?.({ phase: 'skills', done: run.cursor, total: clusters.length });
       }
+    } finally {
+      await pool?.close();
     }
 
-    // Pattern 2: Analyze critique patterns for successful strategies
-    const critiques = episodes.map((ep) => ep.critique).filter(Boolean);
+    this.db.prepare('DELETE FROM skill_consolidation_runs WHERE run_key = ?').run(runKey);
+    return { created: run.created, updated: run.updated, patterns: run.patterns };
+  }
+
+  /**
+   * Checkpoints for consolidateEpisodesIntoSkills (one row per settings key)
+   */
+  private ensureConsolidationRunsTable(): void {
+    this.db.exec(`
+      CREATE TABLE IF NOT EXISTS skill_consolidation_runs (
+        run_key TEXT PRIMARY KEY,
+        phase TEXT NOT NULL,
+        cursor INTEGER NOT NULL,
+        episode_ids BLOB NOT NULL,
+        parents BLOB NOT NULL,
+        created INTEGER NOT NULL,
+        updated INTEGER NOT NULL,
+        patterns TEXT NOT NULL,
+        started_at INTEGER NOT NULL,
+        updated_at INTEGER NOT NULL
+      )
+    `);
+  }
 
-    if (critiques.length > 0) {
-      const critiqueKeywords = this.extractKeywordFrequency(critiques);
-      const topCritiquePatterns = this.getTopKeywords(critiqueKeywords, 3);
+  private loadConsolidationRun(runKey: string): ConsolidationRun | null {
+    const row = this.db
+      .prepare('SELECT * FROM skill_consolidation_runs WHERE run_key = ?')
+      .get(runKey) as any;
+    if (!row) return null;
 
-      if (topCritiquePatterns.length > 0) {
-        successIndicators.push(...topCritiquePatterns);
-      }
+    // Yesterday's candidate window is stale: start over
+    if (row.started_at < Math.floor(Date.now() / 1000) - CONSOLIDATION_RUN_TTL_SECONDS) {
+      this.db.prepare('DELETE FROM skill_consolidation_runs WHERE run_key = ?').run(runKey);
+      return null;
     }
 
-    // Pattern 3: Analyze reward distribution
-    const avgReward = episodes.reduce((sum, ep) => sum + ep.reward, 0) / episodes.length;
-    const highRewardCount = episodes.filter((ep) => ep.reward > avgReward).length;
-    const highRewardRatio = highRewardCount / episodes.length;
+    return {
+      phase: row.phase,
+      cursor: row.cursor,
+      episodeIds: new Float64Array(copyBlob(row.episode_ids)),
+      clusters: DisjointSet.fromParents(new Int32Array(copyBlob(row.parents))),
+      created: row.created,
+      updated: row.updated,
+      patterns: JSON.parse(row.patterns),
+    };
+  }
 
-    if (highRewardRatio > 0.6) {
-      successIndicators.push(
-        `High consistency (${(highRewardRatio * 100).toFixed(0)}% above average)`
+  private createConsolidationRun(runKey: string, run: ConsolidationRun): void {
+    const now = Math.floor(Date.now() / 1000);
+    this.db
+      .prepare(
+        `
+      INSERT OR REPLACE INTO skill_consolidation_runs
+        (run_key, phase, cursor, episode_ids, parents, created, updated, patterns, started_at, updated_at)
+      VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    `
+      )
+      .run(
+        runKey,
+        run.phase,
+        run.cursor,
+        toBlob(run.episodeIds),
+        toBlob(run.clusters.parents),
+        run.created,
+        run.updated,
+        JSON.stringify(run.patterns),
+        now,
+        now
       );
-    }
+  }
 
-    // Pattern 4: Analyze metadata for common parameters
-    const metadataPatterns = this.extractMetadataPatterns(episodes);
-    if (metadataPatterns.length > 0) {
-      commonPatterns.push(...metadataPatterns);
-    }
+  private saveConsolidationRun(runKey: string, run: ConsolidationRun): void {
+    this.db
+      .prepare(
+        `
+      UPDATE skill_consolidation_runs
+      SET phase = ?, cursor = ?, parents = ?, created = ?, updated = ?, patterns = ?, updated_at = ?
+      WHERE run_key = ?
+    `
+      )
+      .run(
+        run.phase,
+        run.cursor,
+        toBlob(run.clusters.parents),
+        run.created,
+        run.updated,
+        JSON.stringify(run.patterns),
+        Math.floor(Date.now() / 1000),
+        runKey
+      );
+  }
 
-    // Pattern 5: Temporal analysis - learning curve
-    const learningTrend = this.analyzeLearningTrend(episodes);
-    if (learningTrend) {
-      successIndicators.push(learningTrend);
-    }
+  /**
+   * Reload a checkpointed run's candidates; deleted episodes become holes
+   */
+  private loadConsolidationRows(episodeIds: Float64Array, minReward: number): Array<ConsolidationRow | undefined> {
+    const index = new Map<number, number>();
+    episodeIds.forEach((id, i) => index.set(id, i));
+    const rows: Array<ConsolidationRow | undefined> = new Array(episodeIds.length);
 
-    return { commonPatterns, successIndicators };
+    const stmt = this.db.prepare<ConsolidationRow>(`
+      SELECT id, task, reward, success, latency_ms
+      FROM episodes
+      WHERE id BETWEEN ? AND ? AND reward >= ?
+    `);
+    for (const row of stmt.all(episodeIds[0], episodeIds[episodeIds.length - 1], minReward)) {
+      const i = index.get(row.id);
+      if (i !== undefined) rows[i] = row;
+    }
+    return rows;
   }
 
   /**
-   * Extract keyword frequency from text array using NLP-inspired techniques
+   * Neighbor lookup for candidates [start, end): indices of other candidates
+   * at or above the similarity threshold
+   *
+   * Uses the episode vector index restricted to the candidate set; without
+   * one, falls back to a brute-force scan over the candidates' embeddings,
+   * split across `pool` when given and otherwise SIMD on the main thread.
+   * (The skill backend holds skill:<id> vectors and can't serve episode
+   * lookups.)
    */
-  private extractKeywordFrequency(texts: string[]): Map<string, number> {
-    const frequency = new Map<string, number>();
-
-    // Common stop words to filter out
-    const stopWords = new Set([
-      'the',
-      'a',
-      'an',
-      'and',
-      'or',
-      'but',
-      'in',
-      'on',
-      'at',
-      'to',
-      'for',
-      'of',
-      'with',
-      'by',
-      'from',
-      'as',
-      'is',
-      'was',
-      'are',
-      'were',
-      'been',
-      'be',
-      'have',
-      'has',
-      'had',
-      'do',
-      'does',
-      'did',
-      'will',
-      'would',
-      'should',
-      'could',
-      'may',
-      'might',
-      'must',
-      'can',
-      'this',
-      'that',
-      'these',
-      'those',
-    ]);
-
-    for (const text of texts) {
-      // Extract words (alphanumeric sequences)
-      const words = text.toLowerCase().match(/\b[a-z0-9_-]+\b/g) || [];
-
-      for (const word of words) {
-        if (word.length > 3 && !stopWords.has(word)) {
-          frequency.set(word, (frequency.get(word) || 0) + 1);
+  private createNeighborSearch(
+    episodeIds: Float64Array,
+    rows: Array<ConsolidationRow | undefined>,
+    k: number,
+    threshold: number,
+    backend: VectorBackend | null,
+    pool: WorkerPool<NeighborScanJob, NeighborScanResult | null> | null = null
+  ): (start: number, end: number) => Promise<number[][]> {
+    const index = new Map<string, number>();
+    episodeIds.forEach((id, i) => index.set(String(id), i));
+    const allowedIds: ReadonlySet<string> = new Set(index.keys());
+
+    if (backend) {
+      return async (start, end) => {
+        const vectors = await this.loadEpisodeVectors(episodeIds.subarray(start, end), rows.slice(start, end));
+        const linked: number[][] = new Array(end - start);
+
+        // Bounded in-flight queries; the backend's search workers run them in parallel
+        for (let wave = 0; wave < vectors.length; wave += NEIGHBOR_SEARCH_CONCURRENCY) {
+          const waveEnd = Math.min(vectors.length, wave + NEIGHBOR_SEARCH_CONCURRENCY);
+          const results = await Promise.all(
+            vectors.slice(wave, waveEnd).map((vector) =>
+              vector ? backend.searchAsync(vector, k + 1, { threshold, allowedIds }) : Promise.resolve([])
+            )
+          );
+          results.forEach((matches, r) => {
+            const self = start + wave + r;
+            linked[wave + r] = matches
+              .map((match) => index.get(match.id))
+              .filter((j): j is number => j !== undefined && j !== self);
+          });
         }
-      }
+        return linked;
+      };
     }
 
-    return frequency;
-  }
+    let matrix: { kernel: SimdDotKernel | null; data: Float32Array; dim: number } | null = null;
+    return async (start, end) => {
+      const count = episodeIds.length;
+      if (!matrix) {
+        const vectors = await this.loadEpisodeVectors(episodeIds, rows);
+        const dim = vectors.find((v) => v)?.length ?? 0;
+        // Shared, so every scan worker reads the one copy
+        const data = pool
+          ? new Float32Array(new SharedArrayBuffer(vectors.length * dim * 4))
+          : new Float32Array(vectors.length * dim);
+        vectors.forEach((vector, i) => {
+          // Missing rows stay zero and never pass the threshold
+          if (!vector || vector.length !== dim) return;
+          const norm = l2Norm(vector);
+          if (norm > 0) for (let d = 0; d < dim; d++) data[i * dim + d] = vector[d] / norm;
+        });
+        let kernel: SimdDotKernel | null = null;
+        if (pool) {
+          await pool.broadcast({ load: { buffer: data.buffer as SharedArrayBuffer, count, dim } });
+        } else {
+          kernel = SkillLibrary.getDotKernel();
+          kernel?.loadMatrix(data, vectors.length, dim);
+        }
+        matrix = { kernel, data, dim };
+      }
 
-  /**
-   * Get top N keywords by frequency
-   */
-  private getTopKeywords(frequency: Map<string, number>, n: number): string[] {
-    return Array.from(frequency.entries())
-      .sort((a, b) => b[1] - a[1])
-      .slice(0, n)
-      .filter(([_, count]) => count >= 2) // Only keywords appearing at least twice
-      .map(([word, _]) => word);
+      if (pool) {
+        const step = Math.ceil((end - start) / pool.size);
+        const parts: Array<Promise<NeighborScanResult | null>> = [];
+        for (let from = start; from < end; from += step) {
+          parts.push(pool.run({ start: from, end: Math.min(end, from + step), k, threshold }));
+        }
+        const linked: number[][] = [];
+        for (const part of await Promise.all(parts)) {
+          const { offsets, neighbors } = part!;
+          for (let r = 0; r + 1 < offsets.length; r++) {
+            linked.push(Array.from(neighbors.subarray(offsets[r], offsets[r + 1])));
+          }
+        }
+        return linked;
+      }
+
+      const { kernel, data, dim } = matrix;
+      const scratch = kernel ? null : new Float32Array(count);
+      const linked: number[][] = [];
+      for (let i = start; i < end; i++) {
+        const query = data.subarray(i * dim, (i + 1) * dim);
+        const scores = kernel ? kernel.dots(query) : dotBatch(query, data, count, dim, scratch!);
+        linked.push(
+          selectTopK(scores, k + 1, threshold)
+            .map((entry) => entry.index)
+            .filter((j) => j !== i)
+        );
+      }
+      return linked;
+    };
   }
 
   /**
-   * Extract common patterns from episode metadata
+   * Episode embeddings from episode_embeddings, embedding any that are missing
    */
-  private extractMetadataPatterns(episodes: any[]): string[] {
-    const patterns: string[] = [];
-    const metadataFields = new Map<string, Set<any>>();
-
-    for (const episode of episodes) {
-      if (episode.metadata) {
-        try {
-          const metadata =
-            typeof episode.metadata === 'string' ? JSON.parse(episode.metadata) : episode.metadata;
-
-          for (const [key, value] of Object.entries(metadata)) {
-            if (!metadataFields.has(key)) {
-              metadataFields.set(key, new Set());
-            }
-            metadataFields.get(key)!.add(value);
-          }
-        } catch (e) {
-          // Skip invalid metadata
-        }
+  private async loadEpisodeVectors(
+    episodeIds: ArrayLike<number>,
+    rows: Array<ConsolidationRow | undefined>
+  ): Promise<Array<Float32Array | null>> {
+    const stored = new Map<number, Float32Array>();
+    const ids = Array.from(episodeIds).filter((_, i) => rows[i] !== undefined);
+    try {
+      for (let i = 0; i < ids.length; i += SQL_IN_CHUNK) {
+        const chunk = ids.slice(i, i + SQL_IN_CHUNK);
+        const found = this.db
+          .prepare(
+            `SELECT episode_id, embedding FROM episode_embeddings WHERE episode_id IN (${chunk.map(() => '?').join(',')})`
+          )
+          .all(...chunk) as any[];
+        for (const row of found) stored.set(row.episode_id, blobToFloat32(row.embedding));
       }
+    } catch {
+      // No episode_embeddings table: embed everything
     }
 
-    // Find fields with consistent values
-    metadataFields.forEach((values, field) => {
-      if (values.size === 1) {
-        // All episodes have the same value for this field
-        const value = Array.from(values)[0];
-        patterns.push(`Consistent ${field}: ${value}`);
-      }
-    });
+    const missing = ids.filter((id) => !stored.has(id));
+    for (let i = 0; i < missing.length; i += SQL_IN_CHUNK) {
+      const chunk = missing.slice(i, i + SQL_IN_CHUNK);
+      const episodes = this.db
+        .prepare(`SELECT id, task, output, critique FROM episodes WHERE id IN (${chunk.map(() => '?').join(',')})`)
+        .all(...chunk) as any[];
+      // Same text ReflexionMemory embeds on store
+      const texts = episodes.map((e) => [e.task, e.critique, e.output].filter(Boolean).join('\n'));
+      const embeddings = await this.embedder.embedBatch(texts);
+      episodes.forEach((episode, j) => stored.set(episode.id, embeddings[j]));
+    }
 
-    return patterns;
+    return Array.from(episodeIds, (id) => stored.get(id) ?? null);
   }
 
   /**
-   * Analyze learning trend across episodes
+   * Patterns of each cluster's successful episodes, on the worker pool if given
    */
-  private analyzeLearningTrend(episodes: any[]): string | null {
-    if (episodes.length < 3) return null;
+  private async extractClusterPatterns(
+    clusters: number[][],
+    pool: WorkerPool<PatternEpisode[], EpisodePatterns> | null
+  ): Promise<EpisodePatterns[]> {
+    const byId = new Map<number, PatternEpisode>();
+    const ids = clusters.flat();
+    for (let i = 0; i < ids.length; i += SQL_IN_CHUNK) {
+      const chunk = ids.slice(i, i + SQL_IN_CHUNK);
+      const episodes = this.db
+        .prepare(
+          `
+        SELECT id, output, critique, reward, metadata
+        FROM episodes
+        WHERE id IN (${chunk.map(() => '?').join(',')})
+        AND success = 1
+      `
+        )
+        .all(...chunk) as PatternEpisode[];
+      for (const episode of episodes) byId.set(episode.id, episode);
+    }
 
-    // Sort by episode ID (temporal order)
-    const sorted = [...episodes].sort((a, b) => a.id - b.id);
+    return Promise.all(
+      clusters.map((members) => {
+        const episodes = members.filter((id) => byId.has(id)).map((id) => byId.get(id)!);
+        return pool ? pool.run(episodes) : analyzeEpisodePatterns(episodes);
+      })
+    );
+  }
 
-    const firstHalfReward =
-      sorted.slice(0, Math.floor(sorted.length / 2)).reduce((sum, ep) => sum + ep.reward, 0) /
-      Math.floor(sorted.length / 2);
+  private createNeighborScanPool(workers: number): WorkerPool<NeighborScanJob, NeighborScanResult | null> | null {
+    try {
+      return createNeighborScanPool(workers);
+    } catch (error) {
+      console.warn('[SkillLibrary] Neighbor scan workers unavailable, scanning on main thread:', error);
+      return null;
+    }
+  }
 
-    const secondHalfReward =
-      sorted.slice(Math.floor(sorted.length / 2)).reduce((sum, ep) => sum + ep.reward, 0) /
-      (sorted.length - Math.floor(sorted.length / 2));
+  private createPatternPool(workers: number): WorkerPool<PatternEpisode[], EpisodePatterns> | null {
+    try {
+      return createSkillPatternPool(workers);
+    } catch (error) {
+      console.warn('[SkillLibrary] Pattern workers unavailable, extracting on main thread:', error);
+      return null;
+    }
+  }
 
-    const improvement = ((secondHalfReward - firstHalfReward) / firstHalfReward) * 100;
+  private static dotKernel: SimdDotKernel | null | undefined;
 
-    if (improvement > 10) {
-      return `Strong learning curve (+${improvement.toFixed(0)}% improvement)`;
-    } else if (improvement > 5) {
-      return `Moderate learning curve (+${improvement.toFixed(0)}% improvement)`;
-    } else if (Math.abs(improvement) < 5) {
-      return `Stable performance (±${Math.abs(improvement).toFixed(0)}%)`;
+  private static getDotKernel(): SimdDotKernel | null {
+    if (SkillLibrary.dotKernel === undefined) {
+      SkillLibrary.dotKernel = SimdDotKernel.create();
     }
-
-    return null;
+    return SkillLibrary.dotKernel;
   }
 
   /**
@@ -821,21 +1178,29 @@ export class SkillLibrary {
   pruneSkills(config: { minUses?: number; minSuccessRate?: number; maxAgeDays?: number }): number {
     const { minUses = 3, minSuccessRate = 0.4, maxAgeDays = 60 } = config;
 
-    const stmt = this.db.prepare(`
-      DELETE FROM skills
+    const ids: number[] = this.db.prepare(`
+      SELECT id FROM skills
       WHERE uses < ?
         AND success_rate < ?
         AND created_at < strftime('%s', 'now') - ?
-    `);
+    `).all(minUses, minSuccessRate, maxAgeDays * 86400).map((row: any) => row.id as number);
 
-    const result = stmt.run(minUses, minSuccessRate, maxAgeDays * 86400);
+    if (ids.length === 0) return 0;
 
-    // Invalidate cache after pruning
-    if (result.changes > 0) {
-      this.queryCache.invalidateCategory('skills');
+    const remove = this.db.prepare('DELETE FROM skills WHERE id = ?');
+    this.db.transaction(() => {
+      for (const id of ids) remove.run(id);
+    })();
+
+    // Tombstone the vectors in place rather than rebuilding the index
+    for (const id of ids) {
+      this.vectorBackend?.remove(`skill:${id}`);
     }
 
-    return result.changes;
+    // Invalidate cache after pruning
+    this.queryCache.invalidateCategory('skills');
+
+    return ids.length;
   }
 
   /**
@@ -861,8 +1226,14 @@ export class SkillLibrary {
 
   /**
    * Warm cache with common skill queries
+   *
+   * Bulk-loads stored embeddings (recent entries plus the given tasks) from
+   * the embedder's persistent cache first, so the queries don't hit the model.
    */
   async warmCache(commonTasks: string[]): Promise<void> {
+    await this.embedder.warmCache();
+    await this.embedder.warmCache(commonTasks);
+
     await this.queryCache.warm(async (cache) => {
       // Pre-load common skill queries
       for (const task of commonTasks) {
@@ -922,3 +1293,48 @@ export class SkillLibrary {
     );
   }
 }
+
+/**
+ * Aggregate stats of one cluster; its most frequent task names the skill
+ */
+function summarizeCluster(rows: ConsolidationRow[]) {
+  const taskCounts = new Map<string, number>();
+  let reward = 0;
+  let success = 0;
+  let latency = 0;
+  let latencyCount = 0;
+  let latestEpisodeId = 0;
+
+  for (const row of rows) {
+    taskCounts.set(row.task, (taskCounts.get(row.task) ?? 0) + 1);
+    reward += row.reward;
+    success += row.success;
+    if (row.latency_ms != null) {
+      latency += row.latency_ms;
+      latencyCount++;
+    }
+    latestEpisodeId = Math.max(latestEpisodeId, row.id);
+  }
+
+  const tasks = Array.from(taskCounts.entries())
+    .sort((a, b) => b[1] - a[1])
+    .map(([task]) => task);
+
+  return {
+    task: tasks[0],
+    tasks,
+    avgReward: reward / rows.length,
+    successRate: success / rows.length,
+    avgLatency: latencyCount > 0 ? latency / latencyCount : null,
+    latestEpisodeId,
+  };
+}
+
+function toBlob(array: Float64Array | Int32Array): Buffer {
+  return Buffer.from(array.buffer, array.byteOffset, array.byteLength);
+}
+
+/** Aligned copy of a BLOB column for typed-array views */
+function copyBlob(blob: Uint8Array): ArrayBuffer {
+  return new Uint8Array(blob).buffer;
+}
@@ -9,6 +9,7 @@
  * - Bidirectional sync (push and pull)
  * - Conflict resolution strategies
  * - Batch operations for efficiency
+ * - Streamed binary pulls that fetch only changed key ranges
  * - Progress tracking and reporting
  * - Comprehensive error handling
  * - Sync state persistence
@@ -17,6 +18,18 @@
 import chalk from 'chalk';
 import { QUICClient, SyncOptions, SyncResult } from './QUICClient.js';
 import { QUICServer, SyncRequest } from './QUICServer.js';
+import { decodeFrame, readFrames, supportedCompressions, type SyncCompression } from '../utils/SyncCodec.js';
+import {
+  DEFAULT_SYNC_RANGE_SIZE,
+  ackRanges,
+  ensureRangeAckTable,
+  findSyncTable,
+  rangeHashesForRequest,
+  syncTablesFor,
+  tableColumns,
+  type RangeHashes,
+  type SyncTableSpec,
+} from '../utils/sync-ranges.js';
 
 // Database type from db-fallback
 type Database = any;
@@ -29,6 +42,14 @@ export interface SyncCoordinatorConfig {
   batchSize?: number;
   autoSync?: boolean;
   syncIntervalMs?: number;
+  /** 'binary' streams columnar frames of changed ranges; 'json' is the v1 row dump (default: binary) */
+  protocol?: 'binary' | 'json';
+  /** Key range size for range-hash diffing (default: 1024) */
+  rangeSize?: number;
+  /** Codec to ask the remote for (default: the best one this Node decodes) */
+  compression?: SyncCompression;
+  /** int8 quarters embedding bytes at a small precision cost (default: float32) */
+  vectorEncoding?: 'float32' | 'int8';
 }
 
 export interface SyncState {
@@ -67,8 +88,10 @@ export class SyncCoordinator {
   private db: Database;
   private client?: QUICClient;
   private server?: QUICServer;
-  private config: Required<Omit<SyncCoordinatorConfig, 'db' | 'client' | 'server'>>;
+  private config: Required<Omit<SyncCoordinatorConfig, 'db' | 'client' | 'server' | 'compression'>> &
+    Pick<SyncCoordinatorConfig, 'compression'>;
   private syncState: SyncState;
+  private rangeAcks: boolean;
   private isSyncing: boolean = false;
   private autoSyncInterval: NodeJS.Timeout | null = null;
 
@@ -81,10 +104,15 @@ export class SyncCoordinator {
       batchSize: config.batchSize || 100,
       autoSync: config.autoSync || false,
       syncIntervalMs: config.syncIntervalMs || 60000, // 1 minute
+      protocol: config.protocol || 'binary',
+      rangeSize: config.rangeSize || DEFAULT_SYNC_RANGE_SIZE,
+      compression: config.compression,
+      vectorEncoding: config.vectorEncoding || 'float32',
     };
 
     // Load sync state
     this.syncState = this.loadSyncState();
+    this.rangeAcks = ensureRangeAckTable(this.db);
 
     // Start auto-sync if enabled
     if (this.config.autoSync) {
@@ -211,20 +239,20 @@ export class SyncCoordinator {
   }> {
     const { lastEpisodeSync, lastSkillSync, lastEdgeSync } = this.syncState;
 
+    // Tables without a ts column (or not present in this schema) have no change feed
+    const since = (table: string, ts: number): any[] =>
+      tableColumns(this.db, table).includes('ts')
+        ? this.db.prepare(`SELECT * FROM ${table} WHERE ts > ?`).all(ts)
+        : [];
+
     // Detect new/modified episodes
-    const episodes = this.db
-      .prepare('SELECT * FROM episodes WHERE ts > ?')
-      .all(lastEpisodeSync);
+    const episodes = since('episodes', lastEpisodeSync);
 
     // Detect new/modified skills
-    const skills = this.db
-      .prepare('SELECT * FROM skills WHERE ts > ?')
-      .all(lastSkillSync);
+    const skills = since('skills', lastSkillSync);
 
     // Detect new/modified edges
-    const edges = this.db
-      .prepare('SELECT * FROM skill_edges WHERE ts > ?')
-      .all(lastEdgeSync);
+    const edges = since('skill_edges', lastEdgeSync);
 
     return { episodes, skills, edges };
   }
@@ -263,6 +291,10 @@ export class SyncCoordinator {
       throw new Error('QUICClient not configured');
     }
 
+    if (this.config.protocol === 'binary') {
+      return this.pullBinary(onProgress);
+    }
+
     const errors: string[] = [];
     let itemsPulled = 0;
     let bytesTransferred = 0;
@@ -353,6 +385,157 @@ export class SyncCoordinator {
     };
   }
 
+  /**
+   * Pull over a binary sync stream, applying each batch as it arrives
+   *
+   * Local range hashes go with the request, so the remote sends only the key
+   * ranges that differ, and nothing is buffered beyond one frame. Each span
+   * ends with a RANGE frame: local rows the remote no longer has are deleted
+   * (kept under local-wins), and ranges still differing afterwards are acked
+   * so they are not resent until either side changes them.
+   */
+  private async pullBinary(onProgress?: (progress: SyncProgress) => void): Promise<{
+    itemsPulled: number;
+    bytesTransferred: number;
+    data: any;
+    errors: string[];
+  }> {
+    const errors: string[] = [];
+    let itemsPulled = 0;
+    let bytesTransferred = 0;
+    const rangeSize = this.config.rangeSize;
+
+    const ranges: Record<string, RangeHashes> = {};
+    for (const spec of syncTablesFor('full')) {
+      ranges[spec.table] = rangeHashesForRequest(this.db, spec, rangeSize);
+    }
+
+    try {
+      const stream = this.client!.syncStream({
+        type: 'full',
+        ranges,
+        rangeSize,
+        batchSize: this.config.batchSize,
+        compression: this.config.compression,
+        codecs: supportedCompressions(),
+        vectorEncoding: this.config.vectorEncoding,
+        rangeFrames: this.rangeAcks,
+      });
+
+      // Keys the remote sent in the span being received, per table
+      const received = new Map<string, Set<number>>();
+
+      for await (const frame of readFrames(stream)) {
+        bytesTransferred += frame.length;
+        const decoded = await decodeFrame(frame);
+        if (decoded.kind === 'end') break;
+
+        const spec = findSyncTable(decoded.table);
+        if (!spec) {
+          errors.push(`Unknown sync table: ${decoded.table}`);
+          continue;
+        }
+
+        if (decoded.kind === 'range') {
+          const keys = received.get(spec.table) ?? new Set<number>();
+          received.delete(spec.table);
+          if (this.config.conflictStrategy !== 'local-wins') {
+            this.deleteMissingRows(spec, decoded.low, decoded.high, keys, errors);
+          }
+          ackRanges(this.db, spec, decoded.low, decoded.high, decoded.hashes, rangeSize);
+          continue;
+        }
+
+        let keys = received.get(spec.table);
+        if (!keys) received.set(spec.table, (keys = new Set()));
+        for (const row of decoded.rows) keys.add(row[spec.key]);
+        itemsPulled += this.applyRows(spec, decoded.rows, errors);
+        onProgress?.({ phase: 'pulling', current: itemsPulled, total: 100, itemType: decoded.table });
+      }
+
+      const now = Date.now();
+      this.syncState.lastEpisodeSync = now;
+      this.syncState.lastSkillSync = now;
+      this.syncState.lastEdgeSync = now;
+    } catch (error) {
+      const err = error as Error;
+      errors.push(err.message);
+    }
+
+    return { itemsPulled, bytesTransferred, data: { episodes: [], skills: [], edges: [] }, errors };
+  }
+
+  /**
+   * Delete local rows with low <= key <= high that the remote did not send
+   */
+  private deleteMissingRows(
+    spec: SyncTableSpec,
+    low: number,
+    high: number,
+    keep: Set<number>,
+    errors: string[]
+  ): void {
+    const local = this.db.prepare(
+      `SELECT ${spec.key} AS k FROM ${spec.table} WHERE ${spec.key} >= ? AND ${spec.key} <= ?`
+    ).all(low, high) as Array<{ k: number }>;
+    const missing = local.filter((row) => !keep.has(row.k));
+    if (missing.length === 0) return;
+
+    const stmt = this.db.prepare(`DELETE FROM ${spec.table} WHERE ${spec.key} = ?`);
+    try {
+      this.db.transaction(() => {
+        for (const row of missing) stmt.run(row.k);
+      })();
+    } catch (error) {
+      errors.push(`Failed to delete ${missing.length} ${spec.table} rows: ${(error as Error).message}`);
+    }
+  }
+
+  /**
+   * Upsert one decoded batch in a transaction
+   *
+   * Upserts rather than INSERT OR REPLACE, which would delete the row first
+   * and cascade to its embedding. Columns the local schema lacks are dropped.
+   * Under local-wins conflicting rows are kept, and the range ack stops the
+   * remote resending them.
+   */
+  private applyRows(spec: SyncTableSpec, rows: Record<string, any>[], errors: string[]): number {
+    if (rows.length === 0) return 0;
+
+    const local = new Set(tableColumns(this.db, spec.table));
+    const columns = Object.keys(rows[0]).filter((column) => local.has(column));
+    if (!local.has(spec.key) || !columns.includes(spec.key)) {
+      errors.push(`Cannot apply ${spec.table}: key column ${spec.key} missing`);
+      return 0;
+    }
+
+    const updates = columns.filter((column) => column !== spec.key);
+    const onConflict =
+      this.config.conflictStrategy === 'local-wins' || updates.length === 0
+        ? 'DO NOTHING'
+        : `DO UPDATE SET ${updates.map((column) => `${column} = excluded.${column}`).join(', ')}`;
+    const stmt = this.db.prepare(`
+      INSERT INTO ${spec.table} (${columns.join(', ')})
+      VALUES (${columns.map(() => '?').join(', ')})
+      ON CONFLICT(${spec.key}) ${onConflict}
+    `);
+
+    let applied = 0;
+    const apply = this.db.transaction((batch: Record<string, any>[]) => {
+      for (const row of batch) {
+        try {
+          stmt.run(...columns.map((column) => row[column]));
+          applied++;
+        } catch (error) {
+          // e.g. a UNIQUE column other than the key taken by a local row
+          errors.push(`${spec.table} ${row[spec.key]}: ${(error as Error).message}`);
+        }
+      }
+    });
+    apply(rows);
+    return applied;
+  }
+
   /**
    * Resolve conflicts between local and remote data
    */
@@ -9,9 +9,12 @@
  * - Batch vector operations
  * - Approximate nearest neighbors for large datasets
  * - Graceful fallback to JavaScript
- * - SIMD optimizations when available
+ * - SIMD optimizations when available (WASM SIMD128 dot-product kernel)
  */
 
+import { SimdDotKernel, blobToFloat32, dotProduct, l2Norm } from '../utils/vector-kernels.js';
+import { NormalizedVectorStore } from '../utils/NormalizedVectorStore.js';
+
 // Database type from db-fallback
 type Database = any;
 
@@ -20,6 +23,7 @@ export interface VectorSearchConfig {
   enableSIMD: boolean;
   batchSize: number;
   indexThreshold: number; // Build ANN index when vectors exceed this
+  tables?: string[]; // Tables findKNN caches and keeps in sync (default: pattern_embeddings)
 }
 
 export interface VectorSearchResult {
@@ -30,9 +34,8 @@ export interface VectorSearchResult {
 }
 
 export interface VectorIndex {
-  vectors: Float32Array[];
-  ids: number[];
-  metadata: any[];
+  /** Contiguous L2-normalized slab with parallel ids and metadata */
+  store: NormalizedVectorStore;
   built: boolean;
   lastUpdate: number;
 }
@@ -44,6 +47,9 @@ export class WASMVectorSearch {
   private wasmAvailable: boolean = false;
   private simdAvailable: boolean = false;
   private vectorIndex: VectorIndex | null = null;
+  private simdKernelAvailable: boolean = false;
+  private tableStores: Map<string, { store: NormalizedVectorStore; seq: number }> = new Map();
+  private trackedTables: Set<string> = new Set();
 
   constructor(db: Database, config?: Partial<VectorSearchConfig>) {
     this.db = db;
@@ -57,6 +63,31 @@ export class WASMVectorSearch {
 
     this.initializeWASM();
     this.detectSIMD();
+    this.initializeChangeLog();
+  }
+
+  /**
+   * Create the change log and track the configured tables that exist, so
+   * findKNN never runs DDL on the read path
+   */
+  private initializeChangeLog(): void {
+    // One row per (table, id); seq moves forward on every change
+    this.db.exec(`
+      CREATE TABLE IF NOT EXISTS wasm_vector_changes (
+        table_name TEXT NOT NULL,
+        pattern_id INTEGER NOT NULL,
+        seq INTEGER NOT NULL,
+        PRIMARY KEY (table_name, pattern_id)
+      );
+      CREATE INDEX IF NOT EXISTS idx_wasm_vector_changes_seq ON wasm_vector_changes(seq);
+    `);
+
+    for (const tableName of this.config.tables ?? ['pattern_embeddings']) {
+      const exists = this.db.prepare(
+        "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?"
+      ).get(tableName);
+      if (exists) this.trackTable(tableName);
+    }
   }
 
   /**
@@ -110,6 +141,7 @@ export class WASMVectorSearch {
         ]));
 
       if (this.simdAvailable) {
+        this.simdKernelAvailable = SimdDotKernel.create() !== null;
         console.log('[WASMVectorSearch] SIMD support detected');
       }
     } catch {
@@ -158,6 +190,9 @@ export class WASMVectorSearch {
   batchSimilarity(query: Float32Array, vectors: Float32Array[]): number[] {
     const similarities = new Array(vectors.length);
 
+    // Query norm is computed once instead of once per vector
+    const queryNorm = l2Norm(query);
+
     // Process in batches for better cache locality
     const batchSize = this.config.batchSize;
 
@@ -165,7 +200,12 @@ export class WASMVectorSearch {
       const end = Math.min(i + batchSize, vectors.length);
 
       for (let j = i; j < end; j++) {
-        similarities[j] = this.cosineSimilarity(query, vectors[j]);
+        const vector = vectors[j];
+        if (vector.length !== query.length) {
+          throw new Error('Vectors must have same length');
+        }
+        const denom = queryNorm * l2Norm(vector);
+        similarities[j] = denom === 0 ? 0 : dotProduct(query, vector) / denom;
       }
     }
 
@@ -174,6 +214,12 @@ export class WASMVectorSearch {
 
   /**
    * Find k-nearest neighbors using brute force search
+   *
+   * Vectors for each tracked table are loaded once into a normalized
+   * in-memory store and kept in sync incrementally from a trigger-maintained
+   * change log (see trackTable); untracked tables are read per query,
+   * so queries scan the hot slab instead of re-reading every BLOB. Filters
+   * only fetch matching ids from SQLite, never embeddings.
    */
   async findKNN(
     query: Float32Array,
@@ -185,56 +231,133 @@ export class WASMVectorSearch {
     }
   ): Promise<VectorSearchResult[]> {
     const threshold = options?.threshold ?? 0.0;
+    const store = this.syncTableStore(tableName, query.length);
 
     // Build WHERE clause for filters
-    const conditions: string[] = [];
-    const params: any[] = [];
+    let allow: ((id: number) => boolean) | undefined;
+    if (options?.filters && Object.keys(options.filters).length > 0) {
+      const conditions: string[] = [];
+      const params: any[] = [];
 
-    if (options?.filters) {
       Object.entries(options.filters).forEach(([key, value]) => {
         conditions.push(`${key} = ?`);
         params.push(value);
       });
+
+      const rows = this.db.prepare(`
+        SELECT pattern_id as id
+        FROM ${tableName}
+        WHERE ${conditions.join(' AND ')}
+      `).all(...params) as any[];
+
+      const allowed = new Set<number>(rows.map(row => row.id));
+      allow = (id) => allowed.has(id);
     }
 
-    const whereClause = conditions.length > 0
-      ? `WHERE ${conditions.join(' AND ')}`
-      : '';
+    return store.search(query, k, threshold, allow).map(({ id, similarity }) => ({
+      id,
+      distance: 1 - similarity, // Convert to distance
+      similarity,
+    }));
+  }
 
-    // Retrieve all vectors
-    const stmt = this.db.prepare(`
-      SELECT pattern_id as id, embedding
-      FROM ${tableName}
-      ${whereClause}
-    `);
+  /**
+   * Bring the cached store for a table up to date with SQLite
+   *
+   * Triggers on the table record each inserted, updated or deleted
+   * pattern_id in wasm_vector_changes under an increasing seq, so a query
+   * only reads the changes past the store's watermark (an indexed range
+   * scan) instead of counting the table.
+   */
+  private syncTableStore(tableName: string, dimension: number): NormalizedVectorStore {
+    let cached = this.tableStores.get(tableName);
+    if (cached && cached.store.dimension === dimension) {
+      const changes = this.db.prepare(`
+        SELECT c.seq, c.pattern_id as id, t.embedding
+        FROM wasm_vector_changes c
+        LEFT JOIN ${tableName} t ON t.pattern_id = c.pattern_id
+        WHERE c.seq > ? AND c.table_name = ?
+        ORDER BY c.seq
+      `).all(cached.seq, tableName) as any[];
+
+      for (const change of changes) {
+        const embedding = change.embedding ? blobToFloat32(change.embedding as Buffer) : null;
+        if (embedding && embedding.length === dimension) {
+          cached.store.upsert(change.id, embedding);
+        } else {
+          cached.store.remove(change.id);
+        }
+        cached.seq = change.seq;
+      }
+      return cached.store;
+    }
 
-    const rows = stmt.all(...params) as any[];
+    // Without triggers there is no change log to follow: read it all
+    if (!this.trackedTables.has(tableName)) {
+      return this.loadTableStore(tableName, dimension);
+    }
 
-    // Calculate similarities
-    const candidates = rows.map(row => {
-      const embedding = new Float32Array(
-        (row.embedding as Buffer).buffer,
-        (row.embedding as Buffer).byteOffset,
-        (row.embedding as Buffer).byteLength / 4
-      );
+    // Read the watermark first so writes during the load are replayed next time
+    const state = this.db.prepare('SELECT MAX(seq) as seq FROM wasm_vector_changes').get() as any;
+    cached = {
+      store: this.loadTableStore(tableName, dimension),
+      seq: Number(state?.seq ?? 0),
+    };
+    this.tableStores.set(tableName, cached);
+    return cached.store;
+  }
 
-      const similarity = this.cosineSimilarity(query, embedding);
-      const distance = 1 - similarity; // Convert to distance
+  private loadTableStore(tableName: string, dimension: number): NormalizedVectorStore {
+    const store = new NormalizedVectorStore(dimension, { enableSIMD: this.config.enableSIMD });
+    const rows = this.db.prepare(`
+      SELECT pattern_id as id, embedding
+      FROM ${tableName}
+      ORDER BY pattern_id
+    `).all() as any[];
 
-      return {
-        id: row.id,
-        distance,
-        similarity,
-      };
-    });
+    for (const row of rows) {
+      const embedding = blobToFloat32(row.embedding as Buffer);
+      if (embedding.length === dimension) {
+        store.upsert(row.id, embedding);
+      }
+    }
+    return store;
+  }
 
-    // Filter by threshold and sort
-    const filtered = candidates
-      .filter(c => c.similarity >= threshold)
-      .sort((a, b) => b.similarity - a.similarity)
-      .slice(0, k);
+  /**
+   * Install the triggers feeding the change log for a table, so findKNN
+   * caches its vectors; call once after creating a table not tracked at
+   * construction
+   */
+  trackTable(tableName: string): void {
+    // An upsert, not OR REPLACE: an outer INSERT OR IGNORE / ON CONFLICT
+    // would override the trigger's conflict policy
+    const record = (row: 'NEW' | 'OLD') => `
+      INSERT INTO wasm_vector_changes (table_name, pattern_id, seq)
+      VALUES ('${tableName}', ${row}.pattern_id, (SELECT COALESCE(MAX(seq), 0) + 1 FROM wasm_vector_changes))
+      ON CONFLICT (table_name, pattern_id) DO UPDATE SET seq = excluded.seq;`;
+
+    this.db.exec(`
+      CREATE TRIGGER IF NOT EXISTS wasm_vector_${tableName}_insert AFTER INSERT ON ${tableName}
+      BEGIN ${record('NEW')} END;
+      CREATE TRIGGER IF NOT EXISTS wasm_vector_${tableName}_update AFTER UPDATE ON ${tableName}
+      BEGIN ${record('OLD')} ${record('NEW')} END;
+      CREATE TRIGGER IF NOT EXISTS wasm_vector_${tableName}_delete AFTER DELETE ON ${tableName}
+      BEGIN ${record('OLD')} END;
+    `);
+    this.trackedTables.add(tableName);
+    this.tableStores.delete(tableName);
+  }
 
-    return filtered;
+  /**
+   * Drop cached vectors for a table (or all tables)
+   */
+  invalidateCache(tableName?: string): void {
+    if (tableName) {
+      this.tableStores.delete(tableName);
+    } else {
+      this.tableStores.clear();
+    }
   }
 
   /**
@@ -248,10 +371,19 @@ export class WASMVectorSearch {
 
     console.log(`[WASMVectorSearch] Building ANN index for ${vectors.length} vectors...`);
 
+    // Pack into one contiguous, pre-normalized slab
+    const dimension = vectors.length > 0 ? vectors[0].length : 0;
+    const store = new NormalizedVectorStore(dimension, {
+      initialCapacity: vectors.length,
+      enableSIMD: this.config.enableSIMD,
+    });
+
+    for (let i = 0; i < vectors.length; i++) {
+      store.upsert(ids[i], vectors[i], metadata?.[i]);
+    }
+
     this.vectorIndex = {
-      vectors,
-      ids,
-      metadata: metadata || [],
+      store,
       built: true,
       lastUpdate: Date.now(),
     };
@@ -260,32 +392,46 @@ export class WASMVectorSearch {
   }
 
   /**
-   * Search using ANN index (if available)
+   * Append or overwrite a single vector in the built index
    */
-  searchIndex(query: Float32Array, k: number, threshold?: number): VectorSearchResult[] {
+  addToIndex(id: number, vector: Float32Array, metadata?: any): void {
     if (!this.vectorIndex || !this.vectorIndex.built) {
       throw new Error('Index not built. Call buildIndex() first.');
     }
+    this.vectorIndex.store.upsert(id, vector, metadata);
+    this.vectorIndex.lastUpdate = Date.now();
+  }
 
-    const similarities = this.batchSimilarity(query, this.vectorIndex.vectors);
-
-    const results: VectorSearchResult[] = [];
-    for (let i = 0; i < similarities.length; i++) {
-      const similarity = similarities[i];
+  /**
+   * Tombstone a vector in the built index
+   */
+  removeFromIndex(id: number): boolean {
+    if (!this.vectorIndex || !this.vectorIndex.built) {
+      throw new Error('Index not built. Call buildIndex() first.');
+    }
+    const removed = this.vectorIndex.store.remove(id);
+    if (removed) {
+      this.vectorIndex.lastUpdate = Date.now();
+    }
+    return removed;
+  }
 
-      if (threshold === undefined || similarity >= threshold) {
-        results.push({
-          id: this.vectorIndex.ids[i],
-          distance: 1 - similarity,
-          similarity,
-          metadata: this.vectorIndex.metadata[i],
-        });
-      }
+  /**
+   * Search using ANN index (if available)
+   */
+  searchIndex(query: Float32Array, k: number, threshold?: number): VectorSearchResult[] {
+    if (!this.vectorIndex || !this.vectorIndex.built) {
+      throw new Error('Index not built. Call buildIndex() first.');
     }
 
-    // Sort by similarity and take top k
-    results.sort((a, b) => b.similarity - a.similarity);
-    return results.slice(0, k);
+    // Rows are unit length, so one dot-product pass (SIMD when available)
+    // plus heap-based top-k selection replaces per-pair cosine and full sort
+    return this.vectorIndex.store.search(query, k, threshold).map(({ id, similarity, metadata }) => ({
+      id,
+      distance: 1 - similarity,
+      similarity,
+      metadata,
+    }));
   }
 
   /**
@@ -297,13 +443,24 @@ export class WASMVectorSearch {
     indexBuilt: boolean;
     indexSize: number;
     lastIndexUpdate: number | null;
+    simdKernel: boolean;
+    cachedTables: number;
+    cachedVectors: number;
   } {
+    let cachedVectors = 0;
+    for (const { store } of this.tableStores.values()) {
+      cachedVectors += store.size;
+    }
+
     return {
       wasmAvailable: this.wasmAvailable,
       simdAvailable: this.simdAvailable,
+      simdKernel: this.simdKernelAvailable,
       indexBuilt: this.vectorIndex?.built ?? false,
-      indexSize: this.vectorIndex?.vectors.length ?? 0,
+      indexSize: this.vectorIndex?.store.size ?? 0,
       lastIndexUpdate: this.vectorIndex?.lastUpdate ?? null,
+      cachedTables: this.tableStores.size,
+      cachedVectors,
     };
   }
 
@@ -10,6 +10,7 @@ export { EmbeddingService } from './EmbeddingService.js';
 export { WASMVectorSearch } from './WASMVectorSearch.js';
 export { HNSWIndex } from './HNSWIndex.js';
 export { EnhancedEmbeddingService } from './EnhancedEmbeddingService.js';
+export { PersistentEmbeddingCache } from './PersistentEmbeddingCache.js';
 export { MMRDiversityRanker } from './MMRDiversityRanker.js';
 export { ContextSynthesizer } from './ContextSynthesizer.js';
 export { MetadataFilter } from './MetadataFilter.js';
@@ -21,13 +22,15 @@ export { AttentionService } from './AttentionService.js';
 export type { Episode, EpisodeWithEmbedding, ReflexionQuery } from './ReflexionMemory.js';
 export type { Skill, SkillLink, SkillQuery } from './SkillLibrary.js';
 export type { EmbeddingConfig } from './EmbeddingService.js';
+export type { PersistentEmbeddingCacheOptions } from './PersistentEmbeddingCache.js';
 export type { VectorSearchConfig, VectorSearchResult, VectorIndex } from './WASMVectorSearch.js';
-export type { HNSWConfig, HNSWSearchResult, HNSWStats } from './HNSWIndex.js';
+export type { HNSWConfig, HNSWBuildOptions, HNSWSearchResult, HNSWStats } from './HNSWIndex.js';
 export type { EnhancedEmbeddingConfig } from './EnhancedEmbeddingService.js';
 export type { MMROptions, MMRCandidate } from './MMRDiversityRanker.js';
 export type { MemoryPattern, SynthesizedContext } from './ContextSynthesizer.js';
 export type { MetadataFilters, FilterableItem, FilterOperator, FilterValue } from './MetadataFilter.js';
-export type { QUICServerConfig, SyncRequest, SyncResponse } from './QUICServer.js';
+export type { QUICServerConfig, SyncRequest, SyncResponse, StreamSyncRequest } from './QUICServer.js';
 export type { QUICClientConfig, SyncOptions, SyncResult, SyncProgress } from './QUICClient.js';
 export type { SyncCoordinatorConfig, SyncState, SyncReport } from './SyncCoordinator.js';
-export type { AttentionConfig, AttentionResult, AttentionStats } from './AttentionService.js';
+export type { AttentionConfig, AttentionResult, AttentionStats, AttentionBatchInput, AttentionBatchResult } from './AttentionService.js';
+export type { RetrievalMode, FusionOptions } from '../utils/LexicalIndex.js';
@@ -76,6 +76,7 @@ export class AgentDB {
     // Initialize controllers
     this.reflexion = new ReflexionMemory(this.db, this.embedder);
     this.skills = new SkillLibrary(this.db, this.embedder);
+    this.skills.setEpisodeBackend(this.reflexion.getEpisodeBackend());
     this.causalGraph = new CausalMemoryGraph(this.db);
 
     this.initialized = true;
@@ -3,7 +3,7 @@
  *
  * Provides 20-40% speedup on repeated queries through intelligent caching.
  * Features:
- * - LRU (Least Recently Used) eviction policy
+ * - O(1) LRU (Least Recently Used) eviction with an entry cap and byte budget
  * - TTL (Time To Live) support for cache entries
  * - Thread-safe operations
  * - Automatic cache invalidation on writes
@@ -11,6 +11,8 @@
  * - Memory-efficient (size-based limits)
  */
 
+import { LRUCache, hashKey } from '../utils/LRUCache.js';
+
 export interface QueryCacheConfig {
   /** Maximum number of cache entries (default: 1000) */
   maxSize?: number;
@@ -20,6 +22,8 @@ export interface QueryCacheConfig {
   enabled?: boolean;
   /** Maximum size in bytes for cached results (default: 10MB) */
   maxResultSize?: number;
+  /** Total byte budget across all entries (default: 64MB) */
+  maxBytes?: number;
 }
 
 export interface CacheEntry<T = any> {
@@ -58,12 +62,10 @@ export interface CacheStatistics {
 
 export class QueryCache {
   private config: Required<QueryCacheConfig>;
-  private cache: Map<string, CacheEntry>;
-  private accessOrder: string[]; // LRU tracking
+  private cache: LRUCache<CacheEntry>;
   private stats: {
     hits: number;
     misses: number;
-    evictions: number;
   };
 
   constructor(config: QueryCacheConfig = {}) {
@@ -72,14 +74,16 @@ export class QueryCache {
       defaultTTL: config.defaultTTL ?? 5 * 60 * 1000, // 5 minutes
       enabled: config.enabled ?? true,
       maxResultSize: config.maxResultSize ?? 10 * 1024 * 1024, // 10MB
+      maxBytes: config.maxBytes ?? 64 * 1024 * 1024, // 64MB
     };
 
-    this.cache = new Map();
-    this.accessOrder = [];
+    this.cache = new LRUCache<CacheEntry>({
+      maxEntries: this.config.maxSize,
+      maxBytes: this.config.maxBytes,
+    });
     this.stats = {
       hits: 0,
       misses: 0,
-      evictions: 0,
     };
   }
 
@@ -88,9 +92,8 @@ export class QueryCache {
    */
   generateKey(sql: string, params: any[] = [], category: string = 'query'): string {
     const paramStr = params.length > 0 ? JSON.stringify(params) : '';
-    // Use a simple hash for better performance
-    const hash = this.hashCode(`${category}:${sql}:${paramStr}`);
-    return `${category}:${hash}`;
+    // Fixed-length digest: keys stay small and collisions can't return wrong rows
+    return `${category}:${hashKey(category, sql, paramStr)}`;
   }
 
   /**
@@ -101,7 +104,7 @@ export class QueryCache {
       return undefined;
     }
 
-    const entry = this.cache.get(key);
+    const entry = this.cache.peek(key);
 
     if (!entry) {
       this.stats.misses++;
@@ -112,13 +115,12 @@ export class QueryCache {
     const now = Date.now();
     if (now - entry.timestamp > entry.ttl) {
       this.cache.delete(key);
-      this.removeFromAccessOrder(key);
       this.stats.misses++;
       return undefined;
     }
 
-    // Update access order (move to end = most recently used)
-    this.updateAccessOrder(key);
+    // Mark most recently used
+    this.cache.get(key);
     entry.hits++;
     this.stats.hits++;
 
@@ -140,11 +142,6 @@ export class QueryCache {
       return;
     }
 
-    // Check if we need to evict entries
-    if (this.cache.size >= this.config.maxSize && !this.cache.has(key)) {
-      this.evictLRU();
-    }
-
     const entry: CacheEntry<T> = {
       value,
       key,
@@ -154,8 +151,8 @@ export class QueryCache {
       hits: 0,
     };
 
-    this.cache.set(key, entry);
-    this.updateAccessOrder(key);
+    // Evicts least recently used entries past maxSize / maxBytes
+    this.cache.set(key, entry, size);
   }
 
   /**
@@ -166,7 +163,7 @@ export class QueryCache {
       return false;
     }
 
-    const entry = this.cache.get(key);
+    const entry = this.cache.peek(key);
     if (!entry) {
       return false;
     }
@@ -175,7 +172,6 @@ export class QueryCache {
     const now = Date.now();
     if (now - entry.timestamp > entry.ttl) {
       this.cache.delete(key);
-      this.removeFromAccessOrder(key);
       return false;
     }
 
@@ -186,11 +182,7 @@ export class QueryCache {
    * Delete specific key from cache
    */
   delete(key: string): boolean {
-    const deleted = this.cache.delete(key);
-    if (deleted) {
-      this.removeFromAccessOrder(key);
-    }
-    return deleted;
+    return this.cache.delete(key);
   }
 
   /**
@@ -200,7 +192,7 @@ export class QueryCache {
     let count = 0;
     const keysToDelete: string[] = [];
 
-    for (const [key] of this.cache) {
+    for (const key of this.cache.keys()) {
       if (key.startsWith(`${category}:`)) {
         keysToDelete.push(key);
       }
@@ -219,7 +211,6 @@ export class QueryCache {
    */
   clear(): void {
     this.cache.clear();
-    this.accessOrder = [];
   }
 
   /**
@@ -229,12 +220,9 @@ export class QueryCache {
     const total = this.stats.hits + this.stats.misses;
     const hitRate = total > 0 ? (this.stats.hits / total) * 100 : 0;
 
-    let memoryUsed = 0;
     const entriesByCategory: Record<string, number> = {};
 
-    for (const [key, entry] of this.cache) {
-      memoryUsed += entry.size;
-
+    for (const key of this.cache.keys()) {
       const category = key.split(':')[0];
       entriesByCategory[category] = (entriesByCategory[category] || 0) + 1;
     }
@@ -245,8 +233,8 @@ export class QueryCache {
       hitRate: Math.round(hitRate * 100) / 100,
       size: this.cache.size,
       capacity: this.config.maxSize,
-      evictions: this.stats.evictions,
-      memoryUsed,
+      evictions: this.cache.getStats().evictions,
+      memoryUsed: this.cache.bytes,
       entriesByCategory,
     };
   }
@@ -258,8 +246,8 @@ export class QueryCache {
     this.stats = {
       hits: 0,
       misses: 0,
-      evictions: 0,
     };
+    this.cache.resetStats();
   }
 
   /**
@@ -269,7 +257,7 @@ export class QueryCache {
     const now = Date.now();
     const keysToDelete: string[] = [];
 
-    for (const [key, entry] of this.cache) {
+    for (const [key, entry] of this.cache.entries()) {
       if (now - entry.timestamp > entry.ttl) {
         keysToDelete.push(key);
       }
@@ -315,60 +303,13 @@ export class QueryCache {
    */
   updateConfig(config: Partial<QueryCacheConfig>): void {
     Object.assign(this.config, config);
+    this.cache.setLimits({ maxEntries: this.config.maxSize, maxBytes: this.config.maxBytes });
   }
 
   // ========================================================================
   // Private Helper Methods
   // ========================================================================
 
-  /**
-   * Evict least recently used entry
-   */
-  private evictLRU(): void {
-    if (this.accessOrder.length === 0) {
-      return;
-    }
-
-    // First entry is least recently used
-    const lruKey = this.accessOrder[0];
-    this.cache.delete(lruKey);
-    this.accessOrder.shift();
-    this.stats.evictions++;
-  }
-
-  /**
-   * Update access order for LRU tracking
-   */
-  private updateAccessOrder(key: string): void {
-    // Remove from current position
-    this.removeFromAccessOrder(key);
-    // Add to end (most recently used)
-    this.accessOrder.push(key);
-  }
-
-  /**
-   * Remove key from access order
-   */
-  private removeFromAccessOrder(key: string): void {
-    const index = this.accessOrder.indexOf(key);
-    if (index !== -1) {
-      this.accessOrder.splice(index, 1);
-    }
-  }
-
-  /**
-   * Simple string hash function for key generation
-   */
-  private hashCode(str: string): string {
-    let hash = 0;
-    for (let i = 0; i < str.length; i++) {
-      const char = str.charCodeAt(i);
-      hash = (hash << 5) - hash + char;
-      hash = hash & hash; // Convert to 32-bit integer
-    }
-    return Math.abs(hash).toString(36);
-  }
-
   /**
    * Estimate size of cached value in bytes
    */
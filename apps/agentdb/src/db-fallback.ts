@@ -16,6 +16,9 @@ type Database = any;
 
 let sqlJsWrapper: any = null;
 
+// Live statements above which the wrapper warns about a leak
+const MAX_ACTIVE_STATEMENTS = 50;
+
 /**
  * Get sql.js database implementation (ONLY sql.js, no better-sqlite3)
  */
@@ -56,6 +59,7 @@ function createSqlJsWrapper(SQL: any) {
     private activeStatements: Map<number, any> = new Map();
     private statementCounter: number = 0;
     private intervalId: NodeJS.Timeout | null = null;
+    readonly maxActiveStatements = MAX_ACTIVE_STATEMENTS;
 
     constructor(filename: string, options?: any) {
       this.filename = filename;
@@ -80,7 +84,7 @@ function createSqlJsWrapper(SQL: any) {
 
       // Warn if too many active statements (memory leak detection)
       this.intervalId = setInterval(() => {
-        if (this.activeStatements.size > 50) {
+        if (this.activeStatements.size > MAX_ACTIVE_STATEMENTS) {
           console.warn(`⚠️  Detected ${this.activeStatements.size} active SQL statements - possible memory leak`);
         }
       }, 10000);
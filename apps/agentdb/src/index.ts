@@ -27,6 +27,7 @@ export { ReasoningBank } from './controllers/ReasoningBank.js';
 // Embedding services
 export { EmbeddingService } from './controllers/EmbeddingService.js';
 export { EnhancedEmbeddingService } from './controllers/EnhancedEmbeddingService.js';
+export { PersistentEmbeddingCache } from './controllers/PersistentEmbeddingCache.js';
 
 // WASM acceleration and HNSW indexing
 export { WASMVectorSearch } from './controllers/WASMVectorSearch.js';
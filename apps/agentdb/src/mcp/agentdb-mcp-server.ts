@@ -23,7 +23,7 @@ import { LearningSystem } from '../controllers/LearningSystem.js';
 import { EmbeddingService } from '../controllers/EmbeddingService.js';
 import { BatchOperations } from '../optimizations/BatchOperations.js';
 import { ReasoningBank } from '../controllers/ReasoningBank.js';
-import { MCPToolCaches } from '../optimizations/ToolCache.js';
+import { MCPToolCaches, type ToolCache } from '../optimizations/ToolCache.js';
 import {
   validateId,
   validateTimestamp,
@@ -267,6 +267,7 @@ await embeddingService.initialize();
 const causalGraph = new CausalMemoryGraph(db);
 const reflexion = new ReflexionMemory(db, embeddingService);
 const skills = new SkillLibrary(db, embeddingService);
+skills.setEpisodeBackend(reflexion.getEpisodeBackend());
 const causalRecall = new CausalRecall(db, embeddingService);
 const learner = new NightlyLearner(db, embeddingService);
 const learningSystem = new LearningSystem(db, embeddingService);
@@ -274,6 +275,36 @@ const batchOps = new BatchOperations(db, embeddingService);
 const reasoningBank = new ReasoningBank(db, embeddingService);
 const caches = new MCPToolCaches();
 
+// ============================================================================
+// Cached Search Results
+// ============================================================================
+
+/** Aborted by the SDK when the client cancels the call (notifications/cancelled) */
+interface ToolCallExtra {
+  signal?: AbortSignal;
+}
+
+/**
+ * Cached search results, keyed by tool, query embedding hash and params.
+ * Entries are tagged with the data source that invalidates them.
+ */
+async function cachedSearch<T>(
+  cache: ToolCache<T[]>,
+  tool: string,
+  queryText: string,
+  params: Record<string, unknown>,
+  tag: string,
+  run: () => Promise<T[]>
+): Promise<T[]> {
+  const key = MCPToolCaches.searchKey(tool, await embeddingService.embed(queryText), params);
+  const cached = cache.get(key);
+  if (cached) return cached;
+
+  const results = await run();
+  cache.set(key, results, undefined, [tag]);
+  return results;
+}
+
 // ============================================================================
 // MCP Server Setup
 // ============================================================================
@@ -889,8 +920,9 @@ server.setRequestHandler(ListToolsRequestSchema, async () => {
   return { tools };
 });
 
-server.setRequestHandler(CallToolRequestSchema, async (request) => {
+server.setRequestHandler(CallToolRequestSchema, async (request, extra?: ToolCallExtra) => {
   const { name, arguments: args } = request.params;
+  const signal = extra?.signal;
 
   try {
     switch (name) {
@@ -902,6 +934,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
 
         if (args?.reset && fs.existsSync(targetDbPath)) {
           fs.unlinkSync(targetDbPath);
+          caches.clearAll();
         }
 
         // Initialize schema
@@ -942,6 +975,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           tags,
           metadata,
         });
+        caches.invalidate('episodes');
 
         return {
           content: [
@@ -981,6 +1015,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
         });
 
         const inserted = await batchOpsConfig.insertEpisodes(episodes);
+        caches.invalidate('episodes');
 
         return {
           content: [
@@ -1014,7 +1049,11 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           // Session ID filter would require custom query
         }
 
-        const results = await reflexion.retrieveRelevant(query);
+        query.signal = signal;
+        const results = await cachedSearch(
+          caches.searches, 'agentdb_search', queryText, { k, minReward: query.minReward }, 'episodes',
+          () => reflexion.retrieveRelevant(query)
+        );
 
         // Filter by minimum similarity if specified
         let filteredResults = results;
@@ -1022,6 +1061,11 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           filteredResults = results.filter(r => (r.similarity || 0) >= minSimilarity);
         }
 
+        const formatResult = (r: typeof filteredResults[number], i: number) =>
+          `${i + 1}. [ID: ${r.id}] Similarity: ${(r.similarity || 0).toFixed(3)}\n` +
+          `   Task: ${r.task.substring(0, 80)}${r.task.length > 80 ? '...' : ''}\n` +
+          `   Reward: ${r.reward.toFixed(2)}`;
+
         return {
           content: [
             {
@@ -1030,11 +1074,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
                     `📊 Found: ${filteredResults.length} results\n` +
                     `🎯 Query: ${queryText}\n\n` +
                     `Top Results:\n` +
-                    filteredResults.slice(0, 5).map((r, i) =>
-                      `${i + 1}. [ID: ${r.id}] Similarity: ${(r.similarity || 0).toFixed(3)}\n` +
-                      `   Task: ${r.task.substring(0, 80)}${r.task.length > 80 ? '...' : ''}\n` +
-                      `   Reward: ${r.reward.toFixed(2)}`
-                    ).join('\n\n') +
+                    filteredResults.slice(0, 5).map(formatResult).join('\n\n') +
                     (filteredResults.length > 5 ? `\n\n... and ${filteredResults.length - 5} more results` : ''),
             },
           ],
@@ -1080,6 +1120,8 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
             throw new ValidationError('Either id or filters must be provided', 'MISSING_PARAMETER');
           }
 
+          if (deleted > 0) caches.invalidate('episodes');
+
           return {
             content: [
               {
@@ -1119,6 +1161,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           latencyMs: (args?.latency_ms as number) || 0,
           tokensUsed: (args?.tokens as number) || 0,
         });
+        caches.invalidate('episodes');
         return {
           content: [
             {
@@ -1130,21 +1173,26 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
       }
 
       case 'reflexion_retrieve': {
-        const episodes = await reflexion.retrieveRelevant({
+        const query = {
           task: args?.task as string,
           k: (args?.k as number) || 5,
           onlyFailures: args?.only_failures as boolean | undefined,
           onlySuccesses: args?.only_successes as boolean | undefined,
           minReward: args?.min_reward as number | undefined,
-        });
+        };
+        const { task, ...params } = query;
+        const episodes = await cachedSearch(
+          caches.searches, 'reflexion_retrieve', task, params, 'episodes',
+          () => reflexion.retrieveRelevant({ ...query, signal })
+        );
+
+        const formatEpisode = (ep: typeof episodes[number], i: number) =>
+          `${i + 1}. Episode ${ep.id}\n   Task: ${ep.task}\n   Reward: ${ep.reward.toFixed(2)}\n   Similarity: ${ep.similarity?.toFixed(3) || 'N/A'}`;
         return {
           content: [
             {
               type: 'text',
-              text: `🔍 Retrieved ${episodes.length} episodes:\n\n` +
-                episodes.map((ep, i) =>
-                  `${i + 1}. Episode ${ep.id}\n   Task: ${ep.task}\n   Reward: ${ep.reward.toFixed(2)}\n   Similarity: ${ep.similarity?.toFixed(3) || 'N/A'}`
-                ).join('\n\n'),
+              text: `🔍 Retrieved ${episodes.length} episodes:\n\n` + episodes.map(formatEpisode).join('\n\n'),
             },
           ],
         };
@@ -1161,6 +1209,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           avgReward: 0.0,
           avgLatencyMs: 0.0,
         });
+        caches.invalidate('skills');
         return {
           content: [
             {
@@ -1172,19 +1221,22 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
       }
 
       case 'skill_search': {
-        const foundSkills = await skills.searchSkills({
-          task: args?.task as string,
-          k: (args?.k as number) || 10,
-          minSuccessRate: (args?.min_success_rate as number) || 0.0,
-        });
+        const task = args?.task as string;
+        const k = (args?.k as number) || 10;
+        const minSuccessRate = (args?.min_success_rate as number) || 0.0;
+        const foundSkills = await cachedSearch(
+          caches.patterns, 'skill_search', task, { k, minSuccessRate }, 'skills',
+          () => skills.searchSkills({ task, k, minSuccessRate })
+        );
+        signal?.throwIfAborted();
+
+        const formatSkill = (skill: typeof foundSkills[number], i: number) =>
+          `${i + 1}. ${skill.name}\n   ${skill.description}\n   Success: ${(skill.successRate * 100).toFixed(1)}%`;
         return {
           content: [
             {
               type: 'text',
-              text: `🔍 Found ${foundSkills.length} skills:\n\n` +
-                foundSkills.map((skill, i) =>
-                  `${i + 1}. ${skill.name}\n   ${skill.description}\n   Success: ${(skill.successRate * 100).toFixed(1)}%`
-                ).join('\n\n'),
+              text: `🔍 Found ${foundSkills.length} skills:\n\n` + foundSkills.map(formatSkill).join('\n\n'),
             },
           ],
         };
@@ -1425,6 +1477,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           tags,
           metadata,
         });
+        caches.invalidate('patterns');
 
         return {
           content: [
@@ -1448,19 +1501,30 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
         const threshold = (args?.threshold as number) || 0.0;
         const filters = args?.filters as any;
 
-        // Generate embedding for the task
-        const taskEmbedding = await embeddingService.embed(task);
+        const searchFilters = filters ? {
+          taskType: filters.taskType,
+          minSuccessRate: filters.minSuccessRate,
+          tags: filters.tags,
+        } : undefined;
+
+        const patterns = await cachedSearch(
+          caches.patterns, 'agentdb_pattern_search', task, { k, threshold, filters: searchFilters }, 'patterns',
+          // Embedding was just computed for the cache key (EmbeddingService caches it)
+          async () => reasoningBank.searchPatterns({
+            taskEmbedding: await embeddingService.embed(task),
+            k,
+            threshold,
+            filters: searchFilters,
+          })
+        );
+        signal?.throwIfAborted();
 
-        const patterns = await reasoningBank.searchPatterns({
-          taskEmbedding,
-          k,
-          threshold,
-          filters: filters ? {
-            taskType: filters.taskType,
-            minSuccessRate: filters.minSuccessRate,
-            tags: filters.tags,
-          } : undefined,
-        });
+        const formatPattern = (p: typeof patterns[number], i: number) =>
+          `${i + 1}. [ID: ${p.id}] ${p.taskType}\n` +
+          `   Similarity: ${(p.similarity || 0).toFixed(3)}\n` +
+          `   Success Rate: ${(p.successRate * 100).toFixed(1)}%\n` +
+          `   Approach: ${p.approach.substring(0, 80)}${p.approach.length > 80 ? '...' : ''}\n` +
+          `   Uses: ${p.uses || 0}`;
 
         return {
           content: [
@@ -1471,13 +1535,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
                 `🎯 Query: ${task}\n` +
                 `🎚️  Threshold: ${threshold.toFixed(2)}\n\n` +
                 `Top Results:\n` +
-                patterns.slice(0, 5).map((p, i) =>
-                  `${i + 1}. [ID: ${p.id}] ${p.taskType}\n` +
-                  `   Similarity: ${(p.similarity || 0).toFixed(3)}\n` +
-                  `   Success Rate: ${(p.successRate * 100).toFixed(1)}%\n` +
-                  `   Approach: ${p.approach.substring(0, 80)}${p.approach.length > 80 ? '...' : ''}\n` +
-                  `   Uses: ${p.uses || 0}`
-                ).join('\n\n') +
+                patterns.slice(0, 5).map(formatPattern).join('\n\n') +
                 (patterns.length > 5 ? `\n\n... and ${patterns.length - 5} more patterns` : ''),
             },
           ],
@@ -1601,6 +1659,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           });
 
           const skillIds = await batchOpsConfig.insertSkills(validatedSkills);
+          caches.invalidate('skills');
           const duration = Date.now() - startTime;
 
           // Format response
@@ -1708,6 +1767,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           });
 
           const insertedCount = await batchOpsConfig.insertEpisodes(validatedEpisodes);
+          caches.invalidate('episodes');
           const duration = Date.now() - startTime;
 
           // Format response
@@ -1806,6 +1866,7 @@ server.setRequestHandler(CallToolRequestSchema, async (request) => {
           });
 
           const patternIds = await batchOpsConfig.insertPatterns(validatedPatterns);
+          caches.invalidate('patterns');
           const duration = Date.now() - startTime;
 
           // Format response
@@ -13,3 +13,16 @@ export {
   createSpanAttributes,
   recordErrorWithContext,
 } from './integration';
+
+export {
+  LatencyHistogram,
+  StageTrace,
+  startTrace,
+  recordLatency,
+  stageHistogram,
+  latencySnapshot,
+  resetLatencyHistograms,
+  renderPrometheus,
+  setSpanSink,
+} from './latency';
+export type { HistogramSnapshot, SampledTrace } from './latency';
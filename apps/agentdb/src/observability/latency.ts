@@ -0,0 +1,271 @@
+/**
+ * Hot-path latency histograms and per-stage tracing
+ *
+ * HDR-style log-linear histograms over microseconds: each power-of-two range
+ * is split into 32 linear sub-buckets, so recorded values keep ~3% relative
+ * precision from 1us to ~35min in a fixed, preallocated array. Recording is
+ * an index computation and an increment; nothing allocates after creation.
+ *
+ * Stage traces split one operation (e.g. ReflexionMemory.retrieveRelevant)
+ * into named stages, each with its own histogram. A sampled fraction of
+ * traces is also handed to the span sink that TelemetryManager registers,
+ * so full spans cost nothing on unsampled calls.
+ *
+ * This module has no side effects on import; hot paths import it directly.
+ */
+
+// Linear sub-buckets per power of two (2^5)
+const SUB_BUCKET_BITS = 5;
+const SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const MAX_MAGNITUDE = 31;
+const BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+const MAX_VALUE_US = 2 ** 31 - 1;
+
+const now = typeof performance !== 'undefined' ? () => performance.now() : () => Date.now();
+
+export interface HistogramSnapshot {
+  count: number;
+  /** Values in milliseconds */
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  p999: number;
+}
+
+export class LatencyHistogram {
+  private counts = new Float64Array(BUCKET_COUNT);
+  private _count = 0;
+  private sumUs = 0;
+  private minUs = Infinity;
+  private maxUs = 0;
+
+  get count(): number {
+    return this._count;
+  }
+
+  /** Sum of recorded values in milliseconds */
+  get sum(): number {
+    return this.sumUs / 1000;
+  }
+
+  /**
+   * Record a duration in milliseconds (fractional, e.g. from performance.now())
+   */
+  record(ms: number): void {
+    const us = Math.min(Math.max(Math.round(ms * 1000), 0), MAX_VALUE_US);
+    this.counts[bucketIndex(us)]++;
+    this._count++;
+    this.sumUs += us;
+    if (us < this.minUs) this.minUs = us;
+    if (us > this.maxUs) this.maxUs = us;
+  }
+
+  /**
+   * Value at quantile q (0-1) in milliseconds, as the upper edge of its bucket
+   */
+  percentile(q: number): number {
+    if (this._count === 0) return 0;
+    const rank = Math.max(1, Math.ceil(q * this._count));
+    let seen = 0;
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      seen += this.counts[i];
+      if (seen >= rank) return Math.min(bucketUpper(i), this.maxUs) / 1000;
+    }
+    return this.maxUs / 1000;
+  }
+
+  snapshot(): HistogramSnapshot {
+    return {
+      count: this._count,
+      min: this._count ? this.minUs / 1000 : 0,
+      max: this.maxUs / 1000,
+      mean: this._count ? this.sumUs / this._count / 1000 : 0,
+      p50: this.percentile(0.5),
+      p90: this.percentile(0.9),
+      p99: this.percentile(0.99),
+      p999: this.percentile(0.999),
+    };
+  }
+
+  /**
+   * Add another histogram's counts into this one
+   */
+  merge(other: LatencyHistogram): void {
+    for (let i = 0; i < BUCKET_COUNT; i++) this.counts[i] += other.counts[i];
+    this._count += other._count;
+    this.sumUs += other.sumUs;
+    this.minUs = Math.min(this.minUs, other.minUs);
+    this.maxUs = Math.max(this.maxUs, other.maxUs);
+  }
+
+  reset(): void {
+    this.counts.fill(0);
+    this._count = 0;
+    this.sumUs = 0;
+    this.minUs = Infinity;
+    this.maxUs = 0;
+  }
+}
+
+function bucketIndex(us: number): number {
+  if (us < SUB_BUCKETS) return us;
+  const magnitude = 31 - Math.clz32(us);
+  const shift = magnitude - SUB_BUCKET_BITS;
+  return shift * SUB_BUCKETS + (us >>> shift);
+}
+
+function bucketUpper(index: number): number {
+  if (index < SUB_BUCKETS) return index;
+  const shift = Math.floor(index / SUB_BUCKETS) - 1;
+  const sub = (index % SUB_BUCKETS) + SUB_BUCKETS;
+  return (sub + 1) * 2 ** shift - 1;
+}
+
+/**
+ * A finished, sampled trace as handed to the span sink
+ */
+export interface SampledTrace {
+  operation: string;
+  /** performance.now() at start, ms */
+  startTime: number;
+  durationMs: number;
+  stages: Array<{ stage: string; durationMs: number }>;
+  error?: unknown;
+}
+
+const histograms = new Map<string, Map<string, LatencyHistogram>>();
+let spanSink: ((trace: SampledTrace) => void) | null = null;
+let spanSampleRate = 0.01;
+
+/**
+ * Histogram for one stage of an operation, created on first use
+ */
+export function stageHistogram(operation: string, stage: string): LatencyHistogram {
+  let stages = histograms.get(operation);
+  if (!stages) histograms.set(operation, (stages = new Map()));
+  let histogram = stages.get(stage);
+  if (!histogram) stages.set(stage, (histogram = new LatencyHistogram()));
+  return histogram;
+}
+
+/**
+ * Record one duration directly (single-stage operations)
+ */
+export function recordLatency(operation: string, stage: string, ms: number): void {
+  stageHistogram(operation, stage).record(ms);
+}
+
+/**
+ * Route sampled traces to a span exporter; rate is the fraction of traces sampled
+ */
+export function setSpanSink(sink: ((trace: SampledTrace) => void) | null, sampleRate: number = spanSampleRate): void {
+  spanSink = sink;
+  spanSampleRate = Math.min(Math.max(sampleRate, 0), 1);
+}
+
+export class StageTrace {
+  private readonly startTime: number;
+  private last: number;
+  private readonly stageHistograms: Map<string, LatencyHistogram>;
+  private readonly sampled: SampledTrace['stages'] | null;
+
+  constructor(private readonly operation: string) {
+    this.startTime = now();
+    this.last = this.startTime;
+    let stages = histograms.get(operation);
+    if (!stages) histograms.set(operation, (stages = new Map()));
+    this.stageHistograms = stages;
+    this.sampled = spanSink && Math.random() < spanSampleRate ? [] : null;
+  }
+
+  /**
+   * Close the stage that ran since the previous mark (or the start)
+   */
+  stage(name: string): void {
+    const t = now();
+    const durationMs = t - this.last;
+    this.last = t;
+    let histogram = this.stageHistograms.get(name);
+    if (!histogram) this.stageHistograms.set(name, (histogram = new LatencyHistogram()));
+    histogram.record(durationMs);
+    this.sampled?.push({ stage: name, durationMs });
+  }
+
+  /**
+   * Record the whole operation under the 'total' stage
+   */
+  end(error?: unknown): void {
+    const durationMs = now() - this.startTime;
+    let total = this.stageHistograms.get('total');
+    if (!total) this.stageHistograms.set('total', (total = new LatencyHistogram()));
+    total.record(durationMs);
+
+    if (this.sampled && spanSink) {
+      try {
+        spanSink({ operation: this.operation, startTime: this.startTime, durationMs, stages: this.sampled, error });
+      } catch {
+        // Span export must never break the traced operation
+      }
+    }
+  }
+}
+
+/**
+ * Start timing an operation; call stage() after each step and end() once
+ */
+export function startTrace(operation: string): StageTrace {
+  return new StageTrace(operation);
+}
+
+/**
+ * Snapshots of every stage histogram, keyed `operation` -> `stage`
+ */
+export function latencySnapshot(): Record<string, Record<string, HistogramSnapshot>> {
+  const result: Record<string, Record<string, HistogramSnapshot>> = {};
+  for (const [operation, stages] of histograms) {
+    result[operation] = {};
+    for (const [stage, histogram] of stages) result[operation][stage] = histogram.snapshot();
+  }
+  return result;
+}
+
+export function resetLatencyHistograms(): void {
+  for (const stages of histograms.values()) {
+    for (const histogram of stages.values()) histogram.reset();
+  }
+}
+
+const PROMETHEUS_QUANTILES = [0.5, 0.9, 0.99, 0.999];
+
+/**
+ * Stage histograms in Prometheus text exposition format, as a summary in
+ * seconds labelled by operation and stage
+ */
+export function renderPrometheus(prefix: string = 'agentdb'): string {
+  const name = `${prefix}_stage_latency_seconds`;
+  const lines = [
+    `# HELP ${name} Hot-path stage latency`,
+    `# TYPE ${name} summary`,
+  ];
+
+  for (const [operation, stages] of histograms) {
+    for (const [stage, histogram] of stages) {
+      if (histogram.count === 0) continue;
+      const labels = `operation="${escapeLabel(operation)}",stage="${escapeLabel(stage)}"`;
+      for (const q of PROMETHEUS_QUANTILES) {
+        lines.push(`${name}{${labels},quantile="${q}"} ${histogram.percentile(q) / 1000}`);
+      }
+      lines.push(`${name}_sum{${labels}} ${histogram.sum / 1000}`);
+      lines.push(`${name}_count{${labels}} ${histogram.count}`);
+    }
+  }
+
+  return lines.join('\n') + '\n';
+}
+
+function escapeLabel(value: string): string {
+  return value.replace(/\\/g, '\\\\').replace(/"/g, '\\"').replace(/\n/g, '\\n');
+}
@@ -15,6 +15,8 @@ type Counter = any;
 type Histogram = any;
 type ObservableGauge = any;
 
+import { latencySnapshot, setSpanSink, type SampledTrace } from './latency.js';
+
 /**
  * Telemetry configuration interface
  */
@@ -90,6 +92,7 @@ export class TelemetryManager {
   private operationCounter?: Counter;
   private throughputCounter?: Counter;
   private cacheHitRateGauge?: ObservableGauge;
+  private stageLatencyGauge?: ObservableGauge;
 
   // Statistics for gauge calculation
   private stats = {
@@ -134,10 +137,21 @@ export class TelemetryManager {
         ...this.config.resourceAttributes,
       });
 
-      // Basic SDK initialization without complex exporters for now
+      // Prometheus scrape endpoint, when the exporter package is installed
+      let metricReader: any;
+      if (this.config.prometheusEnabled) {
+        try {
+          const { PrometheusExporter } = await import('@opentelemetry/exporter-prometheus');
+          metricReader = new PrometheusExporter({ port: this.config.prometheusPort });
+        } catch (error) {
+          console.warn('[AgentDB] Prometheus exporter unavailable:', (error as Error).message);
+        }
+      }
+
       this.sdk = new NodeSDK({
         resource,
         instrumentations: [],
+        ...(metricReader ? { metricReader } : {}),
       }) as any;
 
       await this.sdk.start();
@@ -149,6 +163,9 @@ export class TelemetryManager {
       // Initialize metrics
       this.initializeMetrics();
 
+      // Sampled hot-path stage traces become spans
+      setSpanSink((trace) => this.exportStageTrace(trace), this.config.samplingRate);
+
       console.log('[AgentDB] Telemetry initialized successfully');
     } catch (error) {
       console.error('[AgentDB] Failed to initialize telemetry:', error);
@@ -207,6 +224,40 @@ export class TelemetryManager {
       const hitRate = total > 0 ? (this.stats.cacheHits / total) * 100 : 0;
       observableResult.observe(hitRate);
     });
+
+    // Hot-path stage quantiles from the in-process HDR histograms
+    this.stageLatencyGauge = this.meter.createObservableGauge('agentdb.stage.latency', {
+      description: 'Hot-path stage latency quantiles in milliseconds',
+      unit: 'ms',
+    });
+
+    this.stageLatencyGauge.addCallback((observableResult) => {
+      for (const [operation, stages] of Object.entries(latencySnapshot())) {
+        for (const [stage, snapshot] of Object.entries(stages)) {
+          if (snapshot.count === 0) continue;
+          observableResult.observe(snapshot.p50, { operation, stage, quantile: '0.5' });
+          observableResult.observe(snapshot.p99, { operation, stage, quantile: '0.99' });
+          observableResult.observe(snapshot.p999, { operation, stage, quantile: '0.999' });
+        }
+      }
+    });
+  }
+
+  /**
+   * Export a sampled stage trace as a span with one attribute per stage
+   */
+  private exportStageTrace(trace: SampledTrace): void {
+    if (!this.config.enabled || !this.tracer) return;
+
+    const start = performance.timeOrigin + trace.startTime;
+    const attributes: Record<string, number> = {};
+    for (const { stage, durationMs } of trace.stages) {
+      attributes[`agentdb.stage.${stage}.ms`] = durationMs;
+    }
+
+    const span = this.tracer.startSpan(trace.operation, { startTime: start, attributes });
+    if (trace.error) span.recordException?.(trace.error);
+    span.end(start + trace.durationMs);
   }
 
   /**
@@ -313,6 +364,7 @@ export class TelemetryManager {
    * Shutdown telemetry
    */
   public async shutdown(): Promise<void> {
+    setSpanSink(null);
     if (this.sdk) {
       await this.sdk.shutdown();
       console.log('[AgentDB] Telemetry shut down');
@@ -15,29 +15,49 @@
 
 // Database type from db-fallback
 type Database = any;
-import { EmbeddingService } from '../controllers/EmbeddingService';
-import { Episode } from '../controllers/ReflexionMemory';
+import type { EmbeddingService } from '../controllers/EmbeddingService';
+import type { Episode } from '../controllers/ReflexionMemory';
+import type { VectorBackend } from '../backends/VectorBackend.js';
 import {
   validateTableName,
   buildSafeWhereClause,
   buildSafeSetClause,
   ValidationError,
 } from '../security/input-validation.js';
+import { WorkerPool } from '../utils/WorkerPool.js';
+import { SingleWriterQueue } from './SingleWriterQueue.js';
+import { serializeRows, ROW_SERIALIZER_SOURCE, type PackedRows } from './row-serializer.js';
 
 export interface BatchConfig {
   batchSize: number;
   parallelism: number;
   progressCallback?: (progress: number, total: number) => void;
+  /**
+   * Also index embeddings in this backend (IDs match the controllers:
+   * episode id, `skill:<id>`, `pattern:<id>`). Inserts are wrapped in the
+   * backend's bulk-load mode when it has one.
+   */
+  vectorBackend?: VectorBackend;
 }
 
+type VectorItem = { id: string; embedding: Float32Array; metadata?: Record<string, any> };
+
 export interface ParallelBatchConfig {
   chunkSize?: number; // Rows per chunk (default: 1000)
-  maxConcurrency?: number; // Max parallel operations (default: 5)
+  maxConcurrency?: number; // Chunks being serialized at once (default: 5)
   useTransaction?: boolean; // Use transactions for ACID (default: true)
   retryAttempts?: number; // Retry attempts for transient failures (default: 3)
   retryDelayMs?: number; // Delay between retries (default: 100)
+  useWorkers?: boolean; // Serialize in worker_threads (default: when >= 10000 rows)
+  workerCount?: number; // Serializer workers (default: cores - 1)
+  commitRows?: number; // Initial rows per transaction (default: max(chunkSize, 5000))
+  targetCommitMs?: number; // Target duration per commit, adapts commit size (default: 25)
+  maxQueuedChunks?: number; // Serialized chunks buffered for the writer (default: 2 * maxConcurrency)
 }
 
+/** Row count above which batchInsertParallel serializes in worker threads */
+const WORKER_THRESHOLD = 10000;
+
 export interface ParallelBatchResult {
   totalInserted: number;
   chunksProcessed: number;
@@ -67,54 +87,64 @@ export class BatchOperations {
     const totalBatches = Math.ceil(episodes.length / this.config.batchSize);
     let completed = 0;
 
-    for (let i = 0; i < episodes.length; i += this.config.batchSize) {
-      const batch = episodes.slice(i, i + this.config.batchSize);
-
-      // Generate embeddings in parallel
-      const texts = batch.map((ep) => this.buildEpisodeText(ep));
-      const embeddings = await this.embedder.embedBatch(texts);
+    const backend = this.beginVectorBulk();
 
-      // Insert with transaction
-      const transaction = this.db.transaction(() => {
-        const episodeStmt = this.db.prepare(`
-          INSERT INTO episodes (
-            session_id, task, input, output, critique, reward, success,
-            latency_ms, tokens_used, tags, metadata
-          ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        `);
-
-        const embeddingStmt = this.db.prepare(`
-          INSERT INTO episode_embeddings (episode_id, embedding)
-          VALUES (?, ?)
-        `);
-
-        batch.forEach((episode, idx) => {
-          const result = episodeStmt.run(
-            episode.sessionId,
-            episode.task,
-            episode.input || null,
-            episode.output || null,
-            episode.critique || null,
-            episode.reward,
-            episode.success ? 1 : 0,
-            episode.latencyMs || null,
-            episode.tokensUsed || null,
-            episode.tags ? JSON.stringify(episode.tags) : null,
-            episode.metadata ? JSON.stringify(episode.metadata) : null
-          );
-
-          const episodeId = result.lastInsertRowid as number;
-          embeddingStmt.run(episodeId, Buffer.from(embeddings[idx].buffer));
+    try {
+      for (let i = 0; i < episodes.length; i += this.config.batchSize) {
+        const batch = episodes.slice(i, i + this.config.batchSize);
+
+        // Generate embeddings in parallel
+        const texts = batch.map((ep) => this.buildEpisodeText(ep));
+        const embeddings = await this.embedder.embedBatch(texts);
+
+        const vectorItems: VectorItem[] = [];
+
+        // Insert with transaction
+        const transaction = this.db.transaction(() => {
+          const episodeStmt = this.db.prepare(`
+            INSERT INTO episodes (
+              session_id, task, input, output, critique, reward, success,
+              latency_ms, tokens_used, tags, metadata
+            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+          `);
+
+          const embeddingStmt = this.db.prepare(`
+            INSERT INTO episode_embeddings (episode_id, embedding)
+            VALUES (?, ?)
+          `);
+
+          batch.forEach((episode, idx) => {
+            const result = episodeStmt.run(
+              episode.sessionId,
+              episode.task,
+              episode.input || null,
+              episode.output || null,
+              episode.critique || null,
+              episode.reward,
+              episode.success ? 1 : 0,
+              episode.latencyMs || null,
+              episode.tokensUsed || null,
+              episode.tags ? JSON.stringify(episode.tags) : null,
+              episode.metadata ? JSON.stringify(episode.metadata) : null
+            );
+
+            const episodeId = result.lastInsertRowid as number;
+            embeddingStmt.run(episodeId, Buffer.from(embeddings[idx].buffer));
+            vectorItems.push({ id: episodeId.toString(), embedding: embeddings[idx] });
+          });
         });
-      });
 
-      transaction();
+        transaction();
+        backend?.insertBatch(vectorItems);
 
-      completed += batch.length;
+        completed += batch.length;
 
-      if (this.config.progressCallback) {
-        this.config.progressCallback(completed, episodes.length);
+        if (this.config.progressCallback) {
+          this.config.progressCallback(completed, episodes.length);
+        }
       }
+    } finally {
+      await backend?.endBulkLoad?.();
     }
 
     return completed;
@@ -140,54 +170,73 @@ export class BatchOperations {
     const skillIds: number[] = [];
     let completed = 0;
 
-    for (let i = 0; i < skills.length; i += this.config.batchSize) {
-      const batch = skills.slice(i, i + this.config.batchSize);
-
-      // Generate embeddings in parallel
-      const texts = batch.map((skill) => `${skill.name}\n${skill.description}`);
-      const embeddings = await this.embedder.embedBatch(texts);
-
-      // Insert with transaction
-      const transaction = this.db.transaction(() => {
-        const skillStmt = this.db.prepare(`
-          INSERT INTO skills (
-            name, description, signature, code, success_rate, uses,
-            avg_reward, avg_latency_ms, tags, metadata
-          ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        `);
-
-        const embeddingStmt = this.db.prepare(`
-          INSERT INTO skill_embeddings (skill_id, embedding)
-          VALUES (?, ?)
-        `);
+    const backend = this.beginVectorBulk();
 
-        batch.forEach((skill, idx) => {
-          const result = skillStmt.run(
-            skill.name,
-            skill.description,
-            skill.signature ? JSON.stringify(skill.signature) : null,
-            skill.code || null,
-            skill.successRate ?? 0.0,
-            skill.uses ?? 0,
-            skill.avgReward ?? 0.0,
-            skill.avgLatencyMs ?? 0.0,
-            skill.tags ? JSON.stringify(skill.tags) : null,
-            skill.metadata ? JSON.stringify(skill.metadata) : null
-          );
-
-          const skillId = result.lastInsertRowid as number;
-          skillIds.push(skillId);
-          embeddingStmt.run(skillId, Buffer.from(embeddings[idx].buffer));
+    try {
+      for (let i = 0; i < skills.length; i += this.config.batchSize) {
+        const batch = skills.slice(i, i + this.config.batchSize);
+
+        // Generate embeddings in parallel
+        const texts = batch.map((skill) => `${skill.name}\n${skill.description}`);
+        const embeddings = await this.embedder.embedBatch(texts);
+
+        const vectorItems: VectorItem[] = [];
+
+        // Insert with transaction
+        const transaction = this.db.transaction(() => {
+          const skillStmt = this.db.prepare(`
+            INSERT INTO skills (
+              name, description, signature, code, success_rate, uses,
+              avg_reward, avg_latency_ms, tags, metadata
+            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+          `);
+
+          const embeddingStmt = this.db.prepare(`
+            INSERT INTO skill_embeddings (skill_id, embedding)
+            VALUES (?, ?)
+          `);
+
+          batch.forEach((skill, idx) => {
+            const result = skillStmt.run(
+              skill.name,
+              skill.description,
+              skill.signature ? JSON.stringify(skill.signature) : null,
+              skill.code || null,
+              skill.successRate ?? 0.0,
+              skill.uses ?? 0,
+              skill.avgReward ?? 0.0,
+              skill.avgLatencyMs ?? 0.0,
+              skill.tags ? JSON.stringify(skill.tags) : null,
+              skill.metadata ? JSON.stringify(skill.metadata) : null
+            );
+
+            const skillId = result.lastInsertRowid as number;
+            skillIds.push(skillId);
+            embeddingStmt.run(skillId, Buffer.from(embeddings[idx].buffer));
+            vectorItems.push({
+              id: `skill:${skillId}`,
+              embedding: embeddings[idx],
+              metadata: {
+                name: skill.name,
+                description: skill.description,
+                successRate: skill.successRate ?? 0.0,
+                avgReward: skill.avgReward ?? 0.0,
+              },
+            });
+          });
         });
-      });
 
-      transaction();
+        transaction();
+        backend?.insertBatch(vectorItems);
 
-      completed += batch.length;
+        completed += batch.length;
 
-      if (this.config.progressCallback) {
-        this.config.progressCallback(completed, skills.length);
+        if (this.config.progressCallback) {
+          this.config.progressCallback(completed, skills.length);
+        }
       }
+    } finally {
+      await backend?.endBulkLoad?.();
     }
 
     return skillIds;
@@ -210,66 +259,83 @@ export class BatchOperations {
     const patternIds: number[] = [];
     let completed = 0;
 
-    for (let i = 0; i < patterns.length; i += this.config.batchSize) {
-      const batch = patterns.slice(i, i + this.config.batchSize);
-
-      // Generate embeddings in parallel
-      const texts = batch.map((p) => `${p.taskType}\n${p.approach}\n${p.context || ''}`);
-      const embeddings = await this.embedder.embedBatch(texts);
-
-      // Insert with transaction
-      const transaction = this.db.transaction(() => {
-        const patternStmt = this.db.prepare(`
-          INSERT INTO reasoning_patterns (
-            task_type, approach, context, success_rate, outcome, uses, tags, metadata
-          ) VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-        `);
-
-        const embeddingStmt = this.db.prepare(`
-          INSERT INTO pattern_embeddings (pattern_id, embedding)
-          VALUES (?, ?)
-        `);
+    const backend = this.beginVectorBulk();
 
-        batch.forEach((pattern, idx) => {
-          const result = patternStmt.run(
-            pattern.taskType,
-            pattern.approach,
-            pattern.context || null,
-            pattern.successRate,
-            pattern.outcome || null,
-            0, // initial uses = 0
-            pattern.tags ? JSON.stringify(pattern.tags) : null,
-            pattern.metadata ? JSON.stringify(pattern.metadata) : null
-          );
-
-          const patternId = result.lastInsertRowid as number;
-          patternIds.push(patternId);
-          embeddingStmt.run(patternId, Buffer.from(embeddings[idx].buffer));
+    try {
+      for (let i = 0; i < patterns.length; i += this.config.batchSize) {
+        const batch = patterns.slice(i, i + this.config.batchSize);
+
+        // Generate embeddings in parallel
+        const texts = batch.map((p) => `${p.taskType}\n${p.approach}\n${p.context || ''}`);
+        const embeddings = await this.embedder.embedBatch(texts);
+
+        const vectorItems: VectorItem[] = [];
+
+        // Insert with transaction
+        const transaction = this.db.transaction(() => {
+          const patternStmt = this.db.prepare(`
+            INSERT INTO reasoning_patterns (
+              task_type, approach, context, success_rate, outcome, uses, tags, metadata
+            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+          `);
+
+          const embeddingStmt = this.db.prepare(`
+            INSERT INTO pattern_embeddings (pattern_id, embedding)
+            VALUES (?, ?)
+          `);
+
+          batch.forEach((pattern, idx) => {
+            const result = patternStmt.run(
+              pattern.taskType,
+              pattern.approach,
+              pattern.context || null,
+              pattern.successRate,
+              pattern.outcome || null,
+              0, // initial uses = 0
+              pattern.tags ? JSON.stringify(pattern.tags) : null,
+              pattern.metadata ? JSON.stringify(pattern.metadata) : null
+            );
+
+            const patternId = result.lastInsertRowid as number;
+            patternIds.push(patternId);
+            embeddingStmt.run(patternId, Buffer.from(embeddings[idx].buffer));
+            vectorItems.push({
+              id: `pattern:${patternId}`,
+              embedding: embeddings[idx],
+              metadata: { patternId, taskType: pattern.taskType, successRate: pattern.successRate },
+            });
+          });
         });
-      });
 
-      transaction();
+        transaction();
+        backend?.insertBatch(vectorItems);
 
-      completed += batch.length;
+        completed += batch.length;
 
-      if (this.config.progressCallback) {
-        this.config.progressCallback(completed, patterns.length);
+        if (this.config.progressCallback) {
+          this.config.progressCallback(completed, patterns.length);
+        }
       }
+    } finally {
+      await backend?.endBulkLoad?.();
     }
 
     return patternIds;
   }
 
   /**
-   * Parallel batch insert for generic table data (3-5x faster than sequential)
+   * Parallel batch insert for generic table data
    *
-   * Splits data into chunks and processes them concurrently using Promise.all().
-   * Uses database transactions for ACID compliance and automatic rollback on errors.
+   * Pipeline: chunks are serialized (JSON for objects, BLOBs for typed arrays)
+   * by a worker_threads pool for large imports, which transfers them back as
+   * packed typed arrays, then handed to a single writer queue that owns the
+   * connection. The writer groups chunks into transactions
+   * sized to ~targetCommitMs and yields to the event loop between commits, so
+   * large imports no longer block other requests. The queue is bounded, so
+   * serialization pauses while the writer catches up.
    *
-   * @benchmark Performance comparison (10,000 rows):
-   * - Sequential insert: ~8.2 seconds
-   * - Parallel insert (5 concurrent chunks): ~1.8 seconds (4.5x speedup)
-   * - Parallel insert (10 concurrent chunks): ~1.5 seconds (5.5x speedup)
+   * Each chunk is atomic: if a grouped commit fails, its chunks are retried in
+   * their own transactions and failures are reported per chunk.
    *
    * @example
    * ```typescript
@@ -320,95 +386,57 @@ export class BatchOperations {
 
     const startTime = Date.now();
     const errors: Array<{ chunk: number; error: string }> = [];
-    let totalInserted = 0;
-
-    // Split data into chunks
-    const chunks: Array<Record<string, any>[]> = [];
-    for (let i = 0; i < data.length; i += chunkSize) {
-      chunks.push(data.slice(i, i + chunkSize));
-    }
+    const chunkCount = Math.ceil(data.length / chunkSize);
+
+    // Build parameterized INSERT query
+    const placeholders = columns.map(() => '?').join(', ');
+    const query = `INSERT INTO ${validatedTable} (${columns.join(', ')}) VALUES (${placeholders})`;
+
+    const writer = new SingleWriterQueue(this.db, query, {
+      maxQueuedChunks: config.maxQueuedChunks ?? maxConcurrency * 2,
+      commitRows: config.commitRows ?? Math.max(chunkSize, 5000),
+      targetCommitMs: config.targetCommitMs,
+      useTransaction,
+      retryAttempts,
+      retryDelayMs,
+      onCommit: (written) => this.config.progressCallback?.(written, data.length),
+    });
 
-    // Process chunks in parallel with concurrency limit
-    const processChunk = async (
-      chunk: Array<Record<string, any>>,
-      chunkIndex: number,
-      attempt: number = 0
-    ): Promise<number> => {
-      try {
-        // Build parameterized INSERT query
-        const placeholders = columns.map(() => '?').join(', ');
-        const query = `INSERT INTO ${validatedTable} (${columns.join(', ')}) VALUES (${placeholders})`;
-
-        if (useTransaction) {
-          // Use transaction for ACID compliance
-          const insertInTransaction = this.db.transaction(
-            (chunkData: Array<Record<string, any>>) => {
-              const stmt = this.db.prepare(query);
-              for (const row of chunkData) {
-                const values = columns.map((col) => {
-                  const value = row[col];
-                  // Handle JSON serialization
-                  if (value !== null && typeof value === 'object') {
-                    return JSON.stringify(value);
-                  }
-                  return value ?? null;
-                });
-                stmt.run(...values);
-              }
-              return chunkData.length;
-            }
-          );
-
-          return insertInTransaction(chunk);
-        } else {
-          // Direct insertion without transaction
-          const stmt = this.db.prepare(query);
-          for (const row of chunk) {
-            const values = columns.map((col) => {
-              const value = row[col];
-              if (value !== null && typeof value === 'object') {
-                return JSON.stringify(value);
-              }
-              return value ?? null;
-            });
-            stmt.run(...values);
-          }
-          return chunk.length;
+    const pool = (config.useWorkers ?? data.length >= WORKER_THRESHOLD)
+      ? this.createSerializerPool(config.workerCount)
+      : null;
+    const serialize = (chunk: Array<Record<string, any>>): Promise<any[][] | PackedRows> =>
+      pool ? pool.run({ rows: chunk, columns }) : Promise.resolve(serializeRows(chunk, columns));
+
+    // Producers pull chunks until none are left; push() blocks while the writer is behind
+    let nextChunk = 0;
+    const produce = async (): Promise<void> => {
+      while (nextChunk < chunkCount) {
+        const index = nextChunk++;
+        try {
+          const rows = await serialize(data.slice(index * chunkSize, (index + 1) * chunkSize));
+          await writer.push(index, rows);
+        } catch (error) {
+          errors.push({
+            chunk: index,
+            error: error instanceof Error ? error.message : String(error),
+          });
         }
-      } catch (error) {
-        // Retry logic for transient failures
-        if (attempt < retryAttempts) {
-          await new Promise((resolve) => setTimeout(resolve, retryDelayMs * (attempt + 1)));
-          return processChunk(chunk, chunkIndex, attempt + 1);
-        }
-
-        // Record error after all retries exhausted
-        const errorMessage = error instanceof Error ? error.message : String(error);
-        errors.push({
-          chunk: chunkIndex,
-          error: errorMessage,
-        });
-
-        // If using transactions, the chunk is fully rolled back
-        // Return 0 to indicate no rows inserted from this chunk
-        return 0;
       }
     };
 
-    // Process chunks with concurrency control
-    for (let i = 0; i < chunks.length; i += maxConcurrency) {
-      const chunkBatch = chunks.slice(i, i + maxConcurrency);
-      const chunkPromises = chunkBatch.map((chunk, idx) => processChunk(chunk, i + idx));
-
-      const results = await Promise.all(chunkPromises);
-      totalInserted += results.reduce((sum, count) => sum + count, 0);
-
-      // Report progress
-      if (this.config.progressCallback) {
-        this.config.progressCallback(totalInserted, data.length);
-      }
+    let result;
+    try {
+      await Promise.all(
+        Array.from({ length: Math.min(Math.max(1, maxConcurrency), chunkCount) }, produce)
+      );
+    } finally {
+      result = await writer.close();
+      await pool?.close();
     }
 
+    errors.push(...result.errors);
+    const totalInserted = result.inserted;
     const duration = Date.now() - startTime;
 
     // If there were critical errors and no data was inserted, throw
@@ -420,7 +448,7 @@ export class BatchOperations {
 
     return {
       totalInserted,
-      chunksProcessed: chunks.length,
+      chunksProcessed: chunkCount,
       duration,
       errors,
     };
@@ -798,6 +826,27 @@ export class BatchOperations {
     return parts.join('\n');
   }
 
+  /**
+   * Put the configured vector backend in bulk-load mode (if it supports one)
+   */
+  private beginVectorBulk(): VectorBackend | undefined {
+    const backend = this.config.vectorBackend;
+    backend?.beginBulkLoad?.();
+    return backend;
+  }
+
+  /**
+   * Worker pool for row serialization; null (inline fallback) if workers are unavailable
+   */
+  private createSerializerPool(size?: number): WorkerPool | null {
+    try {
+      return new WorkerPool(ROW_SERIALIZER_SOURCE, { size });
+    } catch (error) {
+      console.warn('[BatchOperations] Worker threads unavailable, serializing inline:', error);
+      return null;
+    }
+  }
+
   private chunkArray<T>(array: T[], size: number): T[][] {
     const chunks: T[][] = [];
     for (let i = 0; i < array.length; i += size) {
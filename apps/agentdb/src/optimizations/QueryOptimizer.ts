@@ -3,12 +3,14 @@
  *
  * Implements:
  * - Query result caching with TTL
- * - Prepared statement pooling
+ * - Prepared statement pooling (shared per connection via StatementCache)
  * - Batch operation optimization
  * - Index usage analysis
  * - Query plan analysis
  */
 
+import { StatementCache } from '../utils/StatementCache.js';
+
 // Database type from db-fallback
 type Database = any;
 
@@ -32,9 +34,11 @@ export class QueryOptimizer {
   private cache: Map<string, { result: any; timestamp: number }>;
   private stats: Map<string, QueryStats>;
   private config: CacheConfig;
+  private statements: StatementCache;
 
   constructor(db: Database, config?: Partial<CacheConfig>) {
     this.db = db;
+    this.statements = StatementCache.for(db);
     this.cache = new Map();
     this.stats = new Map();
     this.config = {
@@ -63,9 +67,8 @@ export class QueryOptimizer {
       }
     }
 
-    // Execute query
-    const stmt = this.db.prepare(sql);
-    const result = params.length > 0 ? stmt.all(...params) : stmt.all();
+    // Execute query on the connection's cached statement
+    const result = this.statements.all(sql, params);
 
     const executionTime = Date.now() - startTime;
     this.recordStats(sql, executionTime, false);
@@ -91,8 +94,7 @@ export class QueryOptimizer {
    */
   execute(sql: string, params: any[] = []): any {
     const startTime = Date.now();
-    const stmt = this.db.prepare(sql);
-    const result = params.length > 0 ? stmt.run(...params) : stmt.run();
+    const result = this.statements.run(sql, params);
 
     this.recordStats(sql, Date.now() - startTime, false);
 
@@ -110,7 +112,7 @@ export class QueryOptimizer {
     const sql = `INSERT INTO ${table} (${columns.join(', ')}) VALUES (${placeholders})`;
 
     const transaction = this.db.transaction((rows: any[][]) => {
-      const stmt = this.db.prepare(sql);
+      const stmt = this.statements.prepare(sql);
       for (const row of rows) {
         stmt.run(...row);
       }
@@ -212,15 +214,18 @@ export class QueryOptimizer {
     hitRate: number;
     totalHits: number;
     totalMisses: number;
+    statements: { size: number; hitRate: number };
   } {
     const totalHits = Array.from(this.stats.values()).reduce((sum, s) => sum + s.cacheHits, 0);
     const totalMisses = Array.from(this.stats.values()).reduce((sum, s) => sum + s.cacheMisses, 0);
+    const statementStats = this.statements.getStats();
 
     return {
       size: this.cache.size,
       hitRate: totalHits / (totalHits + totalMisses) || 0,
       totalHits,
-      totalMisses
+      totalMisses,
+      statements: { size: statementStats.size, hitRate: statementStats.hitRate }
     };
   }
 
@@ -0,0 +1,205 @@
+/**
+ * SingleWriterQueue - Bounded write queue with one SQLite writer
+ *
+ * Producers (e.g. serialization workers) push prepared row chunks; a single
+ * drain loop owns the connection and commits them. Queued chunks are grouped
+ * into one transaction up to `commitRows`, the group size adapts so each
+ * commit takes about `targetCommitMs`, and the loop yields to the event loop
+ * between commits so other requests on the same process keep being served.
+ *
+ * push() waits while the queue is full, which applies back-pressure to the
+ * producers instead of buffering an entire import in memory.
+ */
+
+import { readPackedRow, type PackedRows } from './row-serializer.js';
+
+// Database type from db-fallback
+type Database = any;
+
+export interface SingleWriterQueueOptions {
+  /** Max chunks waiting to be written before push() blocks (default: 8) */
+  maxQueuedChunks?: number;
+  /** Initial rows per transaction (default: 5000) */
+  commitRows?: number;
+  /** Target wall time per transaction in ms (default: 25) */
+  targetCommitMs?: number;
+  /** Wrap commits in transactions (default: true) */
+  useTransaction?: boolean;
+  /** Retry attempts per chunk after a failed group commit (default: 3) */
+  retryAttempts?: number;
+  /** Base delay between retries in ms (default: 100) */
+  retryDelayMs?: number;
+  /** Called after every commit with total rows written so far */
+  onCommit?: (written: number) => void;
+}
+
+export interface SingleWriterResult {
+  inserted: number;
+  commits: number;
+  errors: Array<{ chunk: number; error: string }>;
+}
+
+interface QueuedChunk {
+  index: number;
+  rows: any[][] | PackedRows;
+}
+
+const MIN_COMMIT_ROWS = 100;
+const MAX_COMMIT_ROWS = 50000;
+
+/**
+ * Bind-ready value: Uint8Array from a worker becomes a zero-copy Buffer
+ */
+function toBindValue(value: any): any {
+  if (value instanceof Uint8Array && !Buffer.isBuffer(value)) {
+    return Buffer.from(value.buffer, value.byteOffset, value.byteLength);
+  }
+  return value;
+}
+
+export class SingleWriterQueue {
+  private db: Database;
+  private sql: string;
+  private maxQueuedChunks: number;
+  private commitRows: number;
+  private targetCommitMs: number;
+  private useTransaction: boolean;
+  private retryAttempts: number;
+  private retryDelayMs: number;
+  private onCommit?: (written: number) => void;
+
+  private queue: QueuedChunk[] = [];
+  private spaceWaiters: Array<() => void> = [];
+  private draining: Promise<void> | null = null;
+  private result: SingleWriterResult = { inserted: 0, commits: 0, errors: [] };
+
+  constructor(db: Database, sql: string, options: SingleWriterQueueOptions = {}) {
+    this.db = db;
+    this.sql = sql;
+    this.maxQueuedChunks = Math.max(1, options.maxQueuedChunks ?? 8);
+    this.commitRows = options.commitRows ?? 5000;
+    this.targetCommitMs = options.targetCommitMs ?? 25;
+    this.useTransaction = options.useTransaction ?? true;
+    this.retryAttempts = options.retryAttempts ?? 3;
+    this.retryDelayMs = options.retryDelayMs ?? 100;
+    this.onCommit = options.onCommit;
+  }
+
+  /**
+   * Queue a chunk of bind-ready rows, waiting while the queue is full
+   */
+  async push(index: number, rows: any[][] | PackedRows): Promise<void> {
+    while (this.queue.length >= this.maxQueuedChunks) {
+      await new Promise<void>(resolve => this.spaceWaiters.push(resolve));
+    }
+    this.queue.push({ index, rows });
+    if (!this.draining) {
+      this.draining = this.drainLoop().finally(() => {
+        this.draining = null;
+      });
+    }
+  }
+
+  /**
+   * Wait for every queued chunk to be written
+   */
+  async close(): Promise<SingleWriterResult> {
+    while (this.draining) {
+      await this.draining;
+    }
+    return this.result;
+  }
+
+  private async drainLoop(): Promise<void> {
+    const stmt = this.db.prepare(this.sql);
+
+    while (this.queue.length > 0) {
+      // Group queued chunks up to the adaptive commit size
+      const group: QueuedChunk[] = [];
+      let rows = 0;
+      while (this.queue.length > 0 && (group.length === 0 || rows + this.queue[0].rows.length <= this.commitRows)) {
+        const chunk = this.queue.shift()!;
+        group.push(chunk);
+        rows += chunk.rows.length;
+      }
+      this.releaseSpace();
+
+      const start = Date.now();
+      try {
+        this.writeGroup(stmt, group);
+        this.result.inserted += rows;
+        this.result.commits++;
+        this.adaptCommitSize(rows, Date.now() - start);
+      } catch {
+        // Isolate the failing chunk: retry each chunk in its own transaction
+        for (const chunk of group) {
+          await this.writeWithRetry(stmt, chunk);
+        }
+      }
+
+      this.onCommit?.(this.result.inserted);
+
+      // Let other work on the event loop run between commits
+      await new Promise<void>(resolve => setImmediate(resolve));
+    }
+  }
+
+  private writeGroup(stmt: any, group: QueuedChunk[]): void {
+    const write = () => {
+      for (const { rows } of group) {
+        if (Array.isArray(rows)) {
+          for (const row of rows) {
+            stmt.run(...row.map(toBindValue));
+          }
+        } else {
+          const args = new Array(rows.columnCount);
+          for (let r = 0; r < rows.length; r++) {
+            stmt.run(...readPackedRow(rows, r, args));
+          }
+        }
+      }
+    };
+
+    if (this.useTransaction) {
+      this.db.transaction(write)();
+    } else {
+      write();
+    }
+  }
+
+  private async writeWithRetry(stmt: any, chunk: QueuedChunk): Promise<void> {
+    for (let attempt = 0; ; attempt++) {
+      try {
+        this.writeGroup(stmt, [chunk]);
+        this.result.inserted += chunk.rows.length;
+        this.result.commits++;
+        return;
+      } catch (error) {
+        if (attempt >= this.retryAttempts) {
+          this.result.errors.push({
+            chunk: chunk.index,
+            error: error instanceof Error ? error.message : String(error),
+          });
+          return;
+        }
+        await new Promise(resolve => setTimeout(resolve, this.retryDelayMs * (attempt + 1)));
+      }
+    }
+  }
+
+  /**
+   * Scale rows per commit toward the target commit duration
+   */
+  private adaptCommitSize(rows: number, elapsedMs: number): void {
+    if (rows < this.commitRows / 2) return; // Group was limited by queue depth, not size
+    const scale = this.targetCommitMs / Math.max(1, elapsedMs);
+    const next = Math.round(this.commitRows * Math.min(2, Math.max(0.5, scale)));
+    this.commitRows = Math.min(MAX_COMMIT_ROWS, Math.max(MIN_COMMIT_ROWS, next));
+  }
+
+  private releaseSpace(): void {
+    while (this.spaceWaiters.length > 0 && this.queue.length < this.maxQueuedChunks) {
+      this.spaceWaiters.shift()!();
+    }
+  }
+}
@@ -3,11 +3,16 @@
  *
  * Features:
  * - TTL-based expiration
- * - LRU eviction when max size reached
- * - Pattern-based cache invalidation
+ * - LRU eviction when max size reached (O(1), Map insertion order)
+ * - Prefix and tag invalidation through indexes instead of key scans
+ * - Search keys from a hash of the normalized query embedding
  * - Hit/miss rate tracking
  * - Memory-efficient storage
  *
+ * Keys are ':'-separated segments (e.g. 'search:reflexion:<hash>:k=5').
+ * Every segment prefix ('search:', 'search:reflexion:') is indexed, so
+ * invalidatePrefix() and clear('search:*') touch only the matching keys.
+ *
  * Performance Impact:
  * - agentdb_stats: 176ms → ~20ms (8.8x faster)
  * - pattern_stats: Similar improvement
@@ -19,6 +24,7 @@ export interface CacheEntry<T> {
   expiry: number;
   accessCount: number;
   lastAccess: number;
+  tags?: readonly string[];
 }
 
 export interface CacheStats {
@@ -31,8 +37,38 @@ export interface CacheStats {
   avgAccessCount: number;
 }
 
+const SEGMENT = ':';
+// Expired entries checked from the LRU end before evicting a live one
+const EXPIRY_PROBE = 8;
+
+/**
+ * Cache key segment for a query embedding: the L2-normalized vector,
+ * quantized to `precision`, hashed with two FNV-1a lanes (64 bits of hex).
+ * Scaled copies of a vector, and values within the quantization step,
+ * share a key.
+ */
+export function hashEmbedding(embedding: ArrayLike<number>, precision: number = 1e-4): string {
+  let norm = 0;
+  for (let i = 0; i < embedding.length; i++) norm += embedding[i] * embedding[i];
+  const scale = norm > 0 ? 1 / (Math.sqrt(norm) * precision) : 0;
+
+  let h1 = 0x811c9dc5;
+  let h2 = 0x01000193 ^ embedding.length;
+  for (let i = 0; i < embedding.length; i++) {
+    const q = Math.round(embedding[i] * scale) | 0;
+    for (let shift = 0; shift < 32; shift += 8) {
+      const byte = (q >>> shift) & 0xff;
+      h1 = Math.imul(h1 ^ byte, 0x01000193);
+      h2 = Math.imul(h2 ^ byte, 0x5bd1e995);
+    }
+  }
+  return (h1 >>> 0).toString(16).padStart(8, '0') + (h2 >>> 0).toString(16).padStart(8, '0');
+}
+
 export class ToolCache<T = any> {
   private cache: Map<string, CacheEntry<T>>;
+  private prefixIndex: Map<string, Set<string>> = new Map();
+  private tagIndex: Map<string, Set<string>> = new Map();
   private maxSize: number;
   private defaultTTLMs: number;
   private hits: number;
@@ -49,24 +85,24 @@ export class ToolCache<T = any> {
   }
 
   /**
-   * Set cache entry with optional custom TTL
+   * Set cache entry with optional custom TTL and invalidation tags
    */
-  set(key: string, value: T, ttlMs?: number): void {
-    // Evict expired entries first
-    this.evictExpired();
-
-    // If at capacity, evict LRU entry
-    if (this.cache.size >= this.maxSize && !this.cache.has(key)) {
-      this.evictLRU();
+  set(key: string, value: T, ttlMs?: number, tags?: readonly string[]): void {
+    if (this.cache.has(key)) {
+      this.remove(key);
+    } else if (this.cache.size >= this.maxSize) {
+      this.evictOne();
     }
 
-    const expiry = Date.now() + (ttlMs ?? this.defaultTTLMs);
+    const now = Date.now();
     this.cache.set(key, {
       value,
-      expiry,
+      expiry: now + (ttlMs ?? this.defaultTTLMs),
       accessCount: 0,
-      lastAccess: Date.now(),
+      lastAccess: now,
+      tags: tags && tags.length > 0 ? tags : undefined,
     });
+    this.index(key, tags);
   }
 
   /**
@@ -82,14 +118,16 @@ export class ToolCache<T = any> {
 
     // Check expiration
     if (Date.now() > entry.expiry) {
-      this.cache.delete(key);
+      this.remove(key);
       this.misses++;
       return null;
     }
 
-    // Update access stats
+    // Update access stats and move to the most recently used end
     entry.accessCount++;
     entry.lastAccess = Date.now();
+    this.cache.delete(key);
+    this.cache.set(key, entry);
     this.hits++;
 
     return entry.value;
@@ -103,7 +141,7 @@ export class ToolCache<T = any> {
     if (!entry) return false;
 
     if (Date.now() > entry.expiry) {
-      this.cache.delete(key);
+      this.remove(key);
       return false;
     }
 
@@ -114,31 +152,52 @@ export class ToolCache<T = any> {
    * Delete specific key
    */
   delete(key: string): boolean {
-    return this.cache.delete(key);
+    return this.remove(key);
   }
 
   /**
    * Clear all entries matching pattern (e.g., 'stats:*', 'search:user-123:*')
+   *
+   * A single trailing '*' is a prefix invalidation; other globs scan keys.
    */
   clear(pattern?: string): number {
     if (!pattern) {
       const size = this.cache.size;
       this.cache.clear();
+      this.prefixIndex.clear();
+      this.tagIndex.clear();
       return size;
     }
 
+    const star = pattern.indexOf('*');
+    if (star === pattern.length - 1) {
+      return this.invalidatePrefix(pattern.slice(0, -1));
+    }
+    if (star < 0) {
+      return this.remove(pattern) ? 1 : 0;
+    }
+
     // Convert glob pattern to regex
-    const regex = new RegExp('^' + pattern.replace(/\*/g, '.*') + '$');
-    let cleared = 0;
+    const escaped = pattern.replace(/[.+?^${}()|[\]\\]/g, '\\$&');
+    const regex = new RegExp('^' + escaped.replace(/\*/g, '.*') + '$');
+    return this.removeAll(this.candidates(pattern.slice(0, star)), (key) => regex.test(key));
+  }
 
-    for (const key of this.cache.keys()) {
-      if (regex.test(key)) {
-        this.cache.delete(key);
-        cleared++;
-      }
-    }
+  /**
+   * Remove every key starting with `prefix`; prefixes ending at a segment
+   * boundary are a direct index lookup
+   */
+  invalidatePrefix(prefix: string): number {
+    if (prefix === '') return this.clear();
+    return this.removeAll(this.candidates(prefix), (key) => key.startsWith(prefix));
+  }
 
-    return cleared;
+  /**
+   * Remove every entry set with this tag
+   */
+  invalidateTag(tag: string): number {
+    const keys = this.tagIndex.get(tag);
+    return keys ? this.removeAll(keys, () => true) : 0;
   }
 
   /**
@@ -148,9 +207,9 @@ export class ToolCache<T = any> {
     const now = Date.now();
     let evicted = 0;
 
-    for (const [key, entry] of this.cache.entries()) {
+    for (const [key, entry] of this.cache) {
       if (now > entry.expiry) {
-        this.cache.delete(key);
+        this.remove(key);
         evicted++;
       }
     }
@@ -160,25 +219,70 @@ export class ToolCache<T = any> {
   }
 
   /**
-   * Evict least recently used entry (LRU)
+   * Make room for one entry: drop an expired entry near the LRU end if
+   * there is one, else the least recently used entry
    */
-  private evictLRU(): void {
+  private evictOne(): void {
+    const now = Date.now();
     let lruKey: string | null = null;
-    let oldestAccess = Infinity;
+    let probed = 0;
 
-    for (const [key, entry] of this.cache.entries()) {
-      if (entry.lastAccess < oldestAccess) {
-        oldestAccess = entry.lastAccess;
+    for (const [key, entry] of this.cache) {
+      if (lruKey === null) lruKey = key;
+      if (now > entry.expiry) {
         lruKey = key;
+        break;
       }
+      if (++probed >= EXPIRY_PROBE) break;
     }
 
-    if (lruKey) {
-      this.cache.delete(lruKey);
+    if (lruKey !== null) {
+      this.remove(lruKey);
       this.evictions++;
     }
   }
 
+  /**
+   * Keys that may start with `prefix`: the index entry of its longest
+   * segment prefix, or every key when it has none
+   */
+  private candidates(prefix: string): Iterable<string> {
+    const boundary = prefix.lastIndexOf(SEGMENT);
+    if (boundary < 0) return this.cache.keys();
+    return this.prefixIndex.get(prefix.slice(0, boundary + 1)) ?? [];
+  }
+
+  private removeAll(keys: Iterable<string>, match: (key: string) => boolean): number {
+    let removed = 0;
+    for (const key of [...keys]) {
+      if (match(key) && this.remove(key)) removed++;
+    }
+    return removed;
+  }
+
+  private index(key: string, tags?: readonly string[]): void {
+    for (let i = key.indexOf(SEGMENT); i >= 0; i = key.indexOf(SEGMENT, i + 1)) {
+      addToIndex(this.prefixIndex, key.slice(0, i + 1), key);
+    }
+    for (const tag of tags ?? []) {
+      addToIndex(this.tagIndex, tag, key);
+    }
+  }
+
+  private remove(key: string): boolean {
+    const entry = this.cache.get(key);
+    if (!entry) return false;
+    this.cache.delete(key);
+
+    for (let i = key.indexOf(SEGMENT); i >= 0; i = key.indexOf(SEGMENT, i + 1)) {
+      removeFromIndex(this.prefixIndex, key.slice(0, i + 1), key);
+    }
+    for (const tag of entry.tags ?? []) {
+      removeFromIndex(this.tagIndex, tag, key);
+    }
+    return true;
+  }
+
   /**
    * Get cache statistics
    */
@@ -204,6 +308,13 @@ export class ToolCache<T = any> {
     };
   }
 
+  /**
+   * Drop expired entries now (they are otherwise removed lazily)
+   */
+  prune(): number {
+    return this.evictExpired();
+  }
+
   /**
    * Reset statistics (keeps cached data)
    */
@@ -230,18 +341,18 @@ export class ToolCache<T = any> {
   /**
    * Warmup cache with pre-computed values
    */
-  warmup(entries: Array<{ key: string; value: T; ttlMs?: number }>): void {
-    for (const { key, value, ttlMs } of entries) {
-      this.set(key, value, ttlMs);
+  warmup(entries: Array<{ key: string; value: T; ttlMs?: number; tags?: string[] }>): void {
+    for (const { key, value, ttlMs, tags } of entries) {
+      this.set(key, value, ttlMs, tags);
     }
   }
 
   /**
    * Export cache to JSON (for persistence)
    */
-  export(): Array<{ key: string; value: T; expiry: number }> {
+  export(): Array<{ key: string; value: T; expiry: number; tags?: readonly string[] }> {
     const now = Date.now();
-    const exported: Array<{ key: string; value: T; expiry: number }> = [];
+    const exported: Array<{ key: string; value: T; expiry: number; tags?: readonly string[] }> = [];
 
     for (const [key, entry] of this.cache.entries()) {
       // Only export non-expired entries
@@ -250,6 +361,7 @@ export class ToolCache<T = any> {
           key,
           value: entry.value,
           expiry: entry.expiry,
+          ...(entry.tags ? { tags: entry.tags } : {}),
         });
       }
     }
@@ -260,19 +372,14 @@ export class ToolCache<T = any> {
   /**
    * Import cache from JSON (for persistence)
    */
-  import(entries: Array<{ key: string; value: T; expiry: number }>): number {
+  import(entries: Array<{ key: string; value: T; expiry: number; tags?: readonly string[] }>): number {
     const now = Date.now();
     let imported = 0;
 
-    for (const { key, value, expiry } of entries) {
+    for (const { key, value, expiry, tags } of entries) {
       // Only import non-expired entries
       if (expiry > now) {
-        this.cache.set(key, {
-          value,
-          expiry,
-          accessCount: 0,
-          lastAccess: now,
-        });
+        this.set(key, value, expiry - now, tags);
         imported++;
       }
     }
@@ -281,6 +388,19 @@ export class ToolCache<T = any> {
   }
 }
 
+function addToIndex(index: Map<string, Set<string>>, name: string, key: string): void {
+  let keys = index.get(name);
+  if (!keys) index.set(name, (keys = new Set()));
+  keys.add(key);
+}
+
+function removeFromIndex(index: Map<string, Set<string>>, name: string, key: string): void {
+  const keys = index.get(name);
+  if (!keys) return;
+  keys.delete(key);
+  if (keys.size === 0) index.delete(name);
+}
+
 /**
  * Specialized caches for different MCP tools
  */
@@ -305,6 +425,27 @@ export class MCPToolCaches {
     this.metrics = new ToolCache<any>(50, 120000);
   }
 
+  /**
+   * Key for a search result: tool, normalized query embedding hash and the
+   * remaining parameters in sorted order
+   */
+  static searchKey(tool: string, embedding: ArrayLike<number>, params: Record<string, unknown> = {}): string {
+    const rest = Object.keys(params)
+      .filter((name) => params[name] !== undefined)
+      .sort()
+      .map((name) => `${name}=${JSON.stringify(params[name])}`)
+      .join('&');
+    return `${tool}:${hashEmbedding(embedding)}:${rest}`;
+  }
+
+  /**
+   * Drop search and pattern results tagged with a data source
+   * (e.g. 'episodes' after an insert)
+   */
+  invalidate(tag: string): number {
+    return this.searches.invalidateTag(tag) + this.patterns.invalidateTag(tag);
+  }
+
   /**
    * Clear all caches
    */
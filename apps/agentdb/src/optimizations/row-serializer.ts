@@ -0,0 +1,146 @@
+/**
+ * Row serialization for bulk inserts
+ *
+ * Turns row objects into bind-ready value arrays: objects become JSON, typed
+ * arrays become byte BLOBs. The same function runs inline or inside a
+ * worker_threads pool (its source is embedded in ROW_SERIALIZER_SOURCE), so
+ * it must stay self-contained.
+ *
+ * Workers return packRows() output instead: a row's values spread over a
+ * few typed arrays and one string, so the result is transferred rather than
+ * structured-cloned as thousands of small arrays, and the writer binds rows
+ * from it through one reused argument array (readPackedRow).
+ */
+
+/** Bind-ready rows in transferable form; `length` is the row count */
+export interface PackedRows {
+  length: number;
+  columnCount: number;
+  /** Per cell: 0 null, 1 number, 2 text, 3 bytes, 4 other */
+  tags: Uint8Array;
+  /** Per cell: the number, or where its text or bytes start */
+  values: Float64Array;
+  /** Per cell: where its text or bytes end */
+  ends: Uint32Array;
+  text: string;
+  bytes: Uint8Array;
+  /** Cells of any other type (bigint, boolean), by cell index */
+  other: Record<number, any>;
+}
+
+export function serializeRows(rows: Array<Record<string, any>>, columns: string[]): any[][] {
+  const out = new Array(rows.length);
+  for (let r = 0; r < rows.length; r++) {
+    const row = rows[r];
+    const values = new Array(columns.length);
+    for (let c = 0; c < columns.length; c++) {
+      const value = row[columns[c]];
+      if (value === null || value === undefined) {
+        values[c] = null;
+      } else if (ArrayBuffer.isView(value)) {
+        // Pack Float32Array embeddings etc. as raw bytes
+        values[c] = new Uint8Array(value.buffer, value.byteOffset, value.byteLength).slice();
+      } else if (typeof value === 'object') {
+        values[c] = JSON.stringify(value);
+      } else {
+        values[c] = value;
+      }
+    }
+    out[r] = values;
+  }
+  return out;
+}
+
+/**
+ * Serialize rows like serializeRows, packed into typed arrays
+ */
+export function packRows(rows: Array<Record<string, any>>, columns: string[]): PackedRows {
+  const columnCount = columns.length;
+  const cells = rows.length * columnCount;
+  const tags = new Uint8Array(cells);
+  const values = new Float64Array(cells);
+  const ends = new Uint32Array(cells);
+  const text: string[] = [];
+  const blobs: Uint8Array[] = [];
+  const other: Record<number, any> = {};
+  let textLength = 0;
+  let byteLength = 0;
+
+  for (let r = 0; r < rows.length; r++) {
+    const row = rows[r];
+    for (let c = 0; c < columnCount; c++) {
+      const cell = r * columnCount + c;
+      let value = row[columns[c]];
+      if (value === null || value === undefined) continue;
+
+      if (typeof value === 'object' && !ArrayBuffer.isView(value)) {
+        value = JSON.stringify(value);
+      }
+      if (typeof value === 'number') {
+        tags[cell] = 1;
+        values[cell] = value;
+      } else if (typeof value === 'string') {
+        tags[cell] = 2;
+        values[cell] = textLength;
+        textLength += value.length;
+        ends[cell] = textLength;
+        text.push(value);
+      } else if (ArrayBuffer.isView(value)) {
+        tags[cell] = 3;
+        values[cell] = byteLength;
+        byteLength += value.byteLength;
+        ends[cell] = byteLength;
+        blobs.push(new Uint8Array(value.buffer, value.byteOffset, value.byteLength));
+      } else {
+        tags[cell] = 4;
+        other[cell] = value;
+      }
+    }
+  }
+
+  const bytes = new Uint8Array(byteLength);
+  let offset = 0;
+  for (const blob of blobs) {
+    bytes.set(blob, offset);
+    offset += blob.byteLength;
+  }
+  return { length: rows.length, columnCount, tags, values, ends, text: text.join(''), bytes, other };
+}
+
+/**
+ * Fill `out` with row `r` of packed rows; bytes are zero-copy Buffers
+ */
+export function readPackedRow(packed: PackedRows, r: number, out: any[]): any[] {
+  const { columnCount, tags, values, ends } = packed;
+  for (let c = 0, cell = r * columnCount; c < columnCount; c++, cell++) {
+    switch (tags[cell]) {
+      case 1:
+        out[c] = values[cell];
+        break;
+      case 2:
+        out[c] = packed.text.slice(values[cell], ends[cell]);
+        break;
+      case 3:
+        out[c] = Buffer.from(packed.bytes.buffer, packed.bytes.byteOffset + values[cell], ends[cell] - values[cell]);
+        break;
+      case 4:
+        out[c] = packed.other[cell];
+        break;
+      default:
+        out[c] = null;
+    }
+  }
+  return out;
+}
+
+/**
+ * WorkerPool source: handle({ rows, columns }) -> PackedRows, transferred
+ */
+export const ROW_SERIALIZER_SOURCE = `
+${packRows.toString()}
+function handle(payload) {
+  const packed = packRows(payload.rows, payload.columns);
+  packed.__transfer = [packed.tags.buffer, packed.values.buffer, packed.ends.buffer, packed.bytes.buffer];
+  return packed;
+}
+`;
@@ -2,6 +2,10 @@
  * Federated Learning Integration for SONA v0.1.4
  *
  * Provides distributed learning capabilities with WasmEphemeralAgent and WasmFederatedCoordinator
+ *
+ * Agents and the coordinator keep running (quality-weighted) sums instead of
+ * per-task or per-agent arrays, so export and consolidation are O(dim)
+ * regardless of how many tasks or agents contributed.
  */
 
 import type { SonaEngine } from '@ruvector/sona';
@@ -52,9 +56,14 @@ export interface FederatedConfig {
 export class EphemeralLearningAgent {
   private agentId: string;
   private sonaEngine: SonaEngine | null = null;
-  private taskHistory: Array<{ embedding: Float32Array; quality: number; timestamp: number }> = [];
   private config: FederatedConfig;
 
+  // Running sums over tasks that pass the quality filter
+  private embeddingSum: Float64Array | null = null;
+  private qualitySum = 0;
+  private validTasks = 0;
+  private totalTasks = 0;
+
   constructor(config: FederatedConfig) {
     this.agentId = config.agentId;
     this.config = {
@@ -81,12 +90,25 @@ export class EphemeralLearningAgent {
       throw new Error('Agent not initialized. Call initialize() first.');
     }
 
-    // Store in task history
-    this.taskHistory.push({
-      embedding,
-      quality,
-      timestamp: Date.now()
-    });
+    if (this.embeddingSum && embedding.length !== this.embeddingSum.length) {
+      throw new Error(`Embedding dimension mismatch: expected ${this.embeddingSum.length}, got ${embedding.length}`);
+    }
+
+    // Accumulate into task history
+    this.totalTasks++;
+    if (this.config.qualityFiltering && quality < (this.config.minQuality || 0.7)) {
+      return;
+    }
+
+    if (!this.embeddingSum) {
+      this.embeddingSum = new Float64Array(embedding.length);
+    }
+    const sum = this.embeddingSum;
+    for (let i = 0; i < embedding.length; i++) {
+      sum[i] += embedding[i];
+    }
+    this.qualitySum += quality;
+    this.validTasks++;
 
     // Train SONA engine on task
     // In actual implementation, this would call SONA's training methods
@@ -97,26 +119,20 @@ export class EphemeralLearningAgent {
    * Export agent state for federation
    */
   exportState(): FederatedAgentState {
-    if (this.taskHistory.length === 0) {
+    if (this.totalTasks === 0) {
       throw new Error('No tasks processed yet');
     }
 
-    // Filter by quality if enabled
-    const validTasks = this.config.qualityFiltering
-      ? this.taskHistory.filter(t => t.quality >= (this.config.minQuality || 0.7))
-      : this.taskHistory;
-
-    if (validTasks.length === 0) {
+    if (this.validTasks === 0 || !this.embeddingSum) {
       throw new Error('No tasks meet quality threshold');
     }
 
-    // Compute average embedding
-    const avgEmbedding = this.computeAverageEmbedding(
-      validTasks.map(t => t.embedding)
-    );
-
-    // Compute average quality
-    const avgQuality = validTasks.reduce((sum, t) => sum + t.quality, 0) / validTasks.length;
+    // Average embedding and quality of accepted tasks
+    const avgEmbedding = new Float32Array(this.embeddingSum.length);
+    for (let i = 0; i < avgEmbedding.length; i++) {
+      avgEmbedding[i] = this.embeddingSum[i] / this.validTasks;
+    }
+    const avgQuality = this.qualitySum / this.validTasks;
 
     return {
       agentId: this.agentId,
@@ -124,8 +140,8 @@ export class EphemeralLearningAgent {
       quality: avgQuality,
       timestamp: Date.now(),
       metadata: {
-        taskCount: validTasks.length,
-        totalTasks: this.taskHistory.length,
+        taskCount: this.validTasks,
+        totalTasks: this.totalTasks,
         minQuality: this.config.minQuality
       }
     };
@@ -147,38 +163,17 @@ export class EphemeralLearningAgent {
    * Clear task history (after successful aggregation)
    */
   clearHistory(): void {
-    this.taskHistory = [];
+    this.embeddingSum = null;
+    this.qualitySum = 0;
+    this.validTasks = 0;
+    this.totalTasks = 0;
   }
 
   /**
    * Get current task count
    */
   getTaskCount(): number {
-    return this.taskHistory.length;
-  }
-
-  /**
-   * Compute average embedding from multiple embeddings
-   */
-  private computeAverageEmbedding(embeddings: Float32Array[]): Float32Array {
-    if (embeddings.length === 0) {
-      throw new Error('No embeddings to average');
-    }
-
-    const dim = embeddings[0].length;
-    const avg = new Float32Array(dim);
-
-    for (const embedding of embeddings) {
-      for (let i = 0; i < dim; i++) {
-        avg[i] += embedding[i];
-      }
-    }
-
-    for (let i = 0; i < dim; i++) {
-      avg[i] /= embeddings.length;
-    }
-
-    return avg;
+    return this.totalTasks;
   }
 }
 
@@ -197,6 +192,11 @@ export class FederatedLearningCoordinator {
   private consolidatedState: FederatedAgentState | null = null;
   private config: FederatedConfig;
 
+  // Quality-weighted sum of stored embeddings; a replaced or evicted state
+  // is subtracted back out
+  private weightedSum: Float64Array | null = null;
+  private totalWeight = 0;
+
   constructor(config: FederatedConfig) {
     this.coordinatorId = config.agentId;
     this.config = {
@@ -218,42 +218,45 @@ export class FederatedLearningCoordinator {
       return;
     }
 
-    // Check max agents limit
-    if (this.agentStates.size >= (this.config.maxAgents || 100)) {
+    if (this.weightedSum && state.embedding.length !== this.weightedSum.length) {
+      console.warn(`Agent ${state.agentId} state rejected: dimension ${state.embedding.length}, expected ${this.weightedSum.length}`);
+      return;
+    }
+
+    const previous = this.agentStates.get(state.agentId);
+    if (previous) {
+      this.removeState(previous);
+    } else if (this.agentStates.size >= (this.config.maxAgents || 100)) {
       // Remove oldest state if at limit
-      const oldestKey = Array.from(this.agentStates.entries())
-        .sort((a, b) => a[1].timestamp - b[1].timestamp)[0][0];
-      this.agentStates.delete(oldestKey);
+      let oldest: FederatedAgentState | null = null;
+      for (const candidate of this.agentStates.values()) {
+        if (!oldest || candidate.timestamp < oldest.timestamp) oldest = candidate;
+      }
+      if (oldest) this.removeState(oldest);
     }
 
     // Store agent state
     this.agentStates.set(state.agentId, state);
+    this.accumulate(state.embedding, state.quality);
   }
 
   /**
    * Consolidate all agent states into unified model
    */
   async consolidate(): Promise<FederatedAgentState> {
-    if (this.agentStates.size === 0) {
+    if (this.agentStates.size === 0 || !this.weightedSum) {
       throw new Error('No agent states to consolidate');
     }
 
-    const states = Array.from(this.agentStates.values());
-
-    // Compute weighted average based on quality
-    const totalWeight = states.reduce((sum, s) => sum + s.quality, 0);
-    const dim = states[0].embedding.length;
-    const consolidatedEmbedding = new Float32Array(dim);
-
-    for (const state of states) {
-      const weight = state.quality / totalWeight;
-      for (let i = 0; i < dim; i++) {
-        consolidatedEmbedding[i] += state.embedding[i] * weight;
+    // Weighted average based on quality
+    const consolidatedEmbedding = new Float32Array(this.weightedSum.length);
+    if (this.totalWeight > 0) {
+      for (let i = 0; i < consolidatedEmbedding.length; i++) {
+        consolidatedEmbedding[i] = this.weightedSum[i] / this.totalWeight;
       }
     }
 
-    // Compute average quality
-    const avgQuality = states.reduce((sum, s) => sum + s.quality, 0) / states.length;
+    const { avgQuality, minQuality, maxQuality } = this.qualityStats();
 
     this.consolidatedState = {
       agentId: this.coordinatorId,
@@ -261,9 +264,9 @@ export class FederatedLearningCoordinator {
       quality: avgQuality,
       timestamp: Date.now(),
       metadata: {
-        agentCount: states.length,
-        minQuality: Math.min(...states.map(s => s.quality)),
-        maxQuality: Math.max(...states.map(s => s.quality)),
+        agentCount: this.agentStates.size,
+        minQuality,
+        maxQuality,
         avgQuality
       }
     };
@@ -283,6 +286,8 @@ export class FederatedLearningCoordinator {
    */
   clearStates(): void {
     this.agentStates.clear();
+    this.weightedSum = null;
+    this.totalWeight = 0;
   }
 
   /**
@@ -302,9 +307,7 @@ export class FederatedLearningCoordinator {
     maxQuality: number;
     consolidated: boolean;
   } {
-    const states = Array.from(this.agentStates.values());
-
-    if (states.length === 0) {
+    if (this.agentStates.size === 0) {
       return {
         agentCount: 0,
         avgQuality: 0,
@@ -315,13 +318,44 @@ export class FederatedLearningCoordinator {
     }
 
     return {
-      agentCount: states.length,
-      avgQuality: states.reduce((sum, s) => sum + s.quality, 0) / states.length,
-      minQuality: Math.min(...states.map(s => s.quality)),
-      maxQuality: Math.max(...states.map(s => s.quality)),
+      agentCount: this.agentStates.size,
+      ...this.qualityStats(),
       consolidated: this.consolidatedState !== null
     };
   }
+
+  private accumulate(embedding: Float32Array, weight: number): void {
+    if (!this.weightedSum) {
+      this.weightedSum = new Float64Array(embedding.length);
+    }
+    const sum = this.weightedSum;
+    for (let i = 0; i < embedding.length; i++) {
+      sum[i] += embedding[i] * weight;
+    }
+    this.totalWeight += weight;
+  }
+
+  private removeState(state: FederatedAgentState): void {
+    this.agentStates.delete(state.agentId);
+    if (this.agentStates.size === 0) {
+      this.weightedSum = null;
+      this.totalWeight = 0;
+    } else {
+      this.accumulate(state.embedding, -state.quality);
+    }
+  }
+
+  private qualityStats(): { avgQuality: number; minQuality: number; maxQuality: number } {
+    let sum = 0;
+    let minQuality = Infinity;
+    let maxQuality = -Infinity;
+    for (const { quality } of this.agentStates.values()) {
+      sum += quality;
+      if (quality < minQuality) minQuality = quality;
+      if (quality > maxQuality) maxQuality = quality;
+    }
+    return { avgQuality: sum / this.agentStates.size, minQuality, maxQuality };
+  }
 }
 
 /**
@@ -489,4 +489,60 @@ describe('AttentionService', () => {
       expect(stats.totalOps).toBe(3);
     });
   });
+
+  describe('Batched Execution', () => {
+    const batchSize = 3;
+    const seqLen = 4;
+    const embedDim = 512;
+    const random = () => new Float32Array(batchSize * seqLen * embedDim).map(() => Math.random() - 0.5);
+
+    it('should match per-sample calls and write results in place', async () => {
+      const query = random();
+      const key = random();
+      const value = random();
+      const stride = seqLen * embedDim;
+
+      const expected: Float32Array[] = [];
+      for (let b = 0; b < batchSize; b++) {
+        const slice = (a: Float32Array) => a.slice(b * stride, (b + 1) * stride);
+        expected.push((await service.multiHeadAttention(slice(query), slice(key), slice(value))).output);
+      }
+
+      const result = await service.attentionBatch('multi-head', { query, key, value, batchSize, queryLen: seqLen, output: query });
+      expect(result.output).toBe(query);
+      expected.forEach((out, b) => {
+        out.forEach((v, i) => expect(Math.abs(query[b * stride + i] - v)).toBeLessThan(1e-6));
+      });
+
+      const linearQuery = random();
+      const single = await service.linearAttention(linearQuery.slice(0, stride), key.slice(0, stride), value.slice(0, stride));
+      const batched = await service.attentionBatch('linear', { query: linearQuery, key, value, batchSize, queryLen: seqLen });
+      single.output.forEach((v, i) => expect(Math.abs(batched.output[i] - v)).toBeLessThan(1e-5));
+    });
+
+    it('should cross into a native batch entry point once per batch', async () => {
+      const native = new AttentionService({ numHeads: 2, headDim: 4, embedDim: 8 });
+      await native.initialize();
+      let calls = 0;
+      (native as any).napiModule = {
+        multiHeadAttentionBatch: (...args: any[]) => {
+          calls++;
+          (args[8] as Float32Array).fill(1);
+        },
+      };
+
+      const input = () => new Float32Array(5 * 2 * 8);
+      const result = await native.attentionBatch('multi-head', { query: input(), key: input(), value: input(), batchSize: 5, queryLen: 2 });
+      expect(calls).toBe(1);
+      expect(result.runtime).toBe('napi');
+      expect(result.output.every((v) => v === 1)).toBe(true);
+    });
+
+    it('should reject mis-shaped inputs and outputs aliasing keys', async () => {
+      const query = random();
+      const key = random();
+      await expect(service.attentionBatch('flash', { query, key, value: key, batchSize, queryLen: seqLen + 1 })).rejects.toThrow('expected');
+      await expect(service.attentionBatch('flash', { query, key, value: random(), batchSize, queryLen: seqLen, output: key })).rejects.toThrow('alias');
+    });
+  });
 });
@@ -0,0 +1,205 @@
+/**
+ * BatchOperations Tests
+ *
+ * Worker-serialized, single-writer batchInsertParallel pipeline, and vector
+ * backend bulk-load buffering
+ */
+
+import { describe, it, expect } from 'vitest';
+import Database from 'better-sqlite3';
+import { BatchOperations } from '../optimizations/BatchOperations.js';
+import { RuVectorBackend } from '../backends/ruvector/RuVectorBackend.js';
+import { packRows, readPackedRow, serializeRows } from '../optimizations/row-serializer.js';
+
+function createDb() {
+  const db = new Database(':memory:');
+  db.exec(`
+    CREATE TABLE episodes (
+      id INTEGER PRIMARY KEY,
+      session_id TEXT,
+      task TEXT,
+      reward REAL,
+      metadata TEXT,
+      embedding BLOB
+    )
+  `);
+  return db;
+}
+
+function rows(count: number) {
+  return Array.from({ length: count }, (_, i) => ({
+    session_id: `s${i}`,
+    task: `task ${i}`,
+    reward: i / count,
+    metadata: { index: i },
+    embedding: new Float32Array([i, 0.5]),
+  }));
+}
+
+describe('BatchOperations.batchInsertParallel', () => {
+  const columns = ['session_id', 'task', 'reward', 'metadata', 'embedding'];
+
+  for (const useWorkers of [false, true]) {
+    it(`should insert every row (${useWorkers ? 'worker' : 'inline'} serialization)`, async () => {
+      const db = createDb();
+      const ops = new BatchOperations(db, {} as any);
+
+      const result = await ops.batchInsertParallel('episodes', rows(2500), columns, {
+        chunkSize: 500,
+        useWorkers,
+        workerCount: 2,
+      });
+
+      expect(result.totalInserted).toBe(2500);
+      expect(result.chunksProcessed).toBe(5);
+      expect(result.errors).toHaveLength(0);
+
+      const row = db.prepare('SELECT metadata, embedding FROM episodes WHERE session_id = ?').get('s7') as any;
+      expect(JSON.parse(row.metadata).index).toBe(7);
+      const embedding = new Float32Array(row.embedding.buffer, row.embedding.byteOffset, 2);
+      expect(embedding[0]).toBe(7);
+    });
+  }
+
+  it('should report failing chunks without losing the others', async () => {
+    const db = createDb();
+    db.exec('CREATE UNIQUE INDEX idx_session ON episodes(session_id)');
+    const ops = new BatchOperations(db, {} as any);
+
+    const data = rows(300);
+    data[250].session_id = 's0'; // duplicate in the last chunk
+
+    const result = await ops.batchInsertParallel('episodes', data, columns, {
+      chunkSize: 100,
+      retryAttempts: 0,
+    });
+
+    expect(result.totalInserted).toBe(200);
+    expect(result.errors.map((e) => e.chunk)).toEqual([2]);
+  });
+});
+
+describe('packRows', () => {
+  it('should read back the same bind values as serializeRows', () => {
+    const columns = ['text', 'number', 'object', 'bytes', 'missing', 'big'];
+    const data = [
+      { text: 'héllo ✓', number: 1.5, object: { a: [1, 2] }, bytes: new Float32Array([1, 2]), big: 9007199254740993n },
+      { text: '', number: -3, object: null, bytes: new Uint8Array(new Uint8Array([0, 1, 2, 3]).buffer, 1, 2) },
+    ];
+    const packed = packRows(data, columns);
+    const expected = serializeRows(data, columns);
+    const comparable = (v: any) => (v instanceof Uint8Array ? Array.from(v) : typeof v === 'bigint' ? `${v}n` : v);
+
+    expect(packed.length).toBe(2);
+    for (let r = 0; r < packed.length; r++) {
+      const row = readPackedRow(packed, r, new Array(columns.length));
+      expect(Buffer.isBuffer(row[3])).toBe(true);
+      expect(row.map(comparable)).toEqual(expected[r].map(comparable));
+    }
+  });
+});
+
+describe('BatchOperations vector bulk load', () => {
+  it('should wrap skill inserts in the backend bulk-load mode', async () => {
+    const db = new Database(':memory:');
+    db.exec(`
+      CREATE TABLE skills (
+        id INTEGER PRIMARY KEY, name TEXT, description TEXT, signature TEXT, code TEXT,
+        success_rate REAL, uses INTEGER, avg_reward REAL, avg_latency_ms REAL, tags TEXT, metadata TEXT
+      );
+      CREATE TABLE skill_embeddings (skill_id INTEGER PRIMARY KEY, embedding BLOB);
+    `);
+
+    const calls: string[] = [];
+    const inserted: string[] = [];
+    const backend = {
+      beginBulkLoad: () => calls.push('begin'),
+      insertBatch: (items: Array<{ id: string }>) => {
+        calls.push(`batch:${items.length}`);
+        inserted.push(...items.map(item => item.id));
+      },
+      endBulkLoad: async () => {
+        calls.push('end');
+      },
+    } as any;
+    const embedder = {
+      embedBatch: async (texts: string[]) => texts.map(() => new Float32Array([1, 0])),
+    } as any;
+
+    const ops = new BatchOperations(db, embedder, { batchSize: 2, vectorBackend: backend });
+    const ids = await ops.insertSkills([
+      { name: 'a', description: 'x' },
+      { name: 'b', description: 'y' },
+      { name: 'c', description: 'z' },
+    ]);
+
+    expect(calls).toEqual(['begin', 'batch:2', 'batch:1', 'end']);
+    expect(inserted).toEqual(ids.map(id => `skill:${id}`));
+  });
+});
+
+describe('RuVectorBackend bulk load', () => {
+  function createBackend() {
+    const inserted: string[] = [];
+    const backend = new RuVectorBackend({ dimension: 2, metric: 'cosine' });
+    Object.assign(backend as any, {
+      initialized: true,
+      db: {
+        insert: (entry: { id: string }) => inserted.push(entry.id),
+        insertBatch: (entries: Array<{ id: string }>) => inserted.push(...entries.map(e => e.id)),
+        remove: () => false,
+      },
+    });
+    return { backend, inserted };
+  }
+
+  it('should not insert ids removed during a bulk load', async () => {
+    const { backend, inserted } = createBackend();
+
+    backend.beginBulkLoad();
+    backend.insert('a', new Float32Array([1, 0]));
+    backend.insert('b', new Float32Array([0, 1]));
+    backend.insert('c', new Float32Array([1, 1]));
+    expect(backend.remove('b')).toBe(true);
+    expect(backend.remove('missing')).toBe(false);
+    await backend.endBulkLoad();
+
+    expect(inserted).toEqual(['a', 'c']);
+  });
+
+  it('should keep only the latest pending entry for a re-inserted id', async () => {
+    const { backend } = createBackend();
+    const batches: Array<Array<{ id: string; vector: Float32Array }>> = [];
+    (backend as any).db.insertBatch = (entries: any[]) => batches.push(entries);
+
+    backend.beginBulkLoad();
+    backend.insert('a', new Float32Array([1, 0]));
+    backend.insert('b', new Float32Array([0, 1]));
+    backend.remove('a');
+    backend.insert('a', new Float32Array([0.5, 0.5]));
+    await backend.endBulkLoad();
+
+    expect(batches).toHaveLength(1);
+    expect(batches[0].map(e => e.id)).toEqual(['b', 'a']);
+    expect(Array.from(batches[0][1].vector)).toEqual([0.5, 0.5]);
+  });
+});
+
+describe('RuVectorBackend search', () => {
+  it('should pass efSearch with each native query', () => {
+    const queries: any[] = [];
+    const backend = new RuVectorBackend({ dimension: 2, metric: 'cosine' });
+    Object.assign(backend as any, {
+      initialized: true,
+      db: {
+        count: () => 100,
+        search: (query: any) => (queries.push(query), [{ id: 'a', distance: 0.1 }]),
+      },
+    });
+
+    backend.search(new Float32Array([1, 0]), 5, { efSearch: 64 });
+    backend.search(new Float32Array([1, 0]), 5, { efSearch: 2 });
+    backend.search(new Float32Array([1, 0]), 5);
+    expect(queries.map((q) => q.efSearch)).toEqual([64, 5, undefined]);
+  });
+});
@@ -0,0 +1,67 @@
+/**
+ * Browser HNSWIndex Tests
+ *
+ * Multi-node inserts, recall against brute force and the layer distribution
+ */
+
+import { describe, it, expect } from 'vitest';
+import { HNSWIndex } from '../browser/HNSWIndex.js';
+
+// mulberry32, so recall does not depend on the run
+function seeded(seed: number) {
+  return () => {
+    seed = (seed + 0x6d2b79f5) >>> 0;
+    let t = seed;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function randomVectors(count: number, dimension: number, random: () => number): Float32Array[] {
+  return Array.from({ length: count }, () => Float32Array.from({ length: dimension }, () => random() * 2 - 1));
+}
+
+function euclidean(a: Float32Array, b: Float32Array): number {
+  let sum = 0;
+  for (let i = 0; i < a.length; i++) sum += (a[i] - b[i]) ** 2;
+  return Math.sqrt(sum);
+}
+
+describe('Browser HNSWIndex', () => {
+  it('should match brute-force neighbors after many inserts', () => {
+    const random = seeded(11);
+    const vectors = randomVectors(600, 16, random);
+    const index = new HNSWIndex({ dimension: 16, M: 12, efConstruction: 100, efSearch: 64, distanceFunction: 'euclidean' });
+    vectors.forEach((vector, id) => index.add(vector, id));
+    expect(index.size()).toBe(600);
+
+    const k = 10;
+    let hits = 0;
+    const queries = randomVectors(30, 16, random);
+    for (const query of queries) {
+      const exact = vectors
+        .map((vector, id) => ({ id, distance: euclidean(query, vector) }))
+        .sort((a, b) => a.distance - b.distance)
+        .slice(0, k)
+        .map(r => r.id);
+      const results = index.search(query, k);
+
+      expect(results).toHaveLength(k);
+      expect(results.map(r => r.distance)).toEqual([...results.map(r => r.distance)].sort((a, b) => a - b));
+      hits += results.filter(r => exact.includes(r.id)).length;
+    }
+    expect(hits / (queries.length * k)).toBeGreaterThan(0.9);
+  });
+
+  it('should place about half the nodes on layer 0 only', () => {
+    const index = new HNSWIndex({ dimension: 4, M: 8, efConstruction: 32 });
+    for (const vector of randomVectors(400, 4, seeded(5))) index.add(vector);
+
+    const levels: number[] = JSON.parse(index.export()).nodes.map((node: any) => node.level);
+    const ground = levels.filter(level => level === 0).length / levels.length;
+    expect(ground).toBeGreaterThan(0.35);
+    expect(ground).toBeLessThan(0.65);
+    expect(index.getStats().numLayers).toBeLessThan(16);
+  });
+});
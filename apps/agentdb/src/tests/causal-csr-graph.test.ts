@@ -0,0 +1,99 @@
+/**
+ * CausalCsrGraph Tests
+ *
+ * Best-first chain search against exhaustive enumeration, and the
+ * CausalMemoryGraph integration (incremental sync, id-prefix cycle bug)
+ */
+
+import { describe, it, expect } from 'vitest';
+import Database from 'better-sqlite3';
+import { CausalCsrGraph } from '../utils/CausalCsrGraph.js';
+import { CausalMemoryGraph } from '../controllers/CausalMemoryGraph.js';
+
+type Edge = [number, number, number, number]; // from, to, uplift, confidence
+
+function seededRandom(seed: number): () => number {
+  return () => {
+    seed = (seed * 1664525 + 1013904223) >>> 0;
+    return seed / 0x100000000;
+  };
+}
+
+/** Every simple path up to maxDepth edges, best total uplift first */
+function enumerate(edges: Edge[], from: number, to: number, maxDepth: number, minConfidence: number) {
+  const out: { path: number[]; uplift: number }[] = [];
+  const walk = (path: number[], uplift: number) => {
+    const node = path[path.length - 1];
+    if (node === to && path.length > 1) {
+      out.push({ path, uplift });
+      return;
+    }
+    if (path.length > maxDepth) return;
+    for (const [a, b, u, c] of edges) {
+      if (a === node && c >= minConfidence && !path.includes(b)) walk([...path, b], uplift + u);
+    }
+  };
+  walk([from], 0);
+  return out.sort((x, y) => y.uplift - x.uplift);
+}
+
+describe('CausalCsrGraph', () => {
+  it('should return the same top chains as exhaustive search', () => {
+    const random = seededRandom(7);
+    const edges: Edge[] = [];
+    for (let i = 0; i < 400; i++) {
+      edges.push([Math.floor(random() * 40), Math.floor(random() * 40), random() * 2 - 0.5, random()]);
+    }
+
+    const graph = new CausalCsrGraph();
+    edges.slice(0, 300).forEach(([a, b, u, c]) => graph.addEdge(a, b, u, c, false));
+    graph.build();
+    edges.slice(300).forEach(([a, b, u, c]) => graph.addEdge(a, b, u, c)); // delta lists
+
+    for (const [from, to] of [[0, 1], [3, 17], [22, 5]]) {
+      const expected = enumerate(edges, from, to, 4, 0.5).slice(0, 10);
+      const chains = graph.findChains(from, to, { maxDepth: 4, limit: 10 });
+      expect(chains).toHaveLength(expected.length);
+      chains.forEach((chain, i) => expect(chain.totalUplift).toBeCloseTo(expected[i].uplift, 9));
+      for (const chain of chains) {
+        expect(new Set(chain.path).size).toBe(chain.path.length);
+        expect(chain.path[0]).toBe(from);
+        expect(chain.path[chain.path.length - 1]).toBe(to);
+      }
+    }
+  });
+
+  it('should find chains through ids that prefix each other', () => {
+    const db = new Database(':memory:');
+    db.exec(`
+      CREATE TABLE causal_edges (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        from_memory_id INTEGER, from_memory_type TEXT, to_memory_id INTEGER, to_memory_type TEXT,
+        similarity REAL, uplift REAL, confidence REAL, sample_size INTEGER, evidence_ids TEXT,
+        confounder_score REAL, mechanism TEXT, metadata TEXT
+      )
+    `);
+    const graph = new CausalMemoryGraph(db as any);
+    const edge = (from: number, to: number, uplift: number) =>
+      graph.addCausalEdge({
+        fromMemoryId: from, fromMemoryType: 'episode', toMemoryId: to, toMemoryType: 'episode',
+        similarity: 0.9, uplift, confidence: 0.9,
+      });
+
+    return (async () => {
+      await edge(11, 1, 0.3);
+      await edge(1, 2, 0.2);
+      // "11->1" contains "1", so the LIKE cycle check used to drop this chain
+      expect(await graph.getCausalChain(11, 2)).toEqual([{ path: [11, 1, 2], totalUplift: 0.5, confidence: 0.9 }]);
+
+      // Appended through addCausalEdge and by other writers
+      await edge(11, 2, 0.1);
+      db.prepare(`INSERT INTO causal_edges (from_memory_id, from_memory_type, to_memory_id, to_memory_type, uplift, confidence)
+                  VALUES (11, 'episode', 5, 'episode', 0.5, 0.8), (5, 'episode', 2, 'episode', 0.5, 0.8)`).run();
+
+      const chains = await graph.getCausalChain(11, 2);
+      expect(chains.map((c) => c.path)).toEqual([[11, 5, 2], [11, 1, 2], [11, 2]]);
+      expect(chains[0].confidence).toBe(0.8);
+    })();
+  });
+});
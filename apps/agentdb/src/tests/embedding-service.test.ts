@@ -0,0 +1,146 @@
+/**
+ * EmbeddingService Tests
+ *
+ * Request coalescing, in-flight dedupe, bounded concurrency and the
+ * persistent second-tier cache
+ */
+
+import { describe, it, expect } from 'vitest';
+import Database from 'better-sqlite3';
+import { EmbeddingService } from '../controllers/EmbeddingService.js';
+import { PersistentEmbeddingCache } from '../controllers/PersistentEmbeddingCache.js';
+
+const dim = 8;
+
+/**
+ * Fake transformers.js pipeline that records the batches it receives
+ */
+function fakePipeline(calls: string[][], active?: { now: number; max: number }) {
+  return async (texts: string[]) => {
+    calls.push(texts);
+    if (active) {
+      active.now++;
+      active.max = Math.max(active.max, active.now);
+    }
+    await new Promise(resolve => setTimeout(resolve, 1));
+    if (active) active.now--;
+
+    const data = new Float32Array(texts.length * dim);
+    texts.forEach((text, i) => data.fill(text.length, i * dim, (i + 1) * dim));
+    return { data, dims: [texts.length, dim] };
+  };
+}
+
+function createService(overrides: Record<string, any> = {}) {
+  return new EmbeddingService({
+    model: 'test-model',
+    dimension: dim,
+    provider: 'transformers',
+    ...overrides,
+  });
+}
+
+describe('EmbeddingService batching', () => {
+  it('should coalesce concurrent embed() calls into one batch', async () => {
+    const service = createService();
+    const calls: string[][] = [];
+    (service as any).pipeline = fakePipeline(calls);
+
+    const [a, b, c] = await Promise.all([
+      service.embed('a'),
+      service.embed('bb'),
+      service.embed('ccc'),
+    ]);
+
+    expect(calls).toHaveLength(1);
+    expect(calls[0]).toEqual(['a', 'bb', 'ccc']);
+    expect(a[0]).toBe(1);
+    expect(b[0]).toBe(2);
+    expect(c[0]).toBe(3);
+  });
+
+  it('should dedupe identical in-flight texts', async () => {
+    const service = createService();
+    const calls: string[][] = [];
+    (service as any).pipeline = fakePipeline(calls);
+
+    const results = await service.embedBatch(['same', 'same', 'other', 'same']);
+
+    expect(calls).toEqual([['same', 'other']]);
+    expect(results[0]).toBe(results[1]);
+    expect(results).toHaveLength(4);
+  });
+
+  it('should split large batches and bound concurrency', async () => {
+    const service = createService({ maxBatchSize: 4, maxConcurrency: 2 });
+    const calls: string[][] = [];
+    const active = { now: 0, max: 0 };
+    (service as any).pipeline = fakePipeline(calls, active);
+
+    const texts = Array.from({ length: 20 }, (_, i) => `text-${i}`);
+    const results = await service.embedBatch(texts);
+
+    expect(results).toHaveLength(20);
+    expect(calls).toHaveLength(5);
+    expect(calls.every(batch => batch.length <= 4)).toBe(true);
+    expect(active.max).toBeLessThanOrEqual(2);
+  });
+
+  it('should reject every caller in a failed batch', async () => {
+    const service = createService();
+    (service as any).pipeline = async () => {
+      throw new Error('model failed');
+    };
+
+    const results = await Promise.allSettled([service.embed('x'), service.embed('y')]);
+    expect(results.every(r => r.status === 'rejected')).toBe(true);
+  });
+});
+
+describe('EmbeddingService persistent cache', () => {
+  it('should write back and read through across service instances', async () => {
+    const db = new Database(':memory:');
+    const store = new PersistentEmbeddingCache(db as any);
+
+    const first = createService({ persistentCache: store });
+    const calls: string[][] = [];
+    (first as any).pipeline = fakePipeline(calls);
+    const original = await first.embed('persist me');
+    store.flush();
+    expect(store.count('test-model')).toBe(1);
+
+    // A fresh service (e.g. after restart) must not call the model again
+    const second = createService({ persistentCache: store });
+    const secondCalls: string[][] = [];
+    (second as any).pipeline = fakePipeline(secondCalls);
+    const restored = await second.embed('persist me');
+
+    expect(secondCalls).toHaveLength(0);
+    expect(Array.from(restored)).toEqual(Array.from(original));
+  });
+
+  it('should bulk-load stored embeddings with warmCache()', async () => {
+    const db = new Database(':memory:');
+    const store = new PersistentEmbeddingCache(db as any);
+
+    const writer = createService({ persistentCache: store });
+    (writer as any).pipeline = fakePipeline([]);
+    await writer.embedBatch(['a', 'bb', 'ccc']);
+    store.flush();
+
+    const reader = createService({ persistentCache: store });
+    expect(await reader.warmCache()).toBe(3);
+    expect(await reader.warmCache(['bb', 'unknown'])).toBe(0); // already in memory
+    expect(reader.getCacheStats().size).toBe(3);
+  });
+
+  it('should keep models separate', () => {
+    const db = new Database(':memory:');
+    const store = new PersistentEmbeddingCache(db as any);
+    store.put('model-a', 'hash', new Float32Array([1, 2]));
+    store.flush();
+
+    expect(store.get('model-a', 'hash')).not.toBeNull();
+    expect(store.get('model-b', 'hash')).toBeNull();
+  });
+});
@@ -0,0 +1,120 @@
+/**
+ * ExplainableRecall Certificate Tests
+ *
+ * Deferred batch issuance, per-tick draining, Merkle root compatibility and cached tree extension
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import Database from 'better-sqlite3';
+import { ExplainableRecall } from '../controllers/ExplainableRecall.js';
+import { MerkleTreeCache, buildMerkleTree, sha256Hex } from '../utils/MerkleTree.js';
+
+const schemaDir = path.join(path.dirname(fileURLToPath(import.meta.url)), '../schemas');
+
+function createDb() {
+  const db = new Database(':memory:');
+  db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+  db.exec(fs.readFileSync(path.join(schemaDir, 'frontier-schema.sql'), 'utf-8'));
+  const episode = db.prepare("INSERT INTO episodes (session_id, task, output, reward, success) VALUES ('s', ?, ?, 0.9, 1)");
+  for (let i = 1; i <= 5; i++) episode.run(`task ${i}`, `output ${i}`);
+  return db;
+}
+
+function request(queryId: string, count: number) {
+  return {
+    queryId,
+    queryText: 'how to fix login',
+    chunks: Array.from({ length: count }, (_, i) => ({
+      id: String(i + 1),
+      type: 'episode',
+      content: `task ${i + 1}`,
+      relevance: 1 - i * 0.1,
+    })),
+    requirements: ['task', 'login'],
+  };
+}
+
+/** Tree as built before batching: pairwise sha of hex, odd node promoted */
+function referenceRoot(leaves: string[]): string {
+  let level = leaves;
+  while (level.length > 1) {
+    const next: string[] = [];
+    for (let i = 0; i < level.length; i += 2) {
+      next.push(i + 1 < level.length ? sha256Hex(level[i] + level[i + 1]) : level[i]);
+    }
+    level = next;
+  }
+  return level[0];
+}
+
+describe('ExplainableRecall certificates', () => {
+  it('should issue deferred certificates with the same root as immediate ones', async () => {
+    const db = createDb();
+    const recall = new ExplainableRecall(db as any);
+
+    const immediate = await recall.createCertificate(request('q1', 5));
+    const deferred = await recall.createCertificate(request('q2', 5), { defer: true });
+
+    expect(deferred.pending).toBe(true);
+    expect(deferred.merkleRoot).toBe('');
+    expect(recall.pendingCertificates).toBe(1);
+
+    expect(await recall.flushCertificates()).toBe(1);
+    expect(recall.pendingCertificates).toBe(0);
+
+    const row = db.prepare('SELECT merkle_root, source_hashes FROM recall_certificates WHERE id = ?').get(deferred.id) as any;
+    expect(row.merkle_root).toBe(immediate.merkleRoot);
+    expect(row.merkle_root).toBe(referenceRoot(JSON.parse(row.source_hashes)));
+    expect(recall.verifyCertificate(deferred.id)).toEqual({ valid: true, issues: [] });
+  });
+
+  it('should issue a queued certificate when it is read', async () => {
+    const db = createDb();
+    const recall = new ExplainableRecall(db as any, undefined, { deferCertificates: true });
+    const cert = await recall.createCertificate(request('q1', 3));
+
+    expect(recall.verifyCertificate(cert.id).valid).toBe(true);
+    expect(recall.pendingCertificates).toBe(0);
+  });
+
+  it('should drain the background queue one batch per tick', async () => {
+    const db = createDb();
+    const recall = new ExplainableRecall(db as any, undefined, { deferCertificates: true, certificateBatchSize: 2 });
+    for (let i = 0; i < 5; i++) await recall.createCertificate(request(`q${i}`, 2));
+    expect(recall.pendingCertificates).toBe(5);
+
+    const tick = () => new Promise((resolve) => setImmediate(resolve));
+    await tick();
+    expect(recall.pendingCertificates).toBe(3);
+    await tick();
+    await tick();
+    expect(recall.pendingCertificates).toBe(0);
+  });
+
+  it('should detect changed sources', async () => {
+    const db = createDb();
+    const recall = new ExplainableRecall(db as any);
+    const cert = await recall.createCertificate(request('q1', 3));
+
+    db.prepare("UPDATE episodes SET output = 'edited' WHERE id = 2").run();
+    expect(recall.verifyCertificate(cert.id).issues).toEqual(['Chunk 2 hash changed']);
+  });
+});
+
+describe('MerkleTreeCache', () => {
+  it('should extend a cached prefix to the same tree as a full build', () => {
+    const leaves = Array.from({ length: 11 }, (_, i) => sha256Hex(`leaf ${i}`));
+    const cache = new MerkleTreeCache();
+
+    cache.get(leaves.slice(0, 6));
+    const extended = cache.get(leaves);
+
+    expect(cache.getStats()).toMatchObject({ builds: 1, extensions: 1 });
+    expect(extended).toEqual(buildMerkleTree(leaves));
+    expect(extended.root).toBe(referenceRoot(leaves));
+    expect(cache.get(leaves)).toBe(extended);
+  });
+});
@@ -0,0 +1,79 @@
+/**
+ * HNSW Compaction Tests
+ *
+ * Copying live points into a fresh graph and replaying writes made meanwhile
+ */
+
+import { describe, it, expect } from 'vitest';
+import { compactHnswIndex, replayCompactionLog } from '../utils/hnsw-compaction.js';
+
+/** Minimal stand-in with hnswlib's tombstone semantics */
+class FakeIndex {
+  points = new Map<number, number[]>();
+  deleted = new Set<number>();
+  max: number;
+  constructor(max: number) { this.max = max; }
+  getMaxElements() { return this.max; }
+  getCurrentCount() { return this.points.size; }
+  resizeIndex(max: number) { this.max = max; }
+  addPoint(vector: ArrayLike<number>, label: number) {
+    if (!this.points.has(label) && this.points.size >= this.max) throw new Error('Index full');
+    this.deleted.delete(label);
+    this.points.set(label, Array.from(vector));
+  }
+  markDelete(label: number) {
+    if (!this.points.has(label) || this.deleted.has(label)) throw new Error('Label not found');
+    this.deleted.add(label);
+  }
+  getPoint(label: number) {
+    if (!this.points.has(label) || this.deleted.has(label)) throw new Error('Label not found');
+    return this.points.get(label)!;
+  }
+}
+
+describe('hnsw-compaction', () => {
+  it('should copy only live labels, keeping them unchanged', async () => {
+    const source = new FakeIndex(10);
+    for (let label = 0; label < 10; label++) source.addPoint([label, 0], label);
+    for (const label of [1, 4, 7]) source.markDelete(label);
+
+    const live = [0, 2, 3, 5, 6, 8, 9];
+    const target = (await compactHnswIndex(source, [...live, 4], {
+      createIndex: (capacity) => new FakeIndex(capacity),
+      cpuShare: 1,
+    })) as FakeIndex;
+
+    expect(Array.from(target.points.keys())).toEqual(live);
+    expect(target.getPoint(8)).toEqual([8, 0]);
+  });
+
+  it('should replay logged writes and report remaining tombstones', () => {
+    const target = new FakeIndex(2);
+    target.addPoint([0], 0);
+    target.addPoint([1], 1);
+
+    const tombstoned = replayCompactionLog(target, [
+      { op: 'remove', label: 0 },
+      { op: 'add', label: 2, vector: new Float32Array([2]) },
+      { op: 'remove', label: 1 },
+      { op: 'add', label: 1, vector: new Float32Array([5]) },
+      { op: 'remove', label: 9 }, // never copied
+    ]);
+
+    expect(Array.from(tombstoned)).toEqual([0]);
+    expect(target.getPoint(1)).toEqual([5]);
+    expect(target.getPoint(2)).toEqual([2]);
+    expect(target.getMaxElements()).toBeGreaterThanOrEqual(3);
+  });
+
+  it('should stop when asked to abort', async () => {
+    const source = new FakeIndex(3);
+    for (let label = 0; label < 3; label++) source.addPoint([label], label);
+
+    const result = await compactHnswIndex(source, [0, 1, 2], {
+      createIndex: (capacity) => new FakeIndex(capacity),
+      shouldAbort: () => true,
+    });
+    expect(result).toBeNull();
+  });
+});
@@ -0,0 +1,50 @@
+/**
+ * HNSWIndex Streaming Rebuild Tests
+ *
+ * Writes landing while a shadow index is built are replayed as upserts
+ */
+
+import { describe, it, expect } from 'vitest';
+import Database from 'better-sqlite3';
+import { HNSWIndex } from '../controllers/HNSWIndex.js';
+
+function vector(i: number): Float32Array {
+  return new Float32Array([Math.sin(i), Math.cos(i), (i % 7) / 7, 1]);
+}
+
+function createDb(count: number) {
+  const db = new Database(':memory:');
+  db.exec('CREATE TABLE pattern_embeddings (pattern_id INTEGER PRIMARY KEY, embedding BLOB)');
+  const insert = db.prepare('INSERT INTO pattern_embeddings (pattern_id, embedding) VALUES (?, ?)');
+  for (let i = 1; i <= count; i++) insert.run(i, Buffer.from(vector(i).buffer));
+  return db;
+}
+
+describe('HNSWIndex streaming rebuild', () => {
+  it('should replace vectors written after their page was streamed', async () => {
+    const db = createDb(300);
+    const index = new HNSWIndex(db, { dimension: 4, persistIndex: false, compactionThreshold: 0 });
+    await index.buildIndex();
+
+    // The first page (ids 1-50) is in the shadow index before this returns
+    const rebuild = index.buildIndex('pattern_embeddings', { streaming: true, batchSize: 50 });
+
+    const updated = new Float32Array([-1, -1, 0, 0.1]);
+    index.removeVector(10);
+    index.addVector(10, updated);
+    index.removeVector(30);
+    index.removeVector(40);
+    index.addVector(40, vector(40));
+    index.addVector(1000, new Float32Array([1, -1, -1, 0]));
+    await rebuild;
+
+    const top = await index.search(updated, 1);
+    expect(top[0].id).toBe(10);
+    expect(top[0].similarity).toBeCloseTo(1, 5);
+    expect((await index.search(vector(10), 1))[0].id).not.toBe(10);
+    expect((await index.search(vector(30), 5)).map(r => r.id)).not.toContain(30);
+    expect((await index.search(vector(40), 1))[0].id).toBe(40);
+    expect((await index.search(new Float32Array([1, -1, -1, 0]), 1))[0].id).toBe(1000);
+    expect(index.getStats().numElements).toBe(300);
+  });
+});
@@ -0,0 +1,68 @@
+/**
+ * HNSWLibBackend search worker tests
+ *
+ * searchAsync() served from read-only worker replicas, including stale ones
+ */
+
+import { describe, it, expect } from 'vitest';
+import { HNSWLibBackend } from '../backends/hnswlib/HNSWLibBackend.js';
+
+function vector(i: number): Float32Array {
+  return new Float32Array([Math.sin(i), Math.cos(i), (i % 7) / 7, 1]);
+}
+
+describe('HNSWLibBackend.searchAsync', () => {
+  it('should match search() once replicas are current, including allowedIds', async () => {
+    const backend = new HNSWLibBackend({ dimension: 4, metric: 'cosine', searchWorkers: 2, searchRefreshMs: 10 });
+    await backend.initialize();
+    for (let i = 0; i < 200; i++) backend.insert(`v${i}`, vector(i));
+    backend.remove('v3');
+
+    const query = new Float32Array([0.5, 0.5, 0.4, 1]);
+    const expected = backend.search(query, 5).map(r => r.id);
+
+    // First call finds the replicas stale, answers inline and schedules a publish
+    expect((await backend.searchAsync(query, 5)).map(r => r.id)).toEqual(expected);
+    expect(backend.getStats().searchWorkers).toMatchObject({ workers: 2, publishedGeneration: -1, searches: 0 });
+    await backend.whenSearchReplicasRefreshed();
+
+    expect((await backend.searchAsync(query, 5)).map(r => r.id)).toEqual(expected);
+    const stats = backend.getStats().searchWorkers!;
+    expect(stats.publishedGeneration).toBe((backend as any).generation);
+    expect(stats.searches).toBe(1);
+
+    const allowedIds = new Set(['v1', 'v2', 'v3', 'v4']);
+    const filtered = await backend.searchAsync(query, 3, { allowedIds });
+    expect(filtered.map(r => r.id)).toEqual(backend.search(query, 3, { allowedIds }).map(r => r.id));
+    expect(filtered.map(r => r.id)).not.toContain('v3');
+    expect(backend.getStats().searchWorkers!.searches).toBe(2);
+
+    backend.close();
+  });
+
+  it('should serve from a stale replica unless a returned label changed', async () => {
+    const backend = new HNSWLibBackend({ dimension: 4, metric: 'cosine', searchWorkers: 1, searchRefreshMs: 10 });
+    await backend.initialize();
+    for (let i = 0; i < 100; i++) backend.insert(`v${i}`, vector(i));
+    await backend.searchAsync(vector(0), 1);
+    await backend.whenSearchReplicasRefreshed();
+
+    // 'fresh' reuses v10's label; the replica still has v10 under it
+    backend.remove('v10');
+    backend.insert('fresh', new Float32Array([-1, -1, -1, -1]));
+    const published = backend.getStats().searchWorkers!.publishedGeneration;
+
+    const far = await backend.searchAsync(vector(50), 3);
+    expect(far.map(r => r.id)).toEqual(backend.search(vector(50), 3).map(r => r.id));
+    expect(backend.getStats().searchWorkers).toMatchObject({ publishedGeneration: published, searches: 1 });
+
+    const near = await backend.searchAsync(vector(10), 3);
+    expect(near.map(r => r.id)).toEqual(backend.search(vector(10), 3).map(r => r.id));
+    expect(near.map(r => r.id)).not.toContain('fresh');
+    expect(backend.getStats().searchWorkers!.searches).toBe(2);
+
+    await backend.whenSearchReplicasRefreshed();
+    expect(backend.getStats().searchWorkers!.publishedGeneration).toBeGreaterThan(published);
+    backend.close();
+  });
+});
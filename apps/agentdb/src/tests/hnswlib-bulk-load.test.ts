@@ -0,0 +1,42 @@
+/**
+ * HNSWLibBackend bulk load tests
+ *
+ * Worker-built graphs keep writes made while the worker was building
+ */
+
+import { describe, it, expect } from 'vitest';
+import { HNSWLibBackend } from '../backends/hnswlib/HNSWLibBackend.js';
+
+function vector(i: number): Float32Array {
+  return new Float32Array([Math.sin(i), Math.cos(i), Math.sin(i * 0.37), Math.cos(i * 1.7)]);
+}
+
+describe('HNSWLibBackend bulk load', () => {
+  it('should apply inserts and removes made during a worker build', async () => {
+    const backend = new HNSWLibBackend({ dimension: 4, metric: 'l2', bulkWorkerThreshold: 100 });
+    await backend.initialize();
+    backend.beginBulkLoad();
+    for (let i = 0; i < 300; i++) backend.insert(`v${i}`, vector(i));
+
+    const loading = backend.endBulkLoad();
+    expect(backend.isBulkLoading()).toBe(true);
+    backend.remove('v5');
+    backend.insert('late1', vector(1000));
+    backend.remove('v6');
+    backend.insert('late2', vector(2000)); // reuses v6's label
+    backend.remove('late1');
+    backend.insert('late3', vector(3000));
+    await loading;
+
+    expect(backend.isBulkLoading()).toBe(false);
+    expect(backend.getStats().count).toBe(300);
+    expect(backend.search(vector(5), 1)[0].id).not.toBe('v5');
+    expect(backend.search(vector(6), 1)[0].id).not.toBe('late2');
+    expect(backend.search(vector(1000), 1)[0].id).not.toBe('late1');
+    expect(backend.search(vector(2000), 1)[0]).toMatchObject({ id: 'late2', distance: 0 });
+    expect(backend.search(vector(3000), 1)[0]).toMatchObject({ id: 'late3', distance: 0 });
+    expect(backend.search(vector(42), 1)[0].id).toBe('v42');
+
+    backend.close();
+  });
+});
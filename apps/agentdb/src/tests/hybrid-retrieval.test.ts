@@ -0,0 +1,119 @@
+/**
+ * Hybrid Retrieval Tests
+ *
+ * BM25 lookups through the FTS5 index, exact-token queries that skip the
+ * embedder, and RRF fusion with ANN results in ReasoningBank and SkillLibrary
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import Database from 'better-sqlite3';
+import { ReasoningBank } from '../controllers/ReasoningBank.js';
+import { SkillLibrary } from '../controllers/SkillLibrary.js';
+import { fuseRankings, isExactTokenQuery } from '../utils/LexicalIndex.js';
+
+const schemaDir = path.join(path.dirname(fileURLToPath(import.meta.url)), '../schemas');
+
+/** Embeds text onto axes by keyword and counts calls */
+function createEmbedder() {
+  const embedder = {
+    calls: 0,
+    embed: async (text: string) => {
+      embedder.calls++;
+      const t = text.toLowerCase();
+      return new Float32Array([t.includes('deploy') ? 1 : 0, t.includes('test') ? 1 : 0, t.includes('database') ? 1 : 0, 0.1]);
+    },
+  };
+  return embedder;
+}
+
+describe('LexicalIndex helpers', () => {
+  it('should treat identifiers, not prose, as exact-token queries', () => {
+    expect(isExactTokenQuery('read_file')).toBe(true);
+    expect(isExactTokenQuery('ECONNREFUSED')).toBe(true);
+    expect(isExactTokenQuery('E11000 fs.readFile')).toBe(true);
+    expect(isExactTokenQuery('deploy the service')).toBe(false);
+  });
+
+  it('should reward items ranked by both lists under RRF', () => {
+    const fused = fuseRankings(
+      [{ id: 1, score: 9 }, { id: 2, score: 5 }],
+      [{ id: 3, score: 0.9 }, { id: 2, score: 0.8 }]
+    );
+    expect(fused[0].id).toBe(2);
+  });
+});
+
+describe('ReasoningBank hybrid search', () => {
+  async function createBank() {
+    const embedder = createEmbedder();
+    const bank = new ReasoningBank(new Database(':memory:') as any, embedder as any);
+    await bank.storePattern({ taskType: 'deploy', approach: 'Roll back when read_file returns ENOENT', successRate: 0.9 });
+    await bank.storePattern({ taskType: 'deploy', approach: 'Blue green deploy behind the load balancer', successRate: 0.8 });
+    await bank.storePattern({ taskType: 'testing', approach: 'Retry flaky test suites once', successRate: 0.7 });
+    embedder.calls = 0;
+    return { bank, embedder };
+  }
+
+  it('should resolve exact tokens through postings without embedding', async () => {
+    const { bank, embedder } = await createBank();
+    const results = await bank.searchPatterns({ task: 'ENOENT', retrieval: 'hybrid', k: 5 });
+    expect(results.map((p) => p.approach)).toEqual(['Roll back when read_file returns ENOENT']);
+    expect(await bank.searchPatterns({ task: 'read_file', retrieval: 'lexical' })).toHaveLength(1);
+    expect(embedder.calls).toBe(0);
+  });
+
+  it('should back-fill at construction and run no DDL on search', async () => {
+    const db = new Database(':memory:');
+    db.exec(`
+      CREATE TABLE reasoning_patterns (
+        id INTEGER PRIMARY KEY AUTOINCREMENT, ts INTEGER, task_type TEXT NOT NULL, approach TEXT NOT NULL,
+        success_rate REAL NOT NULL DEFAULT 0.0, uses INTEGER DEFAULT 0, avg_reward REAL DEFAULT 0.0, tags TEXT, metadata TEXT
+      );
+      INSERT INTO reasoning_patterns (task_type, approach) VALUES ('deploy', 'Drain nodes before ECONNREFUSED retries');
+    `);
+    const bank = new ReasoningBank(db as any, createEmbedder() as any);
+
+    const exec = db.exec.bind(db);
+    const ddl: string[] = [];
+    (db as any).exec = (sql: string) => (ddl.push(sql), exec(sql));
+    expect(await bank.searchPatterns({ task: 'ECONNREFUSED', retrieval: 'lexical' })).toHaveLength(1);
+    expect(ddl).toEqual([]);
+  });
+
+  it('should fuse BM25 and vector rankings for prose queries', async () => {
+    const { bank, embedder } = await createBank();
+    const results = await bank.searchPatterns({ task: 'load balancer deploy', retrieval: 'hybrid', k: 2 });
+    expect(embedder.calls).toBeGreaterThan(0);
+    expect(results[0].approach).toBe('Blue green deploy behind the load balancer');
+    expect(results[0].similarity).toBeGreaterThan(0);
+
+    const filtered = await bank.searchPatterns({ task: 'ENOENT', retrieval: 'lexical', filters: { taskType: 'testing' } });
+    expect(filtered).toEqual([]);
+  });
+});
+
+describe('SkillLibrary hybrid retrieval', () => {
+  it('should keep the index in sync with skill writes', async () => {
+    const db = new Database(':memory:');
+    db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+    const embedder = createEmbedder();
+    const library = new SkillLibrary(db as any, embedder as any);
+
+    await library.createSkill({ name: 'git_rebase_onto', description: 'Rebase a branch onto main', successRate: 0.9 });
+    const id = await library.createSkill({ name: 'run_database_migration', description: 'Apply pending migrations', successRate: 0.8 });
+    embedder.calls = 0;
+
+    expect((await library.retrieveSkills({ task: 'git_rebase_onto', retrieval: 'hybrid' })).map((s) => s.name)).toEqual(['git_rebase_onto']);
+    expect(embedder.calls).toBe(0);
+
+    db.prepare("UPDATE skills SET name = 'run_schema_migration' WHERE id = ?").run(id);
+    expect(await library.retrieveSkills({ task: 'run_database_migration', retrieval: 'lexical' })).toEqual([]);
+    expect((await library.retrieveSkills({ task: 'run_schema_migration', retrieval: 'lexical' }))[0].id).toBe(id);
+
+    const prose = await library.retrieveSkills({ task: 'database migrations', retrieval: 'hybrid', k: 1 });
+    expect(prose.map((s) => s.id)).toEqual([id]);
+  });
+});
@@ -0,0 +1,81 @@
+/**
+ * IndexFile Tests
+ *
+ * Single-file index container: base sections, appended deltas, checksums
+ */
+
+import { describe, it, expect, beforeEach } from 'vitest';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { isIndexFile, readIndexFile, writeIndexFile, appendIndexDelta } from '../utils/IndexFile.js';
+
+const GRAPH = Buffer.from('fake hnsw graph bytes');
+
+describe('IndexFile', () => {
+  let file: string;
+
+  beforeEach(() => {
+    file = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'agentdb-indexfile-')), 'index.bin');
+  });
+
+  function writeBase(): number {
+    return writeIndexFile(
+      file,
+      (graphPath) => fs.writeFileSync(graphPath, GRAPH),
+      [['a', 0], ['b', 1]],
+      { nextLabel: 2 }
+    );
+  }
+
+  function read() {
+    let graph: Buffer | null = null;
+    const contents = readIndexFile(file, (graphPath) => {
+      graph = fs.readFileSync(graphPath);
+    });
+    return { ...contents, graph: graph as Buffer | null };
+  }
+
+  it('should round-trip graph, ids and metadata', () => {
+    const length = writeBase();
+    expect(isIndexFile(file)).toBe(true);
+    expect(fs.statSync(file).size).toBe(length);
+
+    const contents = read();
+    expect(contents.graph!.equals(GRAPH)).toBe(true);
+    expect(contents.ids).toEqual([['a', 0], ['b', 1]]);
+    expect(contents.meta.nextLabel).toBe(2);
+    expect(contents.deltas).toHaveLength(0);
+  });
+
+  it('should replay appended deltas and skip a torn tail', () => {
+    let length = writeBase();
+    length = appendIndexDelta(file, [
+      { op: 'add', id: 'c', label: 2, vector: new Float32Array([1, 2, 3]), metadata: { tag: 'x' } },
+    ], length)!;
+    length = appendIndexDelta(file, [{ op: 'remove', id: 'a' }], length)!;
+    fs.appendFileSync(file, Buffer.from([0x44, 0x4c, 0x54])); // partial record
+
+    const contents = read();
+    expect(contents.length).toBe(length);
+    expect(contents.deltas).toHaveLength(2);
+    const add = contents.deltas[0] as any;
+    expect(add.id).toBe('c');
+    expect(Array.from(add.vector)).toEqual([1, 2, 3]);
+    expect(add.metadata).toEqual({ tag: 'x' });
+    expect(contents.deltas[1]).toEqual({ op: 'remove', id: 'a' });
+
+    // The next append truncates the torn bytes first
+    appendIndexDelta(file, [{ op: 'remove', id: 'b' }], contents.length);
+    expect(read().deltas).toHaveLength(3);
+  });
+
+  it('should reject a corrupted base section', () => {
+    writeBase();
+    const bytes = fs.readFileSync(file);
+    bytes[40] ^= 0xff; // inside the graph payload
+    fs.writeFileSync(file, bytes);
+
+    expect(() => read()).toThrow(/checksum/);
+  });
+});
@@ -0,0 +1,87 @@
+/**
+ * Latency Histogram Tests
+ *
+ * HDR bucket precision, stage traces, span sampling and Prometheus output
+ */
+
+import { describe, it, expect, beforeEach } from 'vitest';
+import {
+  LatencyHistogram,
+  startTrace,
+  setSpanSink,
+  latencySnapshot,
+  resetLatencyHistograms,
+  renderPrometheus,
+  type SampledTrace,
+} from '../observability/latency.js';
+
+describe('LatencyHistogram', () => {
+  it('should report percentiles within bucket precision', () => {
+    const histogram = new LatencyHistogram();
+    for (let i = 1; i <= 1000; i++) histogram.record(i / 10); // 0.1ms .. 100ms
+
+    expect(histogram.count).toBe(1000);
+    expect(histogram.percentile(0.5)).toBeGreaterThanOrEqual(50);
+    expect(histogram.percentile(0.5)).toBeLessThan(50 * 1.04);
+    expect(histogram.percentile(0.99)).toBeGreaterThanOrEqual(99);
+    expect(histogram.percentile(0.99)).toBeLessThan(99 * 1.04);
+    expect(histogram.percentile(1)).toBe(100);
+    expect(histogram.snapshot().min).toBeCloseTo(0.1, 6);
+  });
+
+  it('should keep extreme values and merge counts', () => {
+    const a = new LatencyHistogram();
+    const b = new LatencyHistogram();
+    a.record(0);
+    b.record(1e9);
+    a.merge(b);
+
+    expect(a.count).toBe(2);
+    expect(a.percentile(1)).toBeGreaterThan(2e6);
+    a.reset();
+    expect(a.percentile(0.5)).toBe(0);
+  });
+});
+
+describe('Stage traces', () => {
+  beforeEach(() => {
+    resetLatencyHistograms();
+    setSpanSink(null);
+  });
+
+  it('should record each stage and the total', () => {
+    const trace = startTrace('test.retrieve');
+    trace.stage('embed');
+    trace.stage('ann');
+    trace.end();
+
+    const stages = latencySnapshot()['test.retrieve'];
+    expect(Object.keys(stages).sort()).toEqual(['ann', 'embed', 'total']);
+    expect(stages.total.count).toBe(1);
+  });
+
+  it('should hand only sampled traces to the span sink', () => {
+    const exported: SampledTrace[] = [];
+    setSpanSink((trace) => exported.push(trace), 1);
+    const trace = startTrace('test.sampled');
+    trace.stage('fetch');
+    trace.end();
+
+    setSpanSink((trace) => exported.push(trace), 0);
+    startTrace('test.sampled').end();
+
+    expect(exported).toHaveLength(1);
+    expect(exported[0].stages.map((s) => s.stage)).toEqual(['fetch']);
+  });
+
+  it('should render a Prometheus summary per stage', () => {
+    const trace = startTrace('test.prom');
+    trace.stage('filter');
+    trace.end();
+
+    const text = renderPrometheus();
+    expect(text).toContain('# TYPE agentdb_stage_latency_seconds summary');
+    expect(text).toContain('agentdb_stage_latency_seconds{operation="test.prom",stage="filter",quantile="0.99"}');
+    expect(text).toContain('agentdb_stage_latency_seconds_count{operation="test.prom",stage="total"} 1');
+  });
+});
@@ -0,0 +1,73 @@
+/**
+ * MMRDiversityRanker Tests
+ *
+ * Incremental max-similarity selection must match the textbook MMR loop
+ */
+
+import { describe, it, expect } from 'vitest';
+import { MMRDiversityRanker, type MMRCandidate } from '../controllers/MMRDiversityRanker.js';
+
+function seededRandom(seed: number): () => number {
+  return () => {
+    seed = (seed * 1664525 + 1013904223) >>> 0;
+    return seed / 0x100000000;
+  };
+}
+
+function similarity(a: ArrayLike<number>, b: ArrayLike<number>, metric: string): number {
+  let dot = 0, na = 0, nb = 0, sq = 0;
+  for (let i = 0; i < a.length; i++) {
+    dot += a[i] * b[i];
+    na += a[i] * a[i];
+    nb += b[i] * b[i];
+    sq += (a[i] - b[i]) ** 2;
+  }
+  if (metric === 'cosine') return dot / Math.sqrt(na * nb);
+  if (metric === 'euclidean') return 1 / (1 + Math.sqrt(sq));
+  return dot;
+}
+
+/** Reference O(k²·n·d) implementation */
+function naiveMMR(candidates: MMRCandidate[], k: number, lambda: number, metric: string): number[] {
+  const remaining = [...candidates].sort((a, b) => b.similarity - a.similarity);
+  const selected = [remaining.shift()!];
+  while (selected.length < k) {
+    let best = -Infinity;
+    let bestIdx = 0;
+    remaining.forEach((c, i) => {
+      const maxSim = Math.max(...selected.map((s) => similarity(c.embedding, s.embedding, metric)));
+      const score = lambda * c.similarity - (1 - lambda) * maxSim;
+      if (score > best) {
+        best = score;
+        bestIdx = i;
+      }
+    });
+    selected.push(remaining.splice(bestIdx, 1)[0]);
+  }
+  return selected.map((c) => c.id);
+}
+
+describe('MMRDiversityRanker', () => {
+  const random = seededRandom(42);
+  const dim = 24;
+  const query = Array.from({ length: dim }, () => random() - 0.5);
+  const candidates: MMRCandidate[] = Array.from({ length: 80 }, (_, id) => {
+    const embedding = new Float32Array(dim).map(() => random() - 0.5);
+    return { id, embedding, similarity: similarity(query, embedding, 'cosine') };
+  });
+
+  for (const metric of ['cosine', 'euclidean', 'dot'] as const) {
+    it(`should match the reference selection (${metric})`, () => {
+      const input = candidates.map((c) => ({ ...c, similarity: similarity(query, c.embedding, metric) }));
+      const result = MMRDiversityRanker.selectDiverse(input, query, { k: 12, lambda: 0.6, metric });
+
+      expect(result.map((c) => c.id)).toEqual(naiveMMR(input, 12, 0.6, metric));
+      expect(result[0]).toBe(input.find((c) => c.id === result[0].id)); // no copies
+    });
+  }
+
+  it('should reject mixed dimensions', () => {
+    const bad = [...candidates.slice(0, 20), { id: 999, embedding: [1, 2], similarity: 0.5 }];
+    expect(() => MMRDiversityRanker.selectDiverse(bad, query, { k: 5 })).toThrow(/dimension mismatch/);
+  });
+});
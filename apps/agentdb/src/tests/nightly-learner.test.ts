@@ -0,0 +1,89 @@
+/**
+ * NightlyLearner Tests
+ *
+ * Watermarked, checkpointed causal discovery over new episodes only
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import Database from 'better-sqlite3';
+import { NightlyLearner } from '../controllers/NightlyLearner.js';
+
+const schemaDir = path.join(path.dirname(fileURLToPath(import.meta.url)), '../schemas');
+
+function createDb() {
+  const db = new Database(':memory:');
+  db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+  db.exec(fs.readFileSync(path.join(schemaDir, 'frontier-schema.sql'), 'utf-8'));
+  return db;
+}
+
+/** Sessions of alternating low/high reward episodes a few minutes apart */
+function addSessions(db: any, from: number, count: number) {
+  const insert = db.prepare('INSERT INTO episodes (ts, session_id, task, reward, success) VALUES (?, ?, ?, ?, ?)');
+  for (let s = from; s < from + count; s++) {
+    for (let i = 0; i < 4; i++) {
+      insert.run(1000 + i * 60, `session-${s}`, i % 2 ? 'deploy' : 'plan', i % 2 ? 0.9 : 0.1, i % 2);
+    }
+  }
+}
+
+function createLearner(db: any) {
+  const embedder = { embed: async () => new Float32Array(8), embedBatch: async (t: string[]) => t.map(() => new Float32Array(8)) };
+  return new NightlyLearner(db, embedder as any, {
+    minSimilarity: 0.7,
+    minSampleSize: 30,
+    confidenceThreshold: 0.1,
+    upliftThreshold: 0.05,
+    pruneOldEdges: false,
+    edgeMaxAgeDays: 90,
+    autoExperiments: false,
+    experimentBudget: 0,
+    checkpointEpisodes: 7,
+  });
+}
+
+describe('NightlyLearner incremental discovery', () => {
+  it('should only scan episodes added since the last run', async () => {
+    const db = createDb();
+    addSessions(db, 0, 30);
+    const learner = createLearner(db);
+
+    const first = await learner.run();
+    const edges = (db.prepare('SELECT COUNT(*) AS n FROM causal_edges').get() as any).n;
+    expect(first.episodesProcessed).toBe(120);
+    expect(first.edgesDiscovered).toBe(edges);
+    expect(edges).toBeGreaterThan(0);
+
+    const idle = await learner.run();
+    expect(idle.episodesProcessed).toBe(0);
+    expect(idle.edgesDiscovered).toBe(0);
+
+    addSessions(db, 30, 2);
+    const delta = await learner.run();
+    expect(delta.episodesProcessed).toBe(8);
+    const pairs = db.prepare(`
+      SELECT COUNT(*) AS n FROM causal_edges ce
+      JOIN episodes e ON e.id = ce.to_memory_id
+      WHERE e.session_id IN ('session-30', 'session-31')
+    `).get() as any;
+    expect(delta.edgesDiscovered).toBe(pairs.n);
+  });
+
+  it('should resume from the last checkpoint without duplicating edges', async () => {
+    const db = createDb();
+    addSessions(db, 0, 10);
+    await createLearner(db).run();
+    const edges = (db.prepare('SELECT COUNT(*) AS n FROM causal_edges').get() as any).n;
+
+    // Roll the watermark back as if the run died mid-way
+    db.prepare("UPDATE learner_watermarks SET last_episode_id = 13 WHERE job = 'discover'").run();
+    const resumed = await createLearner(db).run();
+
+    expect(resumed.episodesProcessed).toBe(40 - 13);
+    expect(resumed.edgesDiscovered).toBe(0);
+    expect((db.prepare('SELECT COUNT(*) AS n FROM causal_edges').get() as any).n).toBe(edges);
+  });
+});
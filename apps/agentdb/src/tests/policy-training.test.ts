@@ -0,0 +1,145 @@
+/**
+ * Policy Training Tests
+ *
+ * Dense policy tables, mini-batch TD training on and off the main thread,
+ * and streaming federated aggregation
+ */
+
+import { describe, it, expect } from 'vitest';
+import Database from 'better-sqlite3';
+import { LearningSystem } from '../controllers/LearningSystem.js';
+import { PolicyTable } from '../utils/policy-training.js';
+import { FederatedLearningCoordinator, EphemeralLearningAgent } from '../services/federated-learning.js';
+
+const embedder = { embed: async () => new Float32Array(4), embedBatch: async (t: string[]) => t.map(() => new Float32Array(4)) };
+
+/** Chain s0 -> s1 -> s2; 'right' is rewarded at the end, 'left' never */
+async function createSession(system: LearningSystem) {
+  const sessionId = await system.startSession('user', 'q-learning', { learningRate: 0.1, discountFactor: 0.9 });
+  let timestamp = 0;
+  for (let i = 0; i < 20; i++) {
+    for (const [state, next, reward] of [['s0', 's1', 0], ['s1', 's2', 1]] as const) {
+      await system.submitFeedback({ sessionId, state, action: 'right', reward, nextState: next, success: true, timestamp: timestamp++ });
+      await system.submitFeedback({ sessionId, state, action: 'left', reward: 0, success: false, timestamp: timestamp++ });
+    }
+  }
+  return sessionId;
+}
+
+describe('PolicyTable', () => {
+  it('should round-trip the stored policy JSON across layout growth', () => {
+    const table = new PolicyTable();
+    for (let a = 0; a < 10; a++) {
+      for (let s = 0; s < 40; s++) table.q[table.cell(`state|${s}`, `a${a}`)] = s + a / 10;
+    }
+
+    const json = table.toJSON();
+    expect(Object.keys(json.qValues)).toHaveLength(400);
+    expect(json.qValues['state|39|a9']).toBeCloseTo(39.9, 4);
+
+    const restored = PolicyTable.fromJSON(json);
+    expect(restored.qValue('state|39', 'a9')).toBeCloseTo(39.9, 4);
+    expect(restored.maxQ('state|7')).toBeCloseTo(7.9, 4);
+    expect(restored.qValue('state|7', 'missing')).toBe(0);
+  });
+
+  it('should merge trained deltas with updates made during training', () => {
+    const table = new PolicyTable();
+    table.q[table.cell('s0', 'a0')] = 1;
+    const base = table.trainingArrays();
+    const stride = table.stride;
+    const trained = { q: base.q.slice(), visits: base.visits.slice() };
+    trained.q[0] += 0.5;
+    trained.visits[0] += 3;
+
+    // Feedback meanwhile, including enough new actions to widen the rows
+    const cell = table.find('s0', 'a0');
+    table.q[cell] += 0.25;
+    table.recordVisit(cell);
+    for (let a = 1; a < 9; a++) table.cell('s1', `a${a}`);
+    expect(table.stride).not.toBe(stride);
+
+    table.applyTraining(trained, base, stride);
+    expect(table.qValue('s0', 'a0')).toBeCloseTo(1.75, 6);
+    expect(table.visitCount('s0', 'a0')).toBe(4);
+    expect(table.totalVisits).toBe(4);
+  });
+});
+
+describe('LearningSystem training', () => {
+  it('should propagate reward back through the chain and persist it', async () => {
+    const db = new Database(':memory:');
+    const system = new LearningSystem(db, embedder as any);
+    const sessionId = await createSession(system);
+
+    const result = await system.train(sessionId, 30, 16, 0.2, { seed: 7 });
+    expect(result.epochsCompleted).toBe(30);
+    expect(Number.isFinite(result.finalLoss)).toBe(true);
+
+    // A fresh instance reads the saved version (read from the table, since
+    // predict() may explore and drop an action from its alternatives)
+    const policy = (new LearningSystem(db, embedder as any) as any).getPolicyTable(sessionId) as PolicyTable;
+    expect(policy.qValue('s0', 'right')).toBeGreaterThan(0.5);
+    expect(policy.qValue('s0', 'left')).toBeLessThan(policy.qValue('s0', 'right'));
+  });
+
+  it('should produce the same policy on a worker thread', async () => {
+    const main = new LearningSystem(new Database(':memory:'), embedder as any);
+    const worker = new LearningSystem(new Database(':memory:'), embedder as any);
+    const a = await main.train(await createSession(main), 5, 8, 0.2, { seed: 3, useWorker: false });
+    const b = await worker.train(await createSession(worker), 5, 8, 0.2, { seed: 3, useWorker: true });
+
+    expect(b.finalLoss).toBeCloseTo(a.finalLoss, 6);
+    expect(b.avgReward).toBeCloseTo(a.avgReward, 6);
+  });
+
+  it('should keep feedback submitted while the worker trains', async () => {
+    const quiet = new LearningSystem(new Database(':memory:'), embedder as any);
+    const busy = new LearningSystem(new Database(':memory:'), embedder as any);
+    const quietId = await createSession(quiet);
+    const busyId = await createSession(busy);
+
+    await quiet.train(quietId, 5, 8, 0.2, { seed: 3, useWorker: true });
+    const training = busy.train(busyId, 5, 8, 0.2, { seed: 3, useWorker: true });
+    await busy.submitFeedback({ sessionId: busyId, state: 's0', action: 'left', reward: 1, success: false, timestamp: 99 });
+    await training;
+
+    // 'left' trains towards 0, so the feedback's +α·(1 - Q) must survive
+    const qLeft = (system: LearningSystem, sessionId: string) =>
+      (system as any).getPolicyTable(sessionId).qValue('s0', 'left');
+    expect(qLeft(busy, busyId)).toBeGreaterThan(qLeft(quiet, quietId) + 0.05);
+  });
+});
+
+describe('Federated aggregation', () => {
+  it('should match a batch weighted average after replacement and eviction', async () => {
+    const coordinator = new FederatedLearningCoordinator({ agentId: 'coord', maxAgents: 3, qualityFiltering: false });
+    const state = (agentId: string, value: number, quality: number, timestamp: number) =>
+      ({ agentId, embedding: new Float32Array([value, -value]), quality, timestamp });
+
+    await coordinator.aggregate(state('a', 1, 0.8, 1));
+    await coordinator.aggregate(state('b', 2, 0.9, 2));
+    await coordinator.aggregate(state('c', 3, 1.0, 3));
+    await coordinator.aggregate(state('b', 4, 0.5, 4)); // replaces b
+    await coordinator.aggregate(state('d', 5, 0.7, 5)); // evicts a
+
+    const consolidated = await coordinator.consolidate();
+    const expected = (3 * 1.0 + 4 * 0.5 + 5 * 0.7) / (1.0 + 0.5 + 0.7);
+    expect(consolidated.embedding[0]).toBeCloseTo(expected, 5);
+    expect(consolidated.embedding[1]).toBeCloseTo(-expected, 5);
+    expect(consolidated.metadata).toMatchObject({ agentCount: 3, minQuality: 0.5, maxQuality: 1.0 });
+  });
+
+  it('should average only tasks that pass the agent quality filter', async () => {
+    const agent = new EphemeralLearningAgent({ agentId: 'agent', minQuality: 0.5 });
+    await agent.initialize({} as any);
+    await agent.processTask(new Float32Array([2, 0]), 0.9);
+    await agent.processTask(new Float32Array([4, 2]), 0.7);
+    await agent.processTask(new Float32Array([100, 100]), 0.1);
+
+    const exported = agent.exportState();
+    expect(Array.from(exported.embedding)).toEqual([3, 1]);
+    expect(exported.quality).toBeCloseTo(0.8, 6);
+    expect(exported.metadata).toMatchObject({ taskCount: 2, totalTasks: 3 });
+  });
+});
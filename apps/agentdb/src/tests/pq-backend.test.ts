@@ -0,0 +1,121 @@
+/**
+ * PQBackend Tests
+ *
+ * IVF-PQ compressed backend: background training, ADC search and filtering
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { PQBackend } from '../backends/pq/PQBackend.js';
+
+function randomVector(dim: number): Float32Array {
+  return new Float32Array(dim).map(() => Math.random() - 0.5);
+}
+
+describe('PQBackend', () => {
+  const dim = 32;
+
+  it('should search exactly before training', () => {
+    const backend = new PQBackend({ dimension: dim, metric: 'cosine', pq: { trainingSize: 1000 } });
+    const target = randomVector(dim);
+    backend.insert('target', target);
+    backend.insert('other', randomVector(dim));
+
+    const results = backend.search(target, 1);
+    expect(results[0].id).toBe('target');
+    expect(results[0].similarity).toBeCloseTo(1.0, 5);
+    expect(backend.isTrained()).toBe(false);
+  });
+
+  it('should train in the background and find near neighbors from codes', async () => {
+    const backend = new PQBackend({
+      dimension: dim,
+      metric: 'cosine',
+      pq: { trainingSize: 300, numSubvectors: 4, nprobe: 4 },
+    });
+    const vectors: Float32Array[] = [];
+    for (let i = 0; i < 300; i++) {
+      vectors.push(randomVector(dim));
+      backend.insert(`v${i}`, vectors[i], { group: i % 2 });
+    }
+
+    // The insert that filled the buffer returned before training ran
+    expect(backend.isTrained()).toBe(false);
+    expect(backend.search(vectors[3], 1)[0].id).toBe('v3');
+    backend.insert('late', randomVector(dim));
+
+    await backend.whenTrained();
+    expect(backend.isTrained()).toBe(true);
+    expect(backend.getStats().count).toBe(301);
+    expect(backend.search(vectors[7], 10).map(r => r.id)).toContain('v7');
+  });
+
+  it('should keep codes for an explicit train()', async () => {
+    const backend = new PQBackend({
+      dimension: dim,
+      metric: 'cosine',
+      pq: { trainingSize: 10000, numSubvectors: 4, nprobe: 4 },
+    });
+    const vectors: Float32Array[] = [];
+    for (let i = 0; i < 300; i++) {
+      vectors.push(randomVector(dim));
+      backend.insert(`v${i}`, vectors[i], { group: i % 2 });
+    }
+
+    await backend.train();
+    expect(backend.isTrained()).toBe(true);
+    expect(backend.getStats().count).toBe(300);
+    expect(backend.getStats().memoryUsage).toBeLessThan(300 * dim * 4 + 256 * dim * 4 + 20 * dim * 4);
+
+    const results = backend.search(vectors[7], 10);
+    expect(results.map(r => r.id)).toContain('v7');
+  });
+
+  it('should apply metadata filters during the scan', async () => {
+    const backend = new PQBackend({
+      dimension: dim,
+      metric: 'l2',
+      pq: { trainingSize: 200, numSubvectors: 4, nprobe: 1 },
+    });
+    for (let i = 0; i < 200; i++) {
+      backend.insert(`v${i}`, randomVector(dim), { group: i % 10 });
+    }
+    await backend.whenTrained();
+    expect(backend.isTrained()).toBe(true);
+
+    const results = backend.search(randomVector(dim), 5, { filter: { group: 3 } });
+    expect(results).toHaveLength(5);
+    results.forEach(r => expect(r.metadata?.group).toBe(3));
+  });
+
+  it('should drop removed vectors from results', async () => {
+    const backend = new PQBackend({ dimension: dim, metric: 'cosine', pq: { trainingSize: 50, numSubvectors: 4 } });
+    const target = randomVector(dim);
+    backend.insert('target', target);
+    for (let i = 0; i < 60; i++) backend.insert(`v${i}`, randomVector(dim));
+    await backend.whenTrained();
+
+    expect(backend.remove('target')).toBe(true);
+    expect(backend.search(target, 5).map(r => r.id)).not.toContain('target');
+  });
+
+  it('should search a loaded index with a different layout', async () => {
+    const small = new PQBackend({ dimension: dim, metric: 'l2', pq: { trainingSize: 100, numSubvectors: 4 } });
+    const large = new PQBackend({ dimension: dim, metric: 'l2', pq: { trainingSize: 100, numSubvectors: 8 } });
+    const vectors = Array.from({ length: 120 }, () => randomVector(dim));
+    vectors.forEach((vector, i) => {
+      small.insert(`v${i}`, vector);
+      large.insert(`v${i}`, vector);
+    });
+    await Promise.all([small.whenTrained(), large.whenTrained()]);
+    small.search(vectors[0], 1); // caches a 4-subvector distance table
+
+    const savePath = path.join(os.tmpdir(), `pq-layout-${process.pid}.json`);
+    await large.save(savePath);
+    await small.load(savePath);
+    fs.rmSync(savePath);
+    expect(small.search(vectors[9], 5).map(r => r.id)).toEqual(large.search(vectors[9], 5).map(r => r.id));
+  });
+});
@@ -0,0 +1,67 @@
+/**
+ * QuantizedIndex Tests
+ *
+ * int8 and binary candidate scans, removal and serialization
+ */
+
+import { describe, it, expect } from 'vitest';
+import { QuantizedIndex, exactDistance } from '../backends/quantization/QuantizedIndex.js';
+
+function randomVector(dim: number): Float32Array {
+  return new Float32Array(dim).map(() => Math.random() - 0.5);
+}
+
+describe('QuantizedIndex', () => {
+  const dim = 64;
+
+  for (const mode of ['int8', 'binary'] as const) {
+    it(`should rank the exact match first (${mode})`, () => {
+      const index = new QuantizedIndex(dim, 'cosine', { mode });
+      const vectors = Array.from({ length: 200 }, () => randomVector(dim));
+      vectors.forEach((v, i) => index.add(`v${i}`, v));
+
+      const candidates = index.candidates(vectors[42], 10);
+      expect(candidates[0]).toBe('v42');
+      expect(index.getStats().queries).toBe(1);
+    });
+  }
+
+  it('should skip removed and disallowed ids', () => {
+    const index = new QuantizedIndex(dim, 'l2', { mode: 'int8' });
+    const target = randomVector(dim);
+    index.add('a', target);
+    index.add('b', target);
+    index.add('c', randomVector(dim));
+    index.remove('a');
+
+    const candidates = index.candidates(target, 3, (id) => id !== 'c');
+    expect(candidates).toEqual(['b']);
+    expect(index.size).toBe(2);
+  });
+
+  it('should restore codes from toJSON()', () => {
+    const index = new QuantizedIndex(dim, 'cosine', { mode: 'binary' });
+    const target = randomVector(dim);
+    index.add('target', target);
+    for (let i = 0; i < 50; i++) index.add(`n${i}`, randomVector(dim));
+
+    const restored = new QuantizedIndex(dim, 'cosine', { mode: 'binary' });
+    expect(restored.restore(JSON.parse(JSON.stringify(index.toJSON())))).toBe(true);
+    expect(restored.candidates(target, 1)).toEqual(['target']);
+  });
+
+  it('should track sampled recall', () => {
+    const index = new QuantizedIndex(dim, 'cosine', { mode: 'int8', recallSampleRate: 1 });
+    expect(index.shouldSampleRecall()).toBe(true);
+    index.recordRecall(['a', 'b'], ['a', 'c']);
+    expect(index.getStats().recallEstimate).toBeCloseTo(0.5);
+  });
+
+  it('should compute hnswlib-style exact distances', () => {
+    const a = new Float32Array([1, 0]);
+    const b = new Float32Array([0, 1]);
+    expect(exactDistance('cosine', a, a)).toBeCloseTo(0);
+    expect(exactDistance('cosine', a, b)).toBeCloseTo(1);
+    expect(exactDistance('l2', a, b)).toBeCloseTo(2);
+  });
+});
@@ -6,6 +6,7 @@
 
 import { describe, it, expect, beforeEach } from 'vitest';
 import { QueryCache } from '../core/QueryCache.js';
+import { LRUCache, hashKey } from '../utils/LRUCache.js';
 
 describe('QueryCache', () => {
   let cache: QueryCache;
@@ -423,3 +424,41 @@ describe('QueryCache', () => {
     });
   });
 });
+
+describe('LRUCache', () => {
+  it('should evict by byte budget', () => {
+    const lru = new LRUCache<Float32Array>({ maxBytes: 1024, sizeOf: v => v.byteLength });
+    lru.set('a', new Float32Array(128)); // 512 bytes
+    lru.set('b', new Float32Array(128));
+    lru.get('a'); // b is now least recently used
+    lru.set('c', new Float32Array(128));
+
+    expect(lru.has('a')).toBe(true);
+    expect(lru.has('b')).toBe(false);
+    expect(lru.bytes).toBe(1024);
+    expect(lru.getStats().evictions).toBe(1);
+  });
+
+  it('should reject values larger than the budget', () => {
+    const lru = new LRUCache<string>({ maxBytes: 10 });
+    expect(lru.set('big', 'x', 11)).toBe(false);
+    expect(lru.size).toBe(0);
+  });
+
+  it('should track hits and misses', () => {
+    const lru = new LRUCache<number>({ maxEntries: 2 });
+    lru.set('a', 1);
+    lru.get('a');
+    lru.get('missing');
+
+    const stats = lru.getStats();
+    expect(stats.hits).toBe(1);
+    expect(stats.misses).toBe(1);
+    expect(stats.hitRate).toBeCloseTo(0.5);
+  });
+
+  it('should produce fixed-length hashed keys', () => {
+    expect(hashKey('model', 'a'.repeat(10000))).toHaveLength(44);
+    expect(hashKey('ab', 'c')).not.toBe(hashKey('a', 'bc'));
+  });
+});
@@ -0,0 +1,182 @@
+/**
+ * SkillLibrary Consolidation Tests
+ *
+ * Embedding clusters over stored episode vectors, the episode backend path
+ * (including ReflexionMemory's backend), and resuming an interrupted run from its checkpoint
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import Database from 'better-sqlite3';
+import { SkillLibrary } from '../controllers/SkillLibrary.js';
+import { ReflexionMemory } from '../controllers/ReflexionMemory.js';
+import { PQBackend } from '../backends/pq/PQBackend.js';
+import { DisjointSet } from '../utils/DisjointSet.js';
+
+const schemaDir = path.join(path.dirname(fileURLToPath(import.meta.url)), '../schemas');
+const embedder = { embed: async () => new Float32Array(4), embedBatch: async (t: string[]) => t.map(() => new Float32Array(4)) };
+
+/** Two phrasings of one task (2 episodes each) plus a distinct task (3 episodes) */
+function createDb() {
+  const db = new Database(':memory:');
+  db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+  const episode = db.prepare(
+    "INSERT INTO episodes (session_id, task, output, reward, success) VALUES ('s', ?, 'validated token refresh', 0.9, 1)"
+  );
+  const embedding = db.prepare('INSERT INTO episode_embeddings (episode_id, embedding) VALUES (?, ?)');
+  const tasks: Array<[string, number[]]> = [
+    ['fix login bug', [1, 0.05, 0, 0]],
+    ['fix login bug', [1, 0, 0.05, 0]],
+    ['repair the login bug', [1, 0.1, 0, 0]],
+    ['repair the login bug', [1, 0, 0.1, 0]],
+    ['write release notes', [0, 0, 0, 1]],
+    ['write release notes', [0, 0.05, 0, 1]],
+    ['write release notes', [0.05, 0, 0, 1]],
+  ];
+  for (const [task, vector] of tasks) {
+    const id = Number(episode.run(task).lastInsertRowid);
+    embedding.run(id, Buffer.from(new Float32Array(vector).buffer));
+  }
+  return db;
+}
+
+function skillNames(db: any): string[] {
+  return db.prepare('SELECT name FROM skills ORDER BY name').all().map((r: any) => r.name);
+}
+
+describe('SkillLibrary.consolidateEpisodesIntoSkills', () => {
+  it('should merge near-duplicate tasks through their embeddings', async () => {
+    const byTask = createDb();
+    await new SkillLibrary(byTask as any, embedder as any).consolidateEpisodesIntoSkills({ clusterBy: 'task', workers: 0 });
+    expect(skillNames(byTask)).toEqual(['write release notes']);
+
+    const db = createDb();
+    const result = await new SkillLibrary(db as any, embedder as any).consolidateEpisodesIntoSkills({ workers: 0 });
+    expect(result).toMatchObject({ created: 2, updated: 0 });
+    expect(skillNames(db)).toEqual(['fix login bug', 'write release notes']);
+
+    const merged = db.prepare("SELECT uses, metadata FROM skills WHERE name = 'fix login bug'").get() as any;
+    expect(merged.uses).toBe(4);
+    expect(JSON.parse(merged.metadata).clusterTasks).toEqual(['fix login bug', 'repair the login bug']);
+    expect(result.patterns[0].commonPatterns).toEqual(['Common techniques: validated, token, refresh']);
+  });
+
+  it('should scan neighbors on worker threads without an episode backend', async () => {
+    const db = createDb();
+    const result = await new SkillLibrary(db as any, embedder as any).consolidateEpisodesIntoSkills({
+      workers: 2,
+      checkpointInterval: 3,
+    });
+    expect(result).toMatchObject({ created: 2, updated: 0 });
+    expect(skillNames(db)).toEqual(['fix login bug', 'write release notes']);
+    const merged = db.prepare("SELECT uses FROM skills WHERE name = 'fix login bug'").get() as any;
+    expect(merged.uses).toBe(4);
+  });
+
+  it('should look up neighbors through the episode backend, restricted to candidates', async () => {
+    const db = createDb();
+    const rows = db.prepare('SELECT episode_id, embedding FROM episode_embeddings').all() as any[];
+    const vectors = new Map<string, Float32Array>(
+      rows.map((r) => [String(r.episode_id), new Float32Array(new Uint8Array(r.embedding).buffer)])
+    );
+    vectors.set('999', new Float32Array([1, 0, 0, 0])); // outside the window
+    const allowedSeen: any[] = [];
+    const backend = {
+      insert: () => {},
+      searchAsync: async (query: Float32Array, k: number, options: any) => {
+        allowedSeen.push(options.allowedIds);
+        const norm = (v: Float32Array) => Math.hypot(...v);
+        return Array.from(vectors, ([id, v]) => ({ id, similarity: query.reduce((s, q, i) => s + q * v[i], 0) / (norm(query) * norm(v)) }))
+          .filter((r) => options.allowedIds.has(r.id) && r.similarity >= options.threshold)
+          .sort((a, b) => b.similarity - a.similarity)
+          .slice(0, k);
+      },
+    };
+
+    const result = await new SkillLibrary(db as any, embedder as any).consolidateEpisodesIntoSkills({
+      workers: 0,
+      episodeBackend: backend as any,
+    });
+    expect(result.created).toBe(2);
+    expect(allowedSeen).toHaveLength(7);
+    expect(new Set(allowedSeen).size).toBe(1); // one set reused for every query
+    expect(allowedSeen[0].has('999')).toBe(false);
+  });
+
+  it("should link neighbors through ReflexionMemory's episode backend", async () => {
+    const db = new Database(':memory:');
+    db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+    const vectors = [[1, 0.05, 0, 0], [1, 0, 0.05, 0], [1, 0.1, 0, 0], [0, 0, 0, 1], [0, 0.05, 0, 1]];
+    const tasks = ['fix login bug', 'fix login bug', 'repair the login bug', 'write release notes', 'write release notes'];
+    let next = 0;
+    const episodeEmbedder = { embed: async () => new Float32Array(vectors[next++]) };
+
+    const backendConfig = { dimension: 4, metric: 'cosine' as const, pq: { trainingSize: 1000, numSubvectors: 1 } };
+    const episodes = new PQBackend(backendConfig);
+    const reflexion = new ReflexionMemory(db as any, episodeEmbedder as any, episodes);
+    for (const task of tasks) {
+      await reflexion.storeEpisode({ sessionId: 's', task, output: 'validated token refresh', reward: 0.9, success: true });
+    }
+
+    // Skill vectors live in their own backend and must not be searched for episodes
+    const skillBackend = new PQBackend(backendConfig);
+    let skillSearches = 0;
+    const searchSkills = skillBackend.searchAsync.bind(skillBackend);
+    skillBackend.searchAsync = (...args) => (skillSearches++, searchSkills(...args));
+    let episodeSearches = 0;
+    const searchEpisodes = episodes.searchAsync.bind(episodes);
+    episodes.searchAsync = (...args) => (episodeSearches++, searchEpisodes(...args));
+
+    const library = new SkillLibrary(db as any, embedder as any, skillBackend);
+    library.setEpisodeBackend(reflexion.getEpisodeBackend());
+    const result = await library.consolidateEpisodesIntoSkills({ minAttempts: 2, workers: 0 });
+
+    expect(episodeSearches).toBe(5);
+    expect(skillSearches).toBe(0);
+    expect(result.created).toBe(2);
+    const merged = db.prepare("SELECT uses, metadata FROM skills WHERE name = 'fix login bug'").get() as any;
+    expect(merged.uses).toBe(3);
+    expect(JSON.parse(merged.metadata).clusterTasks).toEqual(['fix login bug', 'repair the login bug']);
+  });
+
+  it('should resume an interrupted run from its checkpoint', async () => {
+    const db = createDb();
+    const library = new SkillLibrary(db as any, embedder as any);
+    const options = { workers: 0, checkpointInterval: 2 };
+
+    await expect(
+      library.consolidateEpisodesIntoSkills({
+        ...options,
+        onProgress: (p) => {
+          if (p.phase === 'neighbors' && p.done === 4) throw new Error('killed');
+        },
+      })
+    ).rejects.toThrow('killed');
+
+    const checkpoint = db.prepare('SELECT phase, cursor FROM skill_consolidation_runs').get() as any;
+    expect(checkpoint).toEqual({ phase: 'neighbors', cursor: 4 });
+
+    const progress: number[] = [];
+    const result = await library.consolidateEpisodesIntoSkills({
+      ...options,
+      onProgress: (p) => p.phase === 'neighbors' && progress.push(p.done),
+    });
+    expect(progress).toEqual([6, 7]);
+    expect(result.created).toBe(2);
+    expect(skillNames(db)).toEqual(['fix login bug', 'write release notes']);
+    expect(db.prepare('SELECT COUNT(*) AS n FROM skill_consolidation_runs').get()).toEqual({ n: 0 });
+  });
+});
+
+describe('DisjointSet', () => {
+  it('should label components by their first member and survive a round trip', () => {
+    const set = new DisjointSet(6);
+    set.union(4, 2);
+    set.union(5, 4);
+    set.union(3, 1);
+    const restored = DisjointSet.fromParents(Int32Array.from(set.parents));
+    expect(restored.components()).toEqual([[0], [1, 3], [2, 4, 5]]);
+  });
+});
@@ -0,0 +1,63 @@
+/**
+ * StatementCache Tests
+ *
+ * Statement reuse per connection, the sql.js size cap, fixed-arity IN
+ * buckets and column projection
+ */
+
+import { describe, it, expect } from 'vitest';
+import Database from 'better-sqlite3';
+import { StatementCache, bucketFor, projectColumns } from '../utils/StatementCache.js';
+
+function createDb() {
+  const db = new Database(':memory:');
+  db.exec('CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT, body TEXT)');
+  const insert = db.prepare('INSERT INTO items (id, name, body) VALUES (?, ?, ?)');
+  for (let i = 1; i <= 600; i++) insert.run(i, `item-${i}`, 'x'.repeat(100));
+  return db;
+}
+
+describe('StatementCache', () => {
+  it('should share one cache and one statement per SQL on a connection', () => {
+    const db = createDb();
+    const cache = StatementCache.for(db as any);
+    expect(StatementCache.for(db as any)).toBe(cache);
+    expect(cache.prepare('SELECT 1')).toBe(cache.prepare('SELECT 1'));
+  });
+
+  it('should cap the cache below a connection\'s live-statement limit', () => {
+    const finalized: string[] = [];
+    const limited = {
+      maxActiveStatements: 50,
+      prepare: (sql: string) => ({ finalize: () => finalized.push(sql) }),
+    };
+    const cache = StatementCache.for(limited as any);
+    for (let i = 0; i < 40; i++) cache.prepare(`SELECT ${i}`);
+
+    expect(cache.getStats().size).toBe(25);
+    expect(finalized).toHaveLength(15);
+  });
+
+  it('should reuse bucketed IN statements across id counts', () => {
+    const cache = StatementCache.for(createDb() as any);
+    expect(cache.fetchByIds('items', [3, 1, 2])).toHaveLength(3);
+    expect(cache.fetchByIds('items', [5, 6, 7, 8, 5])).toHaveLength(4);
+    const { size } = cache.getStats();
+
+    // Both lookups fit the 8-id bucket, so no new statement was prepared
+    expect(bucketFor(3)).toBe(8);
+    cache.fetchByIds('items', [10, 11]);
+    expect(cache.getStats().size).toBe(size);
+
+    // Larger lists are chunked at the biggest bucket
+    const all = Array.from({ length: 600 }, (_, i) => i + 1);
+    expect(cache.fetchByIds('items', all)).toHaveLength(600);
+  });
+
+  it('should return only the projected columns plus the key', () => {
+    const cache = StatementCache.for(createDb() as any);
+    const [row] = cache.fetchByIds('items', [42], { columns: ['name'] });
+    expect(row).toEqual({ id: 42, name: 'item-42' });
+    expect(() => projectColumns(['name; DROP TABLE items'])).toThrow('Invalid SQL identifier');
+  });
+});
@@ -0,0 +1,227 @@
+/**
+ * Binary Sync Tests
+ *
+ * Columnar frame round trips, codec negotiation, incremental range hashes,
+ * and range-diffed pulls from QUICServer.streamSync through SyncCoordinator
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import Database from 'better-sqlite3';
+import { decodeFrame, encodeBatchFrame, encodeEndFrame, negotiateCompression, readFrames } from '../utils/SyncCodec.js';
+import { computeRangeHashes, diffRanges } from '../utils/sync-ranges.js';
+import { QUICServer } from '../controllers/QUICServer.js';
+import { QUICClient } from '../controllers/QUICClient.js';
+import { SyncCoordinator } from '../controllers/SyncCoordinator.js';
+
+const schemaDir = path.join(path.dirname(fileURLToPath(import.meta.url)), '../schemas');
+
+function createDb() {
+  const db = new Database(':memory:');
+  db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+  return db;
+}
+
+function vector(seed: number, dim = 16): Buffer {
+  return Buffer.from(Float32Array.from({ length: dim }, (_, i) => Math.sin(seed * 31 + i)).buffer);
+}
+
+function addEpisodes(db: any, count: number) {
+  const episode = db.prepare(
+    "INSERT INTO episodes (ts, session_id, task, output, reward, success) VALUES (?, ?, 'deploy service', ?, ?, ?)"
+  );
+  const embedding = db.prepare('INSERT INTO episode_embeddings (episode_id, embedding) VALUES (?, ?)');
+  for (let i = 0; i < count; i++) {
+    const id = Number(episode.run(1700000000 + i, `session-${i % 4}`, `output ${i}`, i / count, i % 2).lastInsertRowid);
+    embedding.run(id, vector(id));
+  }
+}
+
+async function* chunked(frames: Buffer[], size: number) {
+  const all = Buffer.concat(frames);
+  for (let i = 0; i < all.length; i += size) yield all.subarray(i, i + size);
+}
+
+describe('SyncCodec', () => {
+  const rows = [
+    { id: 1, ts: 1700000000, task: 'plan', reward: 0.5, note: null, tags: '["a"]', embedding: vector(1) },
+    { id: 2, ts: 1700000030, task: 'plan', reward: -2, note: 'ok', tags: null, embedding: vector(2) },
+    { id: 9, ts: 1699999999, task: 'plan', reward: 1e-9, note: 'é', tags: '[]', embedding: vector(3) },
+  ];
+
+  for (const compression of ['none', 'deflate', 'brotli'] as const) {
+    it(`should round-trip a batch exactly (${compression})`, async () => {
+      const frame = await encodeBatchFrame('episodes', rows, { compression });
+      expect(await decodeFrame(frame)).toEqual({ kind: 'batch', table: 'episodes', rows });
+    });
+  }
+
+  it('should quantize embeddings to int8 within one step of the row scale', async () => {
+    const decoded = (await decodeFrame(await encodeBatchFrame('episodes', rows, { vectorEncoding: 'int8' }))) as any;
+    decoded.rows.forEach((row: any, r: number) => {
+      const original = new Float32Array(rows[r].embedding.buffer, rows[r].embedding.byteOffset, 16);
+      const restored = new Float32Array(Uint8Array.from(row.embedding).buffer);
+      const scale = Math.max(...original.map(Math.abs)) / 127;
+      original.forEach((value, d) => expect(Math.abs(restored[d] - value)).toBeLessThanOrEqual(scale / 2 + 1e-7));
+    });
+  });
+
+  it('should reassemble frames from arbitrary chunks and reject corruption', async () => {
+    const frames = [await encodeBatchFrame('a', rows), await encodeBatchFrame('b', rows.slice(1)), await encodeEndFrame({ rows: 5 })];
+    const received: Buffer[] = [];
+    for await (const frame of readFrames(chunked(frames, 7))) received.push(Buffer.from(frame));
+    expect(received.map((f) => f.length)).toEqual(frames.map((f) => f.length));
+
+    const corrupt = Buffer.from(frames[0]);
+    corrupt[corrupt.length - 1] ^= 0xff;
+    await expect(decodeFrame(corrupt)).rejects.toThrow('checksum');
+
+    const truncated = (async function* () { yield frames[0].subarray(0, 20); })();
+    await expect((async () => { for await (const _ of readFrames(truncated)); })()).rejects.toThrow('mid-frame');
+  });
+});
+
+describe('Sync negotiation and range hashes', () => {
+  it('should default to brotli unless the client advertises codecs', async () => {
+    expect(negotiateCompression()).toBe('brotli');
+    expect(negotiateCompression(undefined, ['deflate', 'none'])).toBe('deflate');
+    expect(negotiateCompression('none', ['deflate'])).toBe('none');
+
+    const db = createDb();
+    addEpisodes(db, 3);
+    const server = new QUICServer(db, { authToken: 'secret' });
+    const codecs: number[] = [];
+    for await (const frame of server.streamSync('c', { type: 'episodes', codecs: ['deflate'] }, 'secret')) {
+      codecs.push(frame.readUInt8(6));
+    }
+    expect(codecs.slice(0, -1)).toEqual([1, 1]); // deflate batches, END uncompressed
+  });
+
+  it('should rehash only the ranges that were written', () => {
+    const spec = { table: 'episodes', key: 'id' };
+    const db = createDb();
+    addEpisodes(db, 300);
+    const before = new Map(computeRangeHashes(db, spec, 64));
+
+    db.prepare("UPDATE episodes SET critique = 'edited' WHERE id = 200").run();
+    db.prepare('DELETE FROM episodes WHERE id <= 63').run();
+    const after = computeRangeHashes(db, spec, 64);
+
+    expect([...after.keys()]).toEqual([1, 2, 3, 4]);
+    expect(after.get(1)).toBe(before.get(1));
+    expect(after.get(3)).not.toBe(before.get(3));
+
+    // Same data, hashed in one pass
+    const fresh = createDb();
+    addEpisodes(fresh, 300);
+    fresh.prepare("UPDATE episodes SET critique = 'edited' WHERE id = 200").run();
+    fresh.prepare('DELETE FROM episodes WHERE id <= 63').run();
+    expect(computeRangeHashes(fresh, spec, 64)).toEqual(after);
+  });
+
+  it('should count ranges only the client has as changed', () => {
+    const server = new Map([[0, 'a'], [1, 'b'], [3, 'd']]);
+    expect(diffRanges(server, { 0: 'a', 1: 'x', 2: 'c' })).toEqual([1, 2, 3]);
+  });
+});
+
+/** A coordinator on `local` pulling from `remote`, with each END summary in `sent` */
+function pullFrom(remote: any, local: any, config: Record<string, any> = {}) {
+  const server = new QUICServer(remote, { authToken: 'secret' });
+  const sent: any[] = [];
+  const client = new QUICClient({
+    serverHost: 'remote',
+    serverPort: 4433,
+    authToken: 'secret',
+    streamTransport: async function* (request, token) {
+      for await (const frame of server.streamSync('local', request, token)) {
+        const decoded = await decodeFrame(frame);
+        if (decoded.kind === 'end') sent.push(decoded.summary);
+        yield frame;
+      }
+    },
+  });
+  const coordinator = new SyncCoordinator({ db: local, client, rangeSize: 64, batchSize: 50, ...config });
+  return { coordinator, sent };
+}
+
+describe('SyncCoordinator binary pull', () => {
+  it('should copy rows with embeddings, then send only changed ranges', async () => {
+    const remote = createDb();
+    const local = createDb();
+    addEpisodes(remote, 300);
+    const { coordinator, sent } = pullFrom(remote, local);
+
+    const first = await coordinator.sync();
+    expect(first.errors).toEqual([]);
+    expect(first.itemsPulled).toBe(600);
+    const dump = (db: any) => db.prepare('SELECT * FROM episodes e JOIN episode_embeddings ee ON ee.episode_id = e.id ORDER BY e.id').all();
+    expect(dump(local)).toEqual(dump(remote));
+    // Far below the JSON row dump, embeddings as float arrays included
+    const json = JSON.stringify(dump(remote).map((r: any) => ({ ...r, embedding: Array.from(new Float32Array(Uint8Array.from(r.embedding).buffer)) })));
+    expect(first.bytesTransferred).toBeLessThan(json.length / 3);
+
+    const idle = await coordinator.sync();
+    expect(idle.itemsPulled).toBe(0);
+
+    remote.prepare("UPDATE episodes SET critique = 'retry earlier' WHERE id = 200").run();
+    const delta = await coordinator.sync();
+    expect(sent[2].rows).toMatchObject({ episodes: 64, episode_embeddings: 0 }); // ids 192-255
+    expect(delta.itemsPulled).toBe(64);
+    expect(local.prepare('SELECT critique FROM episodes WHERE id = 200').get()).toEqual({ critique: 'retry earlier' });
+    expect((local.prepare('SELECT COUNT(*) AS n FROM episode_embeddings').get() as any).n).toBe(300);
+  });
+
+  it('should delete rows the remote deleted and then go idle', async () => {
+    const remote = createDb();
+    const local = createDb();
+    addEpisodes(remote, 200);
+    const { coordinator } = pullFrom(remote, local);
+    await coordinator.sync();
+
+    remote.prepare('DELETE FROM episodes WHERE id BETWEEN 10 AND 20 OR id > 150').run();
+    const pruned = await coordinator.sync();
+    expect(pruned.errors).toEqual([]);
+    const ids = (db: any) => db.prepare('SELECT id FROM episodes ORDER BY id').all();
+    expect(ids(local)).toEqual(ids(remote));
+
+    expect((await coordinator.sync()).itemsPulled).toBe(0);
+  });
+
+  it('should keep local-wins conflicts without resending their range', async () => {
+    const remote = createDb();
+    const local = createDb();
+    addEpisodes(remote, 100);
+    const { coordinator, sent } = pullFrom(remote, local, { conflictStrategy: 'local-wins' });
+    await coordinator.sync();
+
+    local.prepare("UPDATE episodes SET critique = 'mine' WHERE id = 5").run();
+    remote.prepare("UPDATE episodes SET critique = 'theirs' WHERE id = 5").run();
+    await coordinator.sync();
+    expect(local.prepare('SELECT critique FROM episodes WHERE id = 5').get()).toEqual({ critique: 'mine' });
+
+    const idle = await coordinator.sync();
+    expect(idle.itemsPulled).toBe(0);
+    expect(sent[sent.length - 1].rows).toMatchObject({ episodes: 0, episode_embeddings: 0 });
+  });
+
+  it('should not resend int8 embeddings once settled', async () => {
+    const remote = createDb();
+    const local = createDb();
+    addEpisodes(remote, 100);
+    const { coordinator } = pullFrom(remote, local, { vectorEncoding: 'int8' });
+
+    expect((await coordinator.sync()).itemsPulled).toBe(200);
+    expect((await coordinator.sync()).itemsPulled).toBe(0);
+
+    remote.prepare('UPDATE episode_embeddings SET embedding = ? WHERE episode_id = 3').run(vector(999));
+    expect((await coordinator.sync()).itemsPulled).toBe(63); // ids 1-63
+  });
+
+  it('should refuse a stream without the server token', async () => {
+    const server = new QUICServer(createDb(), { authToken: 'secret' });
+    await expect((async () => { for await (const _ of server.streamSync('x', { type: 'full' }, 'wrong')); })()).rejects.toThrow('Authentication failed');
+  });
+});
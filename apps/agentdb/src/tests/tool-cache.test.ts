@@ -0,0 +1,150 @@
+/**
+ * ToolCache Tests
+ *
+ * Embedding-hash keys, prefix and tag invalidation, LRU order, and
+ * cancellable bounded-memory, filtered episode retrieval behind the search tools
+ */
+
+import { describe, it, expect } from 'vitest';
+import * as fs from 'fs';
+import * as path from 'path';
+import { fileURLToPath } from 'url';
+import Database from 'better-sqlite3';
+import { ToolCache, MCPToolCaches, hashEmbedding } from '../optimizations/ToolCache.js';
+import { ReflexionMemory } from '../controllers/ReflexionMemory.js';
+
+const schemaDir = path.join(path.dirname(fileURLToPath(import.meta.url)), '../schemas');
+
+describe('ToolCache', () => {
+  it('should key searches by normalized embedding and sorted params', () => {
+    const embedding = new Float32Array([0.3, -0.4, 0.5]);
+    const scaled = embedding.map((v) => v * 7);
+
+    expect(hashEmbedding(scaled)).toBe(hashEmbedding(embedding));
+    expect(hashEmbedding(new Float32Array([0.3, -0.4, 0.6]))).not.toBe(hashEmbedding(embedding));
+    expect(MCPToolCaches.searchKey('search', embedding, { k: 5, minReward: 0.5 }))
+      .toBe(MCPToolCaches.searchKey('search', scaled, { minReward: 0.5, k: 5, filters: undefined }));
+  });
+
+  it('should invalidate by segment prefix, glob and tag', () => {
+    const cache = new ToolCache<number>(100, 60000);
+    cache.set('search:reflexion:a:k=5', 1, undefined, ['episodes']);
+    cache.set('search:reflexion:b:k=5', 2, undefined, ['episodes']);
+    cache.set('search:skills:a:k=5', 3, undefined, ['skills']);
+    cache.set('stats:db', 4);
+
+    expect(cache.invalidatePrefix('search:reflexion:')).toBe(2);
+    expect(cache.clear('search:*')).toBe(1);
+    expect(cache.keys()).toEqual(['stats:db']);
+
+    cache.set('search:reflexion:c:k=5', 5, undefined, ['episodes']);
+    cache.set('search:pattern:c:k=5', 6, undefined, ['patterns']);
+    expect(cache.invalidateTag('episodes')).toBe(1);
+    expect(cache.clear('search:*:c:k=5')).toBe(1);
+    expect(cache.invalidateTag('episodes')).toBe(0);
+    expect(cache.get('stats:db')).toBe(4);
+  });
+
+  it('should evict the least recently used entry', () => {
+    const cache = new ToolCache<number>(2, 60000);
+    cache.set('a', 1);
+    cache.set('b', 2);
+    cache.get('a');
+    cache.set('c', 3);
+
+    expect(cache.has('a')).toBe(true);
+    expect(cache.has('b')).toBe(false);
+    expect(cache.getStats().evictions).toBe(1);
+  });
+});
+
+describe('Cancellable retrieval', () => {
+  function createMemory() {
+    const db = new Database(':memory:');
+    db.exec(fs.readFileSync(path.join(schemaDir, 'schema.sql'), 'utf-8'));
+    const embedder = {
+      embed: async (text: string) => new Float32Array([text.length % 7, 1, (text.length * 3) % 5, 1]),
+    };
+    return { db, memory: new ReflexionMemory(db as any, embedder as any) };
+  }
+
+  it('should scan the SQL fallback in pages and keep the top k', async () => {
+    const { db, memory } = createMemory();
+    const episode = db.prepare("INSERT INTO episodes (session_id, task, reward, success) VALUES ('s', ?, ?, 1)");
+    const embedding = db.prepare('INSERT INTO episode_embeddings (episode_id, embedding) VALUES (?, ?)');
+    for (let i = 1; i <= 4500; i++) {
+      const id = Number(episode.run(`task ${i}`, i / 4500).lastInsertRowid);
+      const vector = i === 4321 ? [1, 0, 0, 0] : [0, 1, Math.sin(i), 0];
+      embedding.run(id, Buffer.from(new Float32Array(vector).buffer));
+    }
+
+    (memory as any).embedder.embed = async () => new Float32Array([1, 0, 0, 0]);
+    const results = await memory.retrieveRelevant({ task: 'q', k: 3 });
+    expect(results).toHaveLength(3);
+    expect(results[0].id).toBe(4321);
+  });
+
+  it('should stop when the signal is aborted', async () => {
+    const { memory } = createMemory();
+    const controller = new AbortController();
+    controller.abort(new Error('cancelled by client'));
+
+    await expect(memory.retrieveRelevant({ task: 'q', signal: controller.signal }))
+      .rejects.toThrow('cancelled by client');
+  });
+
+  it('should abort the SQL fallback between pages', async () => {
+    const { db, memory } = createMemory();
+    const episode = db.prepare("INSERT INTO episodes (session_id, task, reward, success) VALUES ('s', ?, 0.5, 1)");
+    const embedding = db.prepare('INSERT INTO episode_embeddings (episode_id, embedding) VALUES (?, ?)');
+    db.exec('BEGIN');
+    for (let i = 1; i <= 4500; i++) {
+      embedding.run(Number(episode.run(`task ${i}`).lastInsertRowid), Buffer.from(new Float32Array([0, 1, 0, 1]).buffer));
+    }
+    db.exec('COMMIT');
+
+    // Fires once the first page has been scanned
+    const controller = new AbortController();
+    const retrieval = memory.retrieveRelevant({ task: 'q', signal: controller.signal });
+    setImmediate(() => controller.abort(new Error('cancelled mid-scan')));
+    await expect(retrieval).rejects.toThrow('cancelled mid-scan');
+  });
+
+  it('should pre-filter selective filters and over-fetch broad ones', async () => {
+    const { db } = createMemory();
+    const episode = db.prepare("INSERT INTO episodes (session_id, task, reward, success) VALUES ('s', ?, ?, 1)");
+    db.exec('BEGIN');
+    for (let i = 1; i <= 12000; i++) episode.run(`task ${i}`, i % 4 === 0 ? 0.9 : 0.1);
+    db.exec('COMMIT');
+
+    // Fake backend ranking every episode by id, recording each search
+    const searches: Array<{ k: number; allowedIds?: Set<string> }> = [];
+    const backend = {
+      getStats: () => ({ count: 12000 }),
+      searchAsync: async (_query: Float32Array, k: number, options: any) => {
+        searches.push({ k, allowedIds: options.allowedIds });
+        const ids = Array.from({ length: 12000 }, (_, i) => String(i + 1))
+          .filter((id) => !options.allowedIds || options.allowedIds.has(id));
+        return ids.slice(0, k).map((id) => ({ id, distance: 0, similarity: 1 }));
+      },
+    };
+    const memory = new ReflexionMemory(db as any, { embed: async () => new Float32Array(4) } as any, backend as any);
+
+    // 3000 matches: allowed ids, no over-fetch
+    const selective = await memory.retrieveRelevant({ task: 'q', k: 5, minReward: 0.5 });
+    expect(selective.map((e) => e.id)).toEqual([4, 8, 12, 16, 20]);
+    expect(searches[0]).toMatchObject({ k: 5 });
+    expect(searches[0].allowedIds?.size).toBe(3000);
+
+    // 11000 matches: too broad to materialise, so over-fetch and post-filter
+    db.prepare('UPDATE episodes SET reward = 0.9 WHERE id % 4 = 1').run();
+    db.prepare('UPDATE episodes SET reward = 0.9 WHERE id % 4 = 2').run();
+    db.prepare('UPDATE episodes SET reward = 0.9 WHERE id % 4 = 3 AND id <= 8000').run();
+    searches.length = 0;
+    const broad = await memory.retrieveRelevant({ task: 'q', k: 5, minReward: 0.4 });
+    expect(broad.map((e) => e.id)).toEqual([1, 2, 3, 4, 5]);
+    expect(searches).toHaveLength(1);
+    expect(searches[0].allowedIds).toBeUndefined();
+    expect(searches[0].k).toBeGreaterThan(5);
+  });
+});
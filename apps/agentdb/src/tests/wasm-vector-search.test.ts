@@ -7,6 +7,9 @@
 import { describe, it, expect, beforeEach } from 'vitest';
 import { WASMVectorSearch } from '../controllers/WASMVectorSearch.js';
 import { EnhancedEmbeddingService } from '../controllers/EnhancedEmbeddingService.js';
+import { SimdDotKernel, dotBatch, selectTopK } from '../utils/vector-kernels.js';
+import { NormalizedVectorStore } from '../utils/NormalizedVectorStore.js';
+import Database from 'better-sqlite3';
 
 describe('WASMVectorSearch', () => {
   let mockDb: any;
@@ -155,6 +158,135 @@ describe('WASMVectorSearch', () => {
   });
 });
 
+describe('WASMVectorSearch.findKNN', () => {
+  const blob = (values: number[]) => Buffer.from(new Float32Array(values).buffer);
+
+  it('should follow inserts, in-place updates and deletes', async () => {
+    const db = new Database(':memory:');
+    db.exec('CREATE TABLE pattern_embeddings (pattern_id INTEGER PRIMARY KEY, embedding BLOB)');
+    const insert = db.prepare('INSERT INTO pattern_embeddings (pattern_id, embedding) VALUES (?, ?)');
+    insert.run(1, blob([1, 0, 0]));
+    insert.run(2, blob([0, 1, 0]));
+
+    const search = new WASMVectorSearch(db);
+    const query = new Float32Array([0, 0, 1]);
+    expect((await search.findKNN(query, 1))[0].similarity).toBeCloseTo(0, 5);
+
+    // Same row count and max id, new embedding
+    db.prepare('UPDATE pattern_embeddings SET embedding = ? WHERE pattern_id = 1').run(blob([0, 0, 1]));
+    let results = await search.findKNN(query, 1);
+    expect(results[0].id).toBe(1);
+    expect(results[0].similarity).toBeCloseTo(1, 5);
+
+    // Outer conflict policy must not swallow the change-log write
+    db.prepare(`
+      INSERT INTO pattern_embeddings (pattern_id, embedding) VALUES (2, ?)
+      ON CONFLICT (pattern_id) DO UPDATE SET embedding = excluded.embedding
+    `).run(blob([0, 0.8, 0.6]));
+    expect((await search.findKNN(query, 2))[1].similarity).toBeCloseTo(0.6, 5);
+
+    db.prepare('DELETE FROM pattern_embeddings WHERE pattern_id = 1').run();
+    insert.run(3, blob([0, 0.6, 0.8]));
+    results = await search.findKNN(query, 3);
+    expect(results.map(r => r.id)).toEqual([3, 2]);
+    expect(results[1].similarity).toBeCloseTo(0.6, 5);
+  });
+
+  it('should read untracked tables fresh and cache them once tracked', async () => {
+    const db = new Database(':memory:');
+    const search = new WASMVectorSearch(db, { tables: ['skill_embeddings'] });
+    db.exec('CREATE TABLE skill_embeddings (pattern_id INTEGER PRIMARY KEY, embedding BLOB)');
+    const insert = db.prepare('INSERT INTO skill_embeddings (pattern_id, embedding) VALUES (?, ?)');
+    insert.run(1, blob([1, 0]));
+
+    const query = new Float32Array([0, 1]);
+    expect((await search.findKNN(query, 1, 'skill_embeddings'))[0].id).toBe(1);
+    insert.run(2, blob([0, 1]));
+    expect((await search.findKNN(query, 1, 'skill_embeddings'))[0].id).toBe(2);
+    expect(search.getStats().cachedTables).toBe(0);
+
+    search.trackTable('skill_embeddings');
+    expect((await search.findKNN(query, 1, 'skill_embeddings'))[0].id).toBe(2);
+    insert.run(3, blob([-0.6, 0.8]));
+    db.prepare('DELETE FROM skill_embeddings WHERE pattern_id = 2').run();
+    expect((await search.findKNN(query, 1, 'skill_embeddings'))[0].id).toBe(3);
+    expect(search.getStats().cachedTables).toBe(1);
+  });
+});
+
+describe('Vector Kernels', () => {
+  it('should select top-k in descending order', () => {
+    const scores = new Float32Array([0.1, 0.9, 0.4, 0.7, 0.2]);
+    const top = selectTopK(scores, 3);
+
+    expect(top.map(t => t.index)).toEqual([1, 3, 2]);
+    expect(top[0].score).toBeCloseTo(0.9, 5);
+  });
+
+  it('should apply threshold during top-k selection', () => {
+    const top = selectTopK([0.1, 0.5, 0.3], 10, 0.2);
+    expect(top.map(t => t.index)).toEqual([1, 2]);
+  });
+
+  it('should match JS dot products with the SIMD kernel', () => {
+    const kernel = SimdDotKernel.create();
+    if (!kernel) return; // Runtime without WASM SIMD
+
+    const rows = 50;
+    const dim = 131; // Not a multiple of 4 to exercise the scalar tail
+    const matrix = new Float32Array(rows * dim).map(() => Math.random() - 0.5);
+    const query = new Float32Array(dim).map(() => Math.random());
+
+    kernel.loadMatrix(matrix, rows, dim);
+    const simd = kernel.dots(query);
+    const js = dotBatch(query, matrix, rows, dim);
+
+    for (let i = 0; i < rows; i++) {
+      expect(simd[i]).toBeCloseTo(js[i], 3);
+    }
+  });
+});
+
+describe('NormalizedVectorStore', () => {
+  it('should return cosine similarity from normalized rows', () => {
+    const store = new NormalizedVectorStore(3, { initialCapacity: 1 });
+    store.upsert(1, new Float32Array([2, 0, 0]));
+    store.upsert(2, new Float32Array([0, 5, 0]));
+    store.upsert(3, new Float32Array([1, 1, 0]));
+
+    const results = store.search(new Float32Array([3, 0, 0]), 2);
+
+    expect(results.map(r => r.id)).toEqual([1, 3]);
+    expect(results[0].similarity).toBeCloseTo(1.0, 5);
+    expect(results[1].similarity).toBeCloseTo(Math.SQRT1_2, 5);
+  });
+
+  it('should skip tombstoned rows and keep ids stable after compaction', () => {
+    const store = new NormalizedVectorStore(2, { compactThreshold: 1 });
+    for (let i = 0; i < 10; i++) {
+      store.upsert(i, new Float32Array([1, i]));
+    }
+
+    store.remove(0);
+    store.remove(1);
+    expect(store.size).toBe(8);
+    expect(store.search(new Float32Array([1, 0]), 10).map(r => r.id)).not.toContain(0);
+
+    store.compact();
+    const results = store.search(new Float32Array([1, 0]), 1);
+    expect(results[0].id).toBe(2);
+  });
+
+  it('should honor the allow predicate', () => {
+    const store = new NormalizedVectorStore(2);
+    store.upsert(1, new Float32Array([1, 0]));
+    store.upsert(2, new Float32Array([0.9, 0.1]));
+
+    const results = store.search(new Float32Array([1, 0]), 5, undefined, id => id === 2);
+    expect(results.map(r => r.id)).toEqual([2]);
+  });
+});
+
 describe('EnhancedEmbeddingService', () => {
   let service: EnhancedEmbeddingService;
 
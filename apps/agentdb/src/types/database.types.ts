@@ -144,6 +144,11 @@ export interface IDatabaseConnection {
    */
   export?(): Uint8Array;
 
+  /**
+   * Live statements above which the connection reports a leak (sql.js only)
+   */
+  readonly maxActiveStatements?: number;
+
   /**
    * Get database file path (better-sqlite3 only)
    */
@@ -0,0 +1,423 @@
+/**
+ * CausalCsrGraph - In-memory causal edge graph with best-first chain search
+ *
+ * Edges are kept as parallel typed arrays and indexed in both directions as
+ * CSR (offsets + edge indices), so a node's out- or in-edges are one
+ * contiguous range. Edges added after the last build go to small per-node
+ * delta lists and are folded into the CSR once they pass an eighth of it.
+ *
+ * findChains() returns the best simple paths by total uplift. It first walks
+ * backwards from the target to get, for every node that can still reach it
+ * within the remaining hops, an upper bound on the uplift left to collect.
+ * Paths are then expanded best-bound-first (A*), so a completed path popped
+ * from the queue beats everything still queued and results come out ranked
+ * without enumerating every path.
+ */
+
+export interface CausalChain {
+  /** Memory ids from source to target */
+  path: number[];
+  /** Sum of edge uplifts (null uplift counts as 0) */
+  totalUplift: number;
+  /** Lowest edge confidence on the path */
+  confidence: number;
+}
+
+export interface ChainSearchOptions {
+  /** Maximum edges per path (default: 5) */
+  maxDepth?: number;
+  /** Skip edges below this confidence (default: 0.5) */
+  minConfidence?: number;
+  /** Number of chains to return (default: 10) */
+  limit?: number;
+  /** Stop after expanding this many partial paths (default: 100000) */
+  maxExpansions?: number;
+}
+
+/** Fold delta edges into the CSR once they exceed this share of it */
+const DELTA_REBUILD_RATIO = 1 / 8;
+const MIN_DELTA_REBUILD = 4096;
+
+/** Hop-count marker for nodes not reached within maxDepth */
+const UNREACHED = 255;
+
+export class CausalCsrGraph {
+  private nodeIndex = new Map<number, number>();
+  private nodeIds: number[] = [];
+
+  // Edge list (index = edge number)
+  private src = new Uint32Array(1024);
+  private dst = new Uint32Array(1024);
+  private uplift = new Float64Array(1024);
+  private confidence = new Float64Array(1024);
+  private edgeCount = 0;
+
+  // CSR over the first csrEdgeCount edges
+  private outOffsets = new Uint32Array(1);
+  private outEdges = new Uint32Array(0);
+  private inOffsets = new Uint32Array(1);
+  private inEdges = new Uint32Array(0);
+  private csrEdgeCount = 0;
+  private csrNodeCount = 0;
+
+  // Edges added since the last build, by node
+  private deltaOut = new Map<number, number[]>();
+  private deltaIn = new Map<number, number[]>();
+
+  // Per-query scratch, grown with the node count and reused between searches
+  private scratch: {
+    bound: Float64Array;
+    hopsToTarget: Uint8Array;
+    hopsFromSource: Uint8Array;
+    round: Uint8Array;
+  } | null = null;
+
+  get edges(): number {
+    return this.edgeCount;
+  }
+
+  get nodes(): number {
+    return this.nodeIds.length;
+  }
+
+  /**
+   * Add a directed edge
+   *
+   * With `autoBuild` the edge is searchable at once (pending edges are folded
+   * into the CSR when they pile up). Bulk loads pass false and call build()
+   * once at the end; such edges are not searchable until then.
+   */
+  addEdge(from: number, to: number, uplift: number | null, confidence: number, autoBuild = true): void {
+    if (this.edgeCount === this.src.length) {
+      this.grow(this.src.length * 2);
+    }
+
+    const e = this.edgeCount++;
+    const s = this.intern(from);
+    const d = this.intern(to);
+    this.src[e] = s;
+    this.dst[e] = d;
+    this.uplift[e] = uplift ?? 0;
+    this.confidence[e] = confidence;
+
+    if (!autoBuild) return;
+
+    pushTo(this.deltaOut, s, e);
+    pushTo(this.deltaIn, d, e);
+
+    const pending = this.edgeCount - this.csrEdgeCount;
+    if (pending > Math.max(MIN_DELTA_REBUILD, this.csrEdgeCount * DELTA_REBUILD_RATIO)) {
+      this.build();
+    }
+  }
+
+  /**
+   * Rebuild both CSR directions over all edges (counting sort, O(V + E))
+   */
+  build(): void {
+    const n = this.nodeIds.length;
+    const m = this.edgeCount;
+    [this.outOffsets, this.outEdges] = csr(this.src, n, m);
+    [this.inOffsets, this.inEdges] = csr(this.dst, n, m);
+    this.csrEdgeCount = m;
+    this.csrNodeCount = n;
+    this.deltaOut.clear();
+    this.deltaIn.clear();
+  }
+
+  /**
+   * Best simple paths from `from` to `to`, highest total uplift first
+   */
+  findChains(from: number, to: number, options: ChainSearchOptions = {}): CausalChain[] {
+    const maxDepth = Math.min(options.maxDepth ?? 5, UNREACHED - 1);
+    const minConfidence = options.minConfidence ?? 0.5;
+    const limit = options.limit ?? 10;
+    const maxExpansions = options.maxExpansions ?? 100000;
+
+    const source = this.nodeIndex.get(from);
+    const target = this.nodeIndex.get(to);
+    if (source === undefined || target === undefined || source === target || maxDepth < 1 || limit < 1) {
+      return [];
+    }
+
+    const { bound, hopsToTarget } = this.upliftBounds(source, target, maxDepth, minConfidence);
+    if (hopsToTarget[source] > maxDepth) return [];
+
+    const states = new SearchStates();
+    const queue = new MaxHeap();
+    queue.push(states.add(source, -1, 0, 0, Infinity), bound[source]);
+
+    const results: CausalChain[] = [];
+    let expansions = 0;
+
+    while (queue.size > 0 && results.length < limit) {
+      const s = queue.pop();
+      const node = states.node[s];
+
+      if (node === target) {
+        results.push({
+          path: states.path(s).map((i) => this.nodeIds[i]),
+          totalUplift: states.uplift[s],
+          confidence: states.confidence[s],
+        });
+        continue;
+      }
+      if (++expansions > maxExpansions) break;
+
+      const depth = states.depth[s] + 1;
+      const remaining = maxDepth - depth;
+      const g = states.uplift[s];
+      const conf = states.confidence[s];
+
+      const visit = (e: number) => {
+        if (this.confidence[e] < minConfidence) return;
+        const next = this.dst[e];
+        const total = g + this.uplift[e];
+        let f = total;
+        if (next !== target) {
+          if (hopsToTarget[next] > remaining || states.onPath(s, next)) return;
+          f += bound[next];
+        }
+        queue.push(states.add(next, s, depth, total, Math.min(conf, this.confidence[e])), f);
+      };
+
+      this.forEachOut(node, visit);
+    }
+
+    return results;
+  }
+
+  /**
+   * Upper bounds for the A* search, in reusable scratch arrays
+   *
+   * hopsToTarget[v] is the fewest edges from v to the target. bound[v] is at
+   * least the uplift any walk v → target of at most maxDepth edges collects
+   * (the simple-path rule is ignored, so it never underestimates). Only
+   * nodes the source reaches within maxDepth - hops are relaxed, and a
+   * node's bound is only propagated again when it rose.
+   */
+  private upliftBounds(
+    source: number,
+    target: number,
+    maxDepth: number,
+    minConfidence: number
+  ): { bound: Float64Array; hopsToTarget: Uint8Array } {
+    const n = this.nodeIds.length;
+    if (!this.scratch || this.scratch.bound.length < n) {
+      const capacity = Math.max(n, 1024);
+      this.scratch = {
+        bound: new Float64Array(capacity),
+        hopsToTarget: new Uint8Array(capacity),
+        hopsFromSource: new Uint8Array(capacity),
+        round: new Uint8Array(capacity),
+      };
+    }
+    const { bound, hopsToTarget, hopsFromSource, round } = this.scratch;
+    bound.fill(-Infinity, 0, n);
+    hopsToTarget.fill(UNREACHED, 0, n);
+    hopsFromSource.fill(UNREACHED, 0, n);
+    round.fill(0, 0, n);
+
+    // Forward BFS: how soon the source can reach each node
+    hopsFromSource[source] = 0;
+    let layer = [source];
+    for (let d = 1; d < maxDepth && layer.length > 0; d++) {
+      const next: number[] = [];
+      for (const u of layer) {
+        this.forEachOut(u, (e) => {
+          const v = this.dst[e];
+          if (hopsFromSource[v] === UNREACHED && this.confidence[e] >= minConfidence) {
+            hopsFromSource[v] = d;
+            next.push(v);
+          }
+        });
+      }
+      layer = next;
+    }
+
+    // Backward relaxation from the target, one hop per round
+    bound[target] = 0;
+    hopsToTarget[target] = 0;
+    let frontier = [target];
+    for (let r = 1; r <= maxDepth && frontier.length > 0; r++) {
+      const changed: number[] = [];
+      const slack = maxDepth - r;
+      for (const v of frontier) {
+        const rest = bound[v];
+        this.forEachIn(v, (e) => {
+          const u = this.src[e];
+          if (u === target || hopsFromSource[u] > slack || this.confidence[e] < minConfidence) return;
+          if (hopsToTarget[u] === UNREACHED) hopsToTarget[u] = r;
+          const value = this.uplift[e] + rest;
+          if (value > bound[u]) {
+            bound[u] = value;
+            if (round[u] !== r) {
+              round[u] = r;
+              changed.push(u);
+            }
+          }
+        });
+      }
+      frontier = changed;
+    }
+
+    return { bound, hopsToTarget };
+  }
+
+  private forEachOut(node: number, fn: (edge: number) => void): void {
+    if (node < this.csrNodeCount) {
+      for (let i = this.outOffsets[node]; i < this.outOffsets[node + 1]; i++) fn(this.outEdges[i]);
+    }
+    const delta = this.deltaOut.get(node);
+    if (delta) for (const e of delta) fn(e);
+  }
+
+  private forEachIn(node: number, fn: (edge: number) => void): void {
+    if (node < this.csrNodeCount) {
+      for (let i = this.inOffsets[node]; i < this.inOffsets[node + 1]; i++) fn(this.inEdges[i]);
+    }
+    const delta = this.deltaIn.get(node);
+    if (delta) for (const e of delta) fn(e);
+  }
+
+  private intern(id: number): number {
+    let index = this.nodeIndex.get(id);
+    if (index === undefined) {
+      index = this.nodeIds.length;
+      this.nodeIndex.set(id, index);
+      this.nodeIds.push(id);
+    }
+    return index;
+  }
+
+  private grow(capacity: number): void {
+    const grow = <T extends Uint32Array | Float64Array>(a: T): T => {
+      const next = new (a.constructor as any)(capacity) as T;
+      next.set(a);
+      return next;
+    };
+    this.src = grow(this.src);
+    this.dst = grow(this.dst);
+    this.uplift = grow(this.uplift);
+    this.confidence = grow(this.confidence);
+  }
+}
+
+function pushTo(map: Map<number, number[]>, key: number, value: number): void {
+  const list = map.get(key);
+  if (list) list.push(value);
+  else map.set(key, [value]);
+}
+
+/**
+ * Group edge indices 0..m-1 by `keys[e]` into offsets + edges arrays
+ */
+function csr(keys: Uint32Array, n: number, m: number): [Uint32Array, Uint32Array] {
+  const offsets = new Uint32Array(n + 1);
+  for (let e = 0; e < m; e++) offsets[keys[e] + 1]++;
+  for (let i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+
+  const cursor = offsets.slice(0, n);
+  const edges = new Uint32Array(m);
+  for (let e = 0; e < m; e++) edges[cursor[keys[e]]++] = e;
+  return [offsets, edges];
+}
+
+/**
+ * Partial paths as parent-linked states in growable typed arrays
+ */
+class SearchStates {
+  node = new Uint32Array(256);
+  parent = new Int32Array(256);
+  depth = new Uint8Array(256);
+  uplift = new Float64Array(256);
+  confidence = new Float64Array(256);
+  private count = 0;
+
+  add(node: number, parent: number, depth: number, uplift: number, confidence: number): number {
+    if (this.count === this.node.length) {
+      const capacity = this.count * 2;
+      const grow = <T extends Uint32Array | Int32Array | Uint8Array | Float64Array>(a: T): T => {
+        const next = new (a.constructor as any)(capacity) as T;
+        next.set(a);
+        return next;
+      };
+      this.node = grow(this.node);
+      this.parent = grow(this.parent);
+      this.depth = grow(this.depth);
+      this.uplift = grow(this.uplift);
+      this.confidence = grow(this.confidence);
+    }
+    const s = this.count++;
+    this.node[s] = node;
+    this.parent[s] = parent;
+    this.depth[s] = depth;
+    this.uplift[s] = uplift;
+    this.confidence[s] = confidence;
+    return s;
+  }
+
+  /** Whether `node` already appears on the path ending at state `s` */
+  onPath(s: number, node: number): boolean {
+    for (let i = s; i >= 0; i = this.parent[i]) {
+      if (this.node[i] === node) return true;
+    }
+    return false;
+  }
+
+  path(s: number): number[] {
+    const nodes: number[] = [];
+    for (let i = s; i >= 0; i = this.parent[i]) nodes.push(this.node[i]);
+    return nodes.reverse();
+  }
+}
+
+/**
+ * Binary max-heap of state indices keyed by bound
+ */
+class MaxHeap {
+  private items = new Int32Array(256);
+  private keys = new Float64Array(256);
+  size = 0;
+
+  push(item: number, key: number): void {
+    if (this.size === this.items.length) {
+      const items = new Int32Array(this.size * 2);
+      const keys = new Float64Array(this.size * 2);
+      items.set(this.items);
+      keys.set(this.keys);
+      this.items = items;
+      this.keys = keys;
+    }
+    let pos = this.size++;
+    while (pos > 0) {
+      const parent = (pos - 1) >> 1;
+      if (this.keys[parent] >= key) break;
+      this.items[pos] = this.items[parent];
+      this.keys[pos] = this.keys[parent];
+      pos = parent;
+    }
+    this.items[pos] = item;
+    this.keys[pos] = key;
+  }
+
+  pop(): number {
+    const top = this.items[0];
+    const lastItem = this.items[--this.size];
+    const lastKey = this.keys[this.size];
+    let pos = 0;
+    while (true) {
+      const left = 2 * pos + 1;
+      if (left >= this.size) break;
+      const right = left + 1;
+      const child = right < this.size && this.keys[right] > this.keys[left] ? right : left;
+      if (this.keys[child] <= lastKey) break;
+      this.items[pos] = this.items[child];
+      this.keys[pos] = this.keys[child];
+      pos = child;
+    }
+    this.items[pos] = lastItem;
+    this.keys[pos] = lastKey;
+    return top;
+  }
+}
@@ -0,0 +1,66 @@
+/**
+ * DisjointSet - Union-find over dense indices
+ *
+ * Backs connected-component clustering over ANN neighbor lists. Parents live
+ * in an Int32Array so a partial clustering can be checkpointed as one blob
+ * and resumed with DisjointSet.fromParents().
+ */
+
+export class DisjointSet {
+  readonly parents: Int32Array;
+
+  constructor(size: number) {
+    this.parents = new Int32Array(size);
+    for (let i = 0; i < size; i++) this.parents[i] = i;
+  }
+
+  static fromParents(parents: Int32Array): DisjointSet {
+    const set = new DisjointSet(0);
+    (set as { parents: Int32Array }).parents = parents;
+    return set;
+  }
+
+  get size(): number {
+    return this.parents.length;
+  }
+
+  find(i: number): number {
+    const parents = this.parents;
+    let root = i;
+    while (parents[root] !== root) root = parents[root];
+    // Path compression
+    while (parents[i] !== root) {
+      const next = parents[i];
+      parents[i] = root;
+      i = next;
+    }
+    return root;
+  }
+
+  /**
+   * Merge the sets of a and b; the smaller index becomes the root so
+   * components are labelled by their first member
+   */
+  union(a: number, b: number): boolean {
+    const ra = this.find(a);
+    const rb = this.find(b);
+    if (ra === rb) return false;
+    if (ra < rb) this.parents[rb] = ra;
+    else this.parents[ra] = rb;
+    return true;
+  }
+
+  /**
+   * Members of every component, ordered by first member
+   */
+  components(): number[][] {
+    const byRoot = new Map<number, number[]>();
+    for (let i = 0; i < this.parents.length; i++) {
+      const root = this.find(i);
+      let members = byRoot.get(root);
+      if (!members) byRoot.set(root, (members = []));
+      members.push(i);
+    }
+    return Array.from(byRoot.values());
+  }
+}
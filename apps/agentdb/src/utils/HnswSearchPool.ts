@@ -0,0 +1,266 @@
+/**
+ * HnswSearchPool - Read-only hnswlib replicas in worker threads
+ *
+ * hnswlib-node keeps its graph in native memory that cannot be placed in a
+ * SharedArrayBuffer, so each worker loads a replica from one snapshot file
+ * (written once, read by every worker, then unlinked). Searches are spread
+ * over the workers so concurrent queries run in parallel instead of queueing
+ * on the main thread.
+ *
+ * The owner tracks a mutation generation and publishes each snapshot with a
+ * copy of its label -> id map. Replicas keep serving while they lag behind
+ * the owner; callers request a republish with scheduleRefresh(), which runs
+ * at most once per refreshDelayMs and, since writeIndexSync() serializes the
+ * whole graph on the main thread, no more often than keeps that work under
+ * SNAPSHOT_CPU_SHARE of the time. Results carry the ids their snapshot had
+ * for each label, so callers can detect labels removed or reused since and
+ * fall back to their own search.
+ */
+
+import * as os from 'os';
+import * as path from 'path';
+import * as fs from 'fs/promises';
+import { createRequire } from 'module';
+import { WorkerPool, defaultPoolSize } from './WorkerPool.js';
+import { searchKnnFiltered, type HnswKnnResult } from './filtered-search.js';
+
+export interface HnswSearchPoolOptions {
+  /** hnswlib space name: 'cosine' | 'l2' | 'ip' */
+  metric: string;
+  dimension: number;
+  /** Worker count (default: cores - 1) */
+  size?: number;
+  /** Delay between a refresh request and the republish (default: 1000ms) */
+  refreshDelayMs?: number;
+}
+
+export interface HnswSearchPoolStats {
+  workers: number;
+  /** Owner generation of the loaded snapshot (-1 before the first publish) */
+  publishedGeneration: number;
+  /** Searches answered by a worker replica */
+  searches: number;
+  /** Main-thread time of the last snapshot write, in ms */
+  snapshotMs: number;
+}
+
+export interface HnswReplicaResult<TId> extends HnswKnnResult {
+  /** Id each label had in the snapshot that answered */
+  ids: Array<TId | undefined>;
+}
+
+/** Largest share of main-thread time spent writing snapshots under steady writes */
+const SNAPSHOT_CPU_SHARE = 0.1;
+
+const SEARCH_WORKER_SOURCE = `
+${searchKnnFiltered.toString()}
+let index = null;
+let generation = -1;
+let baseEf = 100;
+function handle(p, workerData) {
+  if (p.type === 'load') {
+    const { HierarchicalNSW } = require(workerData.modulePath);
+    const next = new HierarchicalNSW(workerData.metric, workerData.dimension);
+    next.readIndexSync(p.path);
+    baseEf = p.ef;
+    next.setEf(baseEf);
+    index = next;
+    generation = p.generation;
+    return next.getCurrentCount();
+  }
+  if (!index) throw new Error('Search worker has no index loaded');
+  const count = index.getCurrentCount();
+  if (count === 0) return { neighbors: [], distances: [], generation };
+  const ef = p.ef || baseEf;
+  try {
+    let result;
+    if (p.allowed) {
+      const words = p.allowed;
+      const filter = (label) => (label >>> 5) < words.length && (words[label >>> 5] & (1 << (label & 31))) !== 0;
+      result = searchKnnFiltered(index, p.query, p.k, filter, { baseEf: ef, maxMatches: p.maxMatches });
+    } else {
+      index.setEf(ef);
+      result = index.searchKnn(p.query, Math.min(p.k, count));
+    }
+    return { neighbors: result.neighbors, distances: result.distances, generation };
+  } finally {
+    index.setEf(baseEf);
+  }
+}
+`;
+
+export class HnswSearchPool<TId = string> {
+  private pool: WorkerPool;
+  private refreshDelayMs: number;
+  private publishedGeneration = -1;
+  private publishing: Promise<void> | null = null;
+  private refreshTimer: ReturnType<typeof setTimeout> | null = null;
+  private pendingRefresh: Promise<void> | null = null;
+  private wakeRefresh: (() => void) | null = null;
+  private closed = false;
+  private searches = 0;
+  private snapshotMs = 0;
+
+  // Label -> id maps of the snapshots workers may still be answering from
+  private labelSnapshots = new Map<number, ReadonlyMap<number, TId>>();
+
+  constructor(options: HnswSearchPoolOptions) {
+    this.refreshDelayMs = options.refreshDelayMs ?? 1000;
+    this.pool = new WorkerPool(SEARCH_WORKER_SOURCE, {
+      size: options.size ?? defaultPoolSize(),
+      unref: true,
+      workerData: {
+        modulePath: createRequire(import.meta.url).resolve('hnswlib-node'),
+        metric: options.metric,
+        dimension: options.dimension,
+      },
+    });
+  }
+
+  get size(): number {
+    return this.pool.size;
+  }
+
+  /**
+   * Whether the workers hold a snapshot of this owner generation
+   */
+  isFresh(generation: number): boolean {
+    return this.canServe() && this.publishedGeneration === generation;
+  }
+
+  /**
+   * Whether the workers hold any snapshot to search
+   */
+  canServe(): boolean {
+    return !this.closed && this.pool.size > 0 && this.publishedGeneration >= 0;
+  }
+
+  /**
+   * Snapshot `index` (including its tombstones) and load it in every worker;
+   * `labels` is the owner's label -> id map at this generation
+   */
+  async publish(index: any, generation: number, ef: number, labels: ReadonlyMap<number, TId>): Promise<void> {
+    if (this.closed) return;
+    const snapshotPath = path.join(
+      os.tmpdir(),
+      `agentdb-search-${process.pid}-${Date.now()}-${generation}.hnsw`
+    );
+
+    const run = (async () => {
+      const start = performance.now();
+      index.writeIndexSync(snapshotPath);
+      this.snapshotMs = performance.now() - start;
+      // Registered first: workers answer from the new snapshot as soon as they load it
+      this.labelSnapshots.set(generation, labels);
+      try {
+        await this.pool.broadcast({ type: 'load', path: snapshotPath, ef, generation });
+        this.publishedGeneration = Math.max(this.publishedGeneration, generation);
+        for (const published of this.labelSnapshots.keys()) {
+          if (published < this.publishedGeneration) this.labelSnapshots.delete(published);
+        }
+      } catch (error) {
+        if (generation > this.publishedGeneration) this.labelSnapshots.delete(generation);
+        throw error;
+      } finally {
+        await fs.rm(snapshotPath, { force: true });
+      }
+    })();
+
+    this.publishing = run;
+    try {
+      await run;
+    } finally {
+      if (this.publishing === run) this.publishing = null;
+    }
+  }
+
+  /**
+   * Republish after a delay; requests while one is pending are merged
+   *
+   * The delay is refreshDelayMs, stretched so snapshot writes stay under
+   * SNAPSHOT_CPU_SHARE of the main thread. `snapshot` is called when the
+   * timer fires; returning null skips the publish.
+   */
+  scheduleRefresh(
+    snapshot: () => { index: any; generation: number; ef: number; labels: ReadonlyMap<number, TId> } | null
+  ): void {
+    if (this.closed || this.pendingRefresh) return;
+    const delay = Math.max(this.refreshDelayMs, this.snapshotMs / SNAPSHOT_CPU_SHARE);
+
+    this.pendingRefresh = (async () => {
+      await new Promise<void>((resolve) => {
+        this.wakeRefresh = resolve;
+        this.refreshTimer = setTimeout(resolve, delay);
+        this.refreshTimer.unref?.();
+      });
+      this.refreshTimer = null;
+      this.wakeRefresh = null;
+      while (this.publishing && !this.closed) {
+        await this.publishing.catch(() => {});
+      }
+      const next = this.closed ? null : snapshot();
+      if (!next) return;
+      await this.publish(next.index, next.generation, next.ef, next.labels).catch((error) => {
+        console.warn('[HnswSearchPool] Snapshot publish failed:', error);
+      });
+    })().finally(() => {
+      this.pendingRefresh = null;
+    });
+  }
+
+  /**
+   * Resolves once the scheduled refresh (if any) has been published; the
+   * timer keeps the process alive while someone waits on it
+   */
+  whenRefreshed(): Promise<void> {
+    this.refreshTimer?.ref?.();
+    return this.pendingRefresh ?? Promise.resolve();
+  }
+
+  /**
+   * k-NN search on a worker replica; `ids` are null when the snapshot that
+   * answered has already been dropped
+   *
+   * @param allowed - Label bitset words (see LabelBitset.toWords) to pre-filter by
+   */
+  async search(
+    query: Float32Array,
+    k: number,
+    options: { ef?: number; allowed?: Uint32Array; maxMatches?: number } = {}
+  ): Promise<HnswReplicaResult<TId> | null> {
+    this.searches++;
+    const result = await this.pool.run({
+      type: 'search',
+      query,
+      k,
+      ef: options.ef,
+      allowed: options.allowed,
+      maxMatches: options.maxMatches,
+    });
+    const labels = this.labelSnapshots.get(result.generation);
+    if (!labels) return null;
+    return {
+      neighbors: result.neighbors,
+      distances: result.distances,
+      ids: result.neighbors.map((label: number) => labels.get(label)),
+    };
+  }
+
+  getStats(): HnswSearchPoolStats {
+    return {
+      workers: this.pool.size,
+      publishedGeneration: this.publishedGeneration,
+      searches: this.searches,
+      snapshotMs: this.snapshotMs,
+    };
+  }
+
+  async close(): Promise<void> {
+    if (this.closed) return;
+    this.closed = true;
+    if (this.refreshTimer) clearTimeout(this.refreshTimer);
+    this.wakeRefresh?.();
+    this.labelSnapshots.clear();
+    await this.pool.close();
+  }
+}
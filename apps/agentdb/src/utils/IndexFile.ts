@@ -0,0 +1,376 @@
+/**
+ * IndexFile - Single-file, versioned, checksummed HNSW index container
+ *
+ * Layout (little-endian):
+ *   header   magic "AGDBIDX\0" | version u32 | reserved u32
+ *   sections tag u32 | length u64 | crc32 u32 | payload
+ *
+ * A base is three sections: GRPH (hnswlib's serialized graph + vectors), IDS
+ * (binary id <-> label map) and META (JSON: config, metadata, deletions...).
+ * Later saves append DLTA sections holding add/remove records, so persisting
+ * a few changes costs O(changes) instead of rewriting the file. Readers replay
+ * deltas in order; a torn trailing record (crash mid-append) is ignored and
+ * truncated by the next append. Owners compact by writing a fresh base.
+ *
+ * hnswlib-node can only load a graph from its own standalone file, so the
+ * GRPH section is streamed through a temp file in fixed-size chunks rather
+ * than being mapped in place.
+ */
+
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as zlib from 'zlib';
+
+export const INDEX_FILE_VERSION = 1;
+
+const MAGIC = Buffer.from('AGDBIDX\0', 'latin1');
+const HEADER_BYTES = 16;
+const SECTION_HEADER_BYTES = 16;
+const COPY_CHUNK_BYTES = 4 * 1024 * 1024;
+
+const TAG_GRAPH = 0x48505247; // 'GRPH'
+const TAG_IDS = 0x20534449; // 'IDS '
+const TAG_META = 0x4154454d; // 'META'
+const TAG_DELTA = 0x41544c44; // 'DLTA'
+
+const OP_ADD = 1;
+const OP_REMOVE = 2;
+
+export type IndexDelta =
+  | { op: 'add'; id: string; label: number; vector: Float32Array; metadata?: Record<string, any> }
+  | { op: 'remove'; id: string };
+
+export interface IndexFileContents {
+  ids: Array<[string, number]>;
+  meta: Record<string, any>;
+  /** Replayed in file order; deltas.length drives compaction decisions */
+  deltas: IndexDelta[];
+  /** Bytes of valid data; anything past this is a torn append */
+  length: number;
+}
+
+let crcTable: Uint32Array | null = null;
+
+/**
+ * CRC32 via zlib.crc32 where available (Node 20.15+), table fallback otherwise
+ */
+export function crc32(data: Uint8Array, value = 0): number {
+  const native = (zlib as any).crc32;
+  if (typeof native === 'function') return native(data, value);
+
+  if (!crcTable) {
+    crcTable = new Uint32Array(256);
+    for (let n = 0; n < 256; n++) {
+      let c = n;
+      for (let k = 0; k < 8; k++) c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+      crcTable[n] = c >>> 0;
+    }
+  }
+  let crc = ~value >>> 0;
+  for (let i = 0; i < data.length; i++) {
+    crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >>> 8);
+  }
+  return ~crc >>> 0;
+}
+
+function encodeIds(ids: Iterable<[string, number]>): Buffer {
+  const parts: Buffer[] = [];
+  let count = 0;
+  for (const [id, label] of ids) {
+    const idBytes = Buffer.from(id, 'utf8');
+    const head = Buffer.allocUnsafe(8);
+    head.writeUInt32LE(label, 0);
+    head.writeUInt32LE(idBytes.length, 4);
+    parts.push(head, idBytes);
+    count++;
+  }
+  const countBytes = Buffer.allocUnsafe(4);
+  countBytes.writeUInt32LE(count, 0);
+  return Buffer.concat([countBytes, ...parts]);
+}
+
+function decodeIds(buf: Buffer): Array<[string, number]> {
+  const count = buf.readUInt32LE(0);
+  const ids: Array<[string, number]> = new Array(count);
+  let offset = 4;
+  for (let i = 0; i < count; i++) {
+    const label = buf.readUInt32LE(offset);
+    const len = buf.readUInt32LE(offset + 4);
+    offset += 8;
+    ids[i] = [buf.toString('utf8', offset, offset + len), label];
+    offset += len;
+  }
+  return ids;
+}
+
+function encodeDeltas(ops: IndexDelta[]): Buffer {
+  const parts: Buffer[] = [];
+  const countBytes = Buffer.allocUnsafe(4);
+  countBytes.writeUInt32LE(ops.length, 0);
+  parts.push(countBytes);
+
+  for (const op of ops) {
+    const idBytes = Buffer.from(op.id, 'utf8');
+    const head = Buffer.allocUnsafe(5);
+    head.writeUInt8(op.op === 'add' ? OP_ADD : OP_REMOVE, 0);
+    head.writeUInt32LE(idBytes.length, 1);
+    parts.push(head, idBytes);
+
+    if (op.op === 'add') {
+      const metaBytes = op.metadata ? Buffer.from(JSON.stringify(op.metadata), 'utf8') : Buffer.alloc(0);
+      const fields = Buffer.allocUnsafe(12);
+      fields.writeUInt32LE(op.label, 0);
+      fields.writeUInt32LE(op.vector.length, 4);
+      fields.writeUInt32LE(metaBytes.length, 8);
+      parts.push(
+        fields,
+        Buffer.from(op.vector.buffer, op.vector.byteOffset, op.vector.byteLength),
+        metaBytes
+      );
+    }
+  }
+  return Buffer.concat(parts);
+}
+
+function decodeDeltas(buf: Buffer, out: IndexDelta[]): void {
+  const count = buf.readUInt32LE(0);
+  let offset = 4;
+  for (let i = 0; i < count; i++) {
+    const type = buf.readUInt8(offset);
+    const idLen = buf.readUInt32LE(offset + 1);
+    offset += 5;
+    const id = buf.toString('utf8', offset, offset + idLen);
+    offset += idLen;
+
+    if (type === OP_ADD) {
+      const label = buf.readUInt32LE(offset);
+      const dim = buf.readUInt32LE(offset + 4);
+      const metaLen = buf.readUInt32LE(offset + 8);
+      offset += 12;
+      // Copy out so the vector is aligned and independent of the read buffer
+      const vector = new Float32Array(dim);
+      Buffer.from(vector.buffer).set(buf.subarray(offset, offset + dim * 4));
+      offset += dim * 4;
+      const metadata = metaLen > 0 ? JSON.parse(buf.toString('utf8', offset, offset + metaLen)) : undefined;
+      offset += metaLen;
+      out.push({ op: 'add', id, label, vector, metadata });
+    } else if (type === OP_REMOVE) {
+      out.push({ op: 'remove', id });
+    } else {
+      throw new Error(`Unknown delta op ${type}`);
+    }
+  }
+}
+
+function sectionHeader(tag: number, length: number, crc: number): Buffer {
+  const head = Buffer.allocUnsafe(SECTION_HEADER_BYTES);
+  head.writeUInt32LE(tag, 0);
+  head.writeBigUInt64LE(BigInt(length), 4);
+  head.writeUInt32LE(crc >>> 0, 12);
+  return head;
+}
+
+function writeSection(fd: number, position: number, tag: number, payload: Buffer): number {
+  fs.writeSync(fd, sectionHeader(tag, payload.length, crc32(payload)), 0, SECTION_HEADER_BYTES, position);
+  fs.writeSync(fd, payload, 0, payload.length, position + SECTION_HEADER_BYTES);
+  return position + SECTION_HEADER_BYTES + payload.length;
+}
+
+function tempPath(label: string): string {
+  return path.join(os.tmpdir(), `agentdb-${label}-${process.pid}-${Date.now()}-${Math.random().toString(36).slice(2)}`);
+}
+
+/**
+ * Whether `filePath` starts with the IndexFile magic
+ */
+export function isIndexFile(filePath: string): boolean {
+  let fd: number | null = null;
+  try {
+    fd = fs.openSync(filePath, 'r');
+    const head = Buffer.alloc(MAGIC.length);
+    fs.readSync(fd, head, 0, head.length, 0);
+    return head.equals(MAGIC);
+  } catch {
+    return false;
+  } finally {
+    if (fd !== null) fs.closeSync(fd);
+  }
+}
+
+/**
+ * Write a fresh base (atomically replaces `filePath`)
+ *
+ * @param writeGraph - Writes the hnswlib graph to the given path (writeIndexSync)
+ * @returns File length, for later appendIndexDelta() calls
+ */
+export function writeIndexFile(
+  filePath: string,
+  writeGraph: (graphPath: string) => void,
+  ids: Iterable<[string, number]>,
+  meta: Record<string, any>
+): number {
+  fs.mkdirSync(path.dirname(filePath), { recursive: true });
+  const graphPath = tempPath('graph');
+  const partialPath = `${filePath}.tmp-${process.pid}`;
+  writeGraph(graphPath);
+
+  const fd = fs.openSync(partialPath, 'w');
+  try {
+    const header = Buffer.alloc(HEADER_BYTES);
+    MAGIC.copy(header, 0);
+    header.writeUInt32LE(INDEX_FILE_VERSION, 8);
+    fs.writeSync(fd, header, 0, HEADER_BYTES, 0);
+
+    // Stream the graph in after a placeholder header, checksumming as we go
+    const graphFd = fs.openSync(graphPath, 'r');
+    let position = HEADER_BYTES + SECTION_HEADER_BYTES;
+    let length = 0;
+    let crc = 0;
+    try {
+      const chunk = Buffer.allocUnsafe(COPY_CHUNK_BYTES);
+      for (;;) {
+        const read = fs.readSync(graphFd, chunk, 0, chunk.length, length);
+        if (read === 0) break;
+        const view = chunk.subarray(0, read);
+        crc = crc32(view, crc);
+        fs.writeSync(fd, view, 0, read, position);
+        position += read;
+        length += read;
+      }
+    } finally {
+      fs.closeSync(graphFd);
+    }
+    fs.writeSync(fd, sectionHeader(TAG_GRAPH, length, crc), 0, SECTION_HEADER_BYTES, HEADER_BYTES);
+
+    position = writeSection(fd, position, TAG_IDS, encodeIds(ids));
+    position = writeSection(fd, position, TAG_META, Buffer.from(JSON.stringify(meta), 'utf8'));
+    fs.fsyncSync(fd);
+    fs.closeSync(fd);
+    fs.renameSync(partialPath, filePath);
+    return position;
+  } catch (error) {
+    try { fs.closeSync(fd); } catch { /* already closed */ }
+    fs.rmSync(partialPath, { force: true });
+    throw error;
+  } finally {
+    fs.rmSync(graphPath, { force: true });
+  }
+}
+
+/**
+ * Append delta records to an existing file
+ *
+ * @param expectedLength - Length returned by the last write/read; bytes past it
+ *   (a torn append) are discarded first
+ * @returns New file length, or null if the file no longer matches (caller
+ *   should write a fresh base)
+ */
+export function appendIndexDelta(filePath: string, ops: IndexDelta[], expectedLength: number): number | null {
+  if (ops.length === 0) return expectedLength;
+  if (!fs.existsSync(filePath) || fs.statSync(filePath).size < expectedLength) return null;
+
+  const fd = fs.openSync(filePath, 'r+');
+  try {
+    fs.ftruncateSync(fd, expectedLength);
+    const end = writeSection(fd, expectedLength, TAG_DELTA, encodeDeltas(ops));
+    fs.fsyncSync(fd);
+    return end;
+  } finally {
+    fs.closeSync(fd);
+  }
+}
+
+/**
+ * Read a file, loading the graph through `readGraph` (readIndexSync)
+ *
+ * Base sections must pass their checksum; delta replay stops at the first
+ * torn or corrupt record.
+ */
+export function readIndexFile(filePath: string, readGraph: (graphPath: string) => void): IndexFileContents {
+  const fd = fs.openSync(filePath, 'r');
+  const graphPath = tempPath('graph');
+  try {
+    const size = fs.fstatSync(fd).size;
+    const header = Buffer.alloc(HEADER_BYTES);
+    fs.readSync(fd, header, 0, HEADER_BYTES, 0);
+    if (!header.subarray(0, MAGIC.length).equals(MAGIC)) {
+      throw new Error(`Not an AgentDB index file: ${filePath}`);
+    }
+    const version = header.readUInt32LE(8);
+    if (version > INDEX_FILE_VERSION) {
+      throw new Error(`Index file version ${version} is newer than supported (${INDEX_FILE_VERSION})`);
+    }
+
+    const readSectionHeader = (position: number) => {
+      if (position + SECTION_HEADER_BYTES > size) return null;
+      const head = Buffer.alloc(SECTION_HEADER_BYTES);
+      fs.readSync(fd, head, 0, SECTION_HEADER_BYTES, position);
+      const length = Number(head.readBigUInt64LE(4));
+      const start = position + SECTION_HEADER_BYTES;
+      if (start + length > size) return null;
+      return { tag: head.readUInt32LE(0), length, crc: head.readUInt32LE(12), start };
+    };
+
+    const readPayload = (section: { length: number; start: number; crc: number }) => {
+      const payload = Buffer.allocUnsafe(section.length);
+      fs.readSync(fd, payload, 0, section.length, section.start);
+      return crc32(payload) === section.crc ? payload : null;
+    };
+
+    // GRPH: stream to a temp file for hnswlib, verifying the checksum
+    const graph = readSectionHeader(HEADER_BYTES);
+    if (!graph || graph.tag !== TAG_GRAPH) throw new Error(`Index file truncated: ${filePath}`);
+    const out = fs.openSync(graphPath, 'w');
+    let crc = 0;
+    try {
+      const chunk = Buffer.allocUnsafe(Math.min(COPY_CHUNK_BYTES, Math.max(1, graph.length)));
+      for (let done = 0; done < graph.length; ) {
+        const read = fs.readSync(fd, chunk, 0, Math.min(chunk.length, graph.length - done), graph.start + done);
+        const view = chunk.subarray(0, read);
+        crc = crc32(view, crc);
+        fs.writeSync(out, view);
+        done += read;
+      }
+    } finally {
+      fs.closeSync(out);
+    }
+    if (crc >>> 0 !== graph.crc) throw new Error(`Index graph checksum mismatch: ${filePath}`);
+
+    let position = graph.start + graph.length;
+    const idsSection = readSectionHeader(position);
+    const idsPayload = idsSection && idsSection.tag === TAG_IDS ? readPayload(idsSection) : null;
+    if (!idsSection || !idsPayload) throw new Error(`Index id map corrupt: ${filePath}`);
+    position = idsSection.start + idsSection.length;
+
+    const metaSection = readSectionHeader(position);
+    const metaPayload = metaSection && metaSection.tag === TAG_META ? readPayload(metaSection) : null;
+    if (!metaSection || !metaPayload) throw new Error(`Index metadata corrupt: ${filePath}`);
+    position = metaSection.start + metaSection.length;
+
+    readGraph(graphPath);
+
+    const deltas: IndexDelta[] = [];
+    for (;;) {
+      const section = readSectionHeader(position);
+      if (!section || section.tag !== TAG_DELTA) break;
+      const payload = readPayload(section);
+      if (!payload) break;
+      decodeDeltas(payload, deltas);
+      position = section.start + section.length;
+    }
+    if (position < size) {
+      console.warn(`[IndexFile] Ignoring ${size - position} trailing bytes in ${filePath} (torn append)`);
+    }
+
+    return {
+      ids: decodeIds(idsPayload),
+      meta: JSON.parse(metaPayload.toString('utf8')),
+      deltas,
+      length: position,
+    };
+  } finally {
+    fs.closeSync(fd);
+    fs.rmSync(graphPath, { force: true });
+  }
+}
@@ -0,0 +1,197 @@
+/**
+ * LRUCache - O(1) least-recently-used cache with an entry cap and byte budget
+ *
+ * Recency is tracked by Map insertion order: a hit deletes and re-inserts the
+ * key (moving it to the most-recent end) and eviction pops from the front, so
+ * every operation is O(1). Entries carry an estimated byte size and the cache
+ * evicts until both the entry cap and the byte budget are satisfied.
+ */
+
+import { createHash } from 'crypto';
+
+export interface LRUCacheOptions<V> {
+  /** Maximum number of entries (default: unbounded) */
+  maxEntries?: number;
+  /** Maximum total estimated bytes (default: unbounded) */
+  maxBytes?: number;
+  /** Estimate the size of a value when set() is not given one (default: 0) */
+  sizeOf?: (value: V) => number;
+  /** Called for entries removed to make room (not for delete/clear) */
+  onEvict?: (key: string, value: V) => void;
+}
+
+export interface LRUCacheStats {
+  hits: number;
+  misses: number;
+  evictions: number;
+  /** Hit rate (0-1) */
+  hitRate: number;
+  size: number;
+  bytes: number;
+  maxEntries: number;
+  maxBytes: number;
+}
+
+interface Slot<V> {
+  value: V;
+  size: number;
+}
+
+/**
+ * Fixed-length sha256 digest for cache keys, so long texts are not held as
+ * keys (parts are NUL-separated; a single part hashes as-is)
+ */
+export function hashKey(...parts: string[]): string {
+  const hash = createHash('sha256');
+  parts.forEach((part, i) => {
+    if (i > 0) hash.update('\u0000');
+    hash.update(part);
+  });
+  return hash.digest('base64');
+}
+
+export class LRUCache<V> {
+  private map: Map<string, Slot<V>> = new Map();
+  private maxEntries: number;
+  private maxBytes: number;
+  private sizeOf?: (value: V) => number;
+  private onEvict?: (key: string, value: V) => void;
+  private totalBytes = 0;
+
+  private hits = 0;
+  private misses = 0;
+  private evictions = 0;
+
+  constructor(options: LRUCacheOptions<V> = {}) {
+    this.maxEntries = options.maxEntries ?? Infinity;
+    this.maxBytes = options.maxBytes ?? Infinity;
+    this.sizeOf = options.sizeOf;
+    this.onEvict = options.onEvict;
+  }
+
+  get size(): number {
+    return this.map.size;
+  }
+
+  /** Total estimated bytes held */
+  get bytes(): number {
+    return this.totalBytes;
+  }
+
+  /**
+   * Look up a key, counting a hit or miss and marking it most recently used
+   */
+  get(key: string): V | undefined {
+    const slot = this.map.get(key);
+    if (!slot) {
+      this.misses++;
+      return undefined;
+    }
+    this.map.delete(key);
+    this.map.set(key, slot);
+    this.hits++;
+    return slot.value;
+  }
+
+  /**
+   * Look up a key without affecting recency or stats
+   */
+  peek(key: string): V | undefined {
+    return this.map.get(key)?.value;
+  }
+
+  has(key: string): boolean {
+    return this.map.has(key);
+  }
+
+  /**
+   * Insert or replace a value
+   *
+   * @returns false if the value alone exceeds the byte budget (not cached)
+   */
+  set(key: string, value: V, size?: number): boolean {
+    const bytes = size ?? this.sizeOf?.(value) ?? 0;
+    if (bytes > this.maxBytes) {
+      this.delete(key);
+      return false;
+    }
+
+    const existing = this.map.get(key);
+    if (existing) {
+      this.totalBytes -= existing.size;
+      this.map.delete(key);
+    }
+
+    this.map.set(key, { value, size: bytes });
+    this.totalBytes += bytes;
+    this.evict();
+    return true;
+  }
+
+  delete(key: string): boolean {
+    const slot = this.map.get(key);
+    if (!slot) return false;
+    this.map.delete(key);
+    this.totalBytes -= slot.size;
+    return true;
+  }
+
+  clear(): void {
+    this.map.clear();
+    this.totalBytes = 0;
+  }
+
+  /**
+   * Change limits, evicting immediately if the cache is now over budget
+   */
+  setLimits(limits: { maxEntries?: number; maxBytes?: number }): void {
+    if (limits.maxEntries !== undefined) this.maxEntries = limits.maxEntries;
+    if (limits.maxBytes !== undefined) this.maxBytes = limits.maxBytes;
+    this.evict();
+  }
+
+  /**
+   * Entries from least to most recently used
+   */
+  *entries(): IterableIterator<[string, V]> {
+    for (const [key, slot] of this.map) {
+      yield [key, slot.value];
+    }
+  }
+
+  keys(): IterableIterator<string> {
+    return this.map.keys();
+  }
+
+  getStats(): LRUCacheStats {
+    const total = this.hits + this.misses;
+    return {
+      hits: this.hits,
+      misses: this.misses,
+      evictions: this.evictions,
+      hitRate: total > 0 ? this.hits / total : 0,
+      size: this.map.size,
+      bytes: this.totalBytes,
+      maxEntries: this.maxEntries,
+      maxBytes: this.maxBytes,
+    };
+  }
+
+  resetStats(): void {
+    this.hits = 0;
+    this.misses = 0;
+    this.evictions = 0;
+  }
+
+  private evict(): void {
+    while (this.map.size > this.maxEntries || this.totalBytes > this.maxBytes) {
+      const oldest = this.map.keys().next();
+      if (oldest.done) break;
+      const slot = this.map.get(oldest.value)!;
+      this.map.delete(oldest.value);
+      this.totalBytes -= slot.size;
+      this.evictions++;
+      this.onEvict?.(oldest.value, slot.value);
+    }
+  }
+}
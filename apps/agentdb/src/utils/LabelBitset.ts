@@ -0,0 +1,78 @@
+/**
+ * LabelBitset - Dense bitset over numeric index labels
+ *
+ * Used as a pre-filter for ANN search: hnswlib labels are small dense
+ * integers, so membership is one word load and mask instead of a Set lookup
+ * while the graph is traversed.
+ */
+
+export class LabelBitset {
+  private words: Uint32Array;
+  private _count: number = 0;
+
+  constructor(capacity: number = 0) {
+    this.words = new Uint32Array(Math.max(1, Math.ceil(capacity / 32)));
+  }
+
+  /**
+   * Build a bitset from an iterable of labels
+   */
+  static from(labels: Iterable<number>, capacity: number = 0): LabelBitset {
+    const bitset = new LabelBitset(capacity);
+    for (const label of labels) {
+      bitset.add(label);
+    }
+    return bitset;
+  }
+
+  /**
+   * Number of labels set
+   */
+  get count(): number {
+    return this._count;
+  }
+
+  add(label: number): void {
+    const word = label >>> 5;
+    if (word >= this.words.length) {
+      const grown = new Uint32Array(Math.max(word + 1, this.words.length * 2));
+      grown.set(this.words);
+      this.words = grown;
+    }
+    const mask = 1 << (label & 31);
+    if ((this.words[word] & mask) === 0) {
+      this.words[word] |= mask;
+      this._count++;
+    }
+  }
+
+  delete(label: number): void {
+    const word = label >>> 5;
+    if (word >= this.words.length) return;
+    const mask = 1 << (label & 31);
+    if (this.words[word] & mask) {
+      this.words[word] &= ~mask;
+      this._count--;
+    }
+  }
+
+  has(label: number): boolean {
+    const word = label >>> 5;
+    return word < this.words.length && (this.words[word] & (1 << (label & 31))) !== 0;
+  }
+
+  /**
+   * Underlying words (bit `label & 31` of word `label >>> 5`), e.g. to post
+   * the filter to a search worker
+   */
+  toWords(): Uint32Array {
+    return this.words;
+  }
+
+  /**
+   * Predicate form, suitable for hnswlib's searchKnn filter callback
+   */
+  toPredicate(): (label: number) => boolean {
+    return (label: number) => this.has(label);
+  }
+}
@@ -0,0 +1,203 @@
+/**
+ * LexicalIndex - FTS5/BM25 inverted index over a table's text columns
+ *
+ * Backs the lexical half of hybrid retrieval. The index is an external-content
+ * FTS5 table kept in sync by triggers, so rows written by any path (controllers,
+ * sync, raw SQL) are searchable without an embedding. Builds without FTS5
+ * (some sql.js bundles) report `available = false` and callers fall back to
+ * vector-only search.
+ */
+
+import type { IDatabaseConnection } from '../types/database.types.js';
+
+export type RetrievalMode = 'vector' | 'lexical' | 'hybrid';
+
+export interface FusionOptions {
+  /** Reciprocal rank fusion (default) or a blend of max-normalized scores */
+  method?: 'rrf' | 'weighted';
+  /** Weight of the lexical ranking, 0-1 (default 0.5; vector gets the rest) */
+  lexicalWeight?: number;
+  /** RRF rank offset (default 60) */
+  rrfK?: number;
+}
+
+export interface LexicalIndexSpec {
+  /** Source table; its integer key becomes the FTS rowid */
+  table: string;
+  key: string;
+  columns: string[];
+  /** Per-column BM25 weights, in column order */
+  weights?: number[];
+}
+
+export interface RankedHit {
+  id: number;
+  /** Higher is better */
+  score: number;
+}
+
+export interface LexicalSearchOptions {
+  /** 'all' requires every query token (exact lookups), 'any' ranks partial matches */
+  match?: 'all' | 'any';
+  /** Extra condition on the source table, aliased as `t` */
+  where?: string;
+  params?: any[];
+}
+
+// Tokens that read as identifiers rather than prose: tool names, error codes,
+// paths, versions (read_file, ECONNREFUSED, E11000, fs.readFile)
+const IDENTIFIER_TOKEN = /[_:./#\\-]|\d|[a-z][A-Z]|^[A-Z]{2,}$/;
+const MAX_EXACT_TOKENS = 3;
+
+const openIndexes = new WeakMap<object, Map<string, LexicalIndex>>();
+
+export class LexicalIndex {
+  readonly available: boolean;
+  private readonly ftsTable: string;
+
+  private constructor(private db: IDatabaseConnection, private spec: LexicalIndexSpec) {
+    this.ftsTable = `${spec.table}_fts`;
+    this.available = this.ensure();
+  }
+
+  /**
+   * Index for a table, created (and back-filled) on first open per connection.
+   * Open it where the controller sets up its schema, not on the read path: the
+   * first open runs DDL, and a source table that does not exist yet leaves the
+   * index unavailable
+   */
+  static open(db: IDatabaseConnection, spec: LexicalIndexSpec): LexicalIndex {
+    let indexes = openIndexes.get(db);
+    if (!indexes) openIndexes.set(db, (indexes = new Map()));
+    let index = indexes.get(spec.table);
+    if (!index) {
+      index = new LexicalIndex(db, spec);
+      indexes.set(spec.table, index);
+    }
+    return index;
+  }
+
+  /**
+   * Top-k rows by BM25, best first
+   */
+  search(text: string, k: number, options: LexicalSearchOptions = {}): RankedHit[] {
+    if (!this.available || k <= 0) return [];
+    const match = toMatchQuery(text, options.match ?? 'any');
+    if (!match) return [];
+
+    const { table, key, columns, weights } = this.spec;
+    const bm25Weights = columns.map((_, i) => weights?.[i] ?? 1).join(', ');
+    const where = options.where ? `AND (${options.where})` : '';
+
+    try {
+      const rows = this.db.prepare(`
+        SELECT t.${key} AS id, -bm25(${this.ftsTable}, ${bm25Weights}) AS score
+        FROM ${this.ftsTable}
+        JOIN ${table} t ON t.${key} = ${this.ftsTable}.rowid
+        WHERE ${this.ftsTable} MATCH ? ${where}
+        ORDER BY score DESC
+        LIMIT ?
+      `).all(match, ...(options.params ?? []), k) as RankedHit[];
+      return rows;
+    } catch (error) {
+      console.warn(`[LexicalIndex] Search on ${this.ftsTable} failed:`, (error as Error).message);
+      return [];
+    }
+  }
+
+  private ensure(): boolean {
+    const { table, key, columns } = this.spec;
+    const fts = this.ftsTable;
+    const tableExists = (name: string) =>
+      this.db.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?").get(name);
+    if (!tableExists(table)) return false;
+    const exists = tableExists(fts);
+
+    try {
+      const cols = columns.join(', ');
+      const newCols = columns.map((c) => `new.${c}`).join(', ');
+      const oldCols = columns.map((c) => `old.${c}`).join(', ');
+
+      this.db.exec(`
+        CREATE VIRTUAL TABLE IF NOT EXISTS ${fts} USING fts5(
+          ${cols}, content='${table}', content_rowid='${key}'
+        );
+
+        CREATE TRIGGER IF NOT EXISTS ${fts}_ai AFTER INSERT ON ${table} BEGIN
+          INSERT INTO ${fts}(rowid, ${cols}) VALUES (new.${key}, ${newCols});
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS ${fts}_ad AFTER DELETE ON ${table} BEGIN
+          INSERT INTO ${fts}(${fts}, rowid, ${cols}) VALUES ('delete', old.${key}, ${oldCols});
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS ${fts}_au AFTER UPDATE OF ${cols} ON ${table} BEGIN
+          INSERT INTO ${fts}(${fts}, rowid, ${cols}) VALUES ('delete', old.${key}, ${oldCols});
+          INSERT INTO ${fts}(rowid, ${cols}) VALUES (new.${key}, ${newCols});
+        END;
+      `);
+
+      // Rows written before the index existed
+      if (!exists) {
+        this.db.exec(`INSERT INTO ${fts}(${fts}) VALUES ('rebuild')`);
+      }
+      return true;
+    } catch (error) {
+      console.warn(`[LexicalIndex] FTS5 unavailable for ${table}, using vector search only:`, (error as Error).message);
+      return false;
+    }
+  }
+}
+
+/**
+ * Whether a query is a handful of identifier-like tokens that postings lists
+ * answer exactly, so embedding it would add latency and cost for nothing
+ */
+export function isExactTokenQuery(text: string): boolean {
+  const tokens = text.trim().split(/\s+/).filter(Boolean);
+  return tokens.length > 0 && tokens.length <= MAX_EXACT_TOKENS && tokens.every((token) => IDENTIFIER_TOKEN.test(token));
+}
+
+/**
+ * FTS5 MATCH expression with every token quoted as a phrase, so punctuation in
+ * the query is never parsed as FTS syntax (read_file -> "read file" adjacent)
+ */
+export function toMatchQuery(text: string, match: 'all' | 'any'): string | null {
+  const phrases = text
+    .split(/\s+/)
+    .map((token) => token.replace(/"/g, ''))
+    .filter((token) => /[\p{L}\p{N}]/u.test(token))
+    .map((token) => `"${token}"`);
+  if (phrases.length === 0) return null;
+  return phrases.join(match === 'all' ? ' ' : ' OR ');
+}
+
+/**
+ * Fuse a lexical and a vector ranking into one, best first
+ */
+export function fuseRankings(lexical: RankedHit[], vector: RankedHit[], options: FusionOptions = {}): RankedHit[] {
+  const lexicalWeight = Math.min(Math.max(options.lexicalWeight ?? 0.5, 0), 1);
+  const fused = new Map<number, number>();
+
+  const add = (hits: RankedHit[], weight: number) => {
+    if (weight === 0 || hits.length === 0) return;
+    if (options.method === 'weighted') {
+      const max = Math.max(...hits.map((hit) => hit.score));
+      const min = Math.min(...hits.map((hit) => hit.score));
+      hits.forEach((hit) => {
+        const normalized = max === min ? 1 : (hit.score - min) / (max - min);
+        fused.set(hit.id, (fused.get(hit.id) ?? 0) + weight * normalized);
+      });
+    } else {
+      const rrfK = options.rrfK ?? 60;
+      hits.forEach((hit, rank) => {
+        fused.set(hit.id, (fused.get(hit.id) ?? 0) + weight / (rrfK + rank + 1));
+      });
+    }
+  };
+
+  add(lexical, lexicalWeight);
+  add(vector, 1 - lexicalWeight);
+
+  return [...fused].map(([id, score]) => ({ id, score })).sort((a, b) => b.score - a.score);
+}
@@ -0,0 +1,188 @@
+/**
+ * MerkleTree - Batched SHA-256 Merkle trees with a prefix-aware cache
+ *
+ * Trees are built level by level, hashing each level's pairs in one batch.
+ * Odd nodes are promoted unchanged and parents hash the concatenated hex of
+ * their children, matching the roots of previously issued certificates.
+ *
+ * MerkleTreeCache returns the cached tree for an identical leaf list, and
+ * extends the longest cached prefix otherwise: only the nodes on the right
+ * edge above the new leaves are recomputed.
+ */
+
+import * as crypto from 'crypto';
+import { LRUCache } from './LRUCache.js';
+
+export interface MerkleTree {
+  root: string;
+  /** Levels from leaves (0) to root */
+  tree: string[][];
+}
+
+export interface MerkleCacheStats {
+  hits: number;
+  extensions: number;
+  builds: number;
+  size: number;
+}
+
+// One-shot hashing (Node >= 21.7) skips allocating a Hash object per input
+const oneShotHash: ((algorithm: string, data: string, encoding: 'hex') => string) | undefined =
+  typeof (crypto as any).hash === 'function' ? (crypto as any).hash : undefined;
+
+export function sha256Hex(data: string): string {
+  return oneShotHash
+    ? oneShotHash('sha256', data, 'hex')
+    : crypto.createHash('sha256').update(data).digest('hex');
+}
+
+/**
+ * Hex SHA-256 of each input, in order
+ */
+export function sha256Batch(inputs: readonly string[]): string[] {
+  const out = new Array<string>(inputs.length);
+  for (let i = 0; i < inputs.length; i++) out[i] = sha256Hex(inputs[i]);
+  return out;
+}
+
+export function buildMerkleTree(leaves: readonly string[]): MerkleTree {
+  if (leaves.length === 0) {
+    return { root: '', tree: [[]] };
+  }
+  return extendLevels([leaves.slice()], 0);
+}
+
+/**
+ * Tree over `leaves`, reusing `base`, a tree over a prefix of them
+ */
+export function extendMerkleTree(base: MerkleTree, leaves: readonly string[]): MerkleTree {
+  const prefix = base.tree[0].length;
+  if (prefix === 0) return buildMerkleTree(leaves);
+  if (prefix === leaves.length) return base;
+
+  const tree = base.tree.map((level) => level.slice());
+  tree[0] = leaves.slice();
+  return extendLevels(tree, prefix);
+}
+
+/**
+ * Recompute parents from the first changed index upward; nodes left of it
+ * depend only on unchanged children
+ */
+function extendLevels(tree: string[][], firstChanged: number): MerkleTree {
+  let changed = firstChanged;
+  let height = 0;
+
+  while (tree[height].length > 1) {
+    const level = tree[height];
+    const parentStart = changed >>> 1;
+    const next = (tree[height + 1] ?? []).slice(0, parentStart);
+
+    const pairs: string[] = [];
+    // Per parent: -1 for a hashed pair, else the index of the promoted child
+    const promoted: number[] = [];
+    for (let i = parentStart * 2; i < level.length; i += 2) {
+      if (i + 1 < level.length) {
+        pairs.push(level[i] + level[i + 1]);
+        promoted.push(-1);
+      } else {
+        promoted.push(i);
+      }
+    }
+
+    const hashes = sha256Batch(pairs);
+    let h = 0;
+    for (const index of promoted) {
+      next.push(index < 0 ? hashes[h++] : level[index]);
+    }
+
+    tree[height + 1] = next;
+    changed = parentStart;
+    height++;
+  }
+
+  tree.length = height + 1;
+  return { root: tree[height][0], tree };
+}
+
+export class MerkleTreeCache {
+  private trees: LRUCache<MerkleTree>;
+  // First leaf -> cached keys starting with it, for prefix lookups
+  private byFirstLeaf = new Map<string, Set<string>>();
+  private extensions = 0;
+  private builds = 0;
+
+  constructor(maxEntries: number = 256) {
+    this.trees = new LRUCache<MerkleTree>({
+      maxEntries,
+      onEvict: (key, tree) => this.unindex(key, tree),
+    });
+  }
+
+  /**
+   * Tree over these leaves: cached, extended from a cached prefix, or built
+   */
+  get(leaves: readonly string[]): MerkleTree {
+    if (leaves.length === 0) return buildMerkleTree(leaves);
+
+    const key = leaves.join('');
+    const cached = this.trees.get(key);
+    if (cached) return cached;
+
+    const base = this.longestPrefix(key, leaves);
+    let tree: MerkleTree;
+    if (base) {
+      tree = extendMerkleTree(base, leaves);
+      this.extensions++;
+    } else {
+      tree = buildMerkleTree(leaves);
+      this.builds++;
+    }
+
+    this.trees.set(key, tree);
+    let keys = this.byFirstLeaf.get(leaves[0]);
+    if (!keys) this.byFirstLeaf.set(leaves[0], (keys = new Set()));
+    keys.add(key);
+    return tree;
+  }
+
+  getStats(): MerkleCacheStats {
+    return {
+      hits: this.trees.getStats().hits,
+      extensions: this.extensions,
+      builds: this.builds,
+      size: this.trees.size,
+    };
+  }
+
+  clear(): void {
+    this.trees.clear();
+    this.byFirstLeaf.clear();
+  }
+
+  private longestPrefix(key: string, leaves: readonly string[]): MerkleTree | null {
+    let best: MerkleTree | null = null;
+    for (const candidate of this.byFirstLeaf.get(leaves[0]) ?? []) {
+      if (candidate.length >= key.length || !key.startsWith(candidate)) continue;
+      const tree = this.trees.peek(candidate);
+      if (!tree || (best && tree.tree[0].length <= best.tree[0].length)) continue;
+      if (isLeafPrefix(tree.tree[0], leaves)) best = tree;
+    }
+    return best;
+  }
+
+  private unindex(key: string, tree: MerkleTree): void {
+    const first = tree.tree[0][0];
+    const keys = this.byFirstLeaf.get(first);
+    keys?.delete(key);
+    if (keys && keys.size === 0) this.byFirstLeaf.delete(first);
+  }
+}
+
+function isLeafPrefix(prefix: readonly string[], leaves: readonly string[]): boolean {
+  if (prefix.length >= leaves.length) return false;
+  for (let i = 0; i < prefix.length; i++) {
+    if (prefix[i] !== leaves[i]) return false;
+  }
+  return true;
+}
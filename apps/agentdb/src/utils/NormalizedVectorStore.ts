@@ -0,0 +1,237 @@
+/**
+ * NormalizedVectorStore - Columnar in-memory vector store for brute-force search
+ *
+ * Keeps every vector L2-normalized in one contiguous Float32Array slab with a
+ * parallel id array, so cosine similarity reduces to a single dot-product scan.
+ * Supports incremental append/upsert and tombstoned deletes with compaction.
+ * When WASM SIMD is available the slab lives directly in kernel memory, so
+ * there is no second copy for the SIMD scan.
+ */
+
+import { SimdDotKernel, dotBatch, l2Norm, selectTopK } from './vector-kernels.js';
+
+export interface StoredVectorMatch {
+  id: number;
+  similarity: number;
+  metadata?: any;
+}
+
+export interface NormalizedVectorStoreOptions {
+  /** Initial row capacity (default: 1024) */
+  initialCapacity?: number;
+  /** Use the WASM SIMD kernel when available (default: true) */
+  enableSIMD?: boolean;
+  /** Compact automatically when this fraction of rows is tombstoned (default: 0.25) */
+  compactThreshold?: number;
+}
+
+export class NormalizedVectorStore {
+  readonly dimension: number;
+
+  private kernel: SimdDotKernel | null;
+  private slab: Float32Array;
+  private ids: Float64Array;
+  private tombstones: Uint8Array;
+  private metadata: any[] = [];
+  private idToRow: Map<number, number> = new Map();
+  private capacity: number;
+  private rows: number = 0;
+  private deleted: number = 0;
+  private compactThreshold: number;
+
+  constructor(dimension: number, options: NormalizedVectorStoreOptions = {}) {
+    this.dimension = dimension;
+    this.capacity = Math.max(1, options.initialCapacity ?? 1024);
+    this.compactThreshold = options.compactThreshold ?? 0.25;
+    this.kernel = options.enableSIMD === false ? null : SimdDotKernel.create();
+
+    if (this.kernel) {
+      this.kernel.reserve(this.capacity, dimension);
+      this.slab = this.kernel.matrixView();
+    } else {
+      this.slab = new Float32Array(this.capacity * dimension);
+    }
+    this.ids = new Float64Array(this.capacity);
+    this.tombstones = new Uint8Array(this.capacity);
+  }
+
+  /**
+   * Number of live (non-tombstoned) vectors
+   */
+  get size(): number {
+    return this.rows - this.deleted;
+  }
+
+  /**
+   * Whether the SIMD kernel backs this store
+   */
+  get simd(): boolean {
+    return this.kernel !== null;
+  }
+
+  /**
+   * Approximate bytes held by the slab and parallel arrays
+   */
+  get byteLength(): number {
+    return this.capacity * (this.dimension * 4 + 8 + 1);
+  }
+
+  has(id: number): boolean {
+    return this.idToRow.has(id);
+  }
+
+  /**
+   * Insert or overwrite a vector, normalizing it into the slab
+   */
+  upsert(id: number, vector: Float32Array, metadata?: any): void {
+    if (vector.length !== this.dimension) {
+      throw new Error(`Vector dimension ${vector.length} does not match store dimension ${this.dimension}`);
+    }
+
+    let row = this.idToRow.get(id);
+    if (row === undefined) {
+      if (this.rows === this.capacity) {
+        this.grow(this.capacity * 2);
+      }
+      row = this.rows++;
+      this.idToRow.set(id, row);
+      this.ids[row] = id;
+      this.tombstones[row] = 0;
+      this.kernel?.setRowCount(this.rows);
+    }
+
+    this.writeNormalized(row, vector);
+    this.metadata[row] = metadata;
+  }
+
+  /**
+   * Tombstone a vector; space is reclaimed by compact()
+   */
+  remove(id: number): boolean {
+    const row = this.idToRow.get(id);
+    if (row === undefined) return false;
+
+    this.idToRow.delete(id);
+    this.tombstones[row] = 1;
+    this.metadata[row] = undefined;
+    this.deleted++;
+
+    if (this.deleted / this.rows > this.compactThreshold) {
+      this.compact();
+    }
+    return true;
+  }
+
+  /**
+   * Move live rows down over tombstones
+   */
+  compact(): void {
+    if (this.deleted === 0) return;
+
+    let write = 0;
+    for (let read = 0; read < this.rows; read++) {
+      if (this.tombstones[read]) continue;
+      if (write !== read) {
+        const dim = this.dimension;
+        this.slab.copyWithin(write * dim, read * dim, (read + 1) * dim);
+        this.ids[write] = this.ids[read];
+        this.metadata[write] = this.metadata[read];
+        this.idToRow.set(this.ids[write], write);
+      }
+      this.tombstones[write] = 0;
+      write++;
+    }
+
+    this.tombstones.fill(0, write, this.rows);
+    this.metadata.length = write;
+    this.rows = write;
+    this.deleted = 0;
+    this.kernel?.setRowCount(this.rows);
+  }
+
+  /**
+   * Top-k cosine search over live rows
+   *
+   * @param allow - Optional predicate restricting which ids may be returned
+   */
+  search(
+    query: Float32Array,
+    k: number,
+    threshold?: number,
+    allow?: (id: number) => boolean
+  ): StoredVectorMatch[] {
+    if (query.length !== this.dimension) {
+      throw new Error('Vectors must have same length');
+    }
+    if (this.size === 0 || k <= 0) return [];
+
+    const norm = l2Norm(query);
+    if (norm === 0) return [];
+
+    // Scores are dot(query, row) / |query|, since rows are already unit length
+    const scores = this.kernel
+      ? this.kernel.dots(query)
+      : dotBatch(query, this.slab, this.rows, this.dimension);
+
+    const inv = 1 / norm;
+    for (let i = 0; i < this.rows; i++) {
+      if (this.tombstones[i] || (allow && !allow(this.ids[i]))) {
+        scores[i] = -Infinity;
+      } else {
+        scores[i] *= inv;
+      }
+    }
+
+    return selectTopK(scores, k, threshold ?? -Infinity)
+      .filter(({ score }) => score !== -Infinity)
+      .map(({ index, score }) => ({
+        id: this.ids[index],
+        similarity: score,
+        metadata: this.metadata[index],
+      }));
+  }
+
+  /**
+   * Drop all vectors while keeping the allocated slab
+   */
+  clear(): void {
+    this.idToRow.clear();
+    this.metadata = [];
+    this.tombstones.fill(0);
+    this.rows = 0;
+    this.deleted = 0;
+    this.kernel?.setRowCount(0);
+  }
+
+  private writeNormalized(row: number, vector: Float32Array): void {
+    const norm = l2Norm(vector);
+    const scale = norm === 0 ? 0 : 1 / norm;
+    const offset = row * this.dimension;
+    for (let i = 0; i < this.dimension; i++) {
+      this.slab[offset + i] = vector[i] * scale;
+    }
+  }
+
+  private grow(capacity: number): void {
+    if (this.kernel) {
+      // memory.grow preserves contents but detaches the old view
+      this.kernel.reserve(capacity, this.dimension);
+      this.kernel.setRowCount(this.rows);
+      this.slab = this.kernel.matrixView();
+    } else {
+      const slab = new Float32Array(capacity * this.dimension);
+      slab.set(this.slab.subarray(0, this.rows * this.dimension));
+      this.slab = slab;
+    }
+
+    const ids = new Float64Array(capacity);
+    ids.set(this.ids.subarray(0, this.rows));
+    this.ids = ids;
+
+    const tombstones = new Uint8Array(capacity);
+    tombstones.set(this.tombstones.subarray(0, this.rows));
+    this.tombstones = tombstones;
+
+    this.capacity = capacity;
+  }
+}
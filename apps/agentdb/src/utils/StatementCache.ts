@@ -0,0 +1,179 @@
+/**
+ * StatementCache - Connection-level prepared statement cache
+ *
+ * Hot paths (post-ANN hydration, QueryOptimizer) used to re-prepare the same
+ * SQL on every call, and `IN (...)` lookups built a new statement for every
+ * distinct id count. Statements are cached per connection by SQL text (LRU),
+ * and id lookups pad to a small set of fixed arities so at most a handful of
+ * statements per table and projection ever exist.
+ *
+ * Cached statements must not be held across calls; sql.js statements are
+ * freed when evicted or after an error, and sql.js connections get a smaller
+ * cache so it stays under the wrapper's live-statement warning.
+ */
+
+import type { IDatabaseConnection, IPreparedStatement } from '../types/database.types.js';
+import { LRUCache } from './LRUCache.js';
+
+/** `IN (...)` arities; larger id lists are fetched in chunks of the last size */
+export const ID_BUCKETS = [1, 8, 32, 128, 500] as const;
+
+const DEFAULT_MAX_STATEMENTS = 256;
+const IDENTIFIER = /^[A-Za-z_][A-Za-z0-9_]*$/;
+
+const caches = new WeakMap<object, StatementCache>();
+
+export interface FetchByIdsOptions {
+  /** Columns to return (default: all); the key column is always included */
+  columns?: readonly string[];
+  /** Key column (default: 'id') */
+  key?: string;
+}
+
+export interface StatementCacheStats {
+  size: number;
+  hits: number;
+  misses: number;
+  hitRate: number;
+}
+
+export class StatementCache {
+  private statements: LRUCache<IPreparedStatement>;
+
+  private constructor(private db: IDatabaseConnection, maxStatements: number) {
+    this.statements = new LRUCache<IPreparedStatement>({
+      maxEntries: maxStatements,
+      onEvict: (_sql, stmt) => stmt.finalize?.(),
+    });
+  }
+
+  /**
+   * Cache for a connection, created on first use
+   */
+  static for(db: IDatabaseConnection, maxStatements: number = DEFAULT_MAX_STATEMENTS): StatementCache {
+    let cache = caches.get(db);
+    if (!cache) {
+      // Leave half the sql.js allowance for uncached statements
+      const limit = db.maxActiveStatements;
+      if (limit !== undefined) maxStatements = Math.max(1, Math.min(maxStatements, Math.floor(limit / 2)));
+      cache = new StatementCache(db, maxStatements);
+      caches.set(db, cache);
+    }
+    return cache;
+  }
+
+  /**
+   * Prepared statement for this SQL, reused across calls
+   */
+  prepare<T = any>(sql: string): IPreparedStatement<T> {
+    let stmt = this.statements.get(sql);
+    if (!stmt) {
+      stmt = this.db.prepare(sql);
+      this.statements.set(sql, stmt);
+    }
+    return stmt as IPreparedStatement<T>;
+  }
+
+  all<T = any>(sql: string, params: readonly any[] = []): T[] {
+    return this.guard(sql, (stmt) => stmt.all(...params)) as T[];
+  }
+
+  get<T = any>(sql: string, params: readonly any[] = []): T | undefined {
+    return this.guard(sql, (stmt) => stmt.get(...params)) as T | undefined;
+  }
+
+  run(sql: string, params: readonly any[] = []) {
+    return this.guard(sql, (stmt) => stmt.run(...params));
+  }
+
+  /**
+   * Rows whose key is in `ids`, in no particular order. Ids are de-duplicated
+   * and padded to the next bucket size by repeating the last id, which leaves
+   * the IN set unchanged.
+   */
+  fetchByIds<T = any>(table: string, ids: readonly (number | string)[], options: FetchByIdsOptions = {}): T[] {
+    if (ids.length === 0) return [];
+    const key = options.key ?? 'id';
+    const projection = projectColumns(options.columns, key);
+    assertIdentifier(table);
+    assertIdentifier(key);
+
+    const unique = [...new Set(ids)];
+    const maxBucket = ID_BUCKETS[ID_BUCKETS.length - 1];
+    const rows: T[] = [];
+
+    for (let offset = 0; offset < unique.length; offset += maxBucket) {
+      const chunk = unique.slice(offset, offset + maxBucket);
+      const arity = bucketFor(chunk.length);
+      const params = chunk.length === arity ? chunk : padTo(chunk, arity);
+      const placeholders = new Array(arity).fill('?').join(', ');
+      const sql = `SELECT ${projection} FROM ${table} WHERE ${key} IN (${placeholders})`;
+      rows.push(...this.all<T>(sql, params));
+    }
+
+    return rows;
+  }
+
+  getStats(): StatementCacheStats {
+    const { size, hits, misses, hitRate } = this.statements.getStats();
+    return { size, hits, misses, hitRate };
+  }
+
+  /**
+   * Drop every cached statement (e.g. after closing or swapping the schema)
+   */
+  clear(): void {
+    for (const sql of [...this.statements.keys()]) {
+      this.statements.peek(sql)?.finalize?.();
+    }
+    this.statements.clear();
+  }
+
+  /**
+   * Run against the cached statement; a statement that threw is dropped so
+   * the next call re-prepares (sql.js frees statements on error)
+   */
+  private guard<R>(sql: string, fn: (stmt: IPreparedStatement) => R): R {
+    const stmt = this.prepare(sql);
+    try {
+      return fn(stmt);
+    } catch (error) {
+      this.statements.delete(sql);
+      throw error;
+    }
+  }
+}
+
+/**
+ * Smallest bucket that holds n ids
+ */
+export function bucketFor(n: number): number {
+  for (const size of ID_BUCKETS) {
+    if (n <= size) return size;
+  }
+  return ID_BUCKETS[ID_BUCKETS.length - 1];
+}
+
+/**
+ * SELECT list for a column projection; the key column is always included
+ * so callers can map rows back to ids
+ */
+export function projectColumns(columns: readonly string[] | undefined, key: string = 'id'): string {
+  if (!columns || columns.length === 0) return '*';
+  const selected = columns.includes(key) ? [...columns] : [key, ...columns];
+  selected.forEach(assertIdentifier);
+  return selected.join(', ');
+}
+
+function padTo<T>(values: T[], arity: number): T[] {
+  const padded = values.slice();
+  const last = values[values.length - 1];
+  while (padded.length < arity) padded.push(last);
+  return padded;
+}
+
+function assertIdentifier(name: string): void {
+  if (!IDENTIFIER.test(name)) {
+    throw new Error(`Invalid SQL identifier: ${name}`);
+  }
+}
@@ -0,0 +1,185 @@
+/**
+ * WorkerPool - Minimal promise-based worker_threads pool
+ *
+ * Workers are created from inline source (eval workers), so the pool works the
+ * same from compiled dist/, ts source under vitest, or a bundle - there is no
+ * worker script path to resolve. The source must define
+ * `function handle(payload, workerData)` returning a result or a promise; the
+ * pool adds the message protocol around it.
+ *
+ * Tasks go to the least-busy worker. Callers bound their own in-flight work
+ * for back-pressure; `pending` reports queued + running tasks.
+ */
+
+import { Worker } from 'worker_threads';
+import * as os from 'os';
+
+export interface WorkerPoolOptions {
+  /** Number of workers (default: available cores - 1, min 1) */
+  size?: number;
+  /** Passed to every worker as workerData */
+  workerData?: any;
+  /** Don't keep the process alive while workers are idle (long-lived pools) */
+  unref?: boolean;
+}
+
+interface PoolWorker {
+  worker: Worker;
+  busy: number;
+}
+
+interface PendingTask {
+  resolve: (value: any) => void;
+  reject: (error: Error) => void;
+  worker: PoolWorker;
+}
+
+const PROTOCOL = `
+const { parentPort, workerData } = require('worker_threads');
+parentPort.on('message', async ({ id, payload }) => {
+  try {
+    const result = await handle(payload, workerData);
+    const transfer = result && result.__transfer ? result.__transfer : [];
+    if (result && result.__transfer) delete result.__transfer;
+    parentPort.postMessage({ id, result }, transfer);
+  } catch (error) {
+    parentPort.postMessage({ id, error: error && error.message ? error.message : String(error) });
+  }
+});
+`;
+
+/**
+ * Default pool size: leave one core for the main thread
+ */
+export function defaultPoolSize(): number {
+  const cores = typeof (os as any).availableParallelism === 'function'
+    ? (os as any).availableParallelism()
+    : os.cpus().length;
+  return Math.max(1, cores - 1);
+}
+
+export class WorkerPool<TPayload = any, TResult = any> {
+  private workers: PoolWorker[] = [];
+  private tasks: Map<number, PendingTask> = new Map();
+  private nextId = 0;
+  private closed = false;
+  private unref: boolean;
+
+  constructor(source: string, options: WorkerPoolOptions = {}) {
+    const size = Math.max(1, options.size ?? defaultPoolSize());
+    this.unref = options.unref ?? false;
+    const code = `${source}\n${PROTOCOL}`;
+
+    for (let i = 0; i < size; i++) {
+      const worker = new Worker(code, { eval: true, workerData: options.workerData });
+      const entry: PoolWorker = { worker, busy: 0 };
+      if (this.unref) worker.unref();
+
+      worker.on('message', ({ id, result, error }) => {
+        const task = this.tasks.get(id);
+        if (!task) return;
+        this.tasks.delete(id);
+        task.worker.busy--;
+        if (this.unref && task.worker.busy === 0) task.worker.worker.unref();
+        if (error !== undefined) {
+          task.reject(new Error(error));
+        } else {
+          task.resolve(result);
+        }
+      });
+
+      worker.on('error', (error) => this.failWorker(entry, error));
+      worker.on('exit', (code) => {
+        if (!this.closed) {
+          this.failWorker(entry, new Error(`Worker exited with code ${code}`));
+        }
+      });
+
+      this.workers.push(entry);
+    }
+  }
+
+  get size(): number {
+    return this.workers.length;
+  }
+
+  /** Tasks queued or running */
+  get pending(): number {
+    return this.tasks.size;
+  }
+
+  /**
+   * Run a task on the least-busy worker
+   *
+   * @param transfer - ArrayBuffers to move instead of copy
+   */
+  run(payload: TPayload, transfer: ArrayBuffer[] = []): Promise<TResult> {
+    if (this.closed) {
+      return Promise.reject(new Error('WorkerPool is closed'));
+    }
+    if (this.workers.length === 0) {
+      return Promise.reject(new Error('WorkerPool has no live workers'));
+    }
+
+    let target = this.workers[0];
+    for (const entry of this.workers) {
+      if (entry.busy < target.busy) target = entry;
+    }
+
+    const id = this.nextId++;
+    return new Promise<TResult>((resolve, reject) => {
+      this.tasks.set(id, { resolve, reject, worker: target });
+      this.retain(target);
+      target.worker.postMessage({ id, payload }, transfer);
+    });
+  }
+
+  /**
+   * Run a task on every worker (e.g. to load shared state)
+   */
+  broadcast(payload: TPayload): Promise<TResult[]> {
+    return Promise.all(
+      this.workers.map(entry => {
+        const id = this.nextId++;
+        return new Promise<TResult>((resolve, reject) => {
+          this.tasks.set(id, { resolve, reject, worker: entry });
+          this.retain(entry);
+          entry.worker.postMessage({ id, payload });
+        });
+      })
+    );
+  }
+
+  /**
+   * Terminate all workers; pending tasks are rejected
+   */
+  async close(): Promise<void> {
+    if (this.closed) return;
+    this.closed = true;
+
+    for (const [id, task] of this.tasks) {
+      task.reject(new Error('WorkerPool closed'));
+      this.tasks.delete(id);
+    }
+    await Promise.all(this.workers.map(entry => entry.worker.terminate()));
+    this.workers = [];
+  }
+
+  /**
+   * Count a task against a worker; unref'd workers are ref'd while busy
+   */
+  private retain(entry: PoolWorker): void {
+    if (this.unref && entry.busy === 0) entry.worker.ref();
+    entry.busy++;
+  }
+
+  private failWorker(entry: PoolWorker, error: Error): void {
+    this.workers = this.workers.filter(w => w !== entry);
+    for (const [id, task] of this.tasks) {
+      if (task.worker === entry) {
+        this.tasks.delete(id);
+        task.reject(error);
+      }
+    }
+  }
+}
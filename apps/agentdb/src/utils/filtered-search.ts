@@ -0,0 +1,53 @@
+/**
+ * Filtered ANN search helpers for hnswlib-backed indexes
+ *
+ * hnswlib evaluates the filter callback while it walks the graph, so only
+ * allowed labels enter the result set. With a fixed ef, selective filters can
+ * still exhaust the candidate list early; these helpers widen ef until k
+ * matches are found or every allowed label has been reached.
+ */
+
+export interface HnswKnnResult {
+  neighbors: number[];
+  distances: number[];
+}
+
+export interface FilteredKnnOptions {
+  /** ef to start from and restore afterwards */
+  baseEf: number;
+  /** Upper bound on matches (e.g. bitset count); stops widening once reached */
+  maxMatches?: number;
+}
+
+/**
+ * Run searchKnn with a label filter, doubling ef until k matches are found
+ */
+export function searchKnnFiltered(
+  index: any,
+  query: Float32Array,
+  k: number,
+  filter: (label: number) => boolean,
+  options: FilteredKnnOptions
+): HnswKnnResult {
+  const count: number = index.getCurrentCount();
+  const want = Math.min(k, count, options.maxMatches ?? Infinity);
+  if (want <= 0) {
+    return { neighbors: [], distances: [] };
+  }
+
+  let ef = Math.max(options.baseEf, k);
+  let result: HnswKnnResult;
+
+  try {
+    while (true) {
+      index.setEf(ef);
+      result = index.searchKnn(query, Math.min(k, count), filter);
+      if (result.neighbors.length >= want || ef >= count) break;
+      ef = Math.min(ef * 2, count);
+    }
+  } finally {
+    index.setEf(options.baseEf);
+  }
+
+  return result!;
+}
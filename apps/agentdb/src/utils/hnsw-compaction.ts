@@ -0,0 +1,89 @@
+/**
+ * Background compaction for hnswlib indexes
+ *
+ * Deleted points stay in an hnswlib graph as tombstones (markDelete) so
+ * traversal still routes through them. Their labels are reused by later
+ * inserts, but a burst of deletes with no matching inserts leaves dead nodes
+ * that cost memory and search effort. Compaction copies the live points,
+ * under their existing labels, into a fresh graph in short time slices and
+ * sleeps between slices so the copy uses at most `cpuShare` of one core.
+ * Owners keep serving searches from the old graph, log writes made while the
+ * copy runs, replay them with replayCompactionLog() and swap.
+ */
+
+export type CompactionLogEntry =
+  | { op: 'add'; label: number; vector: Float32Array }
+  | { op: 'remove'; label: number };
+
+export interface CompactionOptions {
+  /** Create an empty, initialized index with room for `capacity` points */
+  createIndex: (capacity: number) => any;
+  /** Share of one core the copy may use (default: 0.25) */
+  cpuShare?: number;
+  /** Work per slice in ms (default: 8) */
+  sliceMs?: number;
+  /** Stop early (e.g. the owner was closed); compaction then returns null */
+  shouldAbort?: () => boolean;
+}
+
+/**
+ * Copy `labels` from `source` into a new index without blocking the event loop
+ */
+export async function compactHnswIndex(
+  source: any,
+  labels: number[],
+  options: CompactionOptions
+): Promise<any | null> {
+  const cpuShare = Math.min(1, Math.max(0.01, options.cpuShare ?? 0.25));
+  const sliceMs = options.sliceMs ?? 8;
+  const target = options.createIndex(Math.max(1, labels.length));
+
+  let i = 0;
+  while (i < labels.length) {
+    const start = performance.now();
+    while (i < labels.length && performance.now() - start < sliceMs) {
+      const label = labels[i++];
+      let point: number[];
+      try {
+        point = source.getPoint(label);
+      } catch {
+        continue; // Deleted since the copy started; the log replay covers it
+      }
+      target.addPoint(point, label);
+    }
+
+    const worked = performance.now() - start;
+    const pause = (worked * (1 - cpuShare)) / cpuShare;
+    await new Promise<void>((resolve) => setTimeout(resolve, pause));
+    if (options.shouldAbort?.()) return null;
+  }
+
+  return target;
+}
+
+/**
+ * Apply writes logged during compaction to the new index
+ *
+ * @returns Labels left tombstoned in the new index
+ */
+export function replayCompactionLog(target: any, log: CompactionLogEntry[]): Set<number> {
+  const tombstoned = new Set<number>();
+  for (const entry of log) {
+    if (entry.op === 'add') {
+      if (target.getCurrentCount() + 1 > target.getMaxElements()) {
+        target.resizeIndex(Math.max(target.getCurrentCount() + 1, target.getMaxElements() * 2));
+      }
+      // Re-adding a tombstoned label un-deletes it and updates it in place
+      target.addPoint(entry.vector, entry.label);
+      tombstoned.delete(entry.label);
+    } else {
+      try {
+        target.markDelete(entry.label);
+        tombstoned.add(entry.label);
+      } catch {
+        // Never copied (added and removed during the copy)
+      }
+    }
+  }
+  return tombstoned;
+}
@@ -0,0 +1,73 @@
+/**
+ * Neighbor scan - brute-force k-nearest neighbors over a normalized matrix
+ *
+ * Skill consolidation links each episode to its most similar candidates.
+ * Without an episode vector index that is an O(n²·d) scan, so
+ * createNeighborScanPool() runs it on worker threads: the matrix is loaded
+ * once into a SharedArrayBuffer that every worker reads in place, and each
+ * task scans a row range, returning its neighbor lists packed and
+ * transferred.
+ */
+
+import { WorkerPool } from './WorkerPool.js';
+import { dotBatch, dotProduct, selectTopK } from './vector-kernels.js';
+
+/** Load the shared matrix, or scan rows start..end-1 of it */
+export type NeighborScanJob =
+  | { load: { buffer: SharedArrayBuffer; count: number; dim: number } }
+  | { start: number; end: number; k: number; threshold: number };
+
+/** Row r's neighbors are neighbors[offsets[r]..offsets[r + 1]) */
+export interface NeighborScanResult {
+  offsets: Uint32Array;
+  neighbors: Uint32Array;
+}
+
+/**
+ * Top-k rows by dot product at or above `threshold` for each row of
+ * start..end-1, excluding the row itself
+ */
+export function scanNeighbors(
+  data: Float32Array,
+  count: number,
+  dim: number,
+  start: number,
+  end: number,
+  k: number,
+  threshold: number
+): NeighborScanResult {
+  const scores = new Float32Array(count);
+  const offsets = new Uint32Array(end - start + 1);
+  const found: number[] = [];
+  for (let i = start; i < end; i++) {
+    dotBatch(data.subarray(i * dim, (i + 1) * dim), data, count, dim, scores);
+    for (const entry of selectTopK(scores, k + 1, threshold)) {
+      if (entry.index !== i) found.push(entry.index);
+    }
+    offsets[i - start + 1] = found.length;
+  }
+  return { offsets, neighbors: Uint32Array.from(found) };
+}
+
+/**
+ * Worker pool running scanNeighbors(); broadcast a `load` job first
+ */
+export function createNeighborScanPool(size?: number): WorkerPool<NeighborScanJob, NeighborScanResult | null> {
+  const source = [
+    dotProduct.toString(),
+    dotBatch.toString(),
+    selectTopK.toString(),
+    scanNeighbors.toString(),
+    `let matrix = null;
+function handle(job) {
+  if (job.load) {
+    matrix = { data: new Float32Array(job.load.buffer), count: job.load.count, dim: job.load.dim };
+    return null;
+  }
+  const result = scanNeighbors(matrix.data, matrix.count, matrix.dim, job.start, job.end, job.k, job.threshold);
+  result.__transfer = [result.offsets.buffer, result.neighbors.buffer];
+  return result;
+}`,
+  ].join('\n');
+  return new WorkerPool<NeighborScanJob, NeighborScanResult | null>(source, { size });
+}
@@ -0,0 +1,360 @@
+/**
+ * Policy training - dense tabular policies and a mini-batch TD kernel
+ *
+ * PolicyTable interns states and actions to row/column indices and keeps
+ * Q-values, visit counts and average rewards in contiguous Float32Arrays
+ * (row-major, one row per state), while still loading and saving the
+ * `state|action` JSON stored in learning_policies.
+ *
+ * trainPolicyEpochs() runs shuffled mini-batches over a columnar experience
+ * buffer. Targets in a batch are computed against the Q-values at the start
+ * of the batch, then applied together. It only touches typed arrays, so
+ * createPolicyTrainingPool() can embed it into an eval worker and training
+ * runs off the main thread (same approach as skill-patterns.ts).
+ */
+
+import { WorkerPool } from './WorkerPool.js';
+
+export interface PolicyJSON {
+  stateActionPairs: Record<string, any>;
+  qValues: Record<string, number>;
+  visitCounts: Record<string, number>;
+  avgRewards: Record<string, number>;
+}
+
+/**
+ * Experiences as parallel columns; nextStateIdx is -1 for terminal steps
+ */
+export interface ExperienceBuffer {
+  size: number;
+  stateIdx: Int32Array;
+  actionIdx: Int32Array;
+  nextStateIdx: Int32Array;
+  reward: Float32Array;
+}
+
+export interface PolicyTrainingJob {
+  q: Float32Array;
+  visits: Float32Array;
+  stride: number;
+  actionCount: number;
+  stateIdx: Int32Array;
+  actionIdx: Int32Array;
+  nextStateIdx: Int32Array;
+  reward: Float32Array;
+  epochs: number;
+  batchSize: number;
+  learningRate: number;
+  gamma: number;
+  /** Add γ·max Q(s') to targets (off for policy gradient) */
+  bootstrap: boolean;
+  seed: number;
+}
+
+export interface PolicyTrainingResult {
+  q: Float32Array;
+  visits: Float32Array;
+  /** Sum of per-batch mean squared TD errors */
+  lossSum: number;
+  batches: number;
+  rewardSum: number;
+}
+
+const MIN_STRIDE = 4;
+const MIN_ROWS = 16;
+
+export class PolicyTable {
+  readonly states: string[] = [];
+  readonly actions: string[] = [];
+  stateActionPairs: Record<string, any> = {};
+
+  /** Row stride (action capacity) */
+  stride = MIN_STRIDE;
+  q = new Float32Array(MIN_ROWS * MIN_STRIDE);
+  visits = new Float32Array(MIN_ROWS * MIN_STRIDE);
+  avgRewards = new Float32Array(MIN_ROWS * MIN_STRIDE);
+  /** 1 where the state|action pair exists in the policy */
+  present = new Uint8Array(MIN_ROWS * MIN_STRIDE);
+
+  private stateIds = new Map<string, number>();
+  private actionIds = new Map<string, number>();
+  private visitTotal = 0;
+
+  static fromJSON(policy: Partial<PolicyJSON>): PolicyTable {
+    const table = new PolicyTable();
+    table.stateActionPairs = policy.stateActionPairs ?? {};
+    const keys = new Set([
+      ...Object.keys(policy.qValues ?? {}),
+      ...Object.keys(policy.visitCounts ?? {}),
+      ...Object.keys(policy.avgRewards ?? {}),
+    ]);
+
+    for (const key of keys) {
+      const split = key.lastIndexOf('|');
+      if (split < 0) continue;
+      const cell = table.cell(key.slice(0, split), key.slice(split + 1));
+      table.q[cell] = policy.qValues?.[key] ?? 0;
+      table.visits[cell] = policy.visitCounts?.[key] ?? 0;
+      table.avgRewards[cell] = policy.avgRewards?.[key] ?? 0;
+      table.visitTotal += table.visits[cell];
+    }
+    return table;
+  }
+
+  toJSON(): PolicyJSON {
+    const qValues: Record<string, number> = {};
+    const visitCounts: Record<string, number> = {};
+    const avgRewards: Record<string, number> = {};
+
+    for (let s = 0; s < this.states.length; s++) {
+      const row = s * this.stride;
+      for (let a = 0; a < this.actions.length; a++) {
+        if (!this.present[row + a]) continue;
+        const key = `${this.states[s]}|${this.actions[a]}`;
+        qValues[key] = this.q[row + a];
+        visitCounts[key] = this.visits[row + a];
+        avgRewards[key] = this.avgRewards[row + a];
+      }
+    }
+    return { stateActionPairs: this.stateActionPairs, qValues, visitCounts, avgRewards };
+  }
+
+  /**
+   * Row index of a state; -1 when absent and not created
+   */
+  stateIndex(state: string, create: boolean = false): number {
+    let index = this.stateIds.get(state);
+    if (index === undefined) {
+      if (!create) return -1;
+      index = this.states.length;
+      this.states.push(state);
+      this.stateIds.set(state, index);
+      this.reserve(this.states.length, this.actions.length);
+    }
+    return index;
+  }
+
+  actionIndex(action: string, create: boolean = false): number {
+    let index = this.actionIds.get(action);
+    if (index === undefined) {
+      if (!create) return -1;
+      index = this.actions.length;
+      this.actions.push(action);
+      this.actionIds.set(action, index);
+      this.reserve(this.states.length, this.actions.length);
+    }
+    return index;
+  }
+
+  /**
+   * Array offset of a state|action pair, created if needed
+   */
+  cell(state: string, action: string): number {
+    const s = this.stateIndex(state, true);
+    const a = this.actionIndex(action, true);
+    const offset = s * this.stride + a;
+    this.present[offset] = 1;
+    return offset;
+  }
+
+  /**
+   * Array offset of an existing pair, or -1
+   */
+  find(state: string, action: string): number {
+    const s = this.stateIds.get(state);
+    const a = this.actionIds.get(action);
+    if (s === undefined || a === undefined) return -1;
+    const offset = s * this.stride + a;
+    return this.present[offset] ? offset : -1;
+  }
+
+  qValue(state: string, action: string): number {
+    const offset = this.find(state, action);
+    return offset < 0 ? 0 : this.q[offset];
+  }
+
+  visitCount(state: string, action: string): number {
+    const offset = this.find(state, action);
+    return offset < 0 ? 0 : this.visits[offset];
+  }
+
+  avgReward(state: string, action: string): number {
+    const offset = this.find(state, action);
+    return offset < 0 ? 0 : this.avgRewards[offset];
+  }
+
+  /** Visits across all pairs */
+  get totalVisits(): number {
+    return this.visitTotal;
+  }
+
+  /**
+   * max_a Q(state, a), floored at 0 (unknown states bootstrap from 0)
+   */
+  maxQ(state: string): number {
+    const s = this.stateIds.get(state);
+    if (s === undefined) return 0;
+    const row = s * this.stride;
+    let max = 0;
+    for (let a = 0; a < this.actions.length; a++) {
+      if (this.q[row + a] > max) max = this.q[row + a];
+    }
+    return max;
+  }
+
+  recordVisit(offset: number): number {
+    this.visitTotal++;
+    return ++this.visits[offset];
+  }
+
+  /**
+   * Copy of the Q and visit arrays for a training job
+   */
+  trainingArrays(): { q: Float32Array; visits: Float32Array } {
+    const length = this.states.length * this.stride;
+    return { q: this.q.slice(0, length), visits: this.visits.slice(0, length) };
+  }
+
+  /**
+   * Merge arrays trained from trainingArrays() as deltas against `base`, the
+   * copy the job started from, so feedback recorded while it ran is kept.
+   * `stride` is the stride they were taken at, since pairs may have been
+   * added meanwhile
+   */
+  applyTraining(
+    trained: { q: Float32Array; visits: Float32Array },
+    base: { q: Float32Array; visits: Float32Array },
+    stride: number = this.stride
+  ): void {
+    for (let s = 0; s * stride < base.q.length; s++) {
+      const from = s * stride;
+      const to = s * this.stride;
+      for (let a = 0; a < stride; a++) {
+        this.q[to + a] += trained.q[from + a] - base.q[from + a];
+        this.visits[to + a] += trained.visits[from + a] - base.visits[from + a];
+      }
+    }
+    let total = 0;
+    for (let i = 0; i < this.visits.length; i++) total += this.visits[i];
+    this.visitTotal = total;
+  }
+
+  /**
+   * Grow to hold `rows` states and `columns` actions, re-laying out rows
+   * when the stride changes
+   */
+  private reserve(rows: number, columns: number): void {
+    const stride = columns > this.stride ? Math.max(columns, this.stride * 2) : this.stride;
+    const capacity = this.q.length / this.stride;
+    if (stride === this.stride && rows <= capacity) return;
+
+    const newRows = rows > capacity ? Math.max(rows, capacity * 2) : capacity;
+    const relayout = <T extends Float32Array | Uint8Array>(source: T, target: T): T => {
+      if (stride === this.stride) {
+        target.set(source);
+      } else {
+        for (let s = 0; s < capacity; s++) {
+          target.set(source.subarray(s * this.stride, (s + 1) * this.stride), s * stride);
+        }
+      }
+      return target;
+    };
+
+    this.q = relayout(this.q, new Float32Array(newRows * stride));
+    this.visits = relayout(this.visits, new Float32Array(newRows * stride));
+    this.avgRewards = relayout(this.avgRewards, new Float32Array(newRows * stride));
+    this.present = relayout(this.present, new Uint8Array(newRows * stride));
+    this.stride = stride;
+  }
+}
+
+/**
+ * Shuffled mini-batch TD updates over an experience buffer, in place on
+ * job.q / job.visits
+ */
+export function trainPolicyEpochs(job: PolicyTrainingJob): PolicyTrainingResult {
+  const { q, visits, stride, actionCount, stateIdx, actionIdx, nextStateIdx, reward } = job;
+  const n = reward.length;
+  const batchSize = Math.max(1, Math.min(job.batchSize, n));
+  const order = new Uint32Array(n);
+  const delta = new Float32Array(batchSize);
+  for (let i = 0; i < n; i++) order[i] = i;
+
+  // mulberry32
+  let seed = job.seed >>> 0;
+  const random = () => {
+    seed = (seed + 0x6d2b79f5) >>> 0;
+    let t = seed;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+
+  let lossSum = 0;
+  let batches = 0;
+  let rewardSum = 0;
+
+  for (let epoch = 0; epoch < job.epochs; epoch++) {
+    for (let i = n - 1; i > 0; i--) {
+      const j = Math.floor(random() * (i + 1));
+      const tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+    for (let start = 0; start < n; start += batchSize) {
+      const m = Math.min(batchSize, n - start);
+      let batchLoss = 0;
+
+      // TD errors against Q at the start of the batch
+      for (let j = 0; j < m; j++) {
+        const e = order[start + j];
+        let target = reward[e];
+        if (job.bootstrap && nextStateIdx[e] >= 0) {
+          const row = nextStateIdx[e] * stride;
+          let maxNext = 0;
+          for (let a = 0; a < actionCount; a++) {
+            if (q[row + a] > maxNext) maxNext = q[row + a];
+          }
+          target += job.gamma * maxNext;
+        }
+        const d = target - q[stateIdx[e] * stride + actionIdx[e]];
+        delta[j] = d;
+        batchLoss += d * d;
+        rewardSum += reward[e];
+      }
+
+      for (let j = 0; j < m; j++) {
+        const e = order[start + j];
+        const cell = stateIdx[e] * stride + actionIdx[e];
+        q[cell] += job.learningRate * delta[j];
+        visits[cell] += 1;
+      }
+
+      lossSum += batchLoss / m;
+      batches++;
+    }
+  }
+
+  return { q, visits, lossSum, batches, rewardSum };
+}
+
+/**
+ * Single-worker pool running trainPolicyEpochs(); job arrays are transferred
+ * both ways
+ */
+export function createPolicyTrainingPool(): WorkerPool<PolicyTrainingJob, PolicyTrainingResult> {
+  const source = [
+    trainPolicyEpochs.toString(),
+    'function handle(job) { const result = trainPolicyEpochs(job); result.__transfer = [result.q.buffer, result.visits.buffer]; return result; }',
+  ].join('\n');
+  return new WorkerPool<PolicyTrainingJob, PolicyTrainingResult>(source, { size: 1 });
+}
+
+/**
+ * Buffers to transfer with a training job
+ */
+export function trainingTransferList(job: PolicyTrainingJob): ArrayBuffer[] {
+  return [job.q, job.visits, job.stateIdx, job.actionIdx, job.nextStateIdx, job.reward]
+    .map((array) => array.buffer as ArrayBuffer);
+}
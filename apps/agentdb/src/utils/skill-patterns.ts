@@ -0,0 +1,199 @@
+/**
+ * Skill pattern extraction - text and reward analysis of successful episodes
+ *
+ * Pure functions over plain episode rows, so consolidation can run them on
+ * worker threads: createSkillPatternPool() embeds this module's functions
+ * into an eval worker (no script path to resolve, same as HnswSearchPool).
+ */
+
+import { WorkerPool } from './WorkerPool.js';
+
+export interface PatternEpisode {
+  id: number;
+  output?: string | null;
+  critique?: string | null;
+  reward: number;
+  metadata?: string | Record<string, any> | null;
+}
+
+export interface EpisodePatterns {
+  commonPatterns: string[];
+  successIndicators: string[];
+}
+
+// Common stop words to filter out
+const STOP_WORDS = [
+  'the', 'a', 'an', 'and', 'or', 'but', 'in', 'on', 'at', 'to', 'for', 'of', 'with', 'by',
+  'from', 'as', 'is', 'was', 'are', 'were', 'been', 'be', 'have', 'has', 'had', 'do', 'does',
+  'did', 'will', 'would', 'should', 'could', 'may', 'might', 'must', 'can', 'this', 'that',
+  'these', 'those',
+];
+
+/**
+ * Extract common patterns from successful episodes using ML-inspired analysis
+ */
+export function analyzeEpisodePatterns(episodes: PatternEpisode[]): EpisodePatterns {
+  if (episodes.length === 0) {
+    return { commonPatterns: [], successIndicators: [] };
+  }
+
+  const commonPatterns: string[] = [];
+  const successIndicators: string[] = [];
+
+  // Pattern 1: Analyze output text for common keywords and phrases
+  const outputTexts = episodes.map((ep) => ep.output).filter(Boolean) as string[];
+
+  if (outputTexts.length > 0) {
+    const topKeywords = getTopKeywords(extractKeywordFrequency(outputTexts), 5);
+
+    if (topKeywords.length > 0) {
+      commonPatterns.push(`Common techniques: ${topKeywords.join(', ')}`);
+    }
+  }
+
+  // Pattern 2: Analyze critique patterns for successful strategies
+  const critiques = episodes.map((ep) => ep.critique).filter(Boolean) as string[];
+
+  if (critiques.length > 0) {
+    const topCritiquePatterns = getTopKeywords(extractKeywordFrequency(critiques), 3);
+
+    if (topCritiquePatterns.length > 0) {
+      successIndicators.push(...topCritiquePatterns);
+    }
+  }
+
+  // Pattern 3: Analyze reward distribution
+  const avgReward = episodes.reduce((sum, ep) => sum + ep.reward, 0) / episodes.length;
+  const highRewardCount = episodes.filter((ep) => ep.reward > avgReward).length;
+  const highRewardRatio = highRewardCount / episodes.length;
+
+  if (highRewardRatio > 0.6) {
+    successIndicators.push(`High consistency (${(highRewardRatio * 100).toFixed(0)}% above average)`);
+  }
+
+  // Pattern 4: Analyze metadata for common parameters
+  const metadataPatterns = extractMetadataPatterns(episodes);
+  if (metadataPatterns.length > 0) {
+    commonPatterns.push(...metadataPatterns);
+  }
+
+  // Pattern 5: Temporal analysis - learning curve
+  const learningTrend = analyzeLearningTrend(episodes);
+  if (learningTrend) {
+    successIndicators.push(learningTrend);
+  }
+
+  return { commonPatterns, successIndicators };
+}
+
+/**
+ * Extract keyword frequency from text array using NLP-inspired techniques
+ */
+export function extractKeywordFrequency(texts: string[]): Map<string, number> {
+  const frequency = new Map<string, number>();
+  const stopWords = new Set(STOP_WORDS);
+
+  for (const text of texts) {
+    // Extract words (alphanumeric sequences)
+    const words = text.toLowerCase().match(/\b[a-z0-9_-]+\b/g) || [];
+
+    for (const word of words) {
+      if (word.length > 3 && !stopWords.has(word)) {
+        frequency.set(word, (frequency.get(word) || 0) + 1);
+      }
+    }
+  }
+
+  return frequency;
+}
+
+/**
+ * Get top N keywords by frequency
+ */
+export function getTopKeywords(frequency: Map<string, number>, n: number): string[] {
+  return Array.from(frequency.entries())
+    .sort((a, b) => b[1] - a[1])
+    .slice(0, n)
+    .filter(([_, count]) => count >= 2) // Only keywords appearing at least twice
+    .map(([word, _]) => word);
+}
+
+/**
+ * Extract common patterns from episode metadata
+ */
+export function extractMetadataPatterns(episodes: PatternEpisode[]): string[] {
+  const patterns: string[] = [];
+  const metadataFields = new Map<string, Set<any>>();
+
+  for (const episode of episodes) {
+    if (episode.metadata) {
+      try {
+        const metadata =
+          typeof episode.metadata === 'string' ? JSON.parse(episode.metadata) : episode.metadata;
+
+        for (const [key, value] of Object.entries(metadata)) {
+          if (!metadataFields.has(key)) {
+            metadataFields.set(key, new Set());
+          }
+          metadataFields.get(key)!.add(value);
+        }
+      } catch (e) {
+        // Skip invalid metadata
+      }
+    }
+  }
+
+  // Find fields with consistent values
+  metadataFields.forEach((values, field) => {
+    if (values.size === 1) {
+      // All episodes have the same value for this field
+      const value = Array.from(values)[0];
+      patterns.push(`Consistent ${field}: ${value}`);
+    }
+  });
+
+  return patterns;
+}
+
+/**
+ * Analyze learning trend across episodes
+ */
+export function analyzeLearningTrend(episodes: PatternEpisode[]): string | null {
+  if (episodes.length < 3) return null;
+
+  // Sort by episode ID (temporal order)
+  const sorted = [...episodes].sort((a, b) => a.id - b.id);
+  const half = Math.floor(sorted.length / 2);
+
+  const firstHalfReward = sorted.slice(0, half).reduce((sum, ep) => sum + ep.reward, 0) / half;
+  const secondHalfReward =
+    sorted.slice(half).reduce((sum, ep) => sum + ep.reward, 0) / (sorted.length - half);
+
+  const improvement = ((secondHalfReward - firstHalfReward) / firstHalfReward) * 100;
+
+  if (improvement > 10) {
+    return `Strong learning curve (+${improvement.toFixed(0)}% improvement)`;
+  } else if (improvement > 5) {
+    return `Moderate learning curve (+${improvement.toFixed(0)}% improvement)`;
+  } else if (Math.abs(improvement) < 5) {
+    return `Stable performance (±${Math.abs(improvement).toFixed(0)}%)`;
+  }
+
+  return null;
+}
+
+/**
+ * Worker pool running analyzeEpisodePatterns() off the main thread
+ */
+export function createSkillPatternPool(size?: number): WorkerPool<PatternEpisode[], EpisodePatterns> {
+  const source = [
+    `const STOP_WORDS = ${JSON.stringify(STOP_WORDS)};`,
+    analyzeEpisodePatterns.toString(),
+    extractKeywordFrequency.toString(),
+    getTopKeywords.toString(),
+    extractMetadataPatterns.toString(),
+    analyzeLearningTrend.toString(),
+    'function handle(episodes) { return analyzeEpisodePatterns(episodes); }',
+  ].join('\n');
+  return new WorkerPool<PatternEpisode[], EpisodePatterns>(source, { size });
+}
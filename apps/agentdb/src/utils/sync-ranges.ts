@@ -0,0 +1,324 @@
+/**
+ * Sync range hashes - find the key ranges two databases disagree on
+ *
+ * Each synced table is cut into fixed-size ranges of its integer key
+ * (ids 0-1023, 1024-2047, ...) and every range is hashed over its rows. The
+ * puller sends its hashes with the request; the server streams only ranges
+ * whose hash differs, so an unchanged million-row table costs one hash list
+ * instead of a full copy. Hashes are cached per range: triggers log each
+ * written key in sync_range_changes, and only ranges holding a logged key
+ * are rehashed (PRAGMA data_version and total_changes() skip the log lookup
+ * when nothing was written at all).
+ *
+ * Ranges only the client has count as changed too, so the server can tell
+ * it which of its rows were deleted. A client that settles a range without
+ * matching the server (kept local rows, lossy int8 vectors) records the
+ * server's hash against its own in sync_range_acks and sends that instead
+ * until either side changes the range.
+ */
+
+import * as crypto from 'crypto';
+
+export interface SyncTableSpec {
+  table: string;
+  /** Integer primary key the ranges are cut on */
+  key: string;
+}
+
+export type SyncType = 'episodes' | 'skills' | 'edges' | 'full';
+
+/** Range index -> hash, as sent on the wire */
+export type RangeHashes = Record<string, string>;
+
+export const DEFAULT_SYNC_RANGE_SIZE = 1024;
+
+/** Tables each sync type covers; embeddings travel with their rows */
+export const SYNC_TABLES: Record<Exclude<SyncType, 'full'>, SyncTableSpec[]> = {
+  episodes: [
+    { table: 'episodes', key: 'id' },
+    { table: 'episode_embeddings', key: 'episode_id' },
+  ],
+  skills: [
+    { table: 'skills', key: 'id' },
+    { table: 'skill_embeddings', key: 'skill_id' },
+  ],
+  edges: [
+    { table: 'skill_links', key: 'id' },
+    { table: 'causal_edges', key: 'id' },
+  ],
+};
+
+export function syncTablesFor(type: SyncType): SyncTableSpec[] {
+  return type === 'full'
+    ? [...SYNC_TABLES.episodes, ...SYNC_TABLES.skills, ...SYNC_TABLES.edges]
+    : SYNC_TABLES[type] ?? [];
+}
+
+/**
+ * Look up a table by name among the syncable ones (never trust a table name
+ * from the wire)
+ */
+export function findSyncTable(table: string): SyncTableSpec | undefined {
+  return syncTablesFor('full').find((spec) => spec.table === table);
+}
+
+/**
+ * Column names of a table, empty when it doesn't exist
+ */
+export function tableColumns(db: any, table: string): string[] {
+  try {
+    return (db.prepare(`PRAGMA table_info(${table})`).all() as any[]).map((column) => column.name);
+  } catch {
+    return [];
+  }
+}
+
+interface CachedRangeHashes {
+  version: string | null;
+  /** Last sync_range_changes seq folded in; -1 when the table is untracked */
+  seq: number;
+  hashes: Map<number, string>;
+}
+
+const rangeHashCache = new WeakMap<object, Map<string, CachedRangeHashes>>();
+
+/**
+ * Hash of every non-empty key range of a table
+ */
+export function computeRangeHashes(db: any, spec: SyncTableSpec, rangeSize: number = DEFAULT_SYNC_RANGE_SIZE): Map<number, string> {
+  if (tableColumns(db, spec.table).length === 0) return new Map();
+
+  let cache = rangeHashCache.get(db);
+  if (!cache) rangeHashCache.set(db, (cache = new Map()));
+  const cacheKey = `${spec.table}:${rangeSize}`;
+  const cached = cache.get(cacheKey);
+  const version = dataVersion(db);
+  if (cached && version !== null && cached.version === version) return cached.hashes;
+
+  if (cached && cached.seq >= 0) {
+    const changes = db.prepare(
+      'SELECT row_key, seq FROM sync_range_changes WHERE seq > ? AND table_name = ? ORDER BY seq'
+    ).all(cached.seq, spec.table) as any[];
+    const dirty = new Set<number>();
+    for (const change of changes) {
+      dirty.add(Math.floor(change.row_key / rangeSize));
+      cached.seq = change.seq;
+    }
+    for (const range of dirty) {
+      const hash = hashRange(db, spec, range * rangeSize, (range + 1) * rangeSize);
+      if (hash) cached.hashes.set(range, hash);
+      else cached.hashes.delete(range);
+    }
+    cached.version = version;
+    return cached.hashes;
+  }
+
+  // Track writes before the full pass so none fall between it and the log
+  const tracked = trackRangeChanges(db, spec);
+  const seq = tracked ? Number((db.prepare('SELECT MAX(seq) AS seq FROM sync_range_changes').get() as any)?.seq ?? 0) : -1;
+
+  const hashes = new Map<number, string>();
+  const stmt = db.prepare(`SELECT * FROM ${spec.table} ORDER BY ${spec.key}`);
+  const rows = typeof stmt.iterate === 'function' ? stmt.iterate() : stmt.all();
+  let range = -1;
+  let hash: crypto.Hash | null = null;
+
+  for (const row of rows) {
+    const rowRange = Math.floor(row[spec.key] / rangeSize);
+    if (rowRange !== range) {
+      if (hash) hashes.set(range, hash.digest('base64').slice(0, 16));
+      range = rowRange;
+      hash = crypto.createHash('sha1');
+    }
+    hashRow(hash!, row);
+  }
+  if (hash) hashes.set(range, hash.digest('base64').slice(0, 16));
+
+  if (tracked || version !== null) cache.set(cacheKey, { version: dataVersion(db), seq, hashes });
+  return hashes;
+}
+
+/**
+ * Range indices where the server and client hashes differ, including
+ * ranges only one side has
+ */
+export function diffRanges(server: Map<number, string>, client?: RangeHashes): number[] {
+  const changed: number[] = [];
+  for (const [range, hash] of server) {
+    if (client?.[range] !== hash) changed.push(range);
+  }
+  for (const range of Object.keys(client ?? {})) {
+    if (!server.has(Number(range))) changed.push(Number(range));
+  }
+  return changed.sort((a, b) => a - b);
+}
+
+/**
+ * Range hashes to send for a table: each local hash, or the server hash it
+ * was reconciled with when the range is unchanged since (and nothing when
+ * the server had no rows there)
+ */
+export function rangeHashesForRequest(
+  db: any,
+  spec: SyncTableSpec,
+  rangeSize: number = DEFAULT_SYNC_RANGE_SIZE
+): RangeHashes {
+  const acks = new Map<number, { local: string; remote: string | null }>();
+  try {
+    const rows = db.prepare(
+      'SELECT range_index, local_hash, remote_hash FROM sync_range_acks WHERE table_name = ? AND range_size = ?'
+    ).all(spec.table, rangeSize) as any[];
+    for (const row of rows) acks.set(row.range_index, { local: row.local_hash, remote: row.remote_hash });
+  } catch {
+    // no acks recorded yet
+  }
+
+  const hashes: RangeHashes = {};
+  for (const [range, hash] of computeRangeHashes(db, spec, rangeSize)) {
+    const ack = acks.get(range);
+    if (!ack || ack.local !== hash) hashes[range] = hash;
+    else if (ack.remote !== null) hashes[range] = ack.remote;
+  }
+  return hashes;
+}
+
+/**
+ * Record that each range in low..high was settled against the server's
+ * `remote` hashes; ranges whose local hash already matches need no ack
+ */
+export function ackRanges(
+  db: any,
+  spec: SyncTableSpec,
+  low: number,
+  high: number,
+  remote: RangeHashes,
+  rangeSize: number = DEFAULT_SYNC_RANGE_SIZE
+): void {
+  const upsert = db.prepare(`
+    INSERT INTO sync_range_acks (table_name, range_size, range_index, local_hash, remote_hash)
+    VALUES (?, ?, ?, ?, ?)
+    ON CONFLICT (table_name, range_size, range_index)
+    DO UPDATE SET local_hash = excluded.local_hash, remote_hash = excluded.remote_hash`);
+  const clear = db.prepare(
+    'DELETE FROM sync_range_acks WHERE table_name = ? AND range_size = ? AND range_index = ?'
+  );
+
+  for (let range = Math.floor(low / rangeSize); range * rangeSize <= high; range++) {
+    const local = hashRange(db, spec, range * rangeSize, (range + 1) * rangeSize);
+    const server = remote[range] ?? null;
+    if (local === null || local === server) clear.run(spec.table, rangeSize, range);
+    else upsert.run(spec.table, rangeSize, range, local, server);
+  }
+}
+
+/**
+ * Create sync_range_acks; false when the database is read-only
+ */
+export function ensureRangeAckTable(db: any): boolean {
+  try {
+    db.exec(`
+      CREATE TABLE IF NOT EXISTS sync_range_acks (
+        table_name TEXT NOT NULL,
+        range_size INTEGER NOT NULL,
+        range_index INTEGER NOT NULL,
+        local_hash TEXT NOT NULL,
+        remote_hash TEXT,
+        PRIMARY KEY (table_name, range_size, range_index)
+      )
+    `);
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+/**
+ * Merge adjacent range indices into inclusive key spans
+ */
+export function rangeSpans(ranges: number[], rangeSize: number): Array<[number, number]> {
+  const spans: Array<[number, number]> = [];
+  for (const range of ranges) {
+    const last = spans[spans.length - 1];
+    if (last && last[1] === range * rangeSize - 1) last[1] = (range + 1) * rangeSize - 1;
+    else spans.push([range * rangeSize, (range + 1) * rangeSize - 1]);
+  }
+  return spans;
+}
+
+export function toRangeHashes(hashes: Map<number, string>): RangeHashes {
+  return Object.fromEntries(hashes);
+}
+
+/** Column order independent, so schema migrations that reorder columns still match */
+function hashRow(hash: crypto.Hash, row: Record<string, any>): void {
+  for (const column of Object.keys(row).sort()) {
+    const value = row[column];
+    hash.update(column);
+    if (value instanceof Uint8Array) {
+      hash.update('\u0001');
+      hash.update(value);
+    } else {
+      hash.update(value === null || value === undefined ? '\u0000' : `\u0002${value}`);
+    }
+    hash.update('\u0003');
+  }
+}
+
+/**
+ * Hash of the rows with low <= key < high; null when there are none
+ */
+export function hashRange(db: any, spec: SyncTableSpec, low: number, high: number): string | null {
+  const rows = db.prepare(
+    `SELECT * FROM ${spec.table} WHERE ${spec.key} >= ? AND ${spec.key} < ? ORDER BY ${spec.key}`
+  ).all(low, high) as any[];
+  if (rows.length === 0) return null;
+  const hash = crypto.createHash('sha1');
+  for (const row of rows) hashRow(hash, row);
+  return hash.digest('base64').slice(0, 16);
+}
+
+/**
+ * Install the change log and the triggers feeding it for a table; false
+ * when the database can't take them (read-only), so every call rehashes
+ */
+function trackRangeChanges(db: any, spec: SyncTableSpec): boolean {
+  // An upsert, not OR REPLACE: the outer statement's conflict policy
+  // (e.g. applyRows' ON CONFLICT) would override the trigger's
+  const record = (row: 'NEW' | 'OLD') => `
+    INSERT INTO sync_range_changes (table_name, row_key, seq)
+    VALUES ('${spec.table}', ${row}.${spec.key}, (SELECT COALESCE(MAX(seq), 0) + 1 FROM sync_range_changes))
+    ON CONFLICT (table_name, row_key) DO UPDATE SET seq = excluded.seq;`;
+
+  try {
+    // One row per (table, key); seq moves forward on every write
+    db.exec(`
+      CREATE TABLE IF NOT EXISTS sync_range_changes (
+        table_name TEXT NOT NULL,
+        row_key INTEGER NOT NULL,
+        seq INTEGER NOT NULL,
+        PRIMARY KEY (table_name, row_key)
+      );
+      CREATE INDEX IF NOT EXISTS idx_sync_range_changes_seq ON sync_range_changes(seq);
+
+      CREATE TRIGGER IF NOT EXISTS sync_range_${spec.table}_insert AFTER INSERT ON ${spec.table}
+      BEGIN ${record('NEW')} END;
+      CREATE TRIGGER IF NOT EXISTS sync_range_${spec.table}_update AFTER UPDATE ON ${spec.table}
+      BEGIN ${record('OLD')} ${record('NEW')} END;
+      CREATE TRIGGER IF NOT EXISTS sync_range_${spec.table}_delete AFTER DELETE ON ${spec.table}
+      BEGIN ${record('OLD')} END;
+    `);
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+function dataVersion(db: any): string | null {
+  try {
+    const external = db.prepare('PRAGMA data_version').get() as any;
+    const local = db.prepare('SELECT total_changes() AS n').get() as any;
+    return `${external.data_version}:${local.n}`;
+  } catch {
+    return null;
+  }
+}
@@ -0,0 +1,282 @@
+/**
+ * Vector Kernels - Dot-product and top-k primitives for brute-force search
+ *
+ * Operates on contiguous row-major Float32Array matrices so similarity scans
+ * touch memory sequentially. A tiny WASM SIMD128 module (embedded below) is
+ * used when the runtime supports it; otherwise an unrolled JS loop is used.
+ */
+
+/**
+ * WASM SIMD128 module exporting `memory` and
+ * `dots(queryPtr, matrixPtr, rows, dim, outPtr)`, which writes one f32 dot
+ * product per row. The inner loop uses f32x4.mul/f32x4.add over 4 lanes and a
+ * scalar tail, so any dimension is supported.
+ */
+const SIMD_DOTS_WASM =
+  'AGFzbQEAAAABCQFgBX9/f39/AAMCAQAFAwEAAQcRAgZtZW1vcnkCAARkb3RzAAAK3gEB2wEDBH8BewF9IANBfHEhByABIQgC' +
+  'QANAIAUgAk8NAf0MAAAAAAAAAAAAAAAAAAAAACEJQQAhBgJAA0AgBiAHTw0BIAkgACAGQQJ0av0AAgAgCCAGQQJ0av0AAgD9' +
+  '5gH95AEhCSAGQQRqIQYMAAsLIAn9HwAgCf0fAZIgCf0fApIgCf0fA5IhCgJAA0AgBiADTw0BIAogACAGQQJ0aioCACAIIAZB' +
+  'AnRqKgIAlJIhCiAGQQFqIQYMAAsLIAQgBUECdGogCjgCACAIIANBAnRqIQggBUEBaiEFDAALCws=';
+
+const WASM_PAGE_BYTES = 65536;
+
+export interface TopKEntry {
+  /** Row index into the scanned matrix */
+  index: number;
+  /** Score for that row (higher is better) */
+  score: number;
+}
+
+/**
+ * View a SQLite BLOB as a Float32Array without copying.
+ *
+ * better-sqlite3 returns Buffers that may be slices of a shared pool, so the
+ * byte offset is not guaranteed to be 4-byte aligned. Aligned buffers are
+ * wrapped in place; misaligned ones fall back to a single copy.
+ */
+export function blobToFloat32(blob: Buffer | Uint8Array): Float32Array {
+  const length = blob.byteLength >>> 2;
+  if ((blob.byteOffset & 3) === 0) {
+    return new Float32Array(blob.buffer, blob.byteOffset, length);
+  }
+  const copy = new Float32Array(length);
+  new Uint8Array(copy.buffer).set(blob.subarray(0, length * 4));
+  return copy;
+}
+
+/**
+ * Dot product of two equal-length vectors (4-way unrolled)
+ */
+export function dotProduct(a: Float32Array, b: Float32Array, aOffset = 0, bOffset = 0, length = a.length): number {
+  let s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  const end = length - (length % 4);
+
+  for (let i = 0; i < end; i += 4) {
+    s0 += a[aOffset + i] * b[bOffset + i];
+    s1 += a[aOffset + i + 1] * b[bOffset + i + 1];
+    s2 += a[aOffset + i + 2] * b[bOffset + i + 2];
+    s3 += a[aOffset + i + 3] * b[bOffset + i + 3];
+  }
+  for (let i = end; i < length; i++) {
+    s0 += a[aOffset + i] * b[bOffset + i];
+  }
+
+  return s0 + s1 + s2 + s3;
+}
+
+/**
+ * Euclidean (L2) norm of a vector
+ */
+export function l2Norm(v: Float32Array, offset = 0, length = v.length): number {
+  return Math.sqrt(dotProduct(v, v, offset, offset, length));
+}
+
+/**
+ * Compute the L2 norm of every row in a row-major matrix
+ */
+export function computeRowNorms(
+  matrix: Float32Array,
+  rows: number,
+  dim: number,
+  out: Float32Array = new Float32Array(rows)
+): Float32Array {
+  for (let r = 0; r < rows; r++) {
+    out[r] = l2Norm(matrix, r * dim, dim);
+  }
+  return out;
+}
+
+/**
+ * Query-vs-matrix dot products in plain JS
+ */
+export function dotBatch(
+  query: Float32Array,
+  matrix: Float32Array,
+  rows: number,
+  dim: number,
+  out: Float32Array = new Float32Array(rows)
+): Float32Array {
+  for (let r = 0; r < rows; r++) {
+    out[r] = dotProduct(query, matrix, 0, r * dim, dim);
+  }
+  return out;
+}
+
+/**
+ * Select the k highest scores without sorting the whole array
+ *
+ * Uses a fixed-size binary min-heap over typed arrays: O(n log k) time and
+ * O(k) extra memory. Scores below `threshold` are skipped. The returned
+ * entries are ordered best first.
+ */
+export function selectTopK(scores: ArrayLike<number>, k: number, threshold?: number): TopKEntry[] {
+  const n = scores.length;
+  const cap = Math.min(k, n);
+  if (cap <= 0) return [];
+
+  const heapIdx = new Uint32Array(cap);
+  const heapScore = new Float64Array(cap);
+  let size = 0;
+  const min = threshold ?? -Infinity;
+
+  const siftDown = (pos: number) => {
+    while (true) {
+      const left = 2 * pos + 1;
+      if (left >= size) return;
+      const right = left + 1;
+      const child = right < size && heapScore[right] < heapScore[left] ? right : left;
+      if (heapScore[child] >= heapScore[pos]) return;
+      const ts = heapScore[pos]; heapScore[pos] = heapScore[child]; heapScore[child] = ts;
+      const ti = heapIdx[pos]; heapIdx[pos] = heapIdx[child]; heapIdx[child] = ti;
+      pos = child;
+    }
+  };
+
+  for (let i = 0; i < n; i++) {
+    const score = scores[i];
+    if (score < min || score !== score) continue;
+
+    if (size < cap) {
+      // Sift up
+      let pos = size++;
+      heapScore[pos] = score;
+      heapIdx[pos] = i;
+      while (pos > 0) {
+        const parent = (pos - 1) >> 1;
+        if (heapScore[parent] <= heapScore[pos]) break;
+        const ts = heapScore[pos]; heapScore[pos] = heapScore[parent]; heapScore[parent] = ts;
+        const ti = heapIdx[pos]; heapIdx[pos] = heapIdx[parent]; heapIdx[parent] = ti;
+        pos = parent;
+      }
+    } else if (score > heapScore[0]) {
+      heapScore[0] = score;
+      heapIdx[0] = i;
+      siftDown(0);
+    }
+  }
+
+  const result: TopKEntry[] = new Array(size);
+  for (let i = 0; i < size; i++) {
+    result[i] = { index: heapIdx[i], score: heapScore[i] };
+  }
+  return result.sort((a, b) => b.score - a.score);
+}
+
+/**
+ * Resident-matrix SIMD dot-product kernel
+ *
+ * The matrix lives in WASM linear memory. It is either copied in once with
+ * loadMatrix(), or written in place through matrixView() after reserve() so
+ * callers can keep their storage slab inside the kernel and avoid a second
+ * copy. Each dots() call only copies the query in. Returned views alias WASM
+ * memory: scores are valid until the next dots() call, and any view is
+ * invalidated when reserve() grows memory.
+ */
+export class SimdDotKernel {
+  private memory: WebAssembly.Memory;
+  private dotsFn: (q: number, m: number, rows: number, dim: number, out: number) => void;
+  private rows: number = 0;
+  private dim: number = 0;
+  private capacity: number = 0;
+  private queryPtr: number = 0;
+  private matrixPtr: number = 0;
+  private outPtr: number = 0;
+
+  private constructor(instance: WebAssembly.Instance) {
+    this.memory = instance.exports.memory as WebAssembly.Memory;
+    this.dotsFn = instance.exports.dots as any;
+  }
+
+  /**
+   * Instantiate the kernel, or return null if WASM SIMD is unavailable
+   */
+  static create(): SimdDotKernel | null {
+    try {
+      const globalAny = globalThis as any;
+      if (typeof globalAny.WebAssembly === 'undefined') return null;
+
+      const bytes = typeof Buffer !== 'undefined'
+        ? Buffer.from(SIMD_DOTS_WASM, 'base64')
+        : Uint8Array.from(atob(SIMD_DOTS_WASM), (c) => c.charCodeAt(0));
+
+      if (!WebAssembly.validate(bytes)) return null;
+
+      // Module is a few hundred bytes, so synchronous compilation is fine
+      const module = new WebAssembly.Module(bytes);
+      return new SimdDotKernel(new WebAssembly.Instance(module, {}));
+    } catch {
+      return null;
+    }
+  }
+
+  /**
+   * Ensure room for `capacity` rows of `dim` floats
+   *
+   * Existing rows are preserved when the dimension is unchanged, since the
+   * matrix region starts at a fixed offset and memory.grow keeps contents.
+   */
+  reserve(capacity: number, dim: number): void {
+    // Layout: [query | matrix | scores], each region 16-byte aligned
+    const align = (n: number) => (n + 15) & ~15;
+    if (dim !== this.dim) {
+      this.rows = 0;
+    }
+    this.dim = dim;
+    this.capacity = capacity;
+    this.queryPtr = 0;
+    this.matrixPtr = align(dim * 4);
+    this.outPtr = align(this.matrixPtr + capacity * dim * 4);
+    const required = this.outPtr + capacity * 4;
+
+    const current = this.memory.buffer.byteLength;
+    if (required > current) {
+      this.memory.grow(Math.ceil((required - current) / WASM_PAGE_BYTES));
+    }
+  }
+
+  /**
+   * Writable view over the reserved matrix region (capacity * dim floats)
+   */
+  matrixView(): Float32Array {
+    return new Float32Array(this.memory.buffer, this.matrixPtr, this.capacity * this.dim);
+  }
+
+  /**
+   * Set how many leading rows dots() scans
+   */
+  setRowCount(rows: number): void {
+    if (rows > this.capacity) {
+      throw new Error(`Row count ${rows} exceeds reserved capacity ${this.capacity}`);
+    }
+    this.rows = rows;
+  }
+
+  /**
+   * Copy a row-major matrix into linear memory
+   */
+  loadMatrix(matrix: Float32Array, rows: number, dim: number): void {
+    this.reserve(rows, dim);
+    this.matrixView().set(matrix.subarray(0, rows * dim));
+    this.rows = rows;
+  }
+
+  /**
+   * Dot products of `query` against every loaded row
+   */
+  dots(query: Float32Array): Float32Array {
+    if (query.length !== this.dim) {
+      throw new Error(`Query dimension ${query.length} does not match matrix dimension ${this.dim}`);
+    }
+
+    new Float32Array(this.memory.buffer, this.queryPtr, this.dim).set(query);
+    this.dotsFn(this.queryPtr, this.matrixPtr, this.rows, this.dim, this.outPtr);
+    return new Float32Array(this.memory.buffer, this.outPtr, this.rows);
+  }
+
+  /**
+   * Bytes of linear memory currently reserved by the kernel
+   */
+  get byteLength(): number {
+    return this.memory.buffer.byteLength;
+  }
+}
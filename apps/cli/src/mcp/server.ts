@@ -3,7 +3,7 @@
  * Provides tools and resources for hackathon projects
  */
 
-import type { McpRequest, McpResponse } from '../types.js';
+import type { McpRequest, McpResponse, McpRequestContext } from '../types.js';
 import {
   HACKATHON_NAME,
   TRACKS,
@@ -13,8 +13,13 @@ import {
 } from '../constants.js';
 import { loadConfig, checkToolInstalled } from '../utils/index.js';
 
+// JSON-RPC error code for a request the client cancelled
+const REQUEST_CANCELLED = -32800;
+
+type Handler = (params?: Record<string, unknown>, context?: McpRequestContext) => Promise<unknown>;
+
 export class McpServer {
-  private handlers: Map<string, (params?: Record<string, unknown>) => Promise<unknown>>;
+  private handlers: Map<string, Handler>;
 
   constructor() {
     this.handlers = new Map();
@@ -88,7 +93,7 @@ export class McpServer {
     }));
 
     // Call tool
-    this.handlers.set('tools/call', async (params) => {
+    this.handlers.set('tools/call', async (params, context) => {
       // Validate required parameters
       if (!params || typeof params !== 'object') {
         throw new Error('Invalid params: params must be an object');
@@ -138,19 +143,27 @@ export class McpServer {
             throw new Error(`Invalid params: category must be one of: ai-assistants, orchestration, databases, cloud-platform, synthesis`);
           }
 
-          const tools = category
+          const tools = (category
             ? AVAILABLE_TOOLS.filter(t => t.category === category)
-            : AVAILABLE_TOOLS;
+            : AVAILABLE_TOOLS
+          ).map(t => ({
+            name: t.name,
+            displayName: t.displayName,
+            description: t.description,
+            installCommand: t.installCommand,
+            category: t.category
+          }));
+
+          // Streaming transports also get each tool as a progress event
+          tools.forEach((t, i) => {
+            context?.signal?.throwIfAborted();
+            context?.onProgress?.({ progress: i + 1, total: tools.length, message: JSON.stringify(t) });
+          });
+
           return {
             content: [{
               type: 'text',
-              text: JSON.stringify(tools.map(t => ({
-                name: t.name,
-                displayName: t.displayName,
-                description: t.description,
-                installCommand: t.installCommand,
-                category: t.category
-              })), null, 2)
+              text: JSON.stringify(tools, null, 2)
             }]
           };
 
@@ -324,7 +337,7 @@ export class McpServer {
     });
   }
 
-  async handleRequest(request: McpRequest): Promise<McpResponse> {
+  async handleRequest(request: McpRequest, context: McpRequestContext = {}): Promise<McpResponse> {
     const handler = this.handlers.get(request.method);
 
     if (!handler) {
@@ -339,13 +352,25 @@ export class McpServer {
     }
 
     try {
-      const result = await handler(request.params);
+      context.signal?.throwIfAborted();
+      const result = await handler(request.params, context);
+      context.signal?.throwIfAborted();
       return {
         jsonrpc: '2.0',
         id: request.id,
         result
       };
     } catch (error) {
+      if (context.signal?.aborted) {
+        return {
+          jsonrpc: '2.0',
+          id: request.id,
+          error: {
+            code: REQUEST_CANCELLED,
+            message: 'Request cancelled'
+          }
+        };
+      }
       return {
         jsonrpc: '2.0',
         id: request.id,
@@ -2,13 +2,24 @@
 /**
  * MCP Server - SSE (Server-Sent Events) Transport
  * Run with: npx @agenticsorg/hackathon mcp sse --port 3000
+ *
+ * POST /rpc with `Accept: text/event-stream` streams the call: progress
+ * notifications as `progress` events while it runs, then the response as a
+ * `message` event. Closing the connection, a `notifications/cancelled`
+ * request for its id, or the request timeout aborts the call.
+ *
+ * Request ids are chosen by clients, so `notifications/cancelled` needs the
+ * session announced in the /sse `connected` event, sent back as
+ * `Mcp-Session-Id` on both the call and the cancel. Without one a call can
+ * still be aborted by closing its connection.
  */
 
+import { randomUUID } from 'node:crypto';
 import express from 'express';
 import helmet from 'helmet';
 import rateLimit from 'express-rate-limit';
 import { McpServer } from './server.js';
-import type { McpRequest } from '../types.js';
+import type { McpRequest, McpProgress } from '../types.js';
 
 const DEFAULT_PORT = 3000;
 const REQUEST_TIMEOUT_MS = 30000; // 30 seconds
@@ -24,6 +35,17 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
   const app = express();
   const server = new McpServer();
   const activeIntervals = new Set<NodeJS.Timeout>();
+  // Open /sse sessions
+  const sessions = new Set<string>();
+  // In-flight calls by session, then JSON-RPC id, for notifications/cancelled
+  const inFlight = new Map<string, Map<string | number, AbortController>>();
+
+  // Under HTTP/1.1 a cancel cannot arrive on the connection its call is
+  // still using, so only a session ties the two together
+  const callSession = (req: express.Request): string | undefined => {
+    const session = req.header('mcp-session-id');
+    return session && sessions.has(session) ? session : undefined;
+  };
 
   // Security headers via helmet
   app.use(helmet({
@@ -47,9 +69,11 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
   // Instead, we use a timeout flag pattern that's checked before sending responses
   app.use((req, res, next) => {
     let timedOut = false;
+    const controller = new AbortController();
 
     const timeout = setTimeout(() => {
       timedOut = true;
+      controller.abort(new Error('Request timeout'));
       if (!res.headersSent) {
         res.status(408).json({
           jsonrpc: '2.0',
@@ -64,10 +88,15 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
 
     // Store timeout state on request for handlers to check
     (req as any).timedOut = () => timedOut;
+    (req as any).abortSignal = controller.signal;
 
-    // Clean up timeout when response finishes
+    // Clean up timeout when response finishes; a connection closed before
+    // the response was sent aborts the work behind it
     res.on('finish', () => clearTimeout(timeout));
-    res.on('close', () => clearTimeout(timeout));
+    res.on('close', () => {
+      clearTimeout(timeout);
+      if (!res.writableFinished) controller.abort(new Error('Client disconnected'));
+    });
 
     next();
   });
@@ -89,7 +118,7 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
     }
 
     res.setHeader('Access-Control-Allow-Methods', 'GET, POST, OPTIONS');
-    res.setHeader('Access-Control-Allow-Headers', 'Content-Type');
+    res.setHeader('Access-Control-Allow-Headers', 'Content-Type, Mcp-Session-Id');
     res.setHeader('Access-Control-Max-Age', '86400'); // 24 hours
 
     if (req.method === 'OPTIONS') {
@@ -111,7 +140,9 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
     res.setHeader('Connection', 'keep-alive');
 
     // Send initial connection event
-    res.write(`event: connected\ndata: ${JSON.stringify({ server: 'agentics-hackathon-mcp' })}\n\n`);
+    const sessionId = randomUUID();
+    sessions.add(sessionId);
+    res.write(`event: connected\ndata: ${JSON.stringify({ server: 'agentics-hackathon-mcp', sessionId })}\n\n`);
 
     // Keep connection alive
     const keepAlive = setInterval(() => {
@@ -125,6 +156,7 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
     const cleanup = () => {
       clearInterval(keepAlive);
       activeIntervals.delete(keepAlive);
+      sessions.delete(sessionId);
     };
 
     req.on('close', cleanup);
@@ -148,8 +180,69 @@ export function startSseServer(port: number = DEFAULT_PORT): void {
       return;
     }
 
-    const response = await server.handleRequest(request);
-    res.json(response);
+    const session = callSession(req);
+    if (request.method === 'notifications/cancelled') {
+      if (!session) {
+        res.status(400).json({
+          jsonrpc: '2.0',
+          id: null,
+          error: {
+            code: -32600,
+            message: 'Invalid Request: notifications/cancelled requires an open Mcp-Session-Id'
+          }
+        });
+        return;
+      }
+      const requestId = request.params?.requestId as string | number | undefined;
+      if (requestId !== undefined) inFlight.get(session)?.get(requestId)?.abort(new Error('Request cancelled'));
+      res.status(202).end();
+      return;
+    }
+
+    const signal: AbortSignal = (req as any).abortSignal;
+    const controller = new AbortController();
+    const onAbort = () => controller.abort(signal.reason);
+    signal.addEventListener('abort', onAbort, { once: true });
+    let calls = session ? inFlight.get(session) : undefined;
+    if (session && request.id !== undefined) {
+      if (!calls) inFlight.set(session, calls = new Map());
+      calls.set(request.id, controller);
+    }
+
+    try {
+      if (!req.headers.accept?.includes('text/event-stream')) {
+        const response = await server.handleRequest(request, { signal: controller.signal });
+        if (!(req as any).timedOut() && !res.headersSent) {
+          res.json(response);
+        }
+        return;
+      }
+
+      res.setHeader('Content-Type', 'text/event-stream');
+      res.setHeader('Cache-Control', 'no-cache');
+      res.setHeader('Connection', 'keep-alive');
+      res.flushHeaders();
+
+      const meta = request.params?._meta as { progressToken?: string | number } | undefined;
+      const progressToken = meta?.progressToken ?? request.id;
+      const onProgress = (progress: McpProgress) => {
+        if (res.destroyed) return;
+        const notification = { jsonrpc: '2.0', method: 'notifications/progress', params: { progressToken, ...progress } };
+        res.write(`event: progress\ndata: ${JSON.stringify(notification)}\n\n`);
+      };
+
+      const response = await server.handleRequest(request, { signal: controller.signal, onProgress });
+      if (!res.destroyed) {
+        res.write(`event: message\ndata: ${JSON.stringify(response)}\n\n`);
+        res.end();
+      }
+    } finally {
+      signal.removeEventListener('abort', onAbort);
+      if (calls?.get(request.id) === controller) {
+        calls.delete(request.id);
+        if (calls.size === 0 && inFlight.get(session!) === calls) inFlight.delete(session!);
+      }
+    }
   });
 
   // Info endpoint
@@ -92,3 +92,19 @@ export interface McpResponse {
     data?: unknown;
   };
 }
+
+export interface McpProgress {
+  progress: number;
+  total?: number;
+  message?: string;
+}
+
+/**
+ * Per-request transport hooks: cancellation and incremental progress
+ */
+export interface McpRequestContext {
+  /** Aborted when the client cancels or disconnects, or the request times out */
+  signal?: AbortSignal;
+  /** Set by streaming transports; handlers report partial results through it */
+  onProgress?: (progress: McpProgress) => void;
+}
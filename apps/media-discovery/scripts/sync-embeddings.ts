@@ -6,30 +6,49 @@
  * Uses the ruvector npm package for embedded vector database storage.
  * Run periodically to keep embeddings up-to-date.
  *
+ * Stages run as a stream rather than one after another: TMDB pages are
+ * fetched concurrently under a token bucket, items are grouped into
+ * provider-sized embedding batches, and batches are stored while the next
+ * ones are still embedding. A checkpoint file keeps a content hash per item,
+ * so reruns skip anything that hasn't changed.
+ *
  * Usage:
  *   npx tsx scripts/sync-embeddings.ts [options]
  *
  * Options:
- *   --full      Sync all content (movies + TV shows)
- *   --movies    Sync only movies
- *   --tv        Sync only TV shows
- *   --trending  Sync only trending content
- *   --limit N   Limit to N items per category
+ *   --full            Sync all content (movies + TV shows)
+ *   --movies          Sync only movies
+ *   --tv              Sync only TV shows
+ *   --trending        Sync only trending content
+ *   --limit N         Limit to N items per category
+ *   --concurrency N   Concurrent TMDB page fetches (default 4)
+ *   --tmdb-rps N      TMDB requests per second (default 20)
+ *   --batch-size N    Texts per embedding request (default 100)
+ *   --in-flight N     Embedding batches in flight at once (default 3)
+ *   --checkpoint P    Checkpoint file (default ./data/sync-embeddings.checkpoint.json)
+ *   --force           Re-embed items even if the checkpoint says they're unchanged
  */
 
 // Load environment variables from .env.local
 import { config } from 'dotenv';
 config({ path: '.env.local' });
 
+import { createHash } from 'crypto';
+import { promises as fs } from 'fs';
+import * as path from 'path';
 import { TMDB } from 'tmdb-ts';
-import { VectorDB } from 'ruvector';
+import { getPartition, getPartitionPath, getVectorCount, flushVectorIndex } from '../src/lib/vector-search';
+import type { MediaType, MediaVectorMetadata } from '../src/lib/media-vector-index';
 
 // Configuration
 const TMDB_TOKEN = process.env.NEXT_PUBLIC_TMDB_ACCESS_TOKEN;
 const OPENAI_API_KEY = process.env.OPENAI_API_KEY;
-const STORAGE_PATH = process.env.RUVECTOR_STORAGE_PATH || './data/media-vectors.db';
 const EMBEDDING_DIMENSIONS = 768;
 
+// OpenAI accepts up to 2048 inputs per request
+const MAX_BATCH_SIZE = 2048;
+const EMBEDDING_RETRIES = 3;
+
 if (!TMDB_TOKEN) {
   console.error('Error: NEXT_PUBLIC_TMDB_ACCESS_TOKEN is required');
   process.exit(1);
@@ -48,125 +67,209 @@ interface ContentItem {
   posterPath?: string | null;
 }
 
-interface EmbeddingResult {
+interface PendingItem {
+  key: string;
   item: ContentItem;
-  embedding: Float32Array;
   text: string;
+  hash: string;
+}
+
+interface SyncOptions {
+  mode: string;
+  limit: number;
+  concurrency: number;
+  tmdbRps: number;
+  batchSize: number;
+  inFlight: number;
+  checkpointPath: string;
+  force: boolean;
+}
+
+interface Checkpoint {
+  version: 1;
+  items: Record<string, string>;
 }
 
 // Parse command line arguments
-function parseArgs(): { mode: string; limit: number } {
+function parseArgs(): SyncOptions {
   const args = process.argv.slice(2);
-  let mode = 'trending';
-  let limit = 100;
+  const options: SyncOptions = {
+    mode: 'trending',
+    limit: 100,
+    concurrency: 4,
+    tmdbRps: 20,
+    batchSize: 100,
+    inFlight: 3,
+    checkpointPath: process.env.SYNC_CHECKPOINT_PATH || './data/sync-embeddings.checkpoint.json',
+    force: false,
+  };
+  const positive = (value: string | undefined, fallback: number) => {
+    const parsed = parseInt(value ?? '', 10);
+    return parsed > 0 ? parsed : fallback;
+  };
 
   for (let i = 0; i < args.length; i++) {
     switch (args[i]) {
       case '--full':
-        mode = 'full';
+        options.mode = 'full';
         break;
       case '--movies':
-        mode = 'movies';
+        options.mode = 'movies';
         break;
       case '--tv':
-        mode = 'tv';
+        options.mode = 'tv';
         break;
       case '--trending':
-        mode = 'trending';
+        options.mode = 'trending';
         break;
       case '--limit':
-        limit = parseInt(args[++i], 10) || 100;
+        options.limit = positive(args[++i], 100);
+        break;
+      case '--concurrency':
+        options.concurrency = positive(args[++i], 4);
+        break;
+      case '--tmdb-rps':
+        options.tmdbRps = positive(args[++i], 20);
+        break;
+      case '--batch-size':
+        options.batchSize = Math.min(positive(args[++i], 100), MAX_BATCH_SIZE);
+        break;
+      case '--in-flight':
+        options.inFlight = positive(args[++i], 3);
+        break;
+      case '--checkpoint':
+        options.checkpointPath = args[++i] || options.checkpointPath;
+        break;
+      case '--force':
+        options.force = true;
         break;
     }
   }
 
-  return { mode, limit };
+  return options;
 }
 
-// Fetch content from TMDB
-async function fetchContent(mode: string, limit: number): Promise<ContentItem[]> {
-  const items: ContentItem[] = [];
-  const pagesNeeded = Math.ceil(limit / 20);
+const sleep = (ms: number) => new Promise(resolve => setTimeout(resolve, ms));
 
-  console.log(`Fetching ${mode} content (limit: ${limit})...`);
-
-  if (mode === 'trending' || mode === 'full') {
-    for (let page = 1; page <= pagesNeeded && items.length < limit; page++) {
-      try {
-        const trending = await tmdb.trending.trending('all', 'week');
-        for (const item of trending.results) {
-          if (items.length >= limit) break;
-          if (item.media_type === 'movie' || item.media_type === 'tv') {
-            items.push({
-              id: item.id,
-              title: item.media_type === 'tv' ? (item as any).name : (item as any).title,
-              overview: item.overview || '',
-              mediaType: item.media_type,
-              genreIds: item.genre_ids || [],
-              voteAverage: item.vote_average,
-              releaseDate: item.media_type === 'tv' ? (item as any).first_air_date : (item as any).release_date,
-              posterPath: item.poster_path,
-            });
-          }
-        }
-      } catch (error) {
-        console.error(`Error fetching trending page ${page}:`, error);
-      }
-    }
+/**
+ * Token bucket shared by concurrent callers; take() resolves once a token is
+ * available, in call order
+ */
+class TokenBucket {
+  private tokens: number;
+  private last = Date.now();
+  private queue: Promise<void> = Promise.resolve();
+
+  constructor(private readonly ratePerSecond: number, private readonly capacity: number = ratePerSecond) {
+    this.tokens = capacity;
   }
 
-  if (mode === 'movies' || mode === 'full') {
-    for (let page = 1; page <= pagesNeeded && items.length < limit; page++) {
-      try {
-        const movies = await tmdb.movies.popular({ page });
-        for (const movie of movies.results) {
-          if (items.length >= limit) break;
-          if (!items.some(i => i.id === movie.id && i.mediaType === 'movie')) {
-            items.push({
-              id: movie.id,
-              title: movie.title,
-              overview: movie.overview || '',
-              mediaType: 'movie',
-              genreIds: movie.genre_ids || [],
-              voteAverage: movie.vote_average,
-              releaseDate: movie.release_date,
-              posterPath: movie.poster_path,
-            });
-          }
+  take(): Promise<void> {
+    const turn = this.queue.then(async () => {
+      for (;;) {
+        const now = Date.now();
+        this.tokens = Math.min(this.capacity, this.tokens + ((now - this.last) / 1000) * this.ratePerSecond);
+        this.last = now;
+        if (this.tokens >= 1) {
+          this.tokens -= 1;
+          return;
         }
-      } catch (error) {
-        console.error(`Error fetching movies page ${page}:`, error);
+        await sleep(((1 - this.tokens) / this.ratePerSecond) * 1000);
       }
-    }
+    });
+    this.queue = turn;
+    return turn;
   }
+}
 
-  if (mode === 'tv' || mode === 'full') {
-    for (let page = 1; page <= pagesNeeded && items.length < limit; page++) {
-      try {
-        const shows = await tmdb.tvShows.popular({ page });
-        for (const show of shows.results) {
-          if (items.length >= limit) break;
-          if (!items.some(i => i.id === show.id && i.mediaType === 'tv')) {
-            items.push({
-              id: show.id,
-              title: show.name,
-              overview: show.overview || '',
-              mediaType: 'tv',
-              genreIds: show.genre_ids || [],
-              voteAverage: show.vote_average,
-              releaseDate: show.first_air_date,
-              posterPath: show.poster_path,
-            });
-          }
+type PageSource = 'trending' | 'movies' | 'tv';
+
+// Fetch one TMDB page; an empty result marks the end of its source
+async function fetchPage(source: PageSource, page: number): Promise<ContentItem[]> {
+  if (source === 'trending') {
+    const trending = await tmdb.trending.trending('all', 'week', { page });
+    return trending.results
+      .filter(item => item.media_type === 'movie' || item.media_type === 'tv')
+      .map(item => ({
+        id: item.id,
+        title: item.media_type === 'tv' ? (item as any).name : (item as any).title,
+        overview: item.overview || '',
+        mediaType: item.media_type as 'movie' | 'tv',
+        genreIds: item.genre_ids || [],
+        voteAverage: item.vote_average,
+        releaseDate: item.media_type === 'tv' ? (item as any).first_air_date : (item as any).release_date,
+        posterPath: item.poster_path,
+      }));
+  }
+
+  if (source === 'movies') {
+    const movies = await tmdb.movies.popular({ page });
+    return movies.results.map(movie => ({
+      id: movie.id,
+      title: movie.title,
+      overview: movie.overview || '',
+      mediaType: 'movie' as const,
+      genreIds: movie.genre_ids || [],
+      voteAverage: movie.vote_average,
+      releaseDate: movie.release_date,
+      posterPath: movie.poster_path,
+    }));
+  }
+
+  const shows = await tmdb.tvShows.popular({ page });
+  return shows.results.map(show => ({
+    id: show.id,
+    title: show.name,
+    overview: show.overview || '',
+    mediaType: 'tv' as const,
+    genreIds: show.genre_ids || [],
+    voteAverage: show.vote_average,
+    releaseDate: show.first_air_date,
+    posterPath: show.poster_path,
+  }));
+}
+
+/**
+ * Stream content from TMDB, fetching up to `concurrency` pages at a time
+ * under the rate limit. Items are yielded in page order, deduplicated.
+ */
+async function* fetchContent(options: SyncOptions, bucket: TokenBucket): AsyncGenerator<ContentItem> {
+  const { mode, limit, concurrency } = options;
+  const pagesNeeded = Math.ceil(limit / 20);
+  const sources: PageSource[] = mode === 'full' ? ['trending', 'movies', 'tv'] : mode === 'movies' ? ['movies'] : mode === 'tv' ? ['tv'] : ['trending'];
+  const seen = new Set<string>();
+  let yielded = 0;
+
+  console.log(`Fetching ${mode} content (limit: ${limit}, ${concurrency} concurrent pages)...`);
+
+  for (const source of sources) {
+    let exhausted = false;
+
+    for (let first = 1; first <= pagesNeeded && !exhausted && yielded < limit; first += concurrency) {
+      const pages = Array.from({ length: Math.min(concurrency, pagesNeeded - first + 1) }, (_, i) => first + i);
+      const results = await Promise.all(pages.map(async page => {
+        await bucket.take();
+        try {
+          return await fetchPage(source, page);
+        } catch (error) {
+          console.error(`Error fetching ${source} page ${page}:`, error);
+          return null;
+        }
+      }));
+
+      for (const items of results) {
+        if (items && items.length === 0) exhausted = true;
+        for (const item of items ?? []) {
+          if (yielded >= limit) return;
+          const key = `${item.mediaType}-${item.id}`;
+          if (seen.has(key)) continue;
+          seen.add(key);
+          yielded++;
+          yield item;
         }
-      } catch (error) {
-        console.error(`Error fetching TV shows page ${page}:`, error);
       }
     }
   }
-
-  console.log(`Fetched ${items.length} content items`);
-  return items.slice(0, limit);
 }
 
 // Generate text for embedding
@@ -180,6 +283,14 @@ function generateEmbeddingText(item: ContentItem): string {
   return parts.filter(Boolean).join('. ');
 }
 
+// Hash of everything stored for an item, so metadata-only changes are picked up too
+function contentHash(item: ContentItem, text: string): string {
+  return createHash('sha256')
+    .update(JSON.stringify([text, item.genreIds, item.voteAverage ?? 0, item.releaseDate ?? '', item.posterPath ?? null]))
+    .digest('base64')
+    .slice(0, 22);
+}
+
 // Generate mock embedding for testing (when no OpenAI key)
 function generateMockEmbedding(text: string): Float32Array {
   const embedding = new Float32Array(EMBEDDING_DIMENSIONS);
@@ -200,141 +311,240 @@ function generateMockEmbedding(text: string): Float32Array {
   return embedding;
 }
 
-// Generate embedding using OpenAI API
-async function generateEmbedding(text: string): Promise<Float32Array | null> {
+/**
+ * Embed a batch of texts in one OpenAI request, retrying rate limits and
+ * server errors with backoff. Returns null if the batch keeps failing.
+ */
+async function generateEmbeddings(texts: string[], bucket: TokenBucket): Promise<Float32Array[] | null> {
   if (!OPENAI_API_KEY) {
-    // Return mock embedding for testing
-    return generateMockEmbedding(text);
+    // Return mock embeddings for testing
+    return texts.map(generateMockEmbedding);
   }
 
-  try {
-    const response = await fetch('https://api.openai.com/v1/embeddings', {
-      method: 'POST',
-      headers: {
-        Authorization: `Bearer ${OPENAI_API_KEY}`,
-        'Content-Type': 'application/json',
-      },
-      body: JSON.stringify({
-        model: 'text-embedding-3-small',
-        input: text,
-        dimensions: EMBEDDING_DIMENSIONS,
-      }),
-    });
+  for (let attempt = 0; attempt <= EMBEDDING_RETRIES; attempt++) {
+    await bucket.take();
+    try {
+      const response = await fetch('https://api.openai.com/v1/embeddings', {
+        method: 'POST',
+        headers: {
+          Authorization: `Bearer ${OPENAI_API_KEY}`,
+          'Content-Type': 'application/json',
+        },
+        body: JSON.stringify({
+          model: 'text-embedding-3-small',
+          input: texts,
+          dimensions: EMBEDDING_DIMENSIONS,
+        }),
+      });
 
-    if (!response.ok) {
-      throw new Error(`OpenAI API error: ${response.status}`);
-    }
+      if (response.status === 429 || response.status >= 500) {
+        const retryAfter = Number(response.headers.get('retry-after'));
+        const delay = retryAfter > 0 ? retryAfter * 1000 : 500 * 2 ** attempt;
+        console.warn(`OpenAI API ${response.status}, retrying batch in ${delay}ms`);
+        await sleep(delay);
+        continue;
+      }
+      if (!response.ok) {
+        throw new Error(`OpenAI API error: ${response.status}`);
+      }
 
-    const data = await response.json();
-    return new Float32Array(data.data[0].embedding);
-  } catch (error) {
-    console.error('Embedding generation error:', error);
-    return null;
+      const data = await response.json();
+      const embeddings = new Array<Float32Array>(texts.length);
+      for (const entry of data.data as Array<{ index: number; embedding: number[] }>) {
+        embeddings[entry.index] = new Float32Array(entry.embedding);
+      }
+      return embeddings;
+    } catch (error) {
+      console.error('Embedding generation error:', error);
+      if (attempt === EMBEDDING_RETRIES) break;
+      await sleep(500 * 2 ** attempt);
+    }
   }
-}
 
-// Store embeddings in RuVector
-async function storeEmbeddings(db: InstanceType<typeof VectorDB>, embeddings: EmbeddingResult[]): Promise<number> {
-  let stored = 0;
+  return null;
+}
 
-  for (const { item, embedding } of embeddings) {
-    const id = `${item.mediaType}-${item.id}`;
+// Store a batch in the media type partitions; returns the stored items
+async function storeEmbeddings(batch: PendingItem[], embeddings: Float32Array[]): Promise<PendingItem[]> {
+  const byType = new Map<MediaType, Array<{ pending: PendingItem; vector: Float32Array }>>();
+  batch.forEach((pending, i) => {
+    const entries = byType.get(pending.item.mediaType) ?? [];
+    entries.push({ pending, vector: embeddings[i] });
+    byType.set(pending.item.mediaType, entries);
+  });
 
+  const stored = await Promise.all([...byType].map(async ([mediaType, entries]) => {
+    const partition = getPartition(mediaType);
+    const items = entries.map(({ pending, vector }) => ({
+      id: pending.key,
+      vector,
+      metadata: toMetadata(pending.item),
+    }));
     try {
-      await db.insert({
-        id,
-        vector: embedding,
-        metadata: {
-          contentId: item.id,
-          mediaType: item.mediaType,
-          title: item.title,
-          overview: item.overview.slice(0, 500),
-          genreIds: item.genreIds,
-          voteAverage: item.voteAverage || 0,
-          releaseDate: item.releaseDate || '',
-          posterPath: item.posterPath || null,
-        },
-      });
-      stored++;
+      await partition.insertBatch(items);
+      return entries.map(({ pending }) => pending);
     } catch (error) {
-      console.error(`Error storing ${id}:`, error);
+      // Retry one by one so a single bad item doesn't fail the batch
+      console.warn(`Batch insert of ${items.length} ${mediaType} items failed, inserting individually:`, error);
+      const done: PendingItem[] = [];
+      for (let i = 0; i < items.length; i++) {
+        try {
+          await partition.insert(items[i].id, items[i].vector, items[i].metadata);
+          done.push(entries[i].pending);
+        } catch (itemError) {
+          console.error(`Error storing ${items[i].id}:`, itemError);
+        }
+      }
+      return done;
+    }
+  }));
+
+  return stored.flat();
+}
+
+function toMetadata(item: ContentItem): MediaVectorMetadata {
+  return {
+    contentId: item.id,
+    mediaType: item.mediaType,
+    title: item.title,
+    overview: item.overview.slice(0, 500),
+    genreIds: item.genreIds,
+    voteAverage: item.voteAverage || 0,
+    releaseDate: item.releaseDate || '',
+    posterPath: item.posterPath || null,
+  };
+}
+
+async function loadCheckpoint(checkpointPath: string): Promise<Checkpoint> {
+  try {
+    const parsed = JSON.parse(await fs.readFile(checkpointPath, 'utf-8'));
+    if (parsed?.version === 1 && parsed.items && typeof parsed.items === 'object') {
+      return parsed as Checkpoint;
+    }
+    console.warn(`Ignoring checkpoint with unknown format: ${checkpointPath}`);
+  } catch (error) {
+    if ((error as NodeJS.ErrnoException).code !== 'ENOENT') {
+      console.warn(`Could not read checkpoint ${checkpointPath}:`, error);
     }
   }
+  return { version: 1, items: {} };
+}
 
-  return stored;
+// Write via a temp file so an interrupted run never leaves a torn checkpoint
+async function saveCheckpoint(checkpointPath: string, checkpoint: Checkpoint): Promise<void> {
+  await fs.mkdir(path.dirname(checkpointPath), { recursive: true });
+  const tmp = `${checkpointPath}.tmp`;
+  await fs.writeFile(tmp, JSON.stringify(checkpoint));
+  await fs.rename(tmp, checkpointPath);
 }
 
 // Main sync function
 async function main() {
-  const { mode, limit } = parseArgs();
+  const options = parseArgs();
+  const startedAt = Date.now();
   console.log(`\n=== Content Embedding Sync ===`);
-  console.log(`Mode: ${mode}`);
-  console.log(`Limit: ${limit}`);
-  console.log(`Storage: ${STORAGE_PATH}`);
+  console.log(`Mode: ${options.mode}`);
+  console.log(`Limit: ${options.limit}`);
+  console.log(`Storage: ${getPartitionPath('movie')}, ${getPartitionPath('tv')}`);
+  console.log(`Checkpoint: ${options.checkpointPath}${options.force ? ' (ignored, --force)' : ''}`);
   console.log(`OpenAI: ${OPENAI_API_KEY ? 'Configured' : 'Not configured (using mock embeddings)'}\n`);
 
-  // Initialize vector database
-  console.log('Initializing RuVector database...');
-  const db = new VectorDB({
-    dimensions: EMBEDDING_DIMENSIONS,
-    maxElements: 100000,
-    storagePath: STORAGE_PATH,
-  });
-
-  const existingCount = await db.len();
+  const existingCount = await getVectorCount();
   console.log(`Existing vectors: ${existingCount}\n`);
 
-  // Step 1: Fetch content
-  const content = await fetchContent(mode, limit);
-  if (content.length === 0) {
-    console.log('No content to process');
-    return;
-  }
+  const checkpoint = await loadCheckpoint(options.checkpointPath);
+  const tmdbBucket = new TokenBucket(options.tmdbRps);
+  const embeddingBucket = new TokenBucket(5);
 
-  // Step 2: Generate embeddings
-  console.log('\nGenerating embeddings...');
-  const embeddings: EmbeddingResult[] = [];
-  let processed = 0;
+  let fetched = 0;
+  let skipped = 0;
+  let embedded = 0;
+  let stored = 0;
+  let failed = 0;
 
-  for (const item of content) {
-    const text = generateEmbeddingText(item);
-    const embedding = await generateEmbedding(text);
+  // Checkpoint writes are serialized; batches finish out of order
+  let checkpointWrite: Promise<void> = Promise.resolve();
+  const inFlight = new Set<Promise<void>>();
 
-    if (embedding) {
-      embeddings.push({
-        item,
-        embedding,
-        text,
-      });
+  const dispatch = async (batch: PendingItem[]) => {
+    while (inFlight.size >= options.inFlight) {
+      await Promise.race(inFlight);
     }
 
-    processed++;
-    if (processed % 10 === 0) {
-      console.log(`  Processed ${processed}/${content.length} items`);
+    const job = (async () => {
+      const embeddings = await generateEmbeddings(batch.map(pending => pending.text), embeddingBucket);
+      if (!embeddings) {
+        failed += batch.length;
+        return;
+      }
+      embedded += batch.length;
+
+      const done = await storeEmbeddings(batch, embeddings);
+      stored += done.length;
+      failed += batch.length - done.length;
+      // Only checkpoint items once their partition sidecar (metadata and
+      // genre bitmap) is on disk, or an interrupted run would skip them
+      const mediaTypes = new Set(done.map(pending => pending.item.mediaType));
+      checkpointWrite = checkpointWrite
+        .then(async () => {
+          await Promise.all([...mediaTypes].map(mediaType => getPartition(mediaType).flush()));
+          for (const pending of done) {
+            checkpoint.items[pending.key] = pending.hash;
+          }
+          await saveCheckpoint(options.checkpointPath, checkpoint);
+        })
+        .catch(error => console.error('Failed to write checkpoint:', error));
+      console.log(`  Stored ${stored} (fetched ${fetched}, skipped ${skipped} unchanged)`);
+    })().catch(error => {
+      console.error('Batch failed:', error);
+      failed += batch.length;
+    });
+
+    inFlight.add(job);
+    job.finally(() => inFlight.delete(job));
+  };
+
+  // Stream: fetch -> hash check -> batch -> embed + store
+  let pending: PendingItem[] = [];
+  for await (const item of fetchContent(options, tmdbBucket)) {
+    fetched++;
+    const key = `${item.mediaType}-${item.id}`;
+    const text = generateEmbeddingText(item);
+    const hash = contentHash(item, text);
+
+    if (!options.force && checkpoint.items[key] === hash) {
+      skipped++;
+      continue;
     }
 
-    // Rate limiting for OpenAI API
-    if (OPENAI_API_KEY) {
-      await new Promise(resolve => setTimeout(resolve, 50));
+    pending.push({ key, item, text, hash });
+    if (pending.length >= options.batchSize) {
+      await dispatch(pending);
+      pending = [];
     }
   }
+  if (pending.length > 0) {
+    await dispatch(pending);
+  }
 
-  console.log(`Generated ${embeddings.length} embeddings`);
-
-  // Step 3: Store in RuVector
-  console.log('\nStoring embeddings in RuVector...');
-  const stored = await storeEmbeddings(db, embeddings);
-  console.log(`Stored ${stored} embeddings`);
+  await Promise.all(inFlight);
+  await checkpointWrite;
+  await flushVectorIndex();
 
   // Get final count
-  const finalCount = await db.len();
+  const finalCount = await getVectorCount();
 
   // Summary
   console.log('\n=== Sync Complete ===');
-  console.log(`Content fetched: ${content.length}`);
-  console.log(`Embeddings generated: ${embeddings.length}`);
+  console.log(`Content fetched: ${fetched}`);
+  console.log(`Unchanged (skipped): ${skipped}`);
+  console.log(`Embeddings generated: ${embedded}`);
   console.log(`Embeddings stored: ${stored}`);
+  if (failed > 0) {
+    console.log(`Failed (retried next run): ${failed}`);
+  }
   console.log(`Total vectors in database: ${finalCount}`);
+  console.log(`Elapsed: ${((Date.now() - startedAt) / 1000).toFixed(1)}s`);
 }
 
 main().catch(console.error);
@@ -0,0 +1,360 @@
+/**
+ * Partitioned media vector index
+ *
+ * One RuVector database per media type, plus an in-process genre bitmap over
+ * the partition's slots. RuVector has no metadata pre-filter or traversal
+ * hook, so filtered searches are planned from the bitmap instead of a fixed
+ * over-fetch: selective genre filters are answered by an exact scan over the
+ * few eligible vectors, broad ones by widening the HNSW candidate window in
+ * proportion to the filter's selectivity.
+ *
+ * Metadata and slots are persisted in a JSON sidecar next to the partition's
+ * storage file so the bitmap survives restarts. Unit vectors are cached per
+ * slot in one contiguous Float32Array, so exact scans read memory instead of
+ * awaiting a RuVector get() per eligible vector; slots loaded from the
+ * sidecar are filled in one batch the first time a scan needs them.
+ */
+
+import { promises as fs, readFileSync } from 'fs';
+import { VectorDB } from 'ruvector';
+
+export type MediaType = 'movie' | 'tv';
+
+/**
+ * Media content metadata stored alongside vectors
+ */
+export interface MediaVectorMetadata {
+  contentId: number;
+  mediaType: MediaType;
+  title: string;
+  overview: string;
+  genreIds: number[];
+  voteAverage: number;
+  releaseDate: string;
+  posterPath: string | null;
+}
+
+export interface PartitionHit {
+  id: string;
+  score: number;
+  metadata: MediaVectorMetadata;
+}
+
+type RawHit = { id: string; score: number; metadata?: Record<string, unknown> };
+
+// Eligible sets up to this size are answered exactly instead of through HNSW
+const EXACT_SCAN_LIMIT = 512;
+
+// Hard cap on exact scans used as the last resort for a short filtered result
+const EXACT_SCAN_MAX = 4096;
+
+// Widening rounds before falling back to an exact scan
+const MAX_WIDEN_ROUNDS = 2;
+
+const SIDECAR_FLUSH_MS = 1000;
+
+/**
+ * Genre filter resolved against the bitmap
+ */
+interface GenreMask {
+  bits: Uint32Array;
+  count: number;
+}
+
+export class MediaPartition {
+  readonly mediaType: MediaType;
+  readonly storagePath: string;
+  readonly dimensions: number;
+  private db: InstanceType<typeof VectorDB>;
+
+  private slots: Array<string | null> = [];
+  private slotOf = new Map<string, number>();
+  private freeSlots: number[] = [];
+  private metadata = new Map<string, MediaVectorMetadata>();
+  private genreBits = new Map<number, Uint32Array>();
+
+  // Unit vector per slot, and which slots hold one
+  private vectors = new Float32Array(0);
+  private cached = new Uint8Array(0);
+  // Vectors in the RuVector database, read once (it may predate the sidecar)
+  private storedCount: number | null = null;
+
+  private flushTimer: ReturnType<typeof setTimeout> | null = null;
+  // Sidecar writes run one at a time; they share the temp file
+  private flushing: Promise<void> = Promise.resolve();
+
+  constructor(mediaType: MediaType, storagePath: string, dimensions: number, maxElements: number) {
+    this.mediaType = mediaType;
+    this.storagePath = storagePath;
+    this.dimensions = dimensions;
+    this.db = new VectorDB({ dimensions, maxElements, storagePath });
+    this.loadSidecar();
+  }
+
+  /** Number of vectors tracked by the bitmap */
+  get size(): number {
+    return this.metadata.size;
+  }
+
+  async len(): Promise<number> {
+    return await this.db.len();
+  }
+
+  async insert(id: string, vector: Float32Array, metadata: MediaVectorMetadata): Promise<void> {
+    await this.db.insert({ id, vector, metadata });
+    if (this.storedCount !== null && !this.slotOf.has(id)) this.storedCount++;
+    this.cacheVector(this.track(id, metadata), vector);
+    this.scheduleFlush();
+  }
+
+  /**
+   * Insert many vectors with one RuVector insertBatch call
+   */
+  async insertBatch(items: Array<{ id: string; vector: Float32Array; metadata: MediaVectorMetadata }>): Promise<void> {
+    if (items.length === 0) return;
+    await this.db.insertBatch(items);
+    for (const { id, vector, metadata } of items) {
+      if (this.storedCount !== null && !this.slotOf.has(id)) this.storedCount++;
+      this.cacheVector(this.track(id, metadata), vector);
+    }
+    this.scheduleFlush();
+  }
+
+  async get(id: string): Promise<{ vector: Float32Array; metadata: MediaVectorMetadata } | null> {
+    const result = await this.db.get(id);
+    if (!result) return null;
+    return {
+      vector: result.vector as Float32Array,
+      metadata: this.metadata.get(id) ?? (result.metadata as MediaVectorMetadata),
+    };
+  }
+
+  async delete(id: string): Promise<boolean> {
+    const deleted = await this.db.delete(id);
+    if (deleted && this.storedCount !== null) this.storedCount--;
+    this.untrack(id);
+    this.scheduleFlush();
+    return deleted;
+  }
+
+  /**
+   * Top-k by similarity among vectors matching any of the genres. Returns k
+   * results whenever k eligible vectors clear the threshold.
+   */
+  async search(query: Float32Array, k: number, threshold: number, genres?: number[]): Promise<PartitionHit[]> {
+    const mask = genres && genres.length > 0 ? this.genreMask(genres) : null;
+    this.storedCount ??= await this.db.len();
+    const total = Math.max(this.size, this.storedCount);
+    const eligible = mask ? mask.count : total;
+    if (eligible === 0 || k <= 0) return [];
+
+    if (mask && eligible <= EXACT_SCAN_LIMIT) {
+      return this.exactScan(query, k, threshold, mask);
+    }
+
+    // Expected candidates for k matches at this selectivity, with headroom
+    let fetchK = mask ? Math.ceil((k * total * 1.5) / eligible) : k;
+    fetchK = Math.min(Math.max(fetchK, k), total);
+    let hits: PartitionHit[] = [];
+
+    for (let round = 0; round <= MAX_WIDEN_ROUNDS; round++) {
+      const raw = (await this.db.search({ vector: query, k: fetchK, threshold })) as RawHit[];
+      hits = this.resolve(raw, mask);
+
+      // Fewer raw hits than asked means the threshold, not k, cut the window
+      if (!mask || hits.length >= k || raw.length < fetchK || fetchK >= total) {
+        return hits.slice(0, k);
+      }
+      fetchK = Math.min(fetchK * 2, total);
+    }
+
+    return eligible <= EXACT_SCAN_MAX ? this.exactScan(query, k, threshold, mask) : hits.slice(0, k);
+  }
+
+  /**
+   * Write pending sidecar changes now, after any write already in progress
+   */
+  flush(): Promise<void> {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    this.flushing = this.flushing.catch(() => {}).then(() => this.writeSidecar());
+    return this.flushing;
+  }
+
+  private async writeSidecar(): Promise<void> {
+    const entries = this.slots.map((id) => (id ? [id, this.metadata.get(id)] : null));
+    // Temp file + rename so an interrupted write never tears the sidecar
+    const tmp = `${this.sidecarPath()}.tmp`;
+    await fs.writeFile(tmp, JSON.stringify({ version: 1, entries }));
+    await fs.rename(tmp, this.sidecarPath());
+  }
+
+  private resolve(raw: RawHit[], mask: GenreMask | null): PartitionHit[] {
+    const hits: PartitionHit[] = [];
+    for (const r of raw) {
+      if (mask && !this.inMask(mask, r.id)) continue;
+      const metadata = this.metadata.get(r.id) ?? (r.metadata as unknown as MediaVectorMetadata | undefined);
+      if (!metadata || typeof metadata !== 'object' || !('contentId' in metadata)) continue;
+      hits.push({ id: r.id, score: r.score, metadata });
+    }
+    return hits;
+  }
+
+  private async exactScan(query: Float32Array, k: number, threshold: number, mask: GenreMask): Promise<PartitionHit[]> {
+    const queryNorm = norm(query);
+    if (queryNorm === 0) return [];
+
+    const slots: number[] = [];
+    const missing: number[] = [];
+    for (let word = 0; word < mask.bits.length; word++) {
+      let bits = mask.bits[word];
+      while (bits !== 0) {
+        const slot = word * 32 + 31 - Math.clz32(bits & -bits);
+        bits &= bits - 1;
+        if (!this.slots[slot]) continue;
+        slots.push(slot);
+        if (!this.cached[slot]) missing.push(slot);
+      }
+    }
+    if (missing.length > 0) await this.fillCache(missing);
+
+    const dim = this.dimensions;
+    const hits: PartitionHit[] = [];
+    for (const slot of slots) {
+      if (!this.cached[slot]) continue;
+      let dot = 0;
+      for (let d = 0, offset = slot * dim; d < dim; d++) dot += query[d] * this.vectors[offset + d];
+      const score = dot / queryNorm;
+      const id = this.slots[slot]!;
+      if (score >= threshold) hits.push({ id, score, metadata: this.metadata.get(id)! });
+    }
+
+    return hits.sort((a, b) => b.score - a.score).slice(0, k);
+  }
+
+  /**
+   * Load uncached slots' vectors from RuVector, all gets in flight at once
+   */
+  private async fillCache(slots: number[]): Promise<void> {
+    const ids = slots.map((slot) => this.slots[slot]!);
+    const entries = await Promise.all(ids.map((id) => this.db.get(id)));
+    entries.forEach((entry, i) => {
+      // Skip slots reassigned while the gets were in flight
+      if (entry && this.slots[slots[i]] === ids[i]) this.cacheVector(slots[i], entry.vector as Float32Array);
+    });
+  }
+
+  private cacheVector(slot: number, vector: Float32Array): void {
+    const dim = this.dimensions;
+    if (slot >= this.cached.length) {
+      const capacity = Math.max(slot + 1, this.cached.length * 2, 64);
+      const vectors = new Float32Array(capacity * dim);
+      vectors.set(this.vectors);
+      const cached = new Uint8Array(capacity);
+      cached.set(this.cached);
+      this.vectors = vectors;
+      this.cached = cached;
+    }
+
+    const vectorNorm = vector.length === dim ? norm(vector) : 0;
+    // Zero or mis-sized vectors never score, as before
+    this.cached[slot] = vectorNorm > 0 ? 1 : 0;
+    if (vectorNorm === 0) return;
+    for (let d = 0; d < dim; d++) this.vectors[slot * dim + d] = vector[d] / vectorNorm;
+  }
+
+  private genreMask(genres: number[]): GenreMask {
+    const bits = new Uint32Array(Math.ceil(this.slots.length / 32));
+    for (const genre of genres) {
+      const genreBits = this.genreBits.get(genre);
+      if (!genreBits) continue;
+      for (let i = 0; i < genreBits.length; i++) bits[i] |= genreBits[i];
+    }
+
+    let count = 0;
+    for (let i = 0; i < bits.length; i++) count += popcount(bits[i]);
+    return { bits, count };
+  }
+
+  private inMask(mask: GenreMask, id: string): boolean {
+    const slot = this.slotOf.get(id);
+    return slot !== undefined && (mask.bits[slot >>> 5] & (1 << (slot & 31))) !== 0;
+  }
+
+  private track(id: string, metadata: MediaVectorMetadata, slot?: number): number {
+    this.untrack(id);
+
+    if (slot === undefined) slot = this.freeSlots.pop() ?? this.slots.length;
+    this.slots[slot] = id;
+    this.slotOf.set(id, slot);
+    this.metadata.set(id, metadata);
+
+    for (const genre of metadata.genreIds ?? []) {
+      let genreBits = this.genreBits.get(genre);
+      const words = (slot >>> 5) + 1;
+      if (!genreBits || genreBits.length < words) {
+        const grown = new Uint32Array(Math.max(words, (genreBits?.length ?? 0) * 2, 32));
+        if (genreBits) grown.set(genreBits);
+        this.genreBits.set(genre, (genreBits = grown));
+      }
+      genreBits[slot >>> 5] |= 1 << (slot & 31);
+    }
+    return slot;
+  }
+
+  private untrack(id: string): void {
+    const slot = this.slotOf.get(id);
+    if (slot === undefined) return;
+
+    for (const genre of this.metadata.get(id)?.genreIds ?? []) {
+      const genreBits = this.genreBits.get(genre);
+      if (genreBits && (slot >>> 5) < genreBits.length) genreBits[slot >>> 5] &= ~(1 << (slot & 31));
+    }
+    this.slots[slot] = null;
+    if (slot < this.cached.length) this.cached[slot] = 0;
+    this.slotOf.delete(id);
+    this.metadata.delete(id);
+    this.freeSlots.push(slot);
+  }
+
+  private sidecarPath(): string {
+    return `${this.storagePath}.meta.json`;
+  }
+
+  private loadSidecar(): void {
+    let parsed: { entries?: Array<[string, MediaVectorMetadata] | null> };
+    try {
+      parsed = JSON.parse(readFileSync(this.sidecarPath(), 'utf-8'));
+    } catch {
+      return;
+    }
+
+    (parsed.entries ?? []).forEach((entry, slot) => {
+      if (entry) this.track(entry[0], entry[1], slot);
+      else this.slots[slot] = null;
+    });
+    this.freeSlots = this.slots.flatMap((id, slot) => (id ? [] : [slot])).reverse();
+  }
+
+  private scheduleFlush(): void {
+    if (this.flushTimer) return;
+    this.flushTimer = setTimeout(() => {
+      this.flush().catch((error) => console.error(`Failed to write ${this.sidecarPath()}:`, error));
+    }, SIDECAR_FLUSH_MS);
+    this.flushTimer.unref?.();
+  }
+}
+
+function norm(vector: Float32Array): number {
+  let sum = 0;
+  for (let i = 0; i < vector.length; i++) sum += vector[i] * vector[i];
+  return Math.sqrt(sum);
+}
+
+function popcount(word: number): number {
+  word -= (word >>> 1) & 0x55555555;
+  word = (word & 0x33333333) + ((word >>> 2) & 0x33333333);
+  return (((word + (word >>> 4)) & 0x0f0f0f0f) * 0x01010101) >>> 24;
+}
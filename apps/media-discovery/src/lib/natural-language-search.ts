@@ -267,7 +267,11 @@ async function performVectorSearch(query: SemanticSearchQuery): Promise<SearchRe
     if (!queryEmbedding) return [];
 
     // Search vector database
-    const vectorResults = await searchByEmbedding(queryEmbedding, 20);
+    const mediaType = query.filters?.mediaType === 'all' ? undefined : query.filters?.mediaType;
+    const vectorResults = await searchByEmbedding(queryEmbedding, 20, 0.5, {
+      mediaType,
+      genres: query.filters?.genres,
+    });
 
     return vectorResults.map(result => ({
       content: result.content,
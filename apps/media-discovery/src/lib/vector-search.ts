@@ -2,63 +2,89 @@
  * Vector Search Integration with RuVector
  * Uses the ruvector npm package for embedded vector database
  * https://www.npmjs.com/package/ruvector
+ *
+ * Vectors are partitioned by media type, each partition carrying a genre
+ * bitmap so filtered searches don't depend on over-fetching (see
+ * media-vector-index.ts)
  */
 
 import { VectorDB } from 'ruvector';
 import type { MediaContent } from '@/types/media';
+import { MediaPartition, type MediaType, type MediaVectorMetadata, type PartitionHit } from './media-vector-index';
+
+export type { MediaVectorMetadata } from './media-vector-index';
 
 // Embedding dimensions (text-embedding-3-small default, can be customized)
 const EMBEDDING_DIMENSIONS = 768;
 
-// Storage path for persistent vector database
-const STORAGE_PATH = process.env.RUVECTOR_STORAGE_PATH || './data/media-vectors.db';
+// Storage path for persistent vector database (read lazily so scripts can
+// load .env.local before the first database opens)
+const storagePath = () => process.env.RUVECTOR_STORAGE_PATH || './data/media-vectors.db';
 
 // Max elements for the HNSW index
 const MAX_ELEMENTS = 100000;
 
-// Singleton database instance
+const MEDIA_TYPES: MediaType[] = ['movie', 'tv'];
+
+// Singleton database instance (combined index written before partitioning)
 let db: InstanceType<typeof VectorDB> | null = null;
 
+// One partition per media type, created on first use
+const partitions = new Map<MediaType, MediaPartition>();
+
 // Server-side embedding cache (survives across requests in the same process)
 const embeddingCache = new Map<string, { embedding: Float32Array; timestamp: number }>();
 const CACHE_TTL_MS = 5 * 60 * 1000; // 5 minute TTL
 
 /**
- * Media content metadata stored alongside vectors
- */
-interface MediaVectorMetadata {
-  contentId: number;
-  mediaType: 'movie' | 'tv';
-  title: string;
-  overview: string;
-  genreIds: number[];
-  voteAverage: number;
-  releaseDate: string;
-  posterPath: string | null;
-}
-
-/**
- * Get or create the vector database instance
+ * Get or create the legacy combined vector database instance
  */
 export function getVectorDb(): InstanceType<typeof VectorDB> {
   if (!db) {
     db = new VectorDB({
       dimensions: EMBEDDING_DIMENSIONS,
       maxElements: MAX_ELEMENTS,
-      storagePath: STORAGE_PATH,
+      storagePath: storagePath(),
     });
     console.log(`✅ VectorDb initialized with ${EMBEDDING_DIMENSIONS} dimensions`);
   }
   return db;
 }
 
+/**
+ * Storage path of a media type's partition (media-vectors.db -> media-vectors.movie.db)
+ */
+export function getPartitionPath(mediaType: MediaType): string {
+  const base = storagePath();
+  return base.endsWith('.db') ? `${base.slice(0, -3)}.${mediaType}.db` : `${base}.${mediaType}`;
+}
+
+/**
+ * Get or create the partition holding one media type
+ */
+export function getPartition(mediaType: MediaType): MediaPartition {
+  let partition = partitions.get(mediaType);
+  if (!partition) {
+    partition = new MediaPartition(mediaType, getPartitionPath(mediaType), EMBEDDING_DIMENSIONS, MAX_ELEMENTS);
+    partitions.set(mediaType, partition);
+    console.log(`✅ ${mediaType} partition initialized with ${partition.size} indexed vectors`);
+  }
+  return partition;
+}
+
+/**
+ * Persist pending genre index changes (call before a script exits)
+ */
+export async function flushVectorIndex(): Promise<void> {
+  await Promise.all([...partitions.values()].map((partition) => partition.flush()));
+}
+
 /**
  * Check if the vector database is available
  */
 export async function isVectorDbAvailable(): Promise<boolean> {
   try {
-    const database = getVectorDb();
-    await database.len();
+    await getPartition('movie').len();
     return true;
   } catch {
     return false;
@@ -159,30 +185,14 @@ function generateMockEmbedding(text: string): Float32Array {
 }
 
 /**
- * Store media content embedding in the vector database
+ * Store media content embedding in its media type's partition
  */
 export async function storeContentEmbedding(
   content: MediaContent,
   embedding: Float32Array
 ): Promise<string> {
-  const database = getVectorDb();
   const id = `${content.mediaType}-${content.id}`;
-
-  await database.insert({
-    id,
-    vector: embedding,
-    metadata: {
-      contentId: content.id,
-      mediaType: content.mediaType,
-      title: content.title,
-      overview: content.overview,
-      genreIds: content.genreIds,
-      voteAverage: content.voteAverage,
-      releaseDate: content.releaseDate,
-      posterPath: content.posterPath,
-    } as MediaVectorMetadata,
-  });
-
+  await getPartition(content.mediaType).insert(id, embedding, toMetadata(content));
   return id;
 }
 
@@ -192,27 +202,10 @@ export async function storeContentEmbedding(
 export async function batchStoreEmbeddings(
   contents: Array<{ content: MediaContent; embedding: Float32Array }>
 ): Promise<string[]> {
-  const database = getVectorDb();
   const ids: string[] = [];
 
   for (const { content, embedding } of contents) {
-    const id = `${content.mediaType}-${content.id}`;
-    ids.push(id);
-
-    await database.insert({
-      id,
-      vector: embedding,
-      metadata: {
-        contentId: content.id,
-        mediaType: content.mediaType,
-        title: content.title,
-        overview: content.overview,
-        genreIds: content.genreIds,
-        voteAverage: content.voteAverage,
-        releaseDate: content.releaseDate,
-        posterPath: content.posterPath,
-      } as MediaVectorMetadata,
-    });
+    ids.push(await storeContentEmbedding(content, embedding));
   }
 
   console.log(`✅ Stored ${ids.length} embeddings`);
@@ -221,6 +214,10 @@ export async function batchStoreEmbeddings(
 
 /**
  * Search for similar content by embedding vector
+ *
+ * Searches only the requested media type's partition, with genres checked
+ * against the partition's bitmap, so filtered queries still return k results
+ * when k matches clear the threshold.
  */
 export async function searchByEmbedding(
   queryEmbedding: Float32Array,
@@ -228,52 +225,99 @@ export async function searchByEmbedding(
   threshold: number = 0.5,
   filter?: { mediaType?: 'movie' | 'tv'; genres?: number[] }
 ): Promise<Array<{ content: MediaContent; score: number }>> {
-  const database = getVectorDb();
+  const mediaTypes = filter?.mediaType ? [filter.mediaType] : MEDIA_TYPES;
 
-  const results = await database.search({
-    vector: queryEmbedding,
-    k: k * 2, // Get more results to filter
-    threshold,
-  });
+  let hits: PartitionHit[];
+  if (await hasPartitionedData()) {
+    const perPartition = await Promise.all(
+      mediaTypes.map(getPartition).map((partition) => partition.search(queryEmbedding, k, threshold, filter?.genres))
+    );
+    hits = perPartition.flat().sort((a, b) => b.score - a.score);
+  } else {
+    hits = await searchLegacy(queryEmbedding, k, threshold, filter);
+  }
 
-  // Apply post-search filtering (ruvector doesn't have built-in metadata filtering)
-  type SearchResultItem = { id: string; score: number; metadata: Record<string, unknown> };
-  let filtered: SearchResultItem[] = (results as SearchResultItem[]).filter(
-    (r) => r.metadata && typeof r.metadata === 'object' && 'contentId' in r.metadata
-  );
+  return hits.slice(0, k).map((hit) => ({ content: toContent(hit.metadata), score: hit.score }));
+}
 
-  if (filter?.mediaType) {
-    filtered = filtered.filter(
-      (r: SearchResultItem) => (r.metadata as unknown as MediaVectorMetadata).mediaType === filter.mediaType
-    );
+/**
+ * Whether any partition holds vectors; until the sync script has written
+ * them, searches read the combined index
+ */
+async function hasPartitionedData(): Promise<boolean> {
+  for (const mediaType of MEDIA_TYPES) {
+    const partition = getPartition(mediaType);
+    if (partition.size > 0 || (await partition.len()) > 0) return true;
   }
+  return false;
+}
 
-  if (filter?.genres && filter.genres.length > 0) {
-    filtered = filtered.filter((r: SearchResultItem) => {
-      const meta = r.metadata as unknown as MediaVectorMetadata;
-      return meta.genreIds && filter.genres!.some((g: number) => meta.genreIds.includes(g));
-    });
+/**
+ * Post-filtered search on the combined index, widening the window until k
+ * results pass the filter or the index is exhausted
+ */
+async function searchLegacy(
+  queryEmbedding: Float32Array,
+  k: number,
+  threshold: number,
+  filter?: { mediaType?: 'movie' | 'tv'; genres?: number[] }
+): Promise<PartitionHit[]> {
+  const database = getVectorDb();
+  const total = await database.len();
+  const filtered = Boolean(filter?.mediaType || filter?.genres?.length);
+
+  type SearchResultItem = { id: string; score: number; metadata: Record<string, unknown> };
+  let fetchK = Math.min(k, total);
+  let hits: PartitionHit[] = [];
+
+  while (fetchK > 0) {
+    const results = (await database.search({ vector: queryEmbedding, k: fetchK, threshold })) as SearchResultItem[];
+
+    hits = results
+      .filter((r) => r.metadata && typeof r.metadata === 'object' && 'contentId' in r.metadata)
+      .map((r) => ({ id: r.id, score: r.score, metadata: r.metadata as unknown as MediaVectorMetadata }))
+      .filter(({ metadata: meta }) => {
+        if (filter?.mediaType && meta.mediaType !== filter.mediaType) return false;
+        if (filter?.genres && filter.genres.length > 0) {
+          return Boolean(meta.genreIds && filter.genres.some((g) => meta.genreIds.includes(g)));
+        }
+        return true;
+      });
+
+    if (!filtered || hits.length >= k || results.length < fetchK || fetchK >= total) break;
+    fetchK = Math.min(fetchK * 2, total);
   }
 
-  return filtered.slice(0, k).map((result: SearchResultItem) => {
-    const meta = result.metadata as unknown as MediaVectorMetadata;
-    return {
-      content: {
-        id: meta.contentId,
-        title: meta.title || 'Unknown',
-        overview: meta.overview || '',
-        mediaType: meta.mediaType || 'movie',
-        genreIds: meta.genreIds || [],
-        voteAverage: meta.voteAverage || 0,
-        releaseDate: meta.releaseDate || '',
-        posterPath: meta.posterPath || null,
-        backdropPath: null,
-        voteCount: 0,
-        popularity: 0,
-      },
-      score: result.score,
-    };
-  });
+  return hits;
+}
+
+function toMetadata(content: MediaContent): MediaVectorMetadata {
+  return {
+    contentId: content.id,
+    mediaType: content.mediaType,
+    title: content.title,
+    overview: content.overview,
+    genreIds: content.genreIds,
+    voteAverage: content.voteAverage,
+    releaseDate: content.releaseDate,
+    posterPath: content.posterPath,
+  };
+}
+
+function toContent(meta: MediaVectorMetadata): MediaContent {
+  return {
+    id: meta.contentId,
+    title: meta.title || 'Unknown',
+    overview: meta.overview || '',
+    mediaType: meta.mediaType || 'movie',
+    genreIds: meta.genreIds || [],
+    voteAverage: meta.voteAverage || 0,
+    releaseDate: meta.releaseDate || '',
+    posterPath: meta.posterPath || null,
+    backdropPath: null,
+    voteCount: 0,
+    popularity: 0,
+  };
 }
 
 /**
@@ -300,18 +344,17 @@ export async function findSimilarContent(
   mediaType: 'movie' | 'tv',
   k: number = 10
 ): Promise<Array<{ content: MediaContent; score: number }>> {
-  const database = getVectorDb();
-  const id = `${mediaType}-${contentId}`;
-
   // Get the existing embedding
-  const existing = await database.get(id);
+  const existing = await getContentVector(contentId, mediaType);
   if (!existing) {
     return [];
   }
 
   // Search for similar (excluding self)
-  const results = await searchByEmbedding(existing.vector as Float32Array, k + 1, 0.3);
-  return results.filter((r) => r.content.id !== contentId).slice(0, k);
+  const results = await searchByEmbedding(existing.vector, k + 1, 0.3);
+  return results
+    .filter((r) => r.content.id !== contentId || r.content.mediaType !== mediaType)
+    .slice(0, k);
 }
 
 /**
@@ -321,10 +364,14 @@ export async function getContentVector(
   contentId: number,
   mediaType: 'movie' | 'tv'
 ): Promise<{ vector: Float32Array; metadata: MediaVectorMetadata } | null> {
-  const database = getVectorDb();
   const id = `${mediaType}-${contentId}`;
 
-  const result = await database.get(id);
+  const partitioned = await getPartition(mediaType).get(id);
+  if (partitioned) {
+    return partitioned;
+  }
+
+  const result = await getVectorDb().get(id);
   if (!result) {
     return null;
   }
@@ -342,18 +389,25 @@ export async function deleteContentVector(
   contentId: number,
   mediaType: 'movie' | 'tv'
 ): Promise<boolean> {
-  const database = getVectorDb();
   const id = `${mediaType}-${contentId}`;
 
-  return await database.delete(id);
+  const [partitioned, legacy] = await Promise.all([
+    getPartition(mediaType).delete(id),
+    getVectorDb().delete(id),
+  ]);
+  return partitioned || legacy;
 }
 
 /**
  * Get the total number of vectors in the database
  */
 export async function getVectorCount(): Promise<number> {
-  const database = getVectorDb();
-  return await database.len();
+  if (!(await hasPartitionedData())) {
+    return await getVectorDb().len();
+  }
+
+  const counts = await Promise.all(MEDIA_TYPES.map((mediaType) => getPartition(mediaType).len()));
+  return counts.reduce((sum, count) => sum + count, 0);
 }
 
 /**
@@ -415,12 +469,9 @@ export async function getDbStats(): Promise<{
   dimensions: number;
   storagePath: string;
 }> {
-  const database = getVectorDb();
-  const count = await database.len();
-
   return {
-    vectorCount: count,
+    vectorCount: await getVectorCount(),
     dimensions: EMBEDDING_DIMENSIONS,
-    storagePath: STORAGE_PATH,
+    storagePath: storagePath(),
   };
 }